@@ -0,0 +1,325 @@
+/* ============================================================================
+ *  Async.c: Running the RSP on a thread of its own.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include "Address.h"
+#include "Async.h"
+#include "Common.h"
+#include "CP0.h"
+#include "CPU.h"
+#include "Interface.h"
+#include "Pipeline.h"
+
+#ifdef __cplusplus
+#include <cstdlib>
+#else
+#include <stdlib.h>
+#endif
+
+#ifdef RSP_ASYNC_THREADED
+#include <sched.h>
+#endif
+
+/* ============================================================================
+ *  WriteAddress: Writes a word to an SP register, DMEM or IMEM.
+ * ========================================================================= */
+static void
+WriteAddress(struct RSP *rsp, uint32_t address, uint32_t data) {
+  if (address >= SP_REGS2_BASE_ADDRESS)
+    SPRegWrite2(rsp, address, &data);
+
+  else if (address >= SP_REGS_BASE_ADDRESS)
+    SPRegWrite(rsp, address, &data);
+
+  else if (address >= RSP_IMEM_BASE_ADDRESS)
+    RSPIMemWriteWord(rsp, address, &data);
+
+  else
+    RSPDMemWriteWord(rsp, address, &data);
+}
+
+/* ============================================================================
+ *  ReadAddress: Reads a word from an SP register, DMEM or IMEM.
+ * ========================================================================= */
+static uint32_t
+ReadAddress(struct RSP *rsp, uint32_t address) {
+  uint32_t data;
+
+  if (address >= SP_REGS2_BASE_ADDRESS)
+    SPRegRead2(rsp, address, &data);
+
+  else if (address >= SP_REGS_BASE_ADDRESS)
+    SPRegRead(rsp, address, &data);
+
+  else if (address >= RSP_IMEM_BASE_ADDRESS)
+    RSPIMemReadWord(rsp, address, &data);
+
+  else
+    RSPDMemReadWord(rsp, address, &data);
+
+  return data;
+}
+
+/* ============================================================================
+ *  Execute: Carries out a command, and publishes the status that results.
+ *  A run stops short if the RSP halts, just as CycleRSP would do nothing.
+ * ========================================================================= */
+static void
+Execute(struct RSPAsync *async, const struct RSPAsyncCommand *command) {
+  struct RSP *rsp = async->rsp;
+  unsigned long long cycles = async->cycles;
+  enum RSPRunStatus status;
+  unsigned remaining;
+
+  switch (command->type) {
+    case RSP_ASYNC_RUN:
+      for (remaining = command->data; remaining > 0; ) {
+        unsigned count = RunRSP(rsp, remaining, &status);
+
+        remaining -= count;
+        cycles += count;
+
+        if (status == RSP_RUN_BREAK || status == RSP_RUN_HALT)
+          break;
+      }
+
+      break;
+
+    case RSP_ASYNC_WRITE:
+      WriteAddress(rsp, command->address, command->data);
+      break;
+
+    case RSP_ASYNC_STOP:
+      break;
+  }
+
+#ifdef RSP_ASYNC_THREADED
+  __atomic_store_n(&async->cycles, cycles, __ATOMIC_RELAXED);
+  __atomic_store_n(&async->status,
+    rsp->cp0.regs[SP_STATUS_REG], __ATOMIC_RELEASE);
+#else
+  async->cycles = cycles;
+  async->status = rsp->cp0.regs[SP_STATUS_REG];
+#endif
+}
+
+#ifdef RSP_ASYNC_THREADED
+/* ============================================================================
+ *  Wait: Backs off while waiting on the other side of the queue.
+ * ========================================================================= */
+static void
+Wait(unsigned *spins) {
+  if (*spins < RSP_ASYNC_SPINS)
+    (*spins)++;
+
+  else
+    sched_yield();
+}
+
+/* ============================================================================
+ *  RunWorker: Carries out commands as they come in, until told to stop.
+ * ========================================================================= */
+static void *
+RunWorker(void *opaque) {
+  struct RSPAsync *async = (struct RSPAsync*) opaque;
+  unsigned tail = async->tail;
+
+  for (;;) {
+    struct RSPAsyncCommand command;
+    unsigned spins = 0;
+
+    while (tail == __atomic_load_n(&async->head, __ATOMIC_ACQUIRE))
+      Wait(&spins);
+
+    command = async->queue[tail & (RSP_ASYNC_QUEUE_SIZE - 1)];
+    Execute(async, &command);
+
+    /* Makes everything the command did visible to the host. */
+    __atomic_store_n(&async->tail, ++tail, __ATOMIC_RELEASE);
+
+    if (command.type == RSP_ASYNC_STOP)
+      return NULL;
+  }
+}
+#endif
+
+/* ============================================================================
+ *  Enqueue: Hands a command to the worker, waiting for room if the queue
+ *  is full. Without a worker, the command is just carried out.
+ * ========================================================================= */
+static void
+Enqueue(struct RSPAsync *async, enum RSPAsyncCommandType type,
+  uint32_t address, uint32_t data) {
+  struct RSPAsyncCommand command;
+
+  command.type = type;
+  command.address = address;
+  command.data = data;
+
+#ifdef RSP_ASYNC_THREADED
+  if (async->threaded) {
+    unsigned head = async->head;
+    unsigned spins = 0;
+
+    while (head - __atomic_load_n(&async->tail, __ATOMIC_ACQUIRE) ==
+      RSP_ASYNC_QUEUE_SIZE)
+      Wait(&spins);
+
+    async->queue[head & (RSP_ASYNC_QUEUE_SIZE - 1)] = command;
+    __atomic_store_n(&async->head, head + 1, __ATOMIC_RELEASE);
+    return;
+  }
+#endif
+
+  Execute(async, &command);
+}
+
+/* ============================================================================
+ *  CreateRSPAsync: Starts a worker thread for an RSP instance, which then
+ *  belongs to it until DestroyRSPAsync.
+ *
+ *  The host queues up what it would have done to the RSP (run it, write
+ *  an SP register or DMEM/IMEM) and the worker does it, in order, while
+ *  the host gets on with other things. Reads sync first (wait for the
+ *  worker to catch up), so the host sees what it would have seen had it
+ *  done everything itself.
+ *
+ *  The externs (DMA, interrupts, DP registers) are called by the worker
+ *  in the meantime. Results stay deterministic as long as the host only
+ *  looks at what they touch after a sync (e.g., once per time slice).
+ *
+ *  If threads aren't available (or one can't be started), commands are
+ *  just carried out as they are queued.
+ * ========================================================================= */
+struct RSPAsync *
+CreateRSPAsync(struct RSP *rsp) {
+  struct RSPAsync *async;
+  void *memory;
+
+#ifdef RSP_ASYNC_THREADED
+  if (posix_memalign(&memory, 64, sizeof(*async)))
+    memory = NULL;
+#else
+  memory = malloc(sizeof(*async));
+#endif
+
+  if ((async = (struct RSPAsync*) memory) == NULL) {
+    debug("Failed to allocate memory.");
+    return NULL;
+  }
+
+  async->head = 0;
+  async->tail = 0;
+  async->status = rsp->cp0.regs[SP_STATUS_REG];
+  async->cycles = 0;
+  async->rsp = rsp;
+  async->threaded = false;
+
+#ifdef RSP_ASYNC_THREADED
+  async->threaded = !pthread_create(&async->thread, NULL, RunWorker, async);
+#endif
+
+  return async;
+}
+
+/* ============================================================================
+ *  DestroyRSPAsync: Finishes what is queued, and stops the worker. The
+ *  RSP instance is left as is, for the host to carry on with or destroy.
+ * ========================================================================= */
+void
+DestroyRSPAsync(struct RSPAsync *async) {
+#ifdef RSP_ASYNC_THREADED
+  if (async->threaded) {
+    Enqueue(async, RSP_ASYNC_STOP, 0, 0);
+    pthread_join(async->thread, NULL);
+  }
+#endif
+
+  free(async);
+}
+
+/* ============================================================================
+ *  RSPAsyncRun: Queues up running the RSP for a number of cycles (as with
+ *  RunRSP, the functional modes count instructions instead).
+ * ========================================================================= */
+void
+RSPAsyncRun(struct RSPAsync *async, unsigned cycles) {
+  Enqueue(async, RSP_ASYNC_RUN, 0, cycles);
+}
+
+/* ============================================================================
+ *  RSPAsyncWrite: Queues up a write to an SP register (PC included), or
+ *  a word of DMEM/IMEM. It takes effect after everything queued before.
+ * ========================================================================= */
+void
+RSPAsyncWrite(struct RSPAsync *async, uint32_t address, uint32_t data) {
+  Enqueue(async, RSP_ASYNC_WRITE, address, data);
+}
+
+/* ============================================================================
+ *  RSPAsyncRead: Reads an SP register (PC included), or a word of DMEM or
+ *  IMEM, once everything queued has been done.
+ * ========================================================================= */
+uint32_t
+RSPAsyncRead(struct RSPAsync *async, uint32_t address) {
+  RSPAsyncSync(async);
+  return ReadAddress(async->rsp, address);
+}
+
+/* ============================================================================
+ *  RSPAsyncSync: Waits for the worker to finish everything queued. Until
+ *  something else is queued, the host may use the instance directly.
+ * ========================================================================= */
+void
+RSPAsyncSync(struct RSPAsync *async) {
+#ifdef RSP_ASYNC_THREADED
+  unsigned spins = 0;
+
+  if (!async->threaded)
+    return;
+
+  while (__atomic_load_n(&async->tail, __ATOMIC_ACQUIRE) != async->head)
+    Wait(&spins);
+#else
+  (void) async;
+#endif
+}
+
+/* ============================================================================
+ *  RSPAsyncGetStatus: Returns SP_STATUS as of the last command done, for
+ *  the host to poll without syncing (e.g., to see if the RSP halted). As
+ *  the worker may be anywhere in the queue, it's only a hint; it is exact
+ *  after a sync.
+ * ========================================================================= */
+uint32_t
+RSPAsyncGetStatus(const struct RSPAsync *async) {
+#ifdef RSP_ASYNC_THREADED
+  return __atomic_load_n(&async->status, __ATOMIC_ACQUIRE);
+#else
+  return async->status;
+#endif
+}
+
+/* ============================================================================
+ *  RSPAsyncGetCycles: Returns the cycles run so far; like the status, it
+ *  is only exact after a sync.
+ * ========================================================================= */
+unsigned long long
+RSPAsyncGetCycles(const struct RSPAsync *async) {
+#ifdef RSP_ASYNC_THREADED
+  return __atomic_load_n(&async->cycles, __ATOMIC_RELAXED);
+#else
+  return async->cycles;
+#endif
+}
+
@@ -0,0 +1,71 @@
+/* ============================================================================
+ *  Async.h: Running the RSP on a thread of its own.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__ASYNC_H__
+#define __RSP__ASYNC_H__
+#include "Common.h"
+#include "CPU.h"
+
+#if defined(__GNUC__) && (defined(__unix__) || defined(__APPLE__))
+#define RSP_ASYNC_THREADED
+#include <pthread.h>
+#endif
+
+/* Commands that can be in flight at once (a power of two). */
+#define RSP_ASYNC_QUEUE_SIZE 256
+
+/* Times the host spins on a full queue (or the worker on */
+/* an empty one) before it starts yielding its processor. */
+#define RSP_ASYNC_SPINS 1024
+
+enum RSPAsyncCommandType {
+  RSP_ASYNC_RUN,
+  RSP_ASYNC_WRITE,
+  RSP_ASYNC_STOP
+};
+
+struct RSPAsyncCommand {
+  enum RSPAsyncCommandType type;
+  uint32_t address;
+  uint32_t data;
+};
+
+/* The host is the only one to write head, and the worker */
+/* the only one to write tail; each is on a line of its own. */
+struct RSPAsync {
+  struct RSPAsyncCommand queue[RSP_ASYNC_QUEUE_SIZE];
+  unsigned head align(64);
+  unsigned tail align(64);
+
+  /* Published by the worker after every command. */
+  uint32_t status align(64);
+  unsigned long long cycles;
+
+  struct RSP *rsp;
+  bool threaded;
+
+#ifdef RSP_ASYNC_THREADED
+  pthread_t thread;
+#endif
+};
+
+struct RSPAsync *CreateRSPAsync(struct RSP *);
+void DestroyRSPAsync(struct RSPAsync *);
+
+void RSPAsyncRun(struct RSPAsync *, unsigned);
+void RSPAsyncWrite(struct RSPAsync *, uint32_t, uint32_t);
+uint32_t RSPAsyncRead(struct RSPAsync *, uint32_t);
+void RSPAsyncSync(struct RSPAsync *);
+
+uint32_t RSPAsyncGetStatus(const struct RSPAsync *);
+unsigned long long RSPAsyncGetCycles(const struct RSPAsync *);
+
+#endif
+
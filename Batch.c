@@ -0,0 +1,304 @@
+/* ============================================================================
+ *  Batch.c: Parallel batch runner.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include "Address.h"
+#include "Batch.h"
+#include "Common.h"
+#include "CP0.h"
+#include "CP2.h"
+#include "CPU.h"
+#include "DecodeCache.h"
+#include "Definitions.h"
+#include "IdleLoop.h"
+#include "Interface.h"
+#include "Pipeline.h"
+#include "Registry.h"
+
+#ifdef __cplusplus
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#else
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define RSP_HAVE_PTHREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/* A worker's share of the tasks: [next, end). Others steal */
+/* from the end when they run out, so the lock is only ever */
+/* contended when someone is out of work. */
+struct RSPBatchWorker {
+  struct RSPBatch *batch;
+  struct RSP *rsp;
+  size_t next, end;
+
+#ifdef RSP_HAVE_PTHREADS
+  pthread_mutex_t lock;
+  pthread_t thread;
+#endif
+};
+
+struct RSPBatch {
+  struct RSPBatchTask *tasks;
+  struct RSPBatchWorker *workers;
+  unsigned numWorkers;
+};
+
+/* ============================================================================
+ *  LoadTask: Puts an instance in the state that a task starts in.
+ *
+ *  Everything the microcode can see is reset, as if the instance was new.
+ *  The decode cache, registry and translated blocks are kept: IMEM is
+ *  replaced the way the CPU would, so the registry gets to pick up where
+ *  it left off if the same microcode is run again.
+ * ========================================================================= */
+static void
+LoadTask(struct RSP *rsp, const struct RSPBatchTask *task) {
+  uint32_t status = SP_CLR_HALT;
+  bool allowed = rsp->idleLoop.allowed;
+
+  RSPRegistrySave(rsp);
+  memcpy(rsp->imem, task->imem, RSP_IMEM_SIZE);
+  RSPInvalidateDecodeCache(&rsp->decodeCache, 0, RSP_IMEM_SIZE);
+  memcpy(rsp->dmem, task->dmem, RSP_DMEM_SIZE);
+
+  memset(rsp->regs, 0, sizeof(rsp->regs));
+  memcpy(rsp->regs, task->regs, sizeof(task->regs));
+  rsp->regs[0] = 0;
+
+  RSPInitCP0(&rsp->cp0);
+  RSPInitCP2(&rsp->cp2);
+  memset(&rsp->pipeline, 0, sizeof(rsp->pipeline));
+  RSPInitPipeline(&rsp->pipeline);
+  RSPInitIdleLoop(&rsp->idleLoop);
+  rsp->idleLoop.allowed = allowed;
+
+  rsp->pipeline.ifrdLatch.pc = (task->pc & 0xFFC) | 0x1000;
+  rsp->cp0.regs[SP_PC_REG] = task->pc;
+  rsp->didBranch = 0;
+  rsp->events = 0;
+
+  ConnectRSPToBus(rsp, task->bus);
+  SPRegWrite(rsp, SP_REGS_BASE_ADDRESS + SP_STATUS_REG * 4, &status);
+}
+
+/* ============================================================================
+ *  RunTask: Runs a task until it breaks, halts or runs out of budget.
+ * ========================================================================= */
+static void
+RunTask(struct RSP *rsp, struct RSPBatchTask *task) {
+  enum RSPRunStatus status = RSP_RUN_BUDGET;
+  unsigned long long remaining = task->cycles;
+
+  LoadTask(rsp, task);
+
+  while (remaining > 0) {
+    unsigned budget = remaining > UINT_MAX ? UINT_MAX : remaining;
+    remaining -= RunRSP(rsp, budget, &status);
+
+    if (status == RSP_RUN_BREAK || status == RSP_RUN_HALT)
+      break;
+  }
+
+  task->status = status;
+  task->cyclesRun = task->cycles - remaining;
+  task->dmemHash = RSPFingerprint(rsp->dmem, RSP_DMEM_SIZE);
+  task->dramHash = task->dram != NULL
+    ? RSPFingerprint(task->dram, task->dramSize) : 0;
+
+  ConnectRSPToBus(rsp, NULL);
+}
+
+#ifdef RSP_HAVE_PTHREADS
+/* ============================================================================
+ *  TakeTask: Takes the next task from a worker's own share. If it has run
+ *  out, half of what is left of the largest share is stolen instead.
+ *  Returns false once there is nothing left anywhere.
+ * ========================================================================= */
+static bool
+TakeTask(struct RSPBatchWorker *worker, size_t *task) {
+  struct RSPBatch *batch = worker->batch;
+
+  for (;;) {
+    struct RSPBatchWorker *victim = NULL;
+    size_t remaining = 0;
+    unsigned i;
+
+    pthread_mutex_lock(&worker->lock);
+
+    if (worker->next < worker->end) {
+      *task = worker->next++;
+      pthread_mutex_unlock(&worker->lock);
+      return true;
+    }
+
+    pthread_mutex_unlock(&worker->lock);
+
+    /* Shares only ever shrink, so a stale look is harmless. */
+    for (i = 0; i < batch->numWorkers; i++) {
+      struct RSPBatchWorker *other = &batch->workers[i];
+      size_t left;
+
+      pthread_mutex_lock(&other->lock);
+      left = other->end - other->next;
+      pthread_mutex_unlock(&other->lock);
+
+      if (left > remaining) {
+        remaining = left;
+        victim = other;
+      }
+    }
+
+    if (victim == NULL)
+      return false;
+
+    pthread_mutex_lock(&victim->lock);
+
+    if ((remaining = victim->end - victim->next) > 0) {
+      size_t stolen = (remaining + 1) / 2;
+
+      victim->end -= stolen;
+      pthread_mutex_unlock(&victim->lock);
+
+      /* Only its owner ever adds to a share, and it's empty. */
+      pthread_mutex_lock(&worker->lock);
+      worker->next = victim->end;
+      worker->end = victim->end + stolen;
+      pthread_mutex_unlock(&worker->lock);
+    }
+
+    else
+      pthread_mutex_unlock(&victim->lock);
+  }
+}
+
+/* ============================================================================
+ *  RunWorker: Runs tasks on a worker's instance until none are left.
+ * ========================================================================= */
+static void *
+RunWorker(void *opaque) {
+  struct RSPBatchWorker *worker = (struct RSPBatchWorker*) opaque;
+  size_t task;
+
+  while (TakeTask(worker, &task))
+    RunTask(worker->rsp, &worker->batch->tasks[task]);
+
+  return NULL;
+}
+
+/* ============================================================================
+ *  GetDefaultThreads: Returns the number of processors online.
+ * ========================================================================= */
+static unsigned
+GetDefaultThreads(void) {
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (unsigned) count : 1;
+}
+#endif
+
+/* ============================================================================
+ *  RSPRunBatch: Runs a list of independent tasks across several threads
+ *  (as many as there are processors, if zero), each with an instance of
+ *  its own, and fills in their results.
+ *
+ *  The tasks are split evenly between the threads up front; threads that
+ *  finish early steal from the others. Instances are reused from one task
+ *  to the next, so tasks that share a microcode only decode (and, in the
+ *  recompiler mode, translate) it once per thread.
+ *
+ *  Returns zero on success, or nonzero if the instances couldn't be
+ *  created (in which case no task was run).
+ * ========================================================================= */
+int
+RSPRunBatch(struct RSPBatchTask *tasks, size_t numTasks,
+  unsigned threads, enum RSPExecutionMode mode) {
+  struct RSPBatchWorker *workers;
+  struct RSPBatch batch;
+  unsigned i;
+  int status = 0;
+
+#ifdef RSP_HAVE_PTHREADS
+  if (threads == 0)
+    threads = GetDefaultThreads();
+#else
+  threads = 1;
+#endif
+
+  if (threads > numTasks)
+    threads = numTasks > 0 ? (unsigned) numTasks : 1;
+
+  if ((workers = (struct RSPBatchWorker*) calloc(
+    threads, sizeof(*workers))) == NULL) {
+    debug("Failed to allocate memory.");
+    return 1;
+  }
+
+  batch.tasks = tasks;
+  batch.workers = workers;
+  batch.numWorkers = threads;
+
+  for (i = 0; i < threads; i++) {
+    workers[i].batch = &batch;
+    workers[i].next = numTasks * i / threads;
+    workers[i].end = numTasks * (i + 1) / threads;
+
+    if ((workers[i].rsp = CreateRSP()) == NULL) {
+      status = 1;
+      break;
+    }
+
+    RSPSetExecutionMode(workers[i].rsp, mode);
+  }
+
+#ifdef RSP_HAVE_PTHREADS
+  if (status == 0) {
+    for (i = 0; i < threads; i++)
+      pthread_mutex_init(&workers[i].lock, NULL);
+
+    /* This thread runs the first share itself. */
+    for (i = 1; i < threads; i++) {
+      if (pthread_create(&workers[i].thread, NULL, RunWorker, &workers[i]))
+        break;
+    }
+
+    RunWorker(&workers[0]);
+
+    while (--i > 0)
+      pthread_join(workers[i].thread, NULL);
+
+    for (i = 0; i < threads; i++)
+      pthread_mutex_destroy(&workers[i].lock);
+  }
+#else
+  if (status == 0) {
+    size_t task;
+
+    for (task = 0; task < numTasks; task++)
+      RunTask(workers[0].rsp, &tasks[task]);
+  }
+#endif
+
+  for (i = 0; i < threads && workers[i].rsp != NULL; i++)
+    DestroyRSP(workers[i].rsp);
+
+  free(workers);
+  return status;
+}
+
@@ -0,0 +1,52 @@
+/* ============================================================================
+ *  Batch.h: Parallel batch runner.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__BATCH_H__
+#define __RSP__BATCH_H__
+#include "Common.h"
+#include "CPU.h"
+#include "Pipeline.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+#else
+#include <stddef.h>
+#endif
+
+struct BusController;
+
+/* One task: a microcode, the state it starts in, and a budget. */
+/* The bus is connected while the task runs; DMA goes through it */
+/* to whatever DRAM it holds. If dram is set, the same DRAM is */
+/* hashed once the task is done (dramSize must be a multiple of */
+/* 32). Tasks must not share a bus or DRAM. */
+struct RSPBatchTask {
+  const uint8_t *imem;
+  const uint8_t *dmem;
+  uint32_t regs[NUM_RSP_REGISTERS];
+  uint32_t pc;
+
+  struct BusController *bus;
+  const uint8_t *dram;
+  size_t dramSize;
+  unsigned long long cycles;
+
+  /* Filled in by RSPRunBatch. */
+  enum RSPRunStatus status;
+  unsigned long long cyclesRun;
+  uint64_t dmemHash;
+  uint64_t dramHash;
+};
+
+int RSPRunBatch(struct RSPBatchTask *, size_t,
+  unsigned, enum RSPExecutionMode);
+
+#endif
+
@@ -48,6 +48,10 @@ RSPMFC0(struct RSP *rsp, uint32_t unused(rs), uint32_t unused(rt)) {
 
   SPRegRead(rsp, SP_REGS_BASE_ADDRESS + (rd * sizeof(uint32_t)), &result);
 
+  /* Polling loops spin on these; have the next loop branch checked. */
+  if (rd < CMD_START && rsp->idleLoop.enabled)
+    rsp->idleLoop.polled = rsp->idleLoop.armed = true;
+
   exdfLatch->result.data = result;
   exdfLatch->result.dest = dest;
 }
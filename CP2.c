@@ -24,6 +24,24 @@
 #include <string.h>
 #endif
 
+/* Built as is, this file holds the SSSE3 functions; the */
+/* wrappers around it (e.g., CP2SSE41.c) build the rest. */
+#ifdef RSP_CP2_VARIANT
+#include "CP2Variant.h"
+#elif defined(RSP_SSE_DISPATCH)
+#pragma GCC target("ssse3")
+#ifndef SSSE3_ONLY
+#define SSSE3_ONLY
+#endif
+#endif
+
+/* Wrappers also build it for one element form at a time (see */
+/* RSPGetElementForm), with the operands built for just that */
+/* form; the fused idioms take any element, so they're left out. */
+#if !defined(RSP_CP2_IDENTITY) && !defined(RSP_CP2_WHOLE)
+#define RSP_CP2_ANY_ELEMENT
+#endif
+
 #ifdef USE_SSE
 #ifdef SSSE3_ONLY
 #include <tmmintrin.h>
@@ -32,51 +50,64 @@
 #endif
 
 /* ============================================================================
- *  RSPClampLowToVal: Clamps the low word of the accumulator.
+ *  RSPClampLowToVal: Clamps the low word of the accumulator: it is kept
+ *  where the upper 32 bits fit in 16 (i.e., adding 0x8000 to them leaves
+ *  the top half zero), and zeroed everywhere else.
  * ========================================================================= */
 static __m128i
-RSPClampLowToVal(__m128i vaccLow, __m128i vaccMid, __m128i vaccHigh) {
-  __m128i setMask = _mm_cmpeq_epi16(_mm_setzero_si128(), _mm_setzero_si128());
-  __m128i negCheck, useValMask, negVal, posVal;
-
-  /* Compute some common values ahead of time. */
-  negCheck = _mm_cmplt_epi16(vaccHigh, _mm_setzero_si128());
-
-  /* If accmulator < 0, clamp to val if val != TMin. */
-  useValMask = _mm_and_si128(vaccHigh, _mm_srai_epi16(vaccMid, 15));
-  useValMask = _mm_cmpeq_epi16(useValMask, setMask);
-  negVal = _mm_and_si128(useValMask, vaccLow);
+RSPClampLowToVal(__m128i vaccLow, __m128i upperLo, __m128i upperHi) {
+  __m128i bias = _mm_set1_epi32(0x8000);
+  __m128i useValMask;
 
-  /* Otherwise, clamp to ~0 if any high bits are set. */
-  useValMask = _mm_or_si128(vaccHigh, _mm_srai_epi16(vaccMid, 15));
+  upperLo = _mm_srli_epi32(_mm_add_epi32(upperLo, bias), 16);
+  upperHi = _mm_srli_epi32(_mm_add_epi32(upperHi, bias), 16);
+  useValMask = _mm_packs_epi32(upperLo, upperHi);
   useValMask = _mm_cmpeq_epi16(useValMask, _mm_setzero_si128());
-  posVal = _mm_and_si128(useValMask, vaccLow);
+  return _mm_and_si128(useValMask, vaccLow);
+}
 
-#ifdef SSSE3_ONLY
-  negVal = _mm_and_si128(negCheck, negVal);
-  posVal = _mm_andnot_si128(negCheck, posVal);
-  return _mm_or_si128(negVal, posVal);
-#else
-  return _mm_blendv_epi8(posVal, negVal, negCheck);
-#endif
+/* ============================================================================
+ *  RSPClampQuantized: Clamps half the upper 32 bits of the accumulator to
+ *  16 bits, and clears the low 4 (as VMULQ and VMACQ write them out).
+ * ========================================================================= */
+static __m128i
+RSPClampQuantized(__m128i upperLo, __m128i upperHi) {
+  __m128i vdReg;
+
+  upperLo = _mm_srai_epi32(upperLo, 1);
+  upperHi = _mm_srai_epi32(upperHi, 1);
+  vdReg = _mm_packs_epi32(upperLo, upperHi);
+  return _mm_and_si128(vdReg, _mm_set1_epi16(~0xF));
 }
 
 /* ============================================================================
- *  RSPGetVCO: Get VCO in the "old" format.
+ *  RSPOddify: Where bit 5 of the upper 32 bits of the accumulator is clear,
+ *  steps them 32 towards zero (values in [0, 32) are left alone).
  * ========================================================================= */
-#ifdef USE_SSE
-uint16_t
-RSPGetVCO(const struct RSPCP2 *cp2) {
-  __m128i vne = _mm_load_si128((__m128i*) (cp2->vcohi.slices));
-  __m128i vco = _mm_load_si128((__m128i*) (cp2->vcolo.slices));
-  return (uint16_t) _mm_movemask_epi8(_mm_packs_epi16(vco, vne));
+static __m128i
+RSPOddify(__m128i upper) {
+  __m128i step = _mm_set1_epi32(32);
+  __m128i negative = _mm_srai_epi32(upper, 31);
+  __m128i atLeast32 = _mm_cmpgt_epi32(upper, _mm_set1_epi32(31));
+  __m128i bitClear = _mm_cmpeq_epi32(_mm_and_si128(upper, step),
+    _mm_setzero_si128());
+
+  step = _mm_sub_epi32(_mm_and_si128(negative, step),
+    _mm_and_si128(atLeast32, step));
+
+  return _mm_add_epi32(upper, _mm_and_si128(bitClear, step));
 }
-#endif
 
 /* ============================================================================
  *  RSPGetVectorOperands: Builds and returns the proper configuration of the
  *  `vt` vector for instructions that require the use of a element specifier.
  * ========================================================================= */
+#ifdef RSP_CP2_IDENTITY
+static __m128i
+RSPGetVectorOperands(__m128i vt, unsigned unused(element)) {
+  return vt;
+}
+#else
 static __m128i
 RSPGetVectorOperands(__m128i vt, unsigned element) {
   static const uint8_t VectorOperandsArray[16][16] align(16) = {
@@ -102,6 +133,7 @@ RSPGetVectorOperands(__m128i vt, unsigned element) {
   __m128i key = _mm_load_si128((__m128i*) VectorOperandsArray[element]);
   return _mm_shuffle_epi8(vt, key);
 }
+#endif
 
 /* ============================================================================
  *  RSPPackLo32to16: Pack LSBs of 32-bit vectors to 16-bits without saturation.
@@ -122,32 +154,6 @@ RSPPackLo32to16(__m128i vectorLow, __m128i vectorHigh) {
 #endif
 }
 
-/* ============================================================================
- *  RSPPackHi32to16: Pack MSBs of 32-bit vectors to 16-bits without saturation.
- * ========================================================================= */
-static __m128i
-RSPPackHi32to16(__m128i vectorLow, __m128i vectorHigh) {
-  vectorLow = _mm_srai_epi32(vectorLow, 16);
-  vectorHigh = _mm_srai_epi32(vectorHigh, 16);
-  return _mm_packs_epi32(vectorLow, vectorHigh);
-}
-
-/* ============================================================================
- *  RSPSetVCO: Set VCO given the "old" format.
- * ========================================================================= */
-#ifdef USE_SSE
-void
-RSPSetVCO(struct RSPCP2 *cp2, uint16_t vco) {
-  static const uint16_t lut[2] = {0x0000, 0xFFFFU};
-  unsigned i;
-
-  for (i = 0; i < 8; i++, vco >>= 1) {
-    cp2->vcolo.slices[i] = lut[(vco >> 0) & 1];
-    cp2->vcohi.slices[i] = lut[(vco >> 8) & 1];
-  }
-}
-#endif
-
 /* ============================================================================
  *  RSPSignExtend16to32: Sign-extend 16-bit slices to 32-bit slices.
  * ========================================================================= */
@@ -167,6 +173,71 @@ RSPZeroExtend16to32(__m128i source, __m128i *vectorLow, __m128i *vectorHigh) {
   *vectorLow = _mm_unpacklo_epi16(source, _mm_setzero_si128());
 }
 
+/* ============================================================================
+ *  RSPLoadAccumulator/RSPStoreAccumulator: Move the accumulator in and out
+ *  of registers: the low word, and the upper 32 bits as two halves.
+ * ========================================================================= */
+static void
+RSPLoadAccumulator(const struct RSPCP2 *cp2,
+  __m128i *vaccLow, __m128i *upperLo, __m128i *upperHi) {
+  const int32_t *accUpper = cp2->accumulatorUpper.slices;
+
+  *vaccLow = _mm_load_si128((const __m128i*) cp2->accumulatorLow.slices);
+  *upperLo = _mm_load_si128((const __m128i*) (accUpper + 0));
+  *upperHi = _mm_load_si128((const __m128i*) (accUpper + 4));
+}
+
+static void
+RSPStoreAccumulator(struct RSPCP2 *cp2,
+  __m128i vaccLow, __m128i upperLo, __m128i upperHi) {
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
+
+  _mm_store_si128((__m128i*) cp2->accumulatorLow.slices, vaccLow);
+  _mm_store_si128((__m128i*) (accUpper + 0), upperLo);
+  _mm_store_si128((__m128i*) (accUpper + 4), upperHi);
+}
+
+/* ============================================================================
+ *  RSPAddProducts: Adds 32-bit products to an accumulator in registers: the
+ *  low halves go to the low word, and the rest (with the carries out of the
+ *  low word) to the upper 32 bits. Returns the new low word.
+ * ========================================================================= */
+static __m128i
+RSPAddProducts(__m128i vaccLow, __m128i loProduct, __m128i hiProduct,
+  __m128i *upperLo, __m128i *upperHi) {
+  __m128i lowMask = _mm_set1_epi32(0xFFFF);
+  __m128i vaccLowLo, vaccLowHi;
+
+  RSPZeroExtend16to32(vaccLow, &vaccLowLo, &vaccLowHi);
+
+  /* 17-bit sums of the low words; bit 16 is the carry. */
+  vaccLowLo = _mm_add_epi32(vaccLowLo, _mm_and_si128(loProduct, lowMask));
+  vaccLowHi = _mm_add_epi32(vaccLowHi, _mm_and_si128(hiProduct, lowMask));
+  vaccLow = RSPPackLo32to16(vaccLowLo, vaccLowHi);
+
+  /* The upper 32 bits are already in 32-bit lanes. */
+  *upperLo = _mm_add_epi32(*upperLo, _mm_srai_epi32(loProduct, 16));
+  *upperHi = _mm_add_epi32(*upperHi, _mm_srai_epi32(hiProduct, 16));
+  *upperLo = _mm_add_epi32(*upperLo, _mm_srli_epi32(vaccLowLo, 16));
+  *upperHi = _mm_add_epi32(*upperHi, _mm_srli_epi32(vaccLowHi, 16));
+  return vaccLow;
+}
+
+/* ============================================================================
+ *  RSPAccumulate: As RSPAddProducts, on the accumulator of the RSPCP2. The
+ *  new upper 32 bits are also returned in `upperLo`/`upperHi`.
+ * ========================================================================= */
+static __m128i
+RSPAccumulate(struct RSPCP2 *cp2, __m128i loProduct, __m128i hiProduct,
+  __m128i *upperLo, __m128i *upperHi) {
+  __m128i vaccLow;
+
+  RSPLoadAccumulator(cp2, &vaccLow, upperLo, upperHi);
+  vaccLow = RSPAddProducts(vaccLow, loProduct, hiProduct, upperLo, upperHi);
+  RSPStoreAccumulator(cp2, vaccLow, *upperLo, *upperHi);
+  return vaccLow;
+}
+
 /* ============================================================================
  *  SSE lacks nand, nor, and nxor (really, xnor), so define them manually.
  * ========================================================================= */
@@ -208,6 +279,457 @@ _mm_mullo_epi32(__m128i a, __m128i b) {
   return _mm_or_si128(baMask, b4a4MaskShift);
 }
 #endif
+
+/* ============================================================================
+ *  RSPLoadFlags: Loads the masks of a flag register, or builds them from
+ *  its bits if that's the form it's in (without keeping them: a call out
+ *  to RSPExpandFlags costs the fast path more than this does).
+ * ========================================================================= */
+static void
+RSPLoadFlags(const struct RSPFlags *flags, __m128i *lo, __m128i *hi) {
+  static const uint16_t keys[2][8] align(16) = {
+    {0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080},
+    {0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, 0x8000}
+  };
+
+  __m128i bits, loKey, hiKey;
+
+  if (flags->forms & RSP_FLAGS_MASKS) {
+    *lo = _mm_load_si128((__m128i*) (flags->lo.slices));
+    *hi = _mm_load_si128((__m128i*) (flags->hi.slices));
+    return;
+  }
+
+  bits = _mm_set1_epi16(flags->bits);
+  loKey = _mm_load_si128((__m128i*) keys[0]);
+  hiKey = _mm_load_si128((__m128i*) keys[1]);
+  *lo = _mm_cmpeq_epi16(_mm_and_si128(bits, loKey), loKey);
+  *hi = _mm_cmpeq_epi16(_mm_and_si128(bits, hiKey), hiKey);
+}
+
+/* ============================================================================
+ *  RSPSetCompareFlags: Sets VCC to the masks of a compare (VEQ, etc.): the
+ *  low half gets the result and the high half is cleared.
+ * ========================================================================= */
+static void
+RSPSetCompareFlags(struct RSPCP2 *cp2, __m128i mask) {
+  _mm_store_si128((__m128i*) (cp2->vcc.lo.slices), mask);
+  _mm_store_si128((__m128i*) (cp2->vcc.hi.slices), _mm_setzero_si128());
+  cp2->vcc.forms = RSP_FLAGS_MASKS;
+}
+
+/* ============================================================================
+ *  RSPStoreFlags: Sets a flag register to the given masks.
+ * ========================================================================= */
+static void
+RSPStoreFlags(struct RSPFlags *flags, __m128i lo, __m128i hi) {
+  _mm_store_si128((__m128i*) (flags->lo.slices), lo);
+  _mm_store_si128((__m128i*) (flags->hi.slices), hi);
+  flags->forms = RSP_FLAGS_MASKS;
+}
+
+/* ============================================================================
+ *  RSPCompareGE/RSPCompareLT: Computes the masks that VGE and VLT select
+ *  with (and set VCC to), from the operands and VCO.
+ * ========================================================================= */
+static __m128i
+RSPCompareGE(__m128i vsReg, __m128i vtReg, __m128i vco, __m128i vne) {
+  __m128i temp, equal;
+
+  /* equal = (~vco | ~vne) && (vs == vt) */
+  temp = _mm_and_si128(vne, vco);
+  temp = _mm_cmpeq_epi16(temp, _mm_setzero_si128());
+  equal = _mm_cmpeq_epi16(vsReg, vtReg);
+  equal = _mm_and_si128(temp, equal);
+
+  /* ge = vs > vt | equal */
+  return _mm_or_si128(_mm_cmpgt_epi16(vsReg, vtReg), equal);
+}
+
+static __m128i
+RSPCompareLT(__m128i vsReg, __m128i vtReg, __m128i vco, __m128i vne) {
+  __m128i temp, equal;
+
+  /* equal = (vco & vne) && (vs == vt) */
+  temp = _mm_and_si128(vne, vco);
+  equal = _mm_cmpeq_epi16(vsReg, vtReg);
+  equal = _mm_and_si128(equal, temp);
+
+  /* le = vs < vt | equal */
+  return _mm_or_si128(_mm_cmplt_epi16(vsReg, vtReg), equal);
+}
+
+/* ============================================================================
+ *  RSPSelect: Picks each slice from `a` where the mask is set, else `b`.
+ * ========================================================================= */
+static __m128i
+RSPSelect(__m128i mask, __m128i a, __m128i b) {
+#ifdef SSSE3_ONLY
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+#else
+  return _mm_blendv_epi8(b, a, mask);
+#endif
+}
+
+/* ============================================================================
+ *  Multiply steps: VMUDH, VMUDL, VMADM, VMADN, VMADH, VMULF, VMACF and VMULQ,
+ *  each on an accumulator held in registers. They return what is written to
+ *  `vd`, so runs of them (see RSPFusedMUL32) can keep the accumulator in
+ *  registers, and products can leave it out (see RSPVMUDHNoAcc).
+ * ========================================================================= */
+static __m128i
+RSPStepVMUDH(__m128i vsReg, __m128i vtReg,
+  __m128i *vaccLow, __m128i *upperLo, __m128i *upperHi) {
+  __m128i unpackLo = _mm_mullo_epi16(vsReg, vtReg);
+  __m128i unpackHi = _mm_mulhi_epi16(vsReg, vtReg);
+
+  /* The product goes on top of the middle word, as is. */
+  *vaccLow = _mm_setzero_si128();
+  *upperLo = _mm_unpacklo_epi16(unpackLo, unpackHi);
+  *upperHi = _mm_unpackhi_epi16(unpackLo, unpackHi);
+  return _mm_packs_epi32(*upperLo, *upperHi);
+}
+
+static __m128i
+RSPStepVMUDL(__m128i vsReg, __m128i vtReg,
+  __m128i *vaccLow, __m128i *upperLo, __m128i *upperHi) {
+
+  /* Only the high word of the unsigned product is used. */
+  *vaccLow = _mm_mulhi_epu16(vsReg, vtReg);
+  *upperLo = _mm_setzero_si128();
+  *upperHi = _mm_setzero_si128();
+  return *vaccLow;
+}
+
+static __m128i
+RSPStepVMADM(__m128i vsReg, __m128i vtReg,
+  __m128i *vaccLow, __m128i *upperLo, __m128i *upperHi) {
+  __m128i vsRegLo, vsRegHi, vtRegLo, vtRegHi;
+  __m128i loProduct, hiProduct;
+
+  /* Signed `vs`, unsigned `vt`. */
+  RSPSignExtend16to32(vsReg, &vsRegLo, &vsRegHi);
+  RSPZeroExtend16to32(vtReg, &vtRegLo, &vtRegHi);
+  loProduct = _mm_mullo_epi32(vsRegLo, vtRegLo);
+  hiProduct = _mm_mullo_epi32(vsRegHi, vtRegHi);
+
+  /* Accumulate the product, and clamp the upper 32 bits. */
+  *vaccLow = RSPAddProducts(*vaccLow, loProduct, hiProduct, upperLo, upperHi);
+  return _mm_packs_epi32(*upperLo, *upperHi);
+}
+
+static __m128i
+RSPStepVMADN(__m128i vsReg, __m128i vtReg,
+  __m128i *vaccLow, __m128i *upperLo, __m128i *upperHi) {
+  __m128i vsRegLo, vsRegHi, vtRegLo, vtRegHi;
+  __m128i loProduct, hiProduct;
+
+  /* Unsigned `vs`, signed `vt`. */
+  RSPZeroExtend16to32(vsReg, &vsRegLo, &vsRegHi);
+  RSPSignExtend16to32(vtReg, &vtRegLo, &vtRegHi);
+  loProduct = _mm_mullo_epi32(vsRegLo, vtRegLo);
+  hiProduct = _mm_mullo_epi32(vsRegHi, vtRegHi);
+
+  *vaccLow = RSPAddProducts(*vaccLow, loProduct, hiProduct, upperLo, upperHi);
+  return RSPClampLowToVal(*vaccLow, *upperLo, *upperHi);
+}
+
+static __m128i
+RSPStepVMADH(__m128i vsReg, __m128i vtReg,
+  __m128i *upperLo, __m128i *upperHi) {
+  __m128i unpackLo = _mm_mullo_epi16(vsReg, vtReg);
+  __m128i unpackHi = _mm_mulhi_epi16(vsReg, vtReg);
+
+  /* Accumulate the product on top of the middle word; */
+  /* clamp the result, the accumulator is stored as is. */
+  *upperLo = _mm_add_epi32(*upperLo, _mm_unpacklo_epi16(unpackLo, unpackHi));
+  *upperHi = _mm_add_epi32(*upperHi, _mm_unpackhi_epi16(unpackLo, unpackHi));
+  return _mm_packs_epi32(*upperLo, *upperHi);
+}
+
+static __m128i
+RSPStepVMULF(__m128i vsReg, __m128i vtReg,
+  __m128i *vaccLow, __m128i *upperLo, __m128i *upperHi) {
+  __m128i round = _mm_set1_epi32(0x8000);
+  __m128i unpackLo, unpackHi, loProduct, hiProduct, vaccMid;
+
+  /* The product of the signed sources is doubled, and rounded. */
+  unpackLo = _mm_mullo_epi16(vsReg, vtReg);
+  unpackHi = _mm_mulhi_epi16(vsReg, vtReg);
+  loProduct = _mm_slli_epi32(_mm_unpacklo_epi16(unpackLo, unpackHi), 1);
+  hiProduct = _mm_slli_epi32(_mm_unpackhi_epi16(unpackLo, unpackHi), 1);
+  loProduct = _mm_add_epi32(loProduct, round);
+  hiProduct = _mm_add_epi32(hiProduct, round);
+
+  *vaccLow = RSPPackLo32to16(loProduct, hiProduct);
+  *upperLo = _mm_srai_epi32(loProduct, 16);
+  *upperHi = _mm_srai_epi32(hiProduct, 16);
+
+  /* The middle word always fits; negative ones are stepped down by one. */
+  vaccMid = _mm_packs_epi32(*upperLo, *upperHi);
+  return _mm_add_epi16(vaccMid, _mm_srai_epi16(vaccMid, 15));
+}
+
+static __m128i
+RSPStepVMACF(__m128i vsReg, __m128i vtReg,
+  __m128i *vaccLow, __m128i *upperLo, __m128i *upperHi) {
+  __m128i unpackLo, unpackHi, loProduct, hiProduct;
+
+  /* The product of the signed sources is doubled. */
+  unpackLo = _mm_mullo_epi16(vsReg, vtReg);
+  unpackHi = _mm_mulhi_epi16(vsReg, vtReg);
+  loProduct = _mm_slli_epi32(_mm_unpacklo_epi16(unpackLo, unpackHi), 1);
+  hiProduct = _mm_slli_epi32(_mm_unpackhi_epi16(unpackLo, unpackHi), 1);
+
+  /* Accumulate the product, and clamp the upper 32 bits. */
+  *vaccLow = RSPAddProducts(*vaccLow, loProduct, hiProduct, upperLo, upperHi);
+  return _mm_packs_epi32(*upperLo, *upperHi);
+}
+
+static __m128i
+RSPStepVMULQ(__m128i vsReg, __m128i vtReg,
+  __m128i *vaccLow, __m128i *upperLo, __m128i *upperHi) {
+  __m128i round = _mm_set1_epi32(31);
+  __m128i unpackLo = _mm_mullo_epi16(vsReg, vtReg);
+  __m128i unpackHi = _mm_mulhi_epi16(vsReg, vtReg);
+
+  /* The product goes on top of the middle word; */
+  /* negative ones are rounded (by 31) towards zero. */
+  *vaccLow = _mm_setzero_si128();
+  *upperLo = _mm_unpacklo_epi16(unpackLo, unpackHi);
+  *upperHi = _mm_unpackhi_epi16(unpackLo, unpackHi);
+  *upperLo = _mm_add_epi32(*upperLo,
+    _mm_and_si128(_mm_srai_epi32(*upperLo, 31), round));
+  *upperHi = _mm_add_epi32(*upperHi,
+    _mm_and_si128(_mm_srai_epi32(*upperHi, 31), round));
+
+  return RSPClampQuantized(*upperLo, *upperHi);
+}
+
+#else
+/* ============================================================================
+ *  Without SSE, the same operations are done a slice at a time. The loops
+ *  are kept simple (no calls that can't be inlined, no early exits) so
+ *  compilers can vectorize them for whatever the host has.
+ * ========================================================================= */
+
+/* ============================================================================
+ *  RSPGetVectorOperands: Builds the proper configuration of the `vt` vector
+ *  for instructions that require the use of a element specifier.
+ * ========================================================================= */
+#ifdef RSP_CP2_IDENTITY
+static void
+RSPGetVectorOperands(const int16_t *vt, int16_t *vtData,
+  unsigned unused(element)) {
+  memcpy(vtData, vt, sizeof(*vtData) * 8);
+}
+#elif defined(RSP_CP2_WHOLE)
+static void
+RSPGetVectorOperands(const int16_t *vt, int16_t *vtData, unsigned element) {
+  int16_t slice = vt[element & 0x7];
+  unsigned i;
+
+  for (i = 0; i < 8; i++)
+    vtData[i] = slice;
+}
+#else
+static void
+RSPGetVectorOperands(const int16_t *vt, int16_t *vtData, unsigned element) {
+  static const int16_t VectorOperandsArray[16][8] align(16) = {
+    /* -- */ {0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7},
+    /* -- */ {0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7},
+    /* 0q */ {0x0,0x0,0x2,0x2,0x4,0x4,0x6,0x6},
+    /* 1q */ {0x1,0x1,0x3,0x3,0x5,0x5,0x7,0x7},
+    /* 0h */ {0x0,0x0,0x0,0x0,0x4,0x4,0x4,0x4},
+    /* 1h */ {0x1,0x1,0x1,0x1,0x5,0x5,0x5,0x5},
+    /* 2h */ {0x2,0x2,0x2,0x2,0x6,0x6,0x6,0x6},
+    /* 3h */ {0x3,0x3,0x3,0x3,0x7,0x7,0x7,0x7},
+    /* 0w */ {0x0,0x0,0x0,0x0,0x0,0x0,0x0,0x0},
+    /* 1w */ {0x1,0x1,0x1,0x1,0x1,0x1,0x1,0x1},
+    /* 2w */ {0x2,0x2,0x2,0x2,0x2,0x2,0x2,0x2},
+    /* 3w */ {0x3,0x3,0x3,0x3,0x3,0x3,0x3,0x3},
+    /* 4w */ {0x4,0x4,0x4,0x4,0x4,0x4,0x4,0x4},
+    /* 5w */ {0x5,0x5,0x5,0x5,0x5,0x5,0x5,0x5},
+    /* 6w */ {0x6,0x6,0x6,0x6,0x6,0x6,0x6,0x6},
+    /* 7w */ {0x7,0x7,0x7,0x7,0x7,0x7,0x7,0x7}
+  };
+
+#if defined(__GNUC__) && !defined(__clang__)
+  typedef int16_t v8hi __attribute__((vector_size(16)));
+  v8hi vtReg, key;
+
+  /* GCC lowers this to the host's shuffle (e.g., tbl on ARM64). */
+  memcpy(&key, VectorOperandsArray[element], sizeof(key));
+  memcpy(&vtReg, vt, sizeof(vtReg));
+  vtReg = __builtin_shuffle(vtReg, key);
+  memcpy(vtData, &vtReg, sizeof(vtReg));
+#else
+  unsigned i;
+
+  for (i = 0; i < 8; i++)
+    vtData[i] = vt[VectorOperandsArray[element][i]];
+#endif
+}
+#endif
+
+/* ============================================================================
+ *  RSPClamp16: Clamps a 32-bit value to 16-bits (i.e., _mm_packs_epi32).
+ * ========================================================================= */
+static int16_t
+RSPClamp16(int32_t value) {
+  if (value < -32768)
+    return -32768;
+
+  return value > 32767 ? 32767 : value;
+}
+
+/* ============================================================================
+ *  RSPClampQuantized: Clamps half the upper 32 bits of the accumulator to
+ *  16 bits, and clears the low 4 (as VMULQ and VMACQ write them out).
+ * ========================================================================= */
+static int16_t
+RSPClampQuantized(int32_t accUpper) {
+  return RSPClamp16(accUpper >> 1) & ~0xF;
+}
+
+/* ============================================================================
+ *  RSPClampLowToVal: Clamps the low word of the accumulator: it is kept
+ *  where the upper 32 bits fit in 16, and zeroed everywhere else.
+ * ========================================================================= */
+static int16_t
+RSPClampLowToVal(int16_t accLow, int32_t accUpper) {
+  return accUpper == (int16_t) accUpper ? accLow : 0;
+}
+
+/* ============================================================================
+ *  RSPSetCompareFlags: Sets VCC to the masks of a compare (VEQ, etc.): the
+ *  low half gets the result and the high half is cleared.
+ * ========================================================================= */
+static void
+RSPSetCompareFlags(struct RSPCP2 *cp2, const int16_t *mask) {
+  memcpy(cp2->vcc.lo.slices, mask, sizeof(cp2->vcc.lo.slices));
+  memset(cp2->vcc.hi.slices, 0, sizeof(cp2->vcc.hi.slices));
+  cp2->vcc.forms = RSP_FLAGS_MASKS;
+}
+
+/* ============================================================================
+ *  RSPAccumulate: Adds 32-bit products to the accumulator: the low halves
+ *  go to the low word, and the rest (with the carries out of the low word)
+ *  to the upper 32 bits.
+ * ========================================================================= */
+static void
+RSPAccumulate(uint16_t *accLow, int32_t *accUpper, const int32_t *products) {
+  uint16_t vaccLow[8];
+  int32_t vaccUpper[8];
+  unsigned i;
+
+  for (i = 0; i < 8; i++) {
+    uint32_t low = accLow[i] + ((uint32_t) products[i] & 0xFFFF);
+    uint32_t upper = (uint32_t) accUpper[i];
+
+    upper += (uint32_t) (products[i] >> 16) + (low >> 16);
+    vaccLow[i] = low;
+    vaccUpper[i] = upper;
+  }
+
+  memcpy(accLow, vaccLow, sizeof(vaccLow));
+  memcpy(accUpper, vaccUpper, sizeof(vaccUpper));
+}
+#endif
+
+#ifndef RSP_CP2_VARIANT
+/* ============================================================================
+ *  RSPGetAccumulator: Get the accumulator as its high, middle and low words
+ *  (in that order, as VSAR numbers them).
+ * ========================================================================= */
+void
+RSPGetAccumulator(const struct RSPCP2 *cp2, struct RSPVector *acc) {
+  unsigned i;
+
+  for (i = 0; i < 8; i++) {
+    acc[0].slices[i] = cp2->accumulatorUpper.slices[i] >> 16;
+    acc[1].slices[i] = cp2->accumulatorUpper.slices[i];
+  }
+
+  acc[2] = cp2->accumulatorLow;
+}
+
+/* ============================================================================
+ *  RSPSetAccumulator: Set the accumulator given its high, middle and low
+ *  words (as above).
+ * ========================================================================= */
+void
+RSPSetAccumulator(struct RSPCP2 *cp2, const struct RSPVector *acc) {
+  unsigned i;
+
+  for (i = 0; i < 8; i++) {
+    uint32_t high = (uint16_t) acc[0].slices[i];
+    uint32_t mid = (uint16_t) acc[1].slices[i];
+
+    cp2->accumulatorUpper.slices[i] = (int32_t) (high << 16 | mid);
+  }
+
+  cp2->accumulatorLow = acc[2];
+}
+
+#ifndef USE_SSE
+/* ============================================================================
+ *  RSPGetFlags: Packs a mask (i.e., all ones or zeros) of each slice into
+ *  the corresponding bit, as is done for VCC.
+ * ========================================================================= */
+static uint16_t
+RSPGetFlags(const int16_t *mask) {
+  uint16_t flags = 0x0000;
+  unsigned i;
+
+  for (i = 0; i < 8; i++)
+    flags |= mask[i] & (1 << i);
+
+  return flags;
+}
+#endif
+
+/* ============================================================================
+ *  RSPPackFlags: Gets the bits of a flag register, packing its masks into
+ *  them if need be. Unlike RSPGetFlagBits, nothing is kept.
+ * ========================================================================= */
+uint16_t
+RSPPackFlags(const struct RSPFlags *flags) {
+  if (flags->forms & RSP_FLAGS_BITS)
+    return flags->bits;
+
+#ifdef USE_SSE
+  __m128i lo = _mm_load_si128((__m128i*) (flags->lo.slices));
+  __m128i hi = _mm_load_si128((__m128i*) (flags->hi.slices));
+  return (uint16_t) _mm_movemask_epi8(_mm_packs_epi16(lo, hi));
+#else
+  return RSPGetFlags(flags->lo.slices) | RSPGetFlags(flags->hi.slices) << 8;
+#endif
+}
+
+/* ============================================================================
+ *  RSPExpandFlags: Expands the bits of a flag register into masks.
+ * ========================================================================= */
+void
+RSPExpandFlags(struct RSPFlags *flags) {
+#ifdef USE_SSE
+  __m128i lo, hi;
+
+  RSPLoadFlags(flags, &lo, &hi);
+  _mm_store_si128((__m128i*) (flags->lo.slices), lo);
+  _mm_store_si128((__m128i*) (flags->hi.slices), hi);
+#else
+  uint16_t bits = flags->bits;
+  unsigned i;
+
+  for (i = 0; i < 8; i++, bits >>= 1) {
+    flags->lo.slices[i] = -(int16_t) ((bits >> 0) & 1);
+    flags->hi.slices[i] = -(int16_t) ((bits >> 8) & 1);
+  }
+#endif
+
+  flags->forms |= RSP_FLAGS_MASKS;
+}
 #endif
 
 /* ============================================================================
@@ -216,7 +738,7 @@ _mm_mullo_epi32(__m128i a, __m128i b) {
 void
 RSPVABS(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
+  uint16_t *accLow = (uint16_t *) cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
   __m128i valLessThan, signLessThan, resultLessThan;
@@ -239,7 +761,19 @@ RSPVABS(struct RSPCP2 *cp2, int16_t *vd,
   _mm_store_si128((__m128i*) vd, vdReg);
   _mm_store_si128((__m128i*) accLow, vdReg);
 #else
-#warning "Unimplemented function: RSPVABS (No SSE)."
+  int16_t vtData[8], vdData[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  /* Like _mm_sign_epi16, but with INT16_MIN fixed up. */
+  for (i = 0; i < 8; i++) {
+    int16_t negated = vtData[i] == -32768 ? 32767 : -vtData[i];
+    vdData[i] = vs[i] < 0 ? negated : vs[i] > 0 ? vtData[i] : 0;
+  }
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vdData, sizeof(vdData));
 #endif
 }
 
@@ -249,17 +783,17 @@ RSPVABS(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVADD(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
+  uint16_t *accLow = (uint16_t *) cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
-  __m128i minimum, maximum, carryOut;
+  __m128i minimum, maximum, carryOut, notEqual;
   __m128i vdReg, vaccLow;
 
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
   vtReg = RSPGetVectorOperands(vtReg, element);
 
-  carryOut = _mm_load_si128((__m128i*) (cp2->vcolo.slices));
+  RSPLoadFlags(&cp2->vco, &carryOut, &notEqual);
   carryOut = _mm_srli_epi16(carryOut, 15);
 
   /* VACC uses unsaturated arithmetic. */
@@ -275,10 +809,25 @@ RSPVADD(struct RSPCP2 *cp2, int16_t *vd,
 
   _mm_store_si128((__m128i*) vd, vdReg);
   _mm_store_si128((__m128i*) accLow, vaccLow);
-  _mm_store_si128((__m128i*) (cp2->vcolo.slices), _mm_setzero_si128());
-  _mm_store_si128((__m128i*) (cp2->vcohi.slices), _mm_setzero_si128());
+  RSPClearFlags(&cp2->vco);
 #else
-#warning "Unimplemented function: RSPVADD (No SSE)."
+  const struct RSPFlags *vco = RSPGetFlagMasks(&cp2->vco);
+  int16_t vtData[8], vdData[8], vaccLow[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  /* VACC uses unsaturated arithmetic, VD saturates. */
+  for (i = 0; i < 8; i++) {
+    int32_t sum = vs[i] + vtData[i] + ((uint16_t) vco->lo.slices[i] >> 15);
+
+    vaccLow[i] = sum;
+    vdData[i] = RSPClamp16(sum);
+  }
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vaccLow, sizeof(vaccLow));
+  RSPClearFlags(&cp2->vco);
 #endif
 }
 
@@ -288,10 +837,10 @@ RSPVADD(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVADDC(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
+  uint16_t *accLow = (uint16_t *) cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
-  __m128i satSum, unsatSum, carryOut, equalMask;
+  __m128i satSum, unsatSum, equalMask;
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
   vtReg = RSPGetVectorOperands(vtReg, element);
@@ -304,10 +853,28 @@ RSPVADDC(struct RSPCP2 *cp2, int16_t *vd,
 
   _mm_store_si128((__m128i*) vd, unsatSum);
   _mm_store_si128((__m128i*) accLow, unsatSum);
-  _mm_store_si128((__m128i*) (cp2->vcolo.slices), equalMask);
-  _mm_store_si128((__m128i*) (cp2->vcohi.slices), _mm_setzero_si128());
+  _mm_store_si128((__m128i*) (cp2->vco.lo.slices), equalMask);
+  _mm_store_si128((__m128i*) (cp2->vco.hi.slices), _mm_setzero_si128());
+  cp2->vco.forms = RSP_FLAGS_MASKS;
 #else
-#warning "Unimplemented function: RSPVADDC (No SSE)."
+  int16_t vtData[8], vdData[8], carryOut[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  /* Set the carry out flags when the sum overflows. */
+  for (i = 0; i < 8; i++) {
+    uint32_t sum = (uint16_t) vs[i] + (uint16_t) vtData[i];
+
+    vdData[i] = sum;
+    carryOut[i] = -(int16_t) (sum >> 16);
+  }
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vdData, sizeof(vdData));
+  memcpy(cp2->vco.lo.slices, carryOut, sizeof(carryOut));
+  memset(cp2->vco.hi.slices, 0, sizeof(cp2->vco.hi.slices));
+  cp2->vco.forms = RSP_FLAGS_MASKS;
 #endif
 }
 
@@ -317,7 +884,7 @@ RSPVADDC(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVAND(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
+  uint16_t *accLow = (uint16_t *) cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
@@ -330,7 +897,16 @@ RSPVAND(struct RSPCP2 *cp2, int16_t *vd,
   _mm_store_si128((__m128i*) vd, vdReg);
   _mm_store_si128((__m128i*) accLow, vdReg);
 #else
-#warning "Unimplemented function: RSPVAND (No SSE)."
+  int16_t vtData[8], vdData[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  for (i = 0; i < 8; i++)
+    vdData[i] = vs[i] & vtData[i];
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vdData, sizeof(vdData));
 #endif
 }
 
@@ -342,21 +918,46 @@ RSPVCH(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vsData, const int16_t *vtDataIn, unsigned element) {
   int16_t *accLow = cp2->accumulatorLow.slices;
 
-  uint16_t vco = 0x0000;
-  int16_t vtData[8];
-  int ge, le, neq;
-  unsigned i;
-
-  cp2->vcc = 0x0000;
-  cp2->vce = 0x00;
-
 #ifdef USE_SSE
+  __m128i zero = _mm_setzero_si128();
+  __m128i ones = _mm_set1_epi16(-1);
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
   __m128i vtReg = _mm_load_si128((__m128i*) vtDataIn);
+  __m128i sn, vtNeg, sum, diff, ge, le, eq, ce, sel, vtSel, vdReg;
+
   vtReg = RSPGetVectorOperands(vtReg, element);
-    _mm_store_si128((__m128i*) vtData, vtReg);
+  sum = _mm_add_epi16(vsReg, vtReg);
+  diff = _mm_sub_epi16(vsReg, vtReg);
+
+  /* Signs differ: compare vs to -vt, else to vt. */
+  /* Neither the sum nor the difference can overflow. */
+  sn = _mm_srai_epi16(_mm_xor_si128(vsReg, vtReg), 15);
+  vtNeg = _mm_srai_epi16(vtReg, 15);
+
+  le = RSPSelect(sn, _mm_cmplt_epi16(sum, _mm_set1_epi16(1)), vtNeg);
+  ge = RSPSelect(sn, vtNeg, _mm_cmpgt_epi16(diff, ones));
+  ce = _mm_and_si128(sn, _mm_cmpeq_epi16(sum, ones));
+  eq = RSPSelect(sn, _mm_or_si128(_mm_cmpeq_epi16(sum, zero), ce),
+    _mm_cmpeq_epi16(diff, zero));
+
+  /* vd = sn ? (le ? -vt : vs) : (ge ? vt : vs) */
+  sel = RSPSelect(sn, le, ge);
+  vtSel = _mm_sub_epi16(_mm_xor_si128(vtReg, sn), sn);
+  vdReg = RSPSelect(sel, vtSel, vsReg);
+
+  _mm_store_si128((__m128i*) accLow, vdReg);
+  _mm_store_si128((__m128i*) vd, vdReg);
+  RSPStoreFlags(&cp2->vco, sn, _mm_cmpeq_epi16(eq, zero));
+  RSPStoreFlags(&cp2->vcc, le, ge);
+  RSPStoreFlags(&cp2->vce, ce, zero);
 #else
-#warning "Unimplemented function: RSPVCH (No SSE)."
-#endif
+  uint16_t vco = 0x0000, vcc = 0x0000;
+  uint8_t vce = 0x00;
+  int16_t vtData[8];
+  int ge, le, neq;
+  unsigned i;
+
+  RSPGetVectorOperands(vtDataIn, vtData, element);
 
   for (i = 0; i < 8; i++) {
     int16_t vs = vsData[i];
@@ -369,7 +970,7 @@ RSPVCH(struct RSPCP2 *cp2, int16_t *vd,
       ge = (vt < 0);
       le = (vs + vt <= 0);
       neq = (vs + vt == -1);
-      cp2->vce |= neq << i;
+      vce |= neq << i;
 
       /* !(x | y) = x ^ !(y), if (x & y) != 1 */
       neq ^= !(vs + vt == 0);
@@ -381,17 +982,20 @@ RSPVCH(struct RSPCP2 *cp2, int16_t *vd,
       le = (vt < 0);
       ge = (vs - vt >= 0);
       neq = !(vs - vt == 0);
-      cp2->vce |= 0x00 << i;
+      vce |= 0x00 << i;
 
       accLow[i] = ge ? vt : vs;
       vco |= (neq <<= (i + 0x8)) | (sn << (i + 0x0));
     }
 
-    cp2->vcc |=  (ge <<= (i + 0x8)) | (le <<= (i + 0x0));
+    vcc |=  (ge <<= (i + 0x8)) | (le <<= (i + 0x0));
   }
 
   memcpy(vd, accLow, sizeof(short) * 8);
-  RSPSetVCO(cp2, vco);
+  RSPSetFlagBits(&cp2->vco, vco);
+  RSPSetFlagBits(&cp2->vcc, vcc);
+  RSPSetFlagBits(&cp2->vce, vce);
+#endif
 }
 
 /* ============================================================================
@@ -402,21 +1006,49 @@ RSPVCL(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vsData, const int16_t *vtDataIn, unsigned element) {
   int16_t *accLow = cp2->accumulatorLow.slices;
 
-  uint16_t vco = RSPGetVCO(cp2);
-  int16_t vccOld = cp2->vcc;
-  int16_t vtData[8];
-  int ge, le;
-  unsigned i;
-
 #ifdef USE_SSE
+  __m128i zero = _mm_setzero_si128();
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
   __m128i vtReg = _mm_load_si128((__m128i*) vtDataIn);
+  __m128i sn, eq, ce, ceHi, leOld, geOld;
+  __m128i sum, lz, uz, ge, le, sel, vtSel, vdReg;
+
   vtReg = RSPGetVectorOperands(vtReg, element);
-    _mm_store_si128((__m128i*) vtData, vtReg);
+  RSPLoadFlags(&cp2->vco, &sn, &eq);
+  RSPLoadFlags(&cp2->vcc, &leOld, &geOld);
+  RSPLoadFlags(&cp2->vce, &ce, &ceHi);
+  eq = _mm_cmpeq_epi16(eq, zero);
+
+  /* Where the slices are equal, the old VCC is retested: lz/uz are */
+  /* whether the 17-bit sum's low/high bits are zero (vs <= sum). */
+  sum = _mm_add_epi16(vsReg, vtReg);
+  lz = _mm_cmpeq_epi16(sum, zero);
+  uz = _mm_cmpeq_epi16(_mm_subs_epu16(vsReg, sum), zero);
+
+  le = RSPSelect(ce, _mm_or_si128(lz, uz), _mm_and_si128(lz, uz));
+  le = RSPSelect(_mm_and_si128(sn, eq), le, leOld);
+  ge = _mm_cmpeq_epi16(_mm_subs_epu16(vtReg, vsReg), zero);
+  ge = RSPSelect(_mm_andnot_si128(sn, eq), ge, geOld);
+
+  /* vd = sn ? (le ? -vt : vs) : (ge ? vt : vs) */
+  sel = RSPSelect(sn, le, ge);
+  vtSel = _mm_sub_epi16(_mm_xor_si128(vtReg, sn), sn);
+  vdReg = RSPSelect(sel, vtSel, vsReg);
+
+  _mm_store_si128((__m128i*) accLow, vdReg);
+  _mm_store_si128((__m128i*) vd, vdReg);
+  RSPStoreFlags(&cp2->vcc, le, ge);
 #else
-#warning "Unimplemented function: RSPVCL (No SSE)."
-#endif
+  uint16_t vco = RSPGetFlagBits(&cp2->vco);
+  uint16_t vccOld = RSPGetFlagBits(&cp2->vcc);
+  uint8_t vce = RSPGetFlagBits(&cp2->vce);
+  uint16_t vcc = 0x0000;
+  int16_t vtData[8];
+  int ge, le;
+  unsigned i;
+
+  RSPGetVectorOperands(vtDataIn, vtData, element);
 
-  cp2->vcc = 0x0000;
   for (i = 0; i < 8; i++) {
     uint16_t vs = (unsigned short) vsData[i];
     uint16_t vt = (unsigned short) vtData[i];
@@ -429,7 +1061,7 @@ RSPVCL(struct RSPCP2 *cp2, int16_t *vd,
     if (sn) {
       if (eq) {
         int sum = vs + vt;
-        int ce = (cp2->vce >> i) & 0x01;
+        int ce = (vce >> i) & 0x01;
         int lz = ((sum & 0x0000FFFF) == 0x00000000);
         int uz = ((sum & 0xFFFF0000) == 0x00000000);
 
@@ -449,13 +1081,15 @@ RSPVCL(struct RSPCP2 *cp2, int16_t *vd,
       accLow[i] = ge ? vt : vs;
     }
 
-    cp2->vcc |= ge | le;
+    vcc |= ge | le;
   }
 
   memcpy(vd, accLow, sizeof(short) * 8);
-  _mm_store_si128((__m128i*) (cp2->vcolo.slices), _mm_setzero_si128());
-  _mm_store_si128((__m128i*) (cp2->vcohi.slices), _mm_setzero_si128());
-  cp2->vce = 0x00;
+  RSPSetFlagBits(&cp2->vcc, vcc);
+#endif
+
+  RSPClearFlags(&cp2->vco);
+  RSPClearFlags(&cp2->vce);
 }
 
 /* ============================================================================
@@ -466,19 +1100,36 @@ RSPVCR(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vsData, const int16_t *vtDataIn, unsigned element) {
   int16_t *accLow = cp2->accumulatorLow.slices;
 
-  int16_t vtData[8];
-  unsigned i;
-  int ge, le;
-
 #ifdef USE_SSE
+  __m128i ones = _mm_set1_epi16(-1);
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
   __m128i vtReg = _mm_load_si128((__m128i*) vtDataIn);
+  __m128i sn, vtNeg, sumNeg, diff, ge, le, vdReg;
+
   vtReg = RSPGetVectorOperands(vtReg, element);
-    _mm_store_si128((__m128i*) vtData, vtReg);
+
+  /* Signs differ: compare vs to ~vt, else to vt. */
+  sn = _mm_srai_epi16(_mm_xor_si128(vsReg, vtReg), 15);
+  vtNeg = _mm_srai_epi16(vtReg, 15);
+  sumNeg = _mm_srai_epi16(_mm_add_epi16(vsReg, vtReg), 15);
+  diff = _mm_sub_epi16(vsReg, vtReg);
+
+  le = RSPSelect(sn, sumNeg, vtNeg);
+  ge = RSPSelect(sn, vtNeg, _mm_cmpgt_epi16(diff, ones));
+
+  /* vd = le ? (sn ? ~vt : vt) : vs */
+  vdReg = RSPSelect(le, _mm_xor_si128(vtReg, sn), vsReg);
+
+  _mm_store_si128((__m128i*) accLow, vdReg);
+  _mm_store_si128((__m128i*) vd, vdReg);
+  RSPStoreFlags(&cp2->vcc, le, ge);
 #else
-#warning "Unimplemented function: RSPVCR (No SSE)."
-#endif
+  uint16_t vcc = 0x0000;
+  int16_t vtData[8];
+  unsigned i;
+  int ge, le;
 
-  cp2->vcc = 0x0000;
+  RSPGetVectorOperands(vtDataIn, vtData, element);
 
   for (i = 0; i < 8; i++) {
     const signed short vs = vsData[i];
@@ -497,13 +1148,15 @@ RSPVCR(struct RSPCP2 *cp2, int16_t *vd,
       accLow[i] = le ? vt : vs;
     }
 
-    cp2->vcc |= (ge <<= (i + 8)) | (le <<= (i + 0));
+    vcc |= (ge <<= (i + 8)) | (le <<= (i + 0));
   }
 
   memcpy(vd, accLow, sizeof(short) * 8);
-  _mm_store_si128((__m128i*) (cp2->vcolo.slices), _mm_setzero_si128());
-  _mm_store_si128((__m128i*) (cp2->vcohi.slices), _mm_setzero_si128());
-  cp2->vce = 0x00;
+  RSPSetFlagBits(&cp2->vcc, vcc);
+#endif
+
+  RSPClearFlags(&cp2->vco);
+  RSPClearFlags(&cp2->vce);
 }
 
 /* ============================================================================
@@ -513,27 +1166,37 @@ void
 RSPVEQ(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vsData, const int16_t *vtData, unsigned element) {
   int16_t *accLow = cp2->accumulatorLow.slices;
-  unsigned i;
-  int eq;
 
 #ifdef USE_SSE
-  __m128i vne = _mm_load_si128((__m128i*) (cp2->vcohi.slices));
+  __m128i vco, vne;
   __m128i vsReg = _mm_load_si128((__m128i*) vsData);
   __m128i vtReg = _mm_load_si128((__m128i*) vtData);
   vtReg = RSPGetVectorOperands(vtReg, element);
+  RSPLoadFlags(&cp2->vco, &vco, &vne);
 
   __m128i equal = _mm_cmpeq_epi16(vtReg, vsReg);
   vne = _mm_cmpeq_epi16(vne, _mm_setzero_si128());
   __m128i vvcc = _mm_and_si128(equal, vne);
 
-  vvcc = _mm_packs_epi16(vvcc, vvcc);
-  cp2->vcc = _mm_movemask_epi8(vvcc) & 0xFF;
+  RSPSetCompareFlags(cp2, vvcc);
   _mm_store_si128((__m128i*) accLow, vtReg);
   _mm_store_si128((__m128i*) vd, vtReg);
-  _mm_store_si128((__m128i*) (cp2->vcolo.slices), _mm_setzero_si128());
-  _mm_store_si128((__m128i*) (cp2->vcohi.slices), _mm_setzero_si128());
+  RSPClearFlags(&cp2->vco);
 #else
-#warning "Unimplemented function: RSPVEQ (No SSE)."
+  const struct RSPFlags *flags = RSPGetFlagMasks(&cp2->vco);
+  int16_t vtReg[8], equal[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vtData, vtReg, element);
+
+  /* equal = !vne && (vs == vt) */
+  for (i = 0; i < 8; i++)
+    equal[i] = -((flags->hi.slices[i] == 0) & (vsData[i] == vtReg[i]));
+
+  RSPSetCompareFlags(cp2, equal);
+  memcpy(vd, vtReg, sizeof(vtReg));
+  memcpy(accLow, vtReg, sizeof(vtReg));
+  RSPClearFlags(&cp2->vco);
 #endif
 }
 
@@ -546,42 +1209,40 @@ RSPVGE(struct RSPCP2 *cp2, int16_t *vd,
   int16_t *accLow = cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
-  __m128i vne = _mm_load_si128((__m128i*) (cp2->vcohi.slices));
-  __m128i vco = _mm_load_si128((__m128i*) (cp2->vcolo.slices));
+  __m128i vco, vne;
   __m128i vsReg = _mm_load_si128((__m128i*) vsData);
   __m128i vtReg = _mm_load_si128((__m128i*) vtData);
   vtReg = RSPGetVectorOperands(vtReg, element);
-
-  __m128i temp, equal, greaterEqual, vvcc, vdReg;
-  cp2->vcc = 0x0000;
-
-  /* equal = (~vco | ~vne) && (vs == vt) */
-  temp = _mm_and_si128(vne, vco);
-  temp = _mm_cmpeq_epi16(temp, _mm_setzero_si128());
-  equal = _mm_cmpeq_epi16(vsReg, vtReg);
-  equal = _mm_and_si128(temp, equal);
-
-  /* ge = vs > vt | equal */
-  greaterEqual = _mm_cmpgt_epi16(vsReg, vtReg);
-  greaterEqual = _mm_or_si128(greaterEqual, equal);
+  RSPLoadFlags(&cp2->vco, &vco, &vne);
 
   /* vd = ge ? vs : vt; */
-#ifdef SSSE3_ONLY
-  vsReg = _mm_and_si128(greaterEqual, vsReg);
-  vtReg = _mm_andnot_si128(greaterEqual, vtReg);
-  vdReg = _mm_or_si128(vsReg, vtReg);
-#else
-  vdReg = _mm_blendv_epi8(vtReg, vsReg, greaterEqual);
-#endif
+  __m128i greaterEqual = RSPCompareGE(vsReg, vtReg, vco, vne);
+  __m128i vdReg = RSPSelect(greaterEqual, vsReg, vtReg);
 
-  vvcc = _mm_packs_epi16(greaterEqual, greaterEqual);
-  cp2->vcc = _mm_movemask_epi8(vvcc) & 0xFF;
+  RSPSetCompareFlags(cp2, greaterEqual);
   _mm_store_si128((__m128i*) accLow, vdReg);
   _mm_store_si128((__m128i*) vd, vdReg);
-  _mm_store_si128((__m128i*) (cp2->vcolo.slices), _mm_setzero_si128());
-  _mm_store_si128((__m128i*) (cp2->vcohi.slices), _mm_setzero_si128());
+  RSPClearFlags(&cp2->vco);
 #else
-#warning "Unimplemented function: RSPVGE (No SSE)."
+  const struct RSPFlags *flags = RSPGetFlagMasks(&cp2->vco);
+  int16_t vtReg[8], vdData[8], greaterEqual[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vtData, vtReg, element);
+
+  /* ge = vs > vt | ((~vco | ~vne) && (vs == vt)) */
+  for (i = 0; i < 8; i++) {
+    int equal = ((flags->lo.slices[i] & flags->hi.slices[i]) == 0) &
+      (vsData[i] == vtReg[i]);
+
+    greaterEqual[i] = -((vsData[i] > vtReg[i]) | equal);
+    vdData[i] = greaterEqual[i] ? vsData[i] : vtReg[i];
+  }
+
+  RSPSetCompareFlags(cp2, greaterEqual);
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vdData, sizeof(vdData));
+  RSPClearFlags(&cp2->vco);
 #endif
 }
 
@@ -589,8 +1250,9 @@ RSPVGE(struct RSPCP2 *cp2, int16_t *vd,
  *  Instruction: VINV (Invalid Vector Operation)
  * ========================================================================= */
 void
-RSPVINV(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
+RSPVINV(struct RSPCP2 *unused(cp2), int16_t *unused(vd),
+  const int16_t *unused(vs), const int16_t *unused(vt),
+  unsigned unused(element)) {
 }
 
 /* ============================================================================
@@ -602,41 +1264,40 @@ RSPVLT(struct RSPCP2 *cp2, int16_t *vd,
   int16_t *accLow = cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
-  __m128i vne = _mm_load_si128((__m128i*) (cp2->vcohi.slices));
-  __m128i vco = _mm_load_si128((__m128i*) (cp2->vcolo.slices));
+  __m128i vco, vne;
   __m128i vsReg = _mm_load_si128((__m128i*) vsData);
   __m128i vtReg = _mm_load_si128((__m128i*) vtData);
   vtReg = RSPGetVectorOperands(vtReg, element);
+  RSPLoadFlags(&cp2->vco, &vco, &vne);
 
-  __m128i temp, equal, lessthanEqual, vvcc, vdReg;
-  cp2->vcc = 0x0000;
+  /* vd = le ? vs : vt; */
+  __m128i lessthanEqual = RSPCompareLT(vsReg, vtReg, vco, vne);
+  __m128i vdReg = RSPSelect(lessthanEqual, vsReg, vtReg);
 
-  /* equal = (vco & vne) && (vs == vt) */
-  temp = _mm_and_si128(vne, vco);
-  equal = _mm_cmpeq_epi16(vsReg, vtReg);
-  equal = _mm_and_si128(equal, temp);
+  RSPSetCompareFlags(cp2, lessthanEqual);
+  _mm_store_si128((__m128i*) accLow, vdReg);
+  _mm_store_si128((__m128i*) vd, vdReg);
+  RSPClearFlags(&cp2->vco);
+#else
+  const struct RSPFlags *flags = RSPGetFlagMasks(&cp2->vco);
+  int16_t vtReg[8], vdData[8], lessthanEqual[8];
+  unsigned i;
 
-  /* le = vs < vt | equal */
-  lessthanEqual = _mm_cmplt_epi16(vsReg, vtReg);
-  lessthanEqual = _mm_or_si128(lessthanEqual, equal);
+  RSPGetVectorOperands(vtData, vtReg, element);
 
-  /* vd = le ? vs : vt; */
-#ifdef SSSE3_ONLY
-  vsReg = _mm_and_si128(lessthanEqual, vsReg);
-  vtReg = _mm_andnot_si128(lessthanEqual, vtReg);
-  vdReg = _mm_or_si128(vsReg, vtReg);
-#else
-  vdReg = _mm_blendv_epi8(vtReg, vsReg, lessthanEqual);
-#endif
+  /* le = vs < vt | ((vco & vne) && (vs == vt)) */
+  for (i = 0; i < 8; i++) {
+    int equal = ((flags->lo.slices[i] & flags->hi.slices[i]) != 0) &
+      (vsData[i] == vtReg[i]);
+
+    lessthanEqual[i] = -((vsData[i] < vtReg[i]) | equal);
+    vdData[i] = lessthanEqual[i] ? vsData[i] : vtReg[i];
+  }
 
-  vvcc = _mm_packs_epi16(lessthanEqual, lessthanEqual);
-  cp2->vcc = _mm_movemask_epi8(vvcc) & 0xFF;
-  _mm_store_si128((__m128i*) accLow, vdReg);
-  _mm_store_si128((__m128i*) vd, vdReg);
-  _mm_store_si128((__m128i*) (cp2->vcolo.slices), _mm_setzero_si128());
-  _mm_store_si128((__m128i*) (cp2->vcohi.slices), _mm_setzero_si128());
-#else
-#warning "Unimplemented function: RSPVLT (No SSE)."
+  RSPSetCompareFlags(cp2, lessthanEqual);
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vdData, sizeof(vdData));
+  RSPClearFlags(&cp2->vco);
 #endif
 }
 
@@ -646,75 +1307,34 @@ RSPVLT(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVMACF(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
-  uint16_t *accMid = cp2->accumulatorMid.slices;
-  uint16_t *accHigh = cp2->accumulatorHigh.slices;
-
 #ifdef USE_SSE
-  __m128i loProduct, hiProduct, unpackLo, unpackHi;
-  __m128i vaccTemp, vaccLow, vaccMid, vaccHigh;
-  __m128i vdReg, vdRegLo, vdRegHi;
+  __m128i vaccLow, upperLo, upperHi, vdReg;
 
-  vaccLow = _mm_load_si128((__m128i*) accLow);
-  vaccMid = _mm_load_si128((__m128i*) accMid);
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
 
-  /* Unpack to obtain for 32-bit precision. */
-  RSPZeroExtend16to32(vaccLow, &vaccLow, &vaccHigh);
-
-  /* Begin accumulating the products. */
-  unpackLo = _mm_mullo_epi16(vsReg, vtReg);
-  unpackHi = _mm_mulhi_epi16(vsReg, vtReg);
-  loProduct = _mm_unpacklo_epi16(unpackLo, unpackHi);
-  hiProduct = _mm_unpackhi_epi16(unpackLo, unpackHi);
-  loProduct = _mm_slli_epi32(loProduct, 1);
-  hiProduct = _mm_slli_epi32(hiProduct, 1);
-
-#ifdef SSSE3_ONLY
-  vdRegLo = _mm_srli_epi32(loProduct, 16);
-  vdRegHi = _mm_srli_epi32(hiProduct, 16);
-  vdRegLo = _mm_slli_epi32(vdRegLo, 16);
-  vdRegHi = _mm_slli_epi32(vdRegHi, 16);
-  vdRegLo = _mm_xor_si128(vdRegLo, loProduct);
-  vdRegHi = _mm_xor_si128(vdRegHi, hiProduct);
+  RSPLoadAccumulator(cp2, &vaccLow, &upperLo, &upperHi);
+  vdReg = RSPStepVMACF(vsReg, vtReg, &vaccLow, &upperLo, &upperHi);
+  RSPStoreAccumulator(cp2, vaccLow, upperLo, upperHi);
+  _mm_store_si128((__m128i*) vd, vdReg);
 #else
-  vdRegLo = _mm_blend_epi16(loProduct, _mm_setzero_si128(), 0xAA);
-  vdRegHi = _mm_blend_epi16(hiProduct, _mm_setzero_si128(), 0xAA);
-#endif
-
-  vaccLow = _mm_add_epi32(vaccLow, vdRegLo);
-  vaccHigh = _mm_add_epi32(vaccHigh, vdRegHi);
-
-  vdReg = RSPPackLo32to16(vaccLow, vaccHigh);
-  _mm_store_si128((__m128i*) accLow, vdReg);
-
-  /* Multiply the MSB of sources, accumulate the product. */
-  vaccTemp = _mm_load_si128((__m128i*) accHigh);
-  vdRegLo = _mm_unpacklo_epi16(vaccMid, vaccTemp);
-  vdRegHi = _mm_unpackhi_epi16(vaccMid, vaccTemp);
+  uint16_t *accLow = (uint16_t*) cp2->accumulatorLow.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
+  int32_t products[8];
+  int16_t vtData[8];
+  unsigned i;
 
-  loProduct = _mm_srai_epi32(loProduct, 16);
-  hiProduct = _mm_srai_epi32(hiProduct, 16);
-  vaccLow = _mm_srai_epi32(vaccLow, 16);
-  vaccHigh = _mm_srai_epi32(vaccHigh, 16);
+  RSPGetVectorOperands(vt, vtData, element);
 
-  vaccLow = _mm_add_epi32(loProduct, vaccLow);
-  vaccHigh = _mm_add_epi32(hiProduct, vaccHigh);
-  vaccLow = _mm_add_epi32(vdRegLo, vaccLow);
-  vaccHigh = _mm_add_epi32(vdRegHi, vaccHigh);
+  /* The product of the signed sources is doubled. */
+  for (i = 0; i < 8; i++)
+    products[i] = (uint32_t) (vs[i] * vtData[i]) << 1;
 
-  /* Clamp the accumulator and write it all out. */
-  vdReg = _mm_packs_epi32(vaccLow, vaccHigh);
-  vaccMid = RSPPackLo32to16(vaccLow, vaccHigh);
-  vaccHigh = RSPPackHi32to16(vaccLow, vaccHigh);
+  RSPAccumulate(accLow, accUpper, products);
 
-  _mm_store_si128((__m128i*) vd, vdReg);
-  _mm_store_si128((__m128i*) accMid, vaccMid);
-  _mm_store_si128((__m128i*) accHigh, vaccHigh);
-#else
-#warning "Unimplemented function: VMACF (No SSE)."
+  for (i = 0; i < 8; i++)
+    vd[i] = RSPClamp16(accUpper[i]);
 #endif
 }
 
@@ -723,8 +1343,45 @@ RSPVMACF(struct RSPCP2 *cp2, int16_t *vd,
  * ========================================================================= */
 void
 RSPVMACQ(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
-  debug("Unimplemented function: VMACQ.");
+  const int16_t *unused(vs), const int16_t *unused(vt),
+  unsigned unused(element)) {
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
+
+#ifdef USE_SSE
+  __m128i upperLo = _mm_load_si128((__m128i*) (accUpper + 0));
+  __m128i upperHi = _mm_load_si128((__m128i*) (accUpper + 4));
+
+  /* Only the upper 32 bits are used (and changed). */
+  upperLo = RSPOddify(upperLo);
+  upperHi = RSPOddify(upperHi);
+
+  _mm_store_si128((__m128i*) vd, RSPClampQuantized(upperLo, upperHi));
+  _mm_store_si128((__m128i*) (accUpper + 0), upperLo);
+  _mm_store_si128((__m128i*) (accUpper + 4), upperHi);
+#else
+  int32_t vaccUpper[8];
+  int16_t vdData[8];
+  unsigned i;
+
+  /* Only the upper 32 bits are used (and changed). */
+  for (i = 0; i < 8; i++) {
+    int32_t upper = accUpper[i];
+
+    if (!(upper & 0x20)) {
+      if (upper < 0)
+        upper += 0x20;
+
+      else if (upper >= 0x20)
+        upper -= 0x20;
+    }
+
+    vdData[i] = RSPClampQuantized(upper);
+    vaccUpper[i] = upper;
+  }
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accUpper, vaccUpper, sizeof(vaccUpper));
+#endif
 }
 
 /* ============================================================================
@@ -733,26 +1390,16 @@ RSPVMACQ(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVMACU(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  int16_t *accLow = cp2->accumulatorLow.slices;
-  int16_t *accMid = cp2->accumulatorMid.slices;
-  int16_t *accHigh = cp2->accumulatorHigh.slices;
-  unsigned i;
-
 #ifdef USE_SSE
-  __m128i loProduct, hiProduct, unpackLo, unpackHi;;
-  __m128i vaccTemp, vaccLow, vaccMid, vaccHigh;
-  __m128i vdReg, vdRegLo, vdRegHi;
+  __m128i loProduct, hiProduct, unpackLo, unpackHi;
+  __m128i upperLo, upperHi, overLo, overHi;
+  __m128i vdReg, negative, maximum;
 
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
-  vaccLow = _mm_load_si128((__m128i*) accLow);
-  vaccMid = _mm_load_si128((__m128i*) accMid);
-
-  /* Unpack to obtain for 32-bit precision. */
-  RSPZeroExtend16to32(vaccLow, &vaccLow, &vaccHigh);
 
-  /* Begin accumulating the products. */
+  /* The product of the signed sources is doubled. */
   unpackLo = _mm_mullo_epi16(vsReg, vtReg);
   unpackHi = _mm_mulhi_epi16(vsReg, vtReg);
   loProduct = _mm_unpacklo_epi16(unpackLo, unpackHi);
@@ -760,67 +1407,39 @@ RSPVMACU(struct RSPCP2 *cp2, int16_t *vd,
   loProduct = _mm_slli_epi32(loProduct, 1);
   hiProduct = _mm_slli_epi32(hiProduct, 1);
 
-#ifdef SSSE3_ONLY
-  vdRegLo = _mm_srli_epi32(loProduct, 16);
-  vdRegHi = _mm_srli_epi32(hiProduct, 16);
-  vdRegLo = _mm_slli_epi32(vdRegLo, 16);
-  vdRegHi = _mm_slli_epi32(vdRegHi, 16);
-  vdRegLo = _mm_xor_si128(vdRegLo, loProduct);
-  vdRegHi = _mm_xor_si128(vdRegHi, hiProduct);
+  RSPAccumulate(cp2, loProduct, hiProduct, &upperLo, &upperHi);
+
+  /* Negative sums give 0, and those past 0x7FFF give 0xFFFF. */
+  maximum = _mm_set1_epi32(0x7FFF);
+  vdReg = _mm_packs_epi32(upperLo, upperHi);
+  negative = _mm_srai_epi16(vdReg, 15);
+  overLo = _mm_cmpgt_epi32(upperLo, maximum);
+  overHi = _mm_cmpgt_epi32(upperHi, maximum);
+  vdReg = _mm_or_si128(vdReg, _mm_packs_epi32(overLo, overHi));
+  vdReg = _mm_andnot_si128(negative, vdReg);
+
+  _mm_store_si128((__m128i*) vd, vdReg);
 #else
-  vdRegLo = _mm_blend_epi16(loProduct, _mm_setzero_si128(), 0xAA);
-  vdRegHi = _mm_blend_epi16(hiProduct, _mm_setzero_si128(), 0xAA);
-#endif
+  uint16_t *accLow = (uint16_t*) cp2->accumulatorLow.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
+  int32_t products[8];
+  int16_t vtData[8], vdData[8];
+  unsigned i;
 
-  vaccLow = _mm_add_epi32(vaccLow, vdRegLo);
-  vaccHigh = _mm_add_epi32(vaccHigh, vdRegHi);
+  RSPGetVectorOperands(vt, vtData, element);
 
-  vdReg = RSPPackLo32to16(vaccLow, vaccHigh);
-  _mm_store_si128((__m128i*) accLow, vdReg);
+  /* The product of the signed sources is doubled. */
+  for (i = 0; i < 8; i++)
+    products[i] = (uint32_t) (vs[i] * vtData[i]) << 1;
 
-  /* Multiply the MSB of sources, accumulate the product. */
-  vaccTemp = _mm_load_si128((__m128i*) accHigh);
-  vdRegLo = _mm_unpacklo_epi16(vaccMid, vaccTemp);
-  vdRegHi = _mm_unpackhi_epi16(vaccMid, vaccTemp);
+  RSPAccumulate(accLow, accUpper, products);
 
-  loProduct = _mm_srai_epi32(loProduct, 16);
-  hiProduct = _mm_srai_epi32(hiProduct, 16);
-  vaccLow = _mm_srai_epi32(vaccLow, 16);
-  vaccHigh = _mm_srai_epi32(vaccHigh, 16);
-
-  vaccLow = _mm_add_epi32(loProduct, vaccLow);
-  vaccHigh = _mm_add_epi32(hiProduct, vaccHigh);
-  vaccLow = _mm_add_epi32(vdRegLo, vaccLow);
-  vaccHigh = _mm_add_epi32(vdRegHi, vaccHigh);
-
-  /* Clamp the accumulator and write it all out. */
-  vaccMid = RSPPackLo32to16(vaccLow, vaccHigh);
-  vaccHigh = RSPPackHi32to16(vaccLow, vaccHigh);
-  _mm_store_si128((__m128i*) accMid, vaccMid);
-  _mm_store_si128((__m128i*) accHigh, vaccHigh);
-#else
-#warning "Unimplemented function: VMACU (No SSE)."
-#endif
+  /* Negative sums give 0, and those past 0x7FFF give 0xFFFF. */
+  for (i = 0; i < 8; i++)
+    vdData[i] = accUpper[i] < 0 ? 0 : accUpper[i] > 32767 ? -1 : accUpper[i];
 
-  for (i = 0; i < 8; i++) {
-    signed short result;
-    short int tmp;
-
-    result = accMid[i];
-
-    unsigned long long lopiece = (unsigned short) accLow[i];
-    unsigned long long mdpiece = (unsigned short) accMid[i];
-    unsigned long long hipiece = (unsigned short) accHigh[i];
-    mdpiece <<= 16;
-    hipiece <<= 32;
-
-    signed long long int thing = lopiece | mdpiece | hipiece;
-    tmp = (signed short)(thing >> 31) != 0x0000;
-    result |= -tmp;
-    tmp = accHigh[i] >> 15;
-    result &= ~tmp;
-    vd[i] = result;
-  }
+  memcpy(vd, vdData, sizeof(vdData));
+#endif
 }
 
 /* ============================================================================
@@ -829,41 +1448,40 @@ RSPVMACU(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVMADH(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accMid = cp2->accumulatorMid.slices;
-  uint16_t *accHigh = cp2->accumulatorHigh.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
 
 #ifdef USE_SSE
-  __m128i unpackLo, unpackHi, loProduct, hiProduct;
-  __m128i vaccLow, vaccMid, vaccHigh, vdReg;
+  __m128i upperLo, upperHi, vdReg;
 
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
-  vaccMid = _mm_load_si128((__m128i*) accMid);
-  vaccHigh = _mm_load_si128((__m128i*) accHigh);
-
-  /* Unpack to obtain for 32-bit precision. */
-  vaccLow = _mm_unpacklo_epi16(vaccMid, vaccHigh);
-  vaccHigh = _mm_unpackhi_epi16(vaccMid, vaccHigh);
-
-  /* Multiply the sources, accumulate the product. */
-  unpackLo = _mm_mullo_epi16(vsReg, vtReg);
-  unpackHi = _mm_mulhi_epi16(vsReg, vtReg);
-  loProduct = _mm_unpacklo_epi16(unpackLo, unpackHi);
-  hiProduct = _mm_unpackhi_epi16(unpackLo, unpackHi);
-  vaccLow = _mm_add_epi32(vaccLow, loProduct);
-  vaccHigh = _mm_add_epi32(vaccHigh, hiProduct);
+  upperLo = _mm_load_si128((__m128i*) (accUpper + 0));
+  upperHi = _mm_load_si128((__m128i*) (accUpper + 4));
 
-  /* Pack the accumulator and result back up. */
-  vdReg = _mm_packs_epi32(vaccLow, vaccHigh);
-  vaccMid = RSPPackLo32to16(vaccLow, vaccHigh);
-  vaccHigh = RSPPackHi32to16(vaccLow, vaccHigh);
+  vdReg = RSPStepVMADH(vsReg, vtReg, &upperLo, &upperHi);
 
   _mm_store_si128((__m128i*) vd, vdReg);
-  _mm_store_si128((__m128i*) accMid, vaccMid);
-  _mm_store_si128((__m128i*) accHigh, vaccHigh);
+  _mm_store_si128((__m128i*) (accUpper + 0), upperLo);
+  _mm_store_si128((__m128i*) (accUpper + 4), upperHi);
 #else
-  debug("Unimplemented function: VMADH.");
+  int16_t vtData[8], vdData[8];
+  int32_t vaccUpper[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  /* Accumulate the product on top of the middle word. */
+  for (i = 0; i < 8; i++) {
+    uint32_t acc = (uint32_t) accUpper[i];
+
+    acc += (uint32_t) (vs[i] * vtData[i]);
+    vdData[i] = RSPClamp16(acc);
+    vaccUpper[i] = acc;
+  }
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accUpper, vaccUpper, sizeof(vaccUpper));
 #endif
 }
 
@@ -873,54 +1491,40 @@ RSPVMADH(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVMADL(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
-  uint16_t *accMid = cp2->accumulatorMid.slices;
-  uint16_t *accHigh = cp2->accumulatorHigh.slices;
-
 #ifdef USE_SSE
-  __m128i vaccTemp, vaccLow, vaccMid, vaccHigh;
   __m128i unpackHi, loProduct, hiProduct;
-  __m128i vdReg, vdRegLo, vdRegHi;
+  __m128i vaccLow, upperLo, upperHi;
 
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
-  vaccLow = _mm_load_si128((__m128i*) accLow);
-  vaccMid = _mm_load_si128((__m128i*) accMid);
-
-  /* Unpack to obtain for 32-bit precision. */
-  RSPZeroExtend16to32(vaccLow, &vaccLow, &vaccHigh);
 
-  /* Begin accumulating the products. */
+  /* Only the high word of the unsigned product is used. */
   unpackHi = _mm_mulhi_epu16(vsReg, vtReg);
   loProduct = _mm_unpacklo_epi16(unpackHi, _mm_setzero_si128());
   hiProduct = _mm_unpackhi_epi16(unpackHi, _mm_setzero_si128());
 
-  vaccLow = _mm_add_epi32(vaccLow, loProduct);
-  vaccHigh = _mm_add_epi32(vaccHigh, hiProduct);
-  vdReg = RSPPackLo32to16(vaccLow, vaccHigh);
-  _mm_store_si128((__m128i*) accLow, vdReg);
+  vaccLow = RSPAccumulate(cp2, loProduct, hiProduct, &upperLo, &upperHi);
+  _mm_store_si128((__m128i*) vd, RSPClampLowToVal(vaccLow, upperLo, upperHi));
+#else
+  uint16_t *accLow = (uint16_t*) cp2->accumulatorLow.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
+  int32_t products[8];
+  int16_t vtData[8], vdData[8];
+  unsigned i;
 
-  /* Finish accumulating whatever is left. */
-  vaccTemp = _mm_load_si128((__m128i*) accHigh);
-  vdRegLo = _mm_unpacklo_epi16(vaccMid, vaccTemp);
-  vdRegHi = _mm_unpackhi_epi16(vaccMid, vaccTemp);
+  RSPGetVectorOperands(vt, vtData, element);
 
-  vaccLow = _mm_srai_epi32(vaccLow, 16);
-  vaccHigh = _mm_srai_epi32(vaccHigh, 16);
-  vaccLow = _mm_add_epi32(vdRegLo, vaccLow);
-  vaccHigh = _mm_add_epi32(vdRegHi, vaccHigh);
+  /* Only the high word of the unsigned product is used. */
+  for (i = 0; i < 8; i++)
+    products[i] = (uint32_t) (uint16_t) vs[i] * (uint16_t) vtData[i] >> 16;
 
-  /* Clamp the accumulator and write it all out. */
-  vaccMid = RSPPackLo32to16(vaccLow, vaccHigh);
-  vaccHigh = RSPPackHi32to16(vaccLow, vaccHigh);
-  vdReg = RSPClampLowToVal(vdReg, vaccMid, vaccHigh);
+  RSPAccumulate(accLow, accUpper, products);
 
-  _mm_store_si128((__m128i*) vd, vdReg);
-  _mm_store_si128((__m128i*) accMid, vaccMid);
-  _mm_store_si128((__m128i*) accHigh, vaccHigh);
-#else
-  debug("Unimplemented function: VMADL.");
+  for (i = 0; i < 8; i++)
+    vdData[i] = RSPClampLowToVal(accLow[i], accUpper[i]);
+
+  memcpy(vd, vdData, sizeof(vdData));
 #endif
 }
 
@@ -930,71 +1534,34 @@ RSPVMADL(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVMADM(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
-  uint16_t *accMid = cp2->accumulatorMid.slices;
-  uint16_t *accHigh = cp2->accumulatorHigh.slices;
-
 #ifdef USE_SSE
-  __m128i vaccTemp, vaccLow, vaccMid, vaccHigh, loProduct, hiProduct;
-  __m128i vsRegLo, vsRegHi, vtRegLo, vtRegHi, vdReg, vdRegLo, vdRegHi;
+  __m128i vaccLow, upperLo, upperHi, vdReg;
 
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
-  vaccLow = _mm_load_si128((__m128i*) accLow);
-  vaccMid = _mm_load_si128((__m128i*) accMid);
-
-  /* Unpack to obtain for 32-bit precision. */
-  RSPSignExtend16to32(vsReg, &vsRegLo, &vsRegHi);
-  RSPZeroExtend16to32(vtReg, &vtRegLo, &vtRegHi);
-  RSPZeroExtend16to32(vaccLow, &vaccLow, &vaccHigh);
-
-  /* Begin accumulating the products. */
-  loProduct = _mm_mullo_epi32(vsRegLo, vtRegLo);
-  hiProduct = _mm_mullo_epi32(vsRegHi, vtRegHi);
 
-#ifdef SSSE3_ONLY
-  vdRegLo = _mm_srli_epi32(loProduct, 16);
-  vdRegHi = _mm_srli_epi32(hiProduct, 16);
-  vdRegLo = _mm_slli_epi32(vdRegLo, 16);
-  vdRegHi = _mm_slli_epi32(vdRegHi, 16);
-  vdRegLo = _mm_xor_si128(vdRegLo, loProduct);
-  vdRegHi = _mm_xor_si128(vdRegHi, hiProduct);
+  RSPLoadAccumulator(cp2, &vaccLow, &upperLo, &upperHi);
+  vdReg = RSPStepVMADM(vsReg, vtReg, &vaccLow, &upperLo, &upperHi);
+  RSPStoreAccumulator(cp2, vaccLow, upperLo, upperHi);
+  _mm_store_si128((__m128i*) vd, vdReg);
 #else
-  vdRegLo = _mm_blend_epi16(loProduct, _mm_setzero_si128(), 0xAA);
-  vdRegHi = _mm_blend_epi16(hiProduct, _mm_setzero_si128(), 0xAA);
-#endif
-  vaccLow = _mm_add_epi32(vaccLow, vdRegLo);
-  vaccHigh = _mm_add_epi32(vaccHigh, vdRegHi);
-
-  vdReg = RSPPackLo32to16(vaccLow, vaccHigh);
-  _mm_store_si128((__m128i*) accLow, vdReg);
-
-  /* Multiply the MSB of sources, accumulate the product. */
-  vaccTemp = _mm_load_si128((__m128i*) accHigh);
-  vdRegLo = _mm_unpacklo_epi16(vaccMid, vaccTemp);
-  vdRegHi = _mm_unpackhi_epi16(vaccMid, vaccTemp);
+  uint16_t *accLow = (uint16_t*) cp2->accumulatorLow.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
+  int32_t products[8];
+  int16_t vtData[8];
+  unsigned i;
 
-  loProduct = _mm_srai_epi32(loProduct, 16);
-  hiProduct = _mm_srai_epi32(hiProduct, 16);
-  vaccLow = _mm_srai_epi32(vaccLow, 16);
-  vaccHigh = _mm_srai_epi32(vaccHigh, 16);
+  RSPGetVectorOperands(vt, vtData, element);
 
-  vaccLow = _mm_add_epi32(loProduct, vaccLow);
-  vaccHigh = _mm_add_epi32(hiProduct, vaccHigh);
-  vaccLow = _mm_add_epi32(vdRegLo, vaccLow);
-  vaccHigh = _mm_add_epi32(vdRegHi, vaccHigh);
+  /* Signed `vs`, unsigned `vt`. */
+  for (i = 0; i < 8; i++)
+    products[i] = vs[i] * (uint16_t) vtData[i];
 
-  /* Clamp the accumulator and write it all out. */
-  vdReg = _mm_packs_epi32(vaccLow, vaccHigh);
-  vaccMid = RSPPackLo32to16(vaccLow, vaccHigh);
-  vaccHigh = RSPPackHi32to16(vaccLow, vaccHigh);
+  RSPAccumulate(accLow, accUpper, products);
 
-  _mm_store_si128((__m128i*) vd, vdReg);
-  _mm_store_si128((__m128i*) accMid, vaccMid);
-  _mm_store_si128((__m128i*) accHigh, vaccHigh);
-#else
-  debug("Unimplemented function: VMADM.");
+  for (i = 0; i < 8; i++)
+    vd[i] = RSPClamp16(accUpper[i]);
 #endif
 }
 
@@ -1004,72 +1571,36 @@ RSPVMADM(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVMADN(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
-  uint16_t *accMid = cp2->accumulatorMid.slices;
-  uint16_t *accHigh = cp2->accumulatorHigh.slices;
-
 #ifdef USE_SSE
-  __m128i vaccTemp, vaccLow, vaccMid, vaccHigh, loProduct, hiProduct;
-  __m128i vsRegLo, vsRegHi, vtRegLo, vtRegHi, vdReg, vdRegLo, vdRegHi;
+  __m128i vaccLow, upperLo, upperHi, vdReg;
 
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
-  vaccLow = _mm_load_si128((__m128i*) accLow);
-  vaccMid = _mm_load_si128((__m128i*) accMid);
 
-  /* Unpack to obtain for 32-bit precision. */
-  RSPZeroExtend16to32(vsReg, &vsRegLo, &vsRegHi);
-  RSPSignExtend16to32(vtReg, &vtRegLo, &vtRegHi);
-  RSPZeroExtend16to32(vaccLow, &vaccLow, &vaccHigh);
-
-  /* Begin accumulating the products. */
-  loProduct = _mm_mullo_epi32(vsRegLo, vtRegLo);
-  hiProduct = _mm_mullo_epi32(vsRegHi, vtRegHi);
-
-#ifdef SSSE3_ONLY
-  vdRegLo = _mm_srli_epi32(loProduct, 16);
-  vdRegHi = _mm_srli_epi32(hiProduct, 16);
-  vdRegLo = _mm_slli_epi32(vdRegLo, 16);
-  vdRegHi = _mm_slli_epi32(vdRegHi, 16);
-  vdRegLo = _mm_xor_si128(vdRegLo, loProduct);
-  vdRegHi = _mm_xor_si128(vdRegHi, hiProduct);
+  RSPLoadAccumulator(cp2, &vaccLow, &upperLo, &upperHi);
+  vdReg = RSPStepVMADN(vsReg, vtReg, &vaccLow, &upperLo, &upperHi);
+  RSPStoreAccumulator(cp2, vaccLow, upperLo, upperHi);
+  _mm_store_si128((__m128i*) vd, vdReg);
 #else
-  vdRegLo = _mm_blend_epi16(loProduct, _mm_setzero_si128(), 0xAA);
-  vdRegHi = _mm_blend_epi16(hiProduct, _mm_setzero_si128(), 0xAA);
-#endif
-
-  vaccLow = _mm_add_epi32(vaccLow, vdRegLo);
-  vaccHigh = _mm_add_epi32(vaccHigh, vdRegHi);
-
-   vdReg = RSPPackLo32to16(vaccLow, vaccHigh);
-  _mm_store_si128((__m128i*) accLow, vdReg);
+  uint16_t *accLow = (uint16_t*) cp2->accumulatorLow.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
+  int32_t products[8];
+  int16_t vtData[8], vdData[8];
+  unsigned i;
 
-  /* Multiply the MSB of sources, accumulate the product. */
-  vaccTemp = _mm_load_si128((__m128i*) accHigh);
-  vdRegLo = _mm_unpacklo_epi16(vaccMid, vaccTemp);
-  vdRegHi = _mm_unpackhi_epi16(vaccMid, vaccTemp);
+  RSPGetVectorOperands(vt, vtData, element);
 
-  loProduct = _mm_srai_epi32(loProduct, 16);
-  hiProduct = _mm_srai_epi32(hiProduct, 16);
-  vaccLow = _mm_srai_epi32(vaccLow, 16);
-  vaccHigh = _mm_srai_epi32(vaccHigh, 16);
+  /* Unsigned `vs`, signed `vt`. */
+  for (i = 0; i < 8; i++)
+    products[i] = (uint16_t) vs[i] * vtData[i];
 
-  vaccLow = _mm_add_epi32(loProduct, vaccLow);
-  vaccHigh = _mm_add_epi32(hiProduct, vaccHigh);
-  vaccLow = _mm_add_epi32(vdRegLo, vaccLow);
-  vaccHigh = _mm_add_epi32(vdRegHi, vaccHigh);
+  RSPAccumulate(accLow, accUpper, products);
 
-  /* Clamp the accumulator and write it all out. */
-  vaccMid = RSPPackLo32to16(vaccLow, vaccHigh);
-  vaccHigh = RSPPackHi32to16(vaccLow, vaccHigh);
-  vdReg = RSPClampLowToVal(vdReg, vaccMid, vaccHigh);
+  for (i = 0; i < 8; i++)
+    vdData[i] = RSPClampLowToVal(accLow[i], accUpper[i]);
 
-  _mm_store_si128((__m128i*) vd, vdReg);
-  _mm_store_si128((__m128i*) accMid, vaccMid);
-  _mm_store_si128((__m128i*) accHigh, vaccHigh);
-#else
-  debug("Unimplemented function: VMADN.");
+  memcpy(vd, vdData, sizeof(vdData));
 #endif
 }
 
@@ -1078,7 +1609,7 @@ RSPVMADN(struct RSPCP2 *cp2, int16_t *vd,
  * ========================================================================= */
 void
 RSPVMOV(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
+  const int16_t *unused(vs), const int16_t *vt, unsigned element) {
   int16_t *accLow = cp2->accumulatorLow.slices;
   unsigned delement = cp2->iw >> 11 & 0x1F;
 
@@ -1087,7 +1618,7 @@ RSPVMOV(struct RSPCP2 *cp2, int16_t *vd,
   vtReg = RSPGetVectorOperands(vtReg, element);
     _mm_store_si128((__m128i*) accLow, vtReg);
 #else
-  debug("Unimplemented function: VMOV.");
+  RSPGetVectorOperands(vt, accLow, element);
 #endif
 
   vd[delement & 0x7] = accLow[delement & 0x7];
@@ -1101,21 +1632,38 @@ RSPVMRG(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vsData, const int16_t *vtDataIn, unsigned element) {
   int16_t *accLow = cp2->accumulatorLow.slices;
 
-  int16_t vtData[8];
-  unsigned i;
-
 #ifdef USE_SSE
+  __m128i le, ge;
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
   __m128i vtReg = _mm_load_si128((__m128i*) vtDataIn);
+  __m128i vdReg;
+
   vtReg = RSPGetVectorOperands(vtReg, element);
-    _mm_store_si128((__m128i*) vtData, vtReg);
+  RSPLoadFlags(&cp2->vcc, &le, &ge);
+
+  /* vd = le ? vs : vt; */
+#ifdef SSSE3_ONLY
+  vsReg = _mm_and_si128(le, vsReg);
+  vtReg = _mm_andnot_si128(le, vtReg);
+  vdReg = _mm_or_si128(vsReg, vtReg);
 #else
-#warning "Unimplemented function: RSPVMRG (No SSE)."
+  vdReg = _mm_blendv_epi8(vtReg, vsReg, le);
 #endif
 
+  _mm_store_si128((__m128i*) accLow, vdReg);
+  _mm_store_si128((__m128i*) vd, vdReg);
+#else
+  const struct RSPFlags *flags = RSPGetFlagMasks(&cp2->vcc);
+  int16_t vtData[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vtDataIn, vtData, element);
+
   for (i = 0; i < 8; i++)
-    accLow[i] = cp2->vcc & (0x0001 << i) ? vsData[i] : vtData[i];
+    accLow[i] = flags->lo.slices[i] ? vsData[i] : vtData[i];
 
   memcpy(vd, accLow, sizeof(short) * 8);
+#endif
 }
 
 /* ============================================================================
@@ -1124,35 +1672,35 @@ RSPVMRG(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVMUDH(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
-  uint16_t *accMid = cp2->accumulatorMid.slices;
-  uint16_t *accHigh = cp2->accumulatorHigh.slices;
-
 #ifdef USE_SSE
-  __m128i vaccLow, vaccMid, vaccHigh, vdReg;
-  __m128i unpackLo, unpackHi;
+  __m128i vaccLow, upperLo, upperHi, vdReg;
 
-  __m128i vtReg = _mm_load_si128((__m128i*) vt);
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
 
-  /* Multiply the sources, accumulate the product. */
-  unpackLo = _mm_mullo_epi16(vsReg, vtReg);
-  unpackHi = _mm_mulhi_epi16(vsReg, vtReg);
-  vaccHigh = _mm_unpackhi_epi16(unpackLo, unpackHi);
-  vaccLow = _mm_unpacklo_epi16(unpackLo, unpackHi);
-
-  /* Pack the accumulator and result back up. */
-  vdReg = _mm_packs_epi32(vaccLow, vaccHigh);
-  vaccMid = RSPPackLo32to16(vaccLow, vaccHigh);
-  vaccHigh = RSPPackHi32to16(vaccLow, vaccHigh);
-
+  vdReg = RSPStepVMUDH(vsReg, vtReg, &vaccLow, &upperLo, &upperHi);
+  RSPStoreAccumulator(cp2, vaccLow, upperLo, upperHi);
   _mm_store_si128((__m128i*) vd, vdReg);
-  _mm_store_si128((__m128i*) accLow, _mm_setzero_si128());
-  _mm_store_si128((__m128i*) accMid, vaccMid);
-  _mm_store_si128((__m128i*) accHigh, vaccHigh);
 #else
-  debug("Unimplemented function: VMUDH.");
+  uint16_t *accLow = (uint16_t*) cp2->accumulatorLow.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
+  int16_t vtData[8], vdData[8];
+  int32_t vaccUpper[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  for (i = 0; i < 8; i++) {
+    int32_t product = vs[i] * vtData[i];
+
+    vdData[i] = RSPClamp16(product);
+    vaccUpper[i] = product;
+  }
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accUpper, vaccUpper, sizeof(vaccUpper));
+  memset(accLow, 0, sizeof(cp2->accumulatorLow.slices));
 #endif
 }
 
@@ -1162,30 +1710,30 @@ RSPVMUDH(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVMUDL(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
-  uint16_t *accMid = cp2->accumulatorMid.slices;
-  uint16_t *accHigh = cp2->accumulatorHigh.slices;
-
 #ifdef USE_SSE
-  __m128i unpackLo, unpackHi, loProduct, hiProduct, vdReg;
+  __m128i vaccLow, upperLo, upperHi, vdReg;
+
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
 
-  /* Unpack to obtain for 32-bit precision. */
-  unpackLo = _mm_mullo_epi16(vsReg, vtReg);
-  unpackHi = _mm_mulhi_epu16(vsReg, vtReg);
-  loProduct = _mm_unpacklo_epi16(unpackLo, unpackHi);
-  hiProduct = _mm_unpackhi_epi16(unpackLo, unpackHi);
-
-  vdReg = RSPPackHi32to16(loProduct, hiProduct);
-
+  vdReg = RSPStepVMUDL(vsReg, vtReg, &vaccLow, &upperLo, &upperHi);
+  RSPStoreAccumulator(cp2, vaccLow, upperLo, upperHi);
   _mm_store_si128((__m128i*) vd, vdReg);
-  _mm_store_si128((__m128i*) accLow, vdReg);
-  _mm_store_si128((__m128i*) accMid, _mm_setzero_si128());
-  _mm_store_si128((__m128i*) accHigh, _mm_setzero_si128());
 #else
-  debug("Unimplemented function: VMUDL.");
+  uint16_t *accLow = (uint16_t*) cp2->accumulatorLow.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
+  int16_t vtData[8], vdData[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  for (i = 0; i < 8; i++)
+    vdData[i] = (uint32_t) (uint16_t) vs[i] * (uint16_t) vtData[i] >> 16;
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vdData, sizeof(vdData));
+  memset(accUpper, 0, sizeof(cp2->accumulatorUpper.slices));
 #endif
 }
 
@@ -1195,38 +1743,51 @@ RSPVMUDL(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVMUDM(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
-  uint16_t *accMid = cp2->accumulatorMid.slices;
-  uint16_t *accHigh = cp2->accumulatorHigh.slices;
+  uint16_t *accLow = (uint16_t*) cp2->accumulatorLow.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
 
 #ifdef USE_SSE
-  __m128i vsRegLo, vsRegHi, vtRegLo, vtRegHi, vdReg;
-  __m128i loProduct, hiProduct, vaccLow, vaccHigh;
+  __m128i vsRegLo, vsRegHi, vtRegLo, vtRegHi;
+  __m128i loProduct, hiProduct, vaccLow, upperLo, upperHi;
 
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
 
-  /* Unpack to obtain for 32-bit precision. */
+  /* Signed `vs`, unsigned `vt`. */
   RSPSignExtend16to32(vsReg, &vsRegLo, &vsRegHi);
   RSPZeroExtend16to32(vtReg, &vtRegLo, &vtRegHi);
-
-  /* Begin accumulating the products. */
   loProduct = _mm_mullo_epi32(vsRegLo, vtRegLo);
   hiProduct = _mm_mullo_epi32(vsRegHi, vtRegHi);
-  vaccLow = RSPPackLo32to16(loProduct, hiProduct);
-  vaccHigh = RSPPackHi32to16(loProduct, hiProduct);
 
-  loProduct = _mm_cmplt_epi32(loProduct, _mm_setzero_si128());
-  hiProduct = _mm_cmplt_epi32(hiProduct, _mm_setzero_si128());
-  vdReg = _mm_packs_epi32(loProduct, hiProduct);
+  /* The upper 32 bits are the product, sign extended. */
+  vaccLow = RSPPackLo32to16(loProduct, hiProduct);
+  upperLo = _mm_srai_epi32(loProduct, 16);
+  upperHi = _mm_srai_epi32(hiProduct, 16);
 
-  _mm_store_si128((__m128i*) vd, vaccHigh);
+  _mm_store_si128((__m128i*) vd, _mm_packs_epi32(upperLo, upperHi));
   _mm_store_si128((__m128i*) accLow, vaccLow);
-  _mm_store_si128((__m128i*) accMid, vaccHigh);
-  _mm_store_si128((__m128i*) accHigh, vdReg);
+  _mm_store_si128((__m128i*) (accUpper + 0), upperLo);
+  _mm_store_si128((__m128i*) (accUpper + 4), upperHi);
 #else
-  debug("Unimplemented function: VMUDM.");
+  int16_t vtData[8], vaccLow[8], vdData[8];
+  int32_t vaccUpper[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  /* Signed `vs`, unsigned `vt`. */
+  for (i = 0; i < 8; i++) {
+    int32_t product = vs[i] * (uint16_t) vtData[i];
+
+    vaccLow[i] = product;
+    vaccUpper[i] = product >> 16;
+    vdData[i] = product >> 16;
+  }
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vaccLow, sizeof(vaccLow));
+  memcpy(accUpper, vaccUpper, sizeof(vaccUpper));
 #endif
 }
 
@@ -1236,35 +1797,50 @@ RSPVMUDM(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVMUDN(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
-  uint16_t *accMid = cp2->accumulatorMid.slices;
-  uint16_t *accHigh = cp2->accumulatorHigh.slices;
+  uint16_t *accLow = (uint16_t*) cp2->accumulatorLow.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
 
 #ifdef USE_SSE
-  __m128i vsRegLo, vsRegHi, vtRegLo, vtRegHi, vdReg;
-  __m128i loProduct, hiProduct, vaccLow, vaccHigh;
+  __m128i vsRegLo, vsRegHi, vtRegLo, vtRegHi;
+  __m128i loProduct, hiProduct, vaccLow;
 
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
 
-  /* Unpack to obtain for 32-bit precision. */
+  /* Unsigned `vs`, signed `vt`. */
   RSPZeroExtend16to32(vsReg, &vsRegLo, &vsRegHi);
   RSPSignExtend16to32(vtReg, &vtRegLo, &vtRegHi);
-
-  /* Begin accumulating the products. */
   loProduct = _mm_mullo_epi32(vsRegLo, vtRegLo);
   hiProduct = _mm_mullo_epi32(vsRegHi, vtRegHi);
+
+  /* The upper 32 bits are the product, sign extended. */
   vaccLow = RSPPackLo32to16(loProduct, hiProduct);
-  vaccHigh = RSPPackHi32to16(loProduct, hiProduct);
-  vdReg = _mm_cmplt_epi16(vaccHigh, _mm_setzero_si128());
+  loProduct = _mm_srai_epi32(loProduct, 16);
+  hiProduct = _mm_srai_epi32(hiProduct, 16);
 
   _mm_store_si128((__m128i*) vd, vaccLow);
   _mm_store_si128((__m128i*) accLow, vaccLow);
-  _mm_store_si128((__m128i*) accMid, vaccHigh);
-  _mm_store_si128((__m128i*) accHigh, vdReg);
+  _mm_store_si128((__m128i*) (accUpper + 0), loProduct);
+  _mm_store_si128((__m128i*) (accUpper + 4), hiProduct);
 #else
-  debug("Unimplemented function: VMUDN.");
+  int16_t vtData[8], vaccLow[8];
+  int32_t vaccUpper[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  /* Unsigned `vs`, signed `vt`. */
+  for (i = 0; i < 8; i++) {
+    int32_t product = (uint16_t) vs[i] * vtData[i];
+
+    vaccLow[i] = product;
+    vaccUpper[i] = product >> 16;
+  }
+
+  memcpy(vd, vaccLow, sizeof(vaccLow));
+  memcpy(accLow, vaccLow, sizeof(vaccLow));
+  memcpy(accUpper, vaccUpper, sizeof(vaccUpper));
 #endif
 }
 
@@ -1274,32 +1850,37 @@ RSPVMUDN(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVMULF(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vsData, const int16_t *vtDataIn, unsigned element) {
+#ifdef USE_SSE
+  __m128i vaccLow, upperLo, upperHi, vdReg;
+
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
+  __m128i vtReg = _mm_load_si128((__m128i*) vtDataIn);
+  vtReg = RSPGetVectorOperands(vtReg, element);
+
+  vdReg = RSPStepVMULF(vsReg, vtReg, &vaccLow, &upperLo, &upperHi);
+  RSPStoreAccumulator(cp2, vaccLow, upperLo, upperHi);
+  _mm_store_si128((__m128i*) vd, vdReg);
+#else
   int16_t *accLow = cp2->accumulatorLow.slices;
-  int16_t *accMid = cp2->accumulatorMid.slices;
-  int16_t *accHigh = cp2->accumulatorHigh.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
 
   int16_t vtData[8];
   unsigned i;
 
-#ifdef USE_SSE
-  __m128i vtReg = _mm_load_si128((__m128i*) vtDataIn);
-  vtReg = RSPGetVectorOperands(vtReg, element);
-    _mm_store_si128((__m128i*) vtData, vtReg);
-#else
-#warning "Unimplemented function: RSPVMULF (No SSE)."
-#endif
+  RSPGetVectorOperands(vtDataIn, vtData, element);
 
   for (i = 0; i < 8; i++) {
     signed long long int thing;
+    int16_t accMid;
+
     thing = (vsData[i] * vtData[i] << 1) + 0x8000;
+    accMid = (int16_t) (thing >> 16);
 
     accLow[i] = (thing & 0xFFFF);
-    accMid[i] = ((thing >> 16) & 0xFFFF);
-    accHigh[i] = ((thing >> 32) & 0xFFFF);
+    accUpper[i] = (int32_t) (thing >> 16);
+    vd[i] = accMid + (signed short)(accMid >> 15);
   }
-
-  for (i = 0; i < 8; i++)
-    vd[i] = accMid[i] + (signed short)(accMid[i] >> 15);
+#endif
 }
 
 /* ============================================================================
@@ -1308,7 +1889,39 @@ RSPVMULF(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVMULQ(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  debug("Unimplemented function: VMULQ.");
+#ifdef USE_SSE
+  __m128i vaccLow, upperLo, upperHi, vdReg;
+
+  __m128i vsReg = _mm_load_si128((__m128i*) vs);
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  vtReg = RSPGetVectorOperands(vtReg, element);
+
+  vdReg = RSPStepVMULQ(vsReg, vtReg, &vaccLow, &upperLo, &upperHi);
+  RSPStoreAccumulator(cp2, vaccLow, upperLo, upperHi);
+  _mm_store_si128((__m128i*) vd, vdReg);
+#else
+  uint16_t *accLow = (uint16_t*) cp2->accumulatorLow.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
+  int16_t vtData[8], vdData[8];
+  int32_t vaccUpper[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  for (i = 0; i < 8; i++) {
+    int32_t product = vs[i] * vtData[i];
+
+    if (product < 0)
+      product += 31;
+
+    vdData[i] = RSPClampQuantized(product);
+    vaccUpper[i] = product;
+  }
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accUpper, vaccUpper, sizeof(vaccUpper));
+  memset(accLow, 0, sizeof(cp2->accumulatorLow.slices));
+#endif
 }
 
 /* ============================================================================
@@ -1318,8 +1931,7 @@ void
 RSPVMULU(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vsData, const int16_t *vtDataIn, unsigned element) {
   int16_t *accLow = cp2->accumulatorLow.slices;
-  int16_t *accMid = cp2->accumulatorMid.slices;
-  int16_t *accHigh = cp2->accumulatorHigh.slices;
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
 
   int16_t vtData[8];
   unsigned i;
@@ -1329,17 +1941,16 @@ RSPVMULU(struct RSPCP2 *cp2, int16_t *vd,
   vtReg = RSPGetVectorOperands(vtReg, element);
     _mm_store_si128((__m128i*) vtData, vtReg);
 #else
-#warning "Unimplemented function: RSPVMULU (No SSE)."
+  RSPGetVectorOperands(vtDataIn, vtData, element);
 #endif
 
   for (i = 0; i < 8; i++) {
     signed long long int thing = (vsData[i] * vtData[i] << 1) + 0x8000;
 
     accLow[i] = thing;
-    accMid[i] = thing >> 16;
-    accHigh[i] = thing >> 32;
+    accUpper[i] = thing >> 16;
 
-    vd[i] = accMid[i];
+    vd[i] = accUpper[i];
     vd[i] |= vd[i] >> 15;
     vd[i] = (thing < 0) ? 0 : vd[i];
   }
@@ -1351,7 +1962,7 @@ RSPVMULU(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVNAND(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
+  uint16_t *accLow = (uint16_t *) cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
@@ -1364,7 +1975,16 @@ RSPVNAND(struct RSPCP2 *cp2, int16_t *vd,
   _mm_store_si128((__m128i*) vd, vdReg);
   _mm_store_si128((__m128i*) accLow, vdReg);
 #else
-#warning "Unimplemented function: RSPVNAND (No SSE)."
+  int16_t vtData[8], vdData[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  for (i = 0; i < 8; i++)
+    vdData[i] = ~(vs[i] & vtData[i]);
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vdData, sizeof(vdData));
 #endif
 }
 
@@ -1375,27 +1995,37 @@ void
 RSPVNE(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vsData, const int16_t *vtData, unsigned element) {
   int16_t *accLow = cp2->accumulatorLow.slices;
-  unsigned i;
-  int eq;
 
 #ifdef USE_SSE
-  __m128i vne = _mm_load_si128((__m128i*) (cp2->vcohi.slices));
+  __m128i vco, vne;
   __m128i vsReg = _mm_load_si128((__m128i*) vsData);
   __m128i vtReg = _mm_load_si128((__m128i*) vtData);
   vtReg = RSPGetVectorOperands(vtReg, element);
+  RSPLoadFlags(&cp2->vco, &vco, &vne);
 
   __m128i notequal = _mm_cmpeq_epi16(vtReg, vsReg);
   notequal = _mm_cmpeq_epi16(notequal, _mm_setzero_si128());
   __m128i vvcc = _mm_or_si128(notequal, vne);
 
-  vvcc = _mm_packs_epi16(vvcc, vvcc);
-  cp2->vcc = _mm_movemask_epi8(vvcc) & 0xFF;
+  RSPSetCompareFlags(cp2, vvcc);
   _mm_store_si128((__m128i*) accLow, vsReg);
   _mm_store_si128((__m128i*) vd, vsReg);
-  _mm_store_si128((__m128i*) (cp2->vcolo.slices), _mm_setzero_si128());
-  _mm_store_si128((__m128i*) (cp2->vcohi.slices), _mm_setzero_si128());
+  RSPClearFlags(&cp2->vco);
 #else
-#warning "Unimplemented function: RSPVNE (No SSE)."
+  const struct RSPFlags *flags = RSPGetFlagMasks(&cp2->vco);
+  int16_t vtReg[8], notEqual[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vtData, vtReg, element);
+
+  /* notEqual = vne || (vs != vt) */
+  for (i = 0; i < 8; i++)
+    notEqual[i] = -((flags->hi.slices[i] != 0) | (vsData[i] != vtReg[i]));
+
+  RSPSetCompareFlags(cp2, notEqual);
+  memcpy(vd, vsData, sizeof(vtReg));
+  memcpy(accLow, vsData, sizeof(vtReg));
+  RSPClearFlags(&cp2->vco);
 #endif
 }
 
@@ -1403,8 +2033,9 @@ RSPVNE(struct RSPCP2 *cp2, int16_t *vd,
  *  Instruction: VNOP (Vector No Operation)
  * ========================================================================= */
 void
-RSPVNOP(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
+RSPVNOP(struct RSPCP2 *unused(cp2), int16_t *unused(vd),
+  const int16_t *unused(vs), const int16_t *unused(vt),
+  unsigned unused(element)) {
 }
 
 /* ============================================================================
@@ -1413,7 +2044,7 @@ RSPVNOP(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVNOR(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
+  uint16_t *accLow = (uint16_t *) cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
@@ -1426,7 +2057,16 @@ RSPVNOR(struct RSPCP2 *cp2, int16_t *vd,
   _mm_store_si128((__m128i*) vd, vdReg);
   _mm_store_si128((__m128i*) accLow, vdReg);
 #else
-#warning "Unimplemented function: RSPVNOR (No SSE)."
+  int16_t vtData[8], vdData[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  for (i = 0; i < 8; i++)
+    vdData[i] = ~(vs[i] | vtData[i]);
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vdData, sizeof(vdData));
 #endif
 }
 
@@ -1436,7 +2076,7 @@ RSPVNOR(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVOR(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
+  uint16_t *accLow = (uint16_t *) cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
@@ -1449,7 +2089,16 @@ RSPVOR(struct RSPCP2 *cp2, int16_t *vd,
   _mm_store_si128((__m128i*) vd, vdReg);
   _mm_store_si128((__m128i*) accLow, vdReg);
 #else
-#warning "Unimplemented function: RSPVOR (No SSE)."
+  int16_t vtData[8], vdData[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  for (i = 0; i < 8; i++)
+    vdData[i] = vs[i] | vtData[i];
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vdData, sizeof(vdData));
 #endif
 }
 
@@ -1459,7 +2108,7 @@ RSPVOR(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVNXOR(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
+  uint16_t *accLow = (uint16_t *) cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
@@ -1472,7 +2121,16 @@ RSPVNXOR(struct RSPCP2 *cp2, int16_t *vd,
   _mm_store_si128((__m128i*) vd, vdReg);
   _mm_store_si128((__m128i*) accLow, vdReg);
 #else
-#warning "Unimplemented function: RSPVNXOR (No SSE)."
+  int16_t vtData[8], vdData[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  for (i = 0; i < 8; i++)
+    vdData[i] = ~(vs[i] ^ vtData[i]);
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vdData, sizeof(vdData));
 #endif
 }
 
@@ -1481,53 +2139,23 @@ RSPVNXOR(struct RSPCP2 *cp2, int16_t *vd,
  * ========================================================================= */
 void
 RSPVRCP(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
+  const int16_t *unused(vs), const int16_t *vt, unsigned element) {
   int16_t *accLow = cp2->accumulatorLow.slices;
   unsigned delement = cp2->iw >> 11 & 0x1F;
 
-  unsigned int addr;
-  int data;
-  int fetch;
-  int shift = 32;
-
   cp2->divIn = (int) vt[element & 07];
-  data = cp2->divIn;
-
-  if (data < 0)
-      data = -data;
-
-  /* while (shift > 0) or ((shift ^ 31) < 32) */
-  do {
-    --shift;
-    if (data & (1 << shift))
-      goto FOUND_MSB;
-  } while (shift);
-
-  shift = 16 ^ 31;
-FOUND_MSB:
-  shift ^= 31;
-  addr = (data << shift) >> 22;
-  fetch = ReciprocalLUT[addr &= 0x000001FF];
-  shift ^= 31;
-  cp2->divOut = (0x40000000 | (fetch << 14)) >> shift;
-
-  if (cp2->divIn < 0)
-    cp2->divOut = ~cp2->divOut;
-  else if (cp2->divIn == 0)
-    cp2->divOut = 0x7FFFFFFF;
-  else if (cp2->divIn == -32768)
-    cp2->divOut = 0xFFFF0000;
+  cp2->divOut = RSPSingleReciprocal(cp2->divIn);
 
 #ifdef USE_SSE
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
   _mm_store_si128((__m128i*) accLow, vtReg);
 #else
-#warning "Unimplemented function: RSPVRCP (No SSE)."
+  RSPGetVectorOperands(vt, accLow, element);
 #endif
 
-    vd[delement & 07] = (short) cp2->divOut;
-    cp2->doublePrecision = 0;
+  vd[delement & 07] = (short) cp2->divOut;
+  cp2->doublePrecision = 0;
 }
 
 /* ============================================================================
@@ -1535,7 +2163,7 @@ FOUND_MSB:
  * ========================================================================= */
 void
 RSPVRCPH(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
+  const int16_t *unused(vs), const int16_t *vt, unsigned element) {
   unsigned delement = cp2->iw >> 11 & 0x1F;
   int16_t *accLow = cp2->accumulatorLow.slices;
 
@@ -1546,7 +2174,7 @@ RSPVRCPH(struct RSPCP2 *cp2, int16_t *vd,
   vtReg = RSPGetVectorOperands(vtReg, element);
   _mm_store_si128((__m128i*) accLow, vtReg);
 #else
-#warning "Unimplemented function: RSPVRCPH (No SSE)."
+  RSPGetVectorOperands(vt, accLow, element);
 #endif
 
   vd[delement & 0x7] = cp2->divOut >> 16;
@@ -1558,67 +2186,94 @@ RSPVRCPH(struct RSPCP2 *cp2, int16_t *vd,
  * ========================================================================= */
 void
 RSPVRCPL(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
+  const int16_t *unused(vs), const int16_t *vt, unsigned element) {
   int16_t *accLow = cp2->accumulatorLow.slices;
   unsigned delement = cp2->iw >> 11 & 0x1F;
-  int data, fetch, shift = 32;
-  unsigned addr;
 
-  if (cp2->doublePrecision)
+  if (cp2->doublePrecision) {
     cp2->divIn |= (unsigned short) vt[element & 07];
+    cp2->divOut = RSPReciprocal(cp2->divIn);
+  }
 
-  else
-    cp2->divIn  = vt[element & 07] & 0x0000FFFF;
-
-  data = cp2->divIn;
-  if (data < 0)
-      /* -(x) if >=; ~(x) if < */
-      data = -data - (data < -32768);
-
-  /* while (shift > 0) or ((shift ^ 31) < 32) */
-  do {
-    --shift;
-
-    if (data & (1 << shift))
-      goto FOUND_MSB;
-  } while (shift);
-
-  /* if (data == 0) shift = DPH ? 16 ^ 31 : 0 ^ 31; */
-  shift = 31 - 16 * (int) cp2->doublePrecision;
-
-FOUND_MSB:
-  shift ^= 31;
-  addr = (data << shift) >> 22;
-  fetch = ReciprocalLUT[addr &= 0x000001FF];
-  shift ^= 31;
-  cp2->divOut = (0x40000000 | (fetch << 14)) >> shift;
-
-  if (cp2->divIn < 0)
-    cp2->divOut = ~cp2->divOut;
-  else if (cp2->divIn == 0)
-    cp2->divOut = 0x7FFFFFFF;
-  else if (cp2->divIn == -32768)
-    cp2->divOut = 0xFFFF0000;
+  else {
+    cp2->divIn = vt[element & 07] & 0x0000FFFF;
+    cp2->divOut = RSPSingleReciprocal(cp2->divIn);
+  }
 
 #ifdef USE_SSE
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
   _mm_store_si128((__m128i*) accLow, vtReg);
 #else
-#warning "Unimplemented function: RSPVRCPL (No SSE)."
+  RSPGetVectorOperands(vt, accLow, element);
 #endif
 
   vd[delement & 0x7] = (short) cp2->divOut;
   cp2->doublePrecision = false;
 }
 
+/* ============================================================================
+ *  RSPRoundDCT: Adds `vt` to the accumulator where it's negative (VRNDN)
+ *  or not (VRNDP), then clamps the upper 32 bits into `vd`. Bit 0 of the
+ *  vs field says whether `vt` is added to the middle word or the low one.
+ * ========================================================================= */
+static void
+RSPRoundDCT(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vt, unsigned element, int positive) {
+  unsigned shift = (cp2->iw >> 11 & 0x1) << 4;
+
+#ifdef USE_SSE
+  __m128i loProduct, hiProduct, loMask, hiMask;
+  __m128i upperLo, upperHi;
+
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  __m128i flip = _mm_set1_epi32(-positive);
+  vtReg = RSPGetVectorOperands(vtReg, element);
+
+  /* The sign of the accumulator is that of its upper 32 bits. */
+  upperLo = _mm_load_si128((__m128i*) (cp2->accumulatorUpper.slices + 0));
+  upperHi = _mm_load_si128((__m128i*) (cp2->accumulatorUpper.slices + 4));
+  loMask = _mm_xor_si128(_mm_srai_epi32(upperLo, 31), flip);
+  hiMask = _mm_xor_si128(_mm_srai_epi32(upperHi, 31), flip);
+
+  RSPSignExtend16to32(vtReg, &loProduct, &hiProduct);
+  loProduct = _mm_sll_epi32(loProduct, _mm_cvtsi32_si128(shift));
+  hiProduct = _mm_sll_epi32(hiProduct, _mm_cvtsi32_si128(shift));
+  loProduct = _mm_and_si128(loProduct, loMask);
+  hiProduct = _mm_and_si128(hiProduct, hiMask);
+
+  RSPAccumulate(cp2, loProduct, hiProduct, &upperLo, &upperHi);
+  _mm_store_si128((__m128i*) vd, _mm_packs_epi32(upperLo, upperHi));
+#else
+  int32_t *accUpper = cp2->accumulatorUpper.slices;
+  int16_t vtData[8], vdData[8];
+  int32_t products[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  /* The sign of the accumulator is that of its upper 32 bits. */
+  for (i = 0; i < 8; i++) {
+    int32_t product = (int32_t) ((uint32_t) vtData[i] << shift);
+    products[i] = (accUpper[i] >= 0) == positive ? product : 0;
+  }
+
+  RSPAccumulate((uint16_t*) cp2->accumulatorLow.slices, accUpper, products);
+
+  for (i = 0; i < 8; i++)
+    vdData[i] = RSPClamp16(accUpper[i]);
+
+  memcpy(vd, vdData, sizeof(vdData));
+#endif
+}
+
 /* ============================================================================
  *  Instruction: VRNDN (Vector Accumulator DCT Rounding (Negative))
  * ========================================================================= */
 void
 RSPVRNDN(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
-  debug("Unimplemented function: VRNDN.");
+  const int16_t *unused(vs), const int16_t *vt, unsigned element) {
+  RSPRoundDCT(cp2, vd, vt, element, 0);
 }
 
 /* ============================================================================
@@ -1626,8 +2281,8 @@ RSPVRNDN(struct RSPCP2 *cp2, int16_t *vd,
  * ========================================================================= */
 void
 RSPVRNDP(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
-  debug("Unimplemented function: VRNDP.");
+  const int16_t *unused(vs), const int16_t *vt, unsigned element) {
+  RSPRoundDCT(cp2, vd, vt, element, 1);
 }
 
 /* ============================================================================
@@ -1635,8 +2290,26 @@ RSPVRNDP(struct RSPCP2 *cp2, int16_t *vd,
  * ========================================================================= */
 void
 RSPVRSQ(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
-  debug("Unimplemented function: VRSQ.");
+  const int16_t *unused(vs), const int16_t *vt, unsigned element) {
+  int16_t *accLow = cp2->accumulatorLow.slices;
+  unsigned delement = cp2->iw >> 11 & 0x1F;
+
+  /* As VRSQL, but on the (sign-extended) slice alone; */
+  /* -32768 has to be caught before the other negatives. */
+  cp2->divIn = (int) vt[element & 07];
+  cp2->divOut = cp2->divIn == -32768
+    ? 0xFFFF0000 : RSPSingleInverseSqrt(cp2->divIn);
+
+#ifdef USE_SSE
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  vtReg = RSPGetVectorOperands(vtReg, element);
+  _mm_store_si128((__m128i*) accLow, vtReg);
+#else
+  RSPGetVectorOperands(vt, accLow, element);
+#endif
+
+  vd[delement & 07] = (short) cp2->divOut;
+  cp2->doublePrecision = 0;
 }
 
 /* ============================================================================
@@ -1644,7 +2317,7 @@ RSPVRSQ(struct RSPCP2 *cp2, int16_t *vd,
  * ========================================================================= */
 void
 RSPVRSQH(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
+  const int16_t *unused(vs), const int16_t *vt, unsigned element) {
   int16_t *accLow = cp2->accumulatorLow.slices;
   unsigned delement = cp2->iw >> 11 & 0x1F;
 
@@ -1655,7 +2328,7 @@ RSPVRSQH(struct RSPCP2 *cp2, int16_t *vd,
   vtReg = RSPGetVectorOperands(vtReg, element);
   _mm_store_si128((__m128i*) accLow, vtReg);
 #else
-#warning "Unimplemented function: RSPVRSQH (No SSE)."
+  RSPGetVectorOperands(vt, accLow, element);
 #endif
 
   vd[delement & 07] = cp2->divOut >> 16;
@@ -1667,56 +2340,26 @@ RSPVRSQH(struct RSPCP2 *cp2, int16_t *vd,
  * ========================================================================= */
 void
 RSPVRSQL(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
+  const int16_t *unused(vs), const int16_t *vt, unsigned element) {
   int16_t *accLow = cp2->accumulatorLow.slices;
   unsigned delement = cp2->iw >> 11 & 0x1F;
-  int data, fetch, shift = 32;
-  unsigned addr;
 
-  if (cp2->doublePrecision)
+  if (cp2->doublePrecision) {
     cp2->divIn |= (unsigned short) vt[element & 07];
-  else
-    cp2->divIn  = vt[element & 07] & 0x0000FFFF; /* Do not sign-extend. */
-
-  data = cp2->divIn;
-
-  if (data < 0)
-    /* -(x) if >=; ~(x) if < */
-    data = -data - (data < -32768);
-
-  /* while (shift > 0) or ((shift ^ 31) < 32) */
-  do {
-    --shift;
-    if (data & (1 << shift))
-      goto FOUND_MSB;
-  } while (shift);
-
-  /* if (data == 0) shift = DPH ? 16 ^ 31 : 0 ^ 31; */
-  shift = 31 - 16 * cp2->doublePrecision;
-
-FOUND_MSB:
-  shift ^= 31;
-  addr = (data << shift) >> 22;
-  addr &= 0x000001FE;
-  addr |= 0x00000200 | (shift & 1);
-  fetch = ReciprocalLUT[addr];
-  shift ^= 31;
-  shift >>= 1;
-  cp2->divOut = (0x40000000 | (fetch << 14)) >> shift;
-
-  if (cp2->divIn < 0)
-    cp2->divOut = ~cp2->divOut;
-  else if (cp2->divIn == 0)
-    cp2->divOut = 0x7FFFFFFF;
-  else if (cp2->divIn == -32768)
-    cp2->divOut = 0xFFFF0000;
+    cp2->divOut = RSPInverseSqrt(cp2->divIn);
+  }
+
+  else {
+    cp2->divIn = vt[element & 07] & 0x0000FFFF; /* Do not sign-extend. */
+    cp2->divOut = RSPSingleInverseSqrt(cp2->divIn);
+  }
 
 #ifdef USE_SSE
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   vtReg = RSPGetVectorOperands(vtReg, element);
   _mm_store_si128((__m128i*) accLow, vtReg);
 #else
-#warning "Unimplemented function: RSPVRSQL (No SSE)."
+  RSPGetVectorOperands(vt, accLow, element);
 #endif
 
   vd[delement & 0x7] = (short) cp2->divOut;
@@ -1728,10 +2371,17 @@ FOUND_MSB:
  * ========================================================================= */
 void
 RSPVSAR(struct RSPCP2 *cp2, int16_t *vd,
-  const int16_t *vs, const int16_t *vt, unsigned element) {
-  int16_t *accLow = cp2->accumulatorLow.slices;
-  int16_t *accMid = cp2->accumulatorMid.slices;
-  int16_t *accHigh = cp2->accumulatorHigh.slices;
+  const int16_t *unused(vs), const int16_t *unused(vt), unsigned element) {
+  const int32_t *accUpper = cp2->accumulatorUpper.slices;
+  const int16_t *accLow = cp2->accumulatorLow.slices;
+
+#ifdef USE_SSE
+  __m128i upperLo = _mm_load_si128((__m128i*) (accUpper + 0));
+  __m128i upperHi = _mm_load_si128((__m128i*) (accUpper + 4));
+#else
+  int16_t vdData[8];
+  unsigned i;
+#endif
 
   /* ==========================================================================
    * Even though `vt` is ignored in VSAR, according to official sources as well
@@ -1745,14 +2395,32 @@ RSPVSAR(struct RSPCP2 *cp2, int16_t *vd,
    * Or, for exception overrides, should this be `e &= 0x7;` ?
    * Currently this code is safer because &= is less likely to catch oddities.
    * Either way, documentation shows that the switch range is 0:2, not 8:A.
+   *
+   * The high and middle words are split out of the upper 32 bits here.
    * ======================================================================= */
   switch (element) {
     case 0:
-      memcpy(vd, accHigh, sizeof(short) * 8);
+#ifdef USE_SSE
+      upperLo = _mm_srai_epi32(upperLo, 16);
+      upperHi = _mm_srai_epi32(upperHi, 16);
+      _mm_store_si128((__m128i*) vd, _mm_packs_epi32(upperLo, upperHi));
+#else
+      for (i = 0; i < 8; i++)
+        vdData[i] = accUpper[i] >> 16;
+
+      memcpy(vd, vdData, sizeof(vdData));
+#endif
       break;
 
     case 1:
-      memcpy(vd, accMid, sizeof(short) * 8);
+#ifdef USE_SSE
+      _mm_store_si128((__m128i*) vd, RSPPackLo32to16(upperLo, upperHi));
+#else
+      for (i = 0; i < 8; i++)
+        vdData[i] = accUpper[i];
+
+      memcpy(vd, vdData, sizeof(vdData));
+#endif
       break;
 
     case 2:
@@ -1770,16 +2438,16 @@ RSPVSAR(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVSUB(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
+  uint16_t *accLow = (uint16_t *) cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
   __m128i vtRegPos, vtRegNeg, vaccLow, vdReg;
-  __m128i unsatDiff, vMask, carryOut;
+  __m128i unsatDiff, vMask, carryOut, notEqual;
 
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
   __m128i vsReg = _mm_load_si128((__m128i*) vs);
   vtReg = RSPGetVectorOperands(vtReg, element);
-  carryOut = _mm_load_si128((__m128i*) (cp2->vcolo.slices));
+  RSPLoadFlags(&cp2->vco, &carryOut, &notEqual);
   carryOut = _mm_srli_epi16(carryOut, 15);
 
   /* VACC uses unsaturated arithmetic. */
@@ -1802,10 +2470,25 @@ RSPVSUB(struct RSPCP2 *cp2, int16_t *vd,
 
   _mm_store_si128((__m128i*) vd, vdReg);
   _mm_store_si128((__m128i*) accLow, vaccLow);
-  _mm_store_si128((__m128i*) (cp2->vcolo.slices), _mm_setzero_si128());
-  _mm_store_si128((__m128i*) (cp2->vcohi.slices), _mm_setzero_si128());
+  RSPClearFlags(&cp2->vco);
 #else
-#warning "Unimplemented function: RSPVSUB (No SSE)."
+  const struct RSPFlags *vco = RSPGetFlagMasks(&cp2->vco);
+  int16_t vtData[8], vdData[8], vaccLow[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  /* VACC uses unsaturated arithmetic, VD saturates. */
+  for (i = 0; i < 8; i++) {
+    int32_t diff = vs[i] - vtData[i] - ((uint16_t) vco->lo.slices[i] >> 15);
+
+    vaccLow[i] = diff;
+    vdData[i] = RSPClamp16(diff);
+  }
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vaccLow, sizeof(vaccLow));
+  RSPClearFlags(&cp2->vco);
 #endif
 }
 
@@ -1815,7 +2498,7 @@ RSPVSUB(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVSUBC(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
+  uint16_t *accLow = (uint16_t *) cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
   __m128i satDiff, lessThanMask, notEqualMask, vdReg;
@@ -1834,10 +2517,27 @@ RSPVSUBC(struct RSPCP2 *cp2, int16_t *vd,
 
   _mm_store_si128((__m128i*) vd, vdReg);
   _mm_store_si128((__m128i*) accLow, vdReg);
-  _mm_store_si128((__m128i*) (cp2->vcolo.slices), lessThanMask);
-  _mm_store_si128((__m128i*) (cp2->vcohi.slices), notEqualMask);
+  _mm_store_si128((__m128i*) (cp2->vco.lo.slices), lessThanMask);
+  _mm_store_si128((__m128i*) (cp2->vco.hi.slices), notEqualMask);
+  cp2->vco.forms = RSP_FLAGS_MASKS;
 #else
-#warning "Unimplemented function: RSPVSUBC (No SSE)."
+  int16_t vtData[8], vdData[8], lessThan[8], notEqual[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  /* Set the carry out flags when difference is < 0. */
+  for (i = 0; i < 8; i++) {
+    vdData[i] = vs[i] - vtData[i];
+    lessThan[i] = -((uint16_t) vs[i] < (uint16_t) vtData[i]);
+    notEqual[i] = -(vdData[i] != 0);
+  }
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vdData, sizeof(vdData));
+  memcpy(cp2->vco.lo.slices, lessThan, sizeof(lessThan));
+  memcpy(cp2->vco.hi.slices, notEqual, sizeof(notEqual));
+  cp2->vco.forms = RSP_FLAGS_MASKS;
 #endif
 }
 
@@ -1847,7 +2547,7 @@ RSPVSUBC(struct RSPCP2 *cp2, int16_t *vd,
 void
 RSPVXOR(struct RSPCP2 *cp2, int16_t *vd,
   const int16_t *vs, const int16_t *vt, unsigned element) {
-  uint16_t *accLow = cp2->accumulatorLow.slices;
+  uint16_t *accLow = (uint16_t *) cp2->accumulatorLow.slices;
 
 #ifdef USE_SSE
   __m128i vtReg = _mm_load_si128((__m128i*) vt);
@@ -1860,10 +2560,277 @@ RSPVXOR(struct RSPCP2 *cp2, int16_t *vd,
   _mm_store_si128((__m128i*) vd, vdReg);
   _mm_store_si128((__m128i*) accLow, vdReg);
 #else
-#warning "Unimplemented function: RSPVXOR (No SSE)."
+  int16_t vtData[8], vdData[8];
+  unsigned i;
+
+  RSPGetVectorOperands(vt, vtData, element);
+
+  for (i = 0; i < 8; i++)
+    vdData[i] = vs[i] ^ vtData[i];
+
+  memcpy(vd, vdData, sizeof(vdData));
+  memcpy(accLow, vdData, sizeof(vdData));
+#endif
+}
+
+#ifdef RSP_CP2_ANY_ELEMENT
+#ifdef USE_SSE
+/* ============================================================================
+ *  Products without the accumulator: each writes `vd` as its instruction
+ *  would, for when what it'd write to the accumulator is written over
+ *  before anything reads it (see RSPFindDeadAccumulatorWrites).
+ * ========================================================================= */
+void
+RSPVMUDHNoAcc(struct RSPCP2 *unused(cp2), int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  __m128i vaccLow, upperLo, upperHi;
+
+  __m128i vsReg = _mm_load_si128((__m128i*) vs);
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  vtReg = RSPGetVectorOperands(vtReg, element);
+
+  _mm_store_si128((__m128i*) vd,
+    RSPStepVMUDH(vsReg, vtReg, &vaccLow, &upperLo, &upperHi));
+}
+
+void
+RSPVMUDLNoAcc(struct RSPCP2 *unused(cp2), int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  __m128i vsReg = _mm_load_si128((__m128i*) vs);
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  vtReg = RSPGetVectorOperands(vtReg, element);
+
+  _mm_store_si128((__m128i*) vd, _mm_mulhi_epu16(vsReg, vtReg));
+}
+
+void
+RSPVMUDMNoAcc(struct RSPCP2 *unused(cp2), int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  __m128i vsReg = _mm_load_si128((__m128i*) vs);
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  __m128i vtSign;
+
+  vtReg = RSPGetVectorOperands(vtReg, element);
+  vtSign = _mm_srai_epi16(vtReg, 15);
+
+  /* The signed high word, plus `vs` where `vt` is unsigned >= 0x8000. */
+  _mm_store_si128((__m128i*) vd, _mm_add_epi16(
+    _mm_mulhi_epi16(vsReg, vtReg), _mm_and_si128(vsReg, vtSign)));
+}
+
+void
+RSPVMUDNNoAcc(struct RSPCP2 *unused(cp2), int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  __m128i vsReg = _mm_load_si128((__m128i*) vs);
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  vtReg = RSPGetVectorOperands(vtReg, element);
+
+  /* Only the low word is written, whatever the signs. */
+  _mm_store_si128((__m128i*) vd, _mm_mullo_epi16(vsReg, vtReg));
+}
+
+void
+RSPVMULFNoAcc(struct RSPCP2 *unused(cp2), int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  __m128i vaccLow, upperLo, upperHi;
+
+  __m128i vsReg = _mm_load_si128((__m128i*) vs);
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  vtReg = RSPGetVectorOperands(vtReg, element);
+
+  _mm_store_si128((__m128i*) vd,
+    RSPStepVMULF(vsReg, vtReg, &vaccLow, &upperLo, &upperHi));
+}
+
+void
+RSPVMULQNoAcc(struct RSPCP2 *unused(cp2), int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  __m128i vaccLow, upperLo, upperHi;
+
+  __m128i vsReg = _mm_load_si128((__m128i*) vs);
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  vtReg = RSPGetVectorOperands(vtReg, element);
+
+  _mm_store_si128((__m128i*) vd,
+    RSPStepVMULQ(vsReg, vtReg, &vaccLow, &upperLo, &upperHi));
+}
+#endif
+
+#ifdef USE_SSE
+/* ============================================================================
+ *  Carries and compares without their flags: each writes `vd` and the
+ *  accumulator as its instruction would (and clears VCO where it would),
+ *  but not the flags it sets (VCO for the carries, VCC for the compares),
+ *  for when they are written over before anything reads them (see
+ *  RSPFindDeadFlagWrites).
+ * ========================================================================= */
+void
+RSPVADDCNoFlags(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  __m128i vsReg = _mm_load_si128((__m128i*) vs);
+  __m128i vdReg;
+
+  vtReg = RSPGetVectorOperands(vtReg, element);
+  vdReg = _mm_add_epi16(vsReg, vtReg);
+
+  _mm_store_si128((__m128i*) vd, vdReg);
+  _mm_store_si128((__m128i*) cp2->accumulatorLow.slices, vdReg);
+}
+
+void
+RSPVSUBCNoFlags(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  __m128i vsReg = _mm_load_si128((__m128i*) vs);
+  __m128i vdReg;
+
+  vtReg = RSPGetVectorOperands(vtReg, element);
+  vdReg = _mm_sub_epi16(vsReg, vtReg);
+
+  _mm_store_si128((__m128i*) vd, vdReg);
+  _mm_store_si128((__m128i*) cp2->accumulatorLow.slices, vdReg);
+}
+
+void
+RSPVEQNoFlags(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *unused(vs), const int16_t *vt, unsigned element) {
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  vtReg = RSPGetVectorOperands(vtReg, element);
+
+  _mm_store_si128((__m128i*) cp2->accumulatorLow.slices, vtReg);
+  _mm_store_si128((__m128i*) vd, vtReg);
+  RSPClearFlags(&cp2->vco);
+}
+
+void
+RSPVGENoFlags(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  __m128i vco, vne, vdReg;
+  __m128i vsReg = _mm_load_si128((__m128i*) vs);
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  vtReg = RSPGetVectorOperands(vtReg, element);
+  RSPLoadFlags(&cp2->vco, &vco, &vne);
+
+  vdReg = RSPSelect(RSPCompareGE(vsReg, vtReg, vco, vne), vsReg, vtReg);
+  _mm_store_si128((__m128i*) cp2->accumulatorLow.slices, vdReg);
+  _mm_store_si128((__m128i*) vd, vdReg);
+  RSPClearFlags(&cp2->vco);
+}
+
+void
+RSPVLTNoFlags(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  __m128i vco, vne, vdReg;
+  __m128i vsReg = _mm_load_si128((__m128i*) vs);
+  __m128i vtReg = _mm_load_si128((__m128i*) vt);
+  vtReg = RSPGetVectorOperands(vtReg, element);
+  RSPLoadFlags(&cp2->vco, &vco, &vne);
+
+  vdReg = RSPSelect(RSPCompareLT(vsReg, vtReg, vco, vne), vsReg, vtReg);
+  _mm_store_si128((__m128i*) cp2->accumulatorLow.slices, vdReg);
+  _mm_store_si128((__m128i*) vd, vdReg);
+  RSPClearFlags(&cp2->vco);
+}
+
+void
+RSPVNENoFlags(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *unused(vt),
+  unsigned unused(element)) {
+  __m128i vsReg = _mm_load_si128((__m128i*) vs);
+
+  _mm_store_si128((__m128i*) cp2->accumulatorLow.slices, vsReg);
+  _mm_store_si128((__m128i*) vd, vsReg);
+  RSPClearFlags(&cp2->vco);
+}
+#endif
+
+/* ============================================================================
+ *  Fused idioms: each runs its instruction words as they would run one at
+ *  a time, down to the registers a later word reads after an earlier one
+ *  wrote them, but keeps the accumulator in registers in between.
+ * ========================================================================= */
+#ifdef USE_SSE
+static __m128i
+RSPLoadFusedOperands(const struct RSPCP2 *cp2, uint32_t iw, __m128i *vtReg) {
+  *vtReg = _mm_load_si128((const __m128i*) cp2->regs[GET_RT(iw)].slices);
+  *vtReg = RSPGetVectorOperands(*vtReg, iw >> 21 & 0xF);
+  return _mm_load_si128((const __m128i*) cp2->regs[GET_RD(iw)].slices);
+}
+
+static void
+RSPStoreFusedResult(struct RSPCP2 *cp2, uint32_t iw, __m128i vdReg) {
+  _mm_store_si128((__m128i*) cp2->regs[iw >> 6 & 0x1F].slices, vdReg);
+}
+#endif
+
+/* ============================================================================
+ *  Fused idiom: VMUDL, VMADM, VMADN, VMADH (32-bit products)
+ * ========================================================================= */
+void
+RSPFusedMUL32(struct RSPCP2 *cp2,
+  uint32_t iw0, uint32_t iw1, uint32_t iw2, uint32_t iw3) {
+#ifdef USE_SSE
+  __m128i vaccLow, upperLo, upperHi;
+  __m128i vsReg, vtReg, vdReg;
+
+  vsReg = RSPLoadFusedOperands(cp2, iw0, &vtReg);
+  vdReg = RSPStepVMUDL(vsReg, vtReg, &vaccLow, &upperLo, &upperHi);
+  RSPStoreFusedResult(cp2, iw0, vdReg);
+
+  vsReg = RSPLoadFusedOperands(cp2, iw1, &vtReg);
+  vdReg = RSPStepVMADM(vsReg, vtReg, &vaccLow, &upperLo, &upperHi);
+  RSPStoreFusedResult(cp2, iw1, vdReg);
+
+  vsReg = RSPLoadFusedOperands(cp2, iw2, &vtReg);
+  vdReg = RSPStepVMADN(vsReg, vtReg, &vaccLow, &upperLo, &upperHi);
+  RSPStoreFusedResult(cp2, iw2, vdReg);
+
+  vsReg = RSPLoadFusedOperands(cp2, iw3, &vtReg);
+  vdReg = RSPStepVMADH(vsReg, vtReg, &upperLo, &upperHi);
+  RSPStoreFusedResult(cp2, iw3, vdReg);
+
+  RSPStoreAccumulator(cp2, vaccLow, upperLo, upperHi);
+  cp2->iw = iw3;
+#else
+  RSPRunVectorWord(cp2, RSPVMUDL, iw0);
+  RSPRunVectorWord(cp2, RSPVMADM, iw1);
+  RSPRunVectorWord(cp2, RSPVMADN, iw2);
+  RSPRunVectorWord(cp2, RSPVMADH, iw3);
+#endif
+}
+
+/* ============================================================================
+ *  Fused idiom: VMULF, VMACF (sums of two products of signed fractions)
+ * ========================================================================= */
+void
+RSPFusedMULF(struct RSPCP2 *cp2, uint32_t iw0, uint32_t iw1,
+  uint32_t unused(iw2), uint32_t unused(iw3)) {
+#ifdef USE_SSE
+  __m128i vaccLow, upperLo, upperHi;
+  __m128i vsReg, vtReg, vdReg;
+
+  vsReg = RSPLoadFusedOperands(cp2, iw0, &vtReg);
+  vdReg = RSPStepVMULF(vsReg, vtReg, &vaccLow, &upperLo, &upperHi);
+  RSPStoreFusedResult(cp2, iw0, vdReg);
+
+  vsReg = RSPLoadFusedOperands(cp2, iw1, &vtReg);
+  vdReg = RSPStepVMACF(vsReg, vtReg, &vaccLow, &upperLo, &upperHi);
+  RSPStoreFusedResult(cp2, iw1, vdReg);
+
+  RSPStoreAccumulator(cp2, vaccLow, upperLo, upperHi);
+  cp2->iw = iw1;
+#else
+  RSPRunVectorWord(cp2, RSPVMULF, iw0);
+  RSPRunVectorWord(cp2, RSPVMACF, iw1);
 #endif
 }
+#endif
 
+/* ============================================================================
+ *  Everything below is shared by all of the variants.
+ * ========================================================================= */
+#ifndef RSP_CP2_VARIANT
 /* ============================================================================
  *  RSPInitCP2: Initializes the co-processor.
  * ========================================================================= */
@@ -1871,6 +2838,10 @@ void
 RSPInitCP2(struct RSPCP2 *cp2) {
   debug("Initializing CP2.");
   memset(cp2, 0, sizeof(*cp2));
+
+  RSPClearFlags(&cp2->vco);
+  RSPClearFlags(&cp2->vcc);
+  RSPClearFlags(&cp2->vce);
 }
 
 /* ============================================================================
@@ -1891,7 +2862,8 @@ RSPCycleCP2(struct RSPCP2 *cp2) {
   cp2->locked[cp2->accStageDest] = false;     /* "WB" */
   cp2->accStageDest = cp2->mulStageDest;      /* "DF" */
 
-  RSPVectorFunctionTable[cp2->opcode.id](cp2, vd, vs, vt, element);
+  RSPVectorFormFunctions[RSPGetElementForm(element)][cp2->opcode.id](
+    cp2, vd, vs, vt, element);
   cp2->mulStageDest = (vd - cp2->regs[0].slices) >> 3;
 
   assert(cp2->mulStageDest >= 0 && cp2->mulStageDest < 32);
@@ -1907,13 +2879,9 @@ RSPCycleCP2(struct RSPCP2 *cp2) {
 #ifndef NDEBUG
 void
 RSPCP2GetAccumulator(const struct RSPCP2 *cp2, unsigned reg, uint16_t *acc) {
-#ifdef USE_SSE
   acc[0] = cp2->accumulatorLow.slices[reg];
-  acc[1] = cp2->accumulatorMid.slices[reg];
-  acc[2] = cp2->accumulatorHigh.slices[reg];
-#else
-#warning "Unimplemented function: RSPCP2GetAccumulator (No SSE)."
-#endif
+  acc[1] = cp2->accumulatorUpper.slices[reg];
+  acc[2] = cp2->accumulatorUpper.slices[reg] >> 16;
 }
 #endif
 
@@ -1923,13 +2891,8 @@ RSPCP2GetAccumulator(const struct RSPCP2 *cp2, unsigned reg, uint16_t *acc) {
 #ifndef NDEBUG
 uint16_t
 RSPCP2GetCarryOut(const struct RSPCP2 *cp2) {
-#ifdef USE_SSE
-  __m128i carryOut = _mm_load_si128((__m128i*) cp2->carryOut.slices);
-  return _mm_movemask_epi8(carryOut);
-#else
-#warning "Unimplemented function: RSPCP2GetCarryOut (No SSE)."
-  return 0;
-#endif
+  return RSPPackFlags(&cp2->vco);
 }
 #endif
+#endif
 
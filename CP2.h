@@ -13,6 +13,23 @@
 #include "Common.h"
 #include "Decoder.h"
 
+/* With GCC on x86, the SSE functions are built for each of a */
+/* few instruction sets regardless of -march, and the best */
+/* that the host supports are picked at runtime. */
+#if defined(USE_SSE) && defined(__GNUC__) && \
+  (defined(__x86_64__) || defined(__i386__))
+#define RSP_SSE_DISPATCH
+#endif
+
+/* On ARM64, NEON is always there: when asked for (USE_NEON), */
+/* the multiplies, the selects and the packed loads/stores use */
+/* it instead of plain C. It is opt-in until it has been run on */
+/* a real ARM64 host (or under emulation) against rspsim -x. */
+#if defined(USE_NEON) && !defined(USE_SSE) && \
+  defined(__aarch64__) && defined(__ARM_NEON)
+#define RSP_HAVE_NEON
+#endif
+
 enum RSPVPRegister {
   RSP_VP_REGISTER_V0, RSP_VP_REGISTER_V1, RSP_VP_REGISTER_V2, 
   RSP_VP_REGISTER_V3, RSP_VP_REGISTER_V4, RSP_VP_REGISTER_V5,
@@ -31,25 +48,37 @@ struct RSPVector {
   int16_t slices[8];
 };
 
+/* The high and middle words of the accumulator are kept */
+/* together, as the 32-bit lanes that the MACs add into; */
+/* only VSAR and the like need them split back apart. */
+struct RSPAccumulatorUpper {
+  int32_t slices[8];
+};
+
+/* A flag register is kept in whatever form its last writer left */
+/* it in: as slice masks (all ones or zeros, as compares produce */
+/* them), as packed bits (as CFC2/CTC2 and AVX-512 see them), or */
+/* both. The other form is only built when something asks for it. */
+#define RSP_FLAGS_MASKS 0x1
+#define RSP_FLAGS_BITS  0x2
+
+struct RSPFlags {
+  struct RSPVector lo align(16); /* VCO: carry, VCC: le, VCE. */
+  struct RSPVector hi;           /* VCO: not equal, VCC: ge. */
+  uint16_t bits;                 /* hi << 8 | lo, as CFC2 reads it. */
+  uint8_t forms;                 /* Which of the above are current. */
+};
+
 struct RSPCP2 {
   struct RSPVector regs[NUM_RSP_VP_REGISTERS] align(16);
   struct RSPVector transposeVector;
-  struct RSPVector accumulatorHigh;
-  struct RSPVector accumulatorMid;
+  struct RSPAccumulatorUpper accumulatorUpper;
   struct RSPVector accumulatorLow;
 
-  /* Be lazy; leave VCC/VCO ready for vector functions. */
-  /* When it comes time to generate, use: _mm_movemask_epi8. */
-  struct RSPVector compareCode;
-  struct RSPVector carryOut;
-
-  /* We cheat to assist vectorization: */
-  /* On hardware, VCO is VCOHI | VCOLO. */
-  struct RSPVector vcohi;
-  struct RSPVector vcolo;
-
-  uint16_t vcc; /* TODO: Remove. */
-  uint8_t  vce; /* TODO: Remove. */
+  /* Flags; see struct RSPFlags. */
+  struct RSPFlags vco;
+  struct RSPFlags vcc;
+  struct RSPFlags vce;
 
   /* Having a larger array than necessary allows us to eliminate */
   /* a costly branch in the writeback stage every cycle. */
@@ -81,10 +110,66 @@ uint16_t RSPCP2GetCarryOut(const struct RSPCP2 *);
 void RSPCycleCP2(struct RSPCP2 *);
 void RSPInitCP2(struct RSPCP2 *);
 
-#ifdef USE_SSE
-uint16_t RSPGetVCO(const struct RSPCP2 *);
-void RSPSetVCO(struct RSPCP2 *, uint16_t);
-#endif
+void RSPGetAccumulator(const struct RSPCP2 *, struct RSPVector *);
+void RSPSetAccumulator(struct RSPCP2 *, const struct RSPVector *);
+
+uint16_t RSPPackFlags(const struct RSPFlags *);
+void RSPExpandFlags(struct RSPFlags *);
+
+/* ============================================================================
+ *  RSPGetFlagBits/RSPGetFlagMasks: Get a flag register in either form,
+ *  building (and keeping) that form if it isn't already there.
+ * ========================================================================= */
+static inline uint16_t
+RSPGetFlagBits(struct RSPFlags *flags) {
+  if (!(flags->forms & RSP_FLAGS_BITS)) {
+    flags->bits = RSPPackFlags(flags);
+    flags->forms |= RSP_FLAGS_BITS;
+  }
+
+  return flags->bits;
+}
+
+static inline const struct RSPFlags *
+RSPGetFlagMasks(struct RSPFlags *flags) {
+  if (!(flags->forms & RSP_FLAGS_MASKS))
+    RSPExpandFlags(flags);
+
+  return flags;
+}
+
+/* ============================================================================
+ *  RSPSetFlagBits: Sets a flag register from packed bits. Writers of the
+ *  masks store them directly and set `forms` to RSP_FLAGS_MASKS instead.
+ * ========================================================================= */
+static inline void
+RSPSetFlagBits(struct RSPFlags *flags, uint16_t bits) {
+  flags->bits = bits;
+  flags->forms = RSP_FLAGS_BITS;
+}
+
+/* ============================================================================
+ *  RSPClearFlags: Zeroes a flag register. Most selects clear VCO, so this
+ *  is kept to the bits; readers of the masks build zeroes from them.
+ * ========================================================================= */
+static inline void
+RSPClearFlags(struct RSPFlags *flags) {
+  RSPSetFlagBits(flags, 0x0000);
+}
+
+/* ============================================================================
+ *  RSPRunVectorWord: Runs a vector computational instruction word through
+ *  a vector function, on the registers its vd/vs/vt fields name.
+ * ========================================================================= */
+static inline void
+RSPRunVectorWord(struct RSPCP2 *cp2, void (*function)(struct RSPCP2 *,
+  int16_t *, const int16_t *, const int16_t *, unsigned), uint32_t iw) {
+  cp2->iw = iw;
+
+  function(cp2, cp2->regs[iw >> 6 & 0x1F].slices,
+    cp2->regs[GET_RD(iw)].slices, cp2->regs[GET_RT(iw)].slices,
+    iw >> 21 & 0xF);
+}
 
 #endif
 
@@ -0,0 +1,51 @@
+/* ============================================================================
+ *  CP2ANSI.c: RSP Coprocessor #2 (ANSI C).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CP2.h"
+#include "CP2ANSI.h"
+
+#ifdef RSP_SSE_DISPATCH
+#undef USE_SSE
+
+/* The vector functions, built from plain C for hosts */
+/* that lack even SSSE3 (which the rest are built for). */
+#define RSP_CP2_VARIANT(op) RSPANSI##op
+#include "CP2.c"
+
+const RSPVectorFunction
+  RSPVectorFunctionTableANSI[NUM_RSP_VECTOR_OPCODES] = {
+#define X(op) RSP##op,
+#include "VectorOpcodes.md"
+#undef X
+};
+
+const RSPFusedFunction
+  RSPFusedFunctionTableANSI[NUM_RSP_FUSED_IDIOMS] = {
+  RSPFusedMUL32, RSPFusedMULF
+};
+
+/* As without SSE, the products don't skip the accumulator, */
+/* nor do the carries and compares skip their flags. */
+const RSPVectorFunction
+  RSPNoAccFunctionTableANSI[NUM_RSP_PRODUCTS] = {
+#define X(op) RSP##op,
+  RSP_PRODUCT_OPCODES
+#undef X
+};
+
+const RSPVectorFunction
+  RSPNoFlagsFunctionTableANSI[NUM_RSP_FLAG_WRITERS] = {
+#define X(op) RSP##op,
+  RSP_FLAG_WRITER_OPCODES
+#undef X
+};
+#endif
+
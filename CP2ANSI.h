@@ -0,0 +1,29 @@
+/* ============================================================================
+ *  CP2ANSI.h: RSP Coprocessor #2 (ANSI C).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__CP2ANSI_H__
+#define __RSP__CP2ANSI_H__
+#include "Common.h"
+#include "CP2.h"
+#include "Opcodes.h"
+
+#ifdef RSP_SSE_DISPATCH
+extern const RSPVectorFunction
+  RSPVectorFunctionTableANSI[NUM_RSP_VECTOR_OPCODES];
+extern const RSPFusedFunction
+  RSPFusedFunctionTableANSI[NUM_RSP_FUSED_IDIOMS];
+extern const RSPVectorFunction
+  RSPNoAccFunctionTableANSI[NUM_RSP_PRODUCTS];
+extern const RSPVectorFunction
+  RSPNoFlagsFunctionTableANSI[NUM_RSP_FLAG_WRITERS];
+#endif
+
+#endif
+
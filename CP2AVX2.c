@@ -0,0 +1,49 @@
+/* ============================================================================
+ *  CP2AVX2.c: RSP Coprocessor #2 (AVX2).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CP2.h"
+#include "CP2AVX2.h"
+
+#ifdef RSP_SSE_DISPATCH
+#pragma GCC target("avx2")
+#undef SSSE3_ONLY
+
+/* The vector functions, built for AVX2. */
+#define RSP_CP2_VARIANT(op) RSPAVX2##op
+#include "CP2.c"
+
+const RSPVectorFunction
+  RSPVectorFunctionTableAVX2[NUM_RSP_VECTOR_OPCODES] = {
+#define X(op) RSP##op,
+#include "VectorOpcodes.md"
+#undef X
+};
+
+const RSPFusedFunction
+  RSPFusedFunctionTableAVX2[NUM_RSP_FUSED_IDIOMS] = {
+  RSPFusedMUL32, RSPFusedMULF
+};
+
+const RSPVectorFunction
+  RSPNoAccFunctionTableAVX2[NUM_RSP_PRODUCTS] = {
+#define X(op) RSP##op##NoAcc,
+  RSP_PRODUCT_OPCODES
+#undef X
+};
+
+const RSPVectorFunction
+  RSPNoFlagsFunctionTableAVX2[NUM_RSP_FLAG_WRITERS] = {
+#define X(op) RSP##op##NoFlags,
+  RSP_FLAG_WRITER_OPCODES
+#undef X
+};
+#endif
+
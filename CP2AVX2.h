@@ -0,0 +1,29 @@
+/* ============================================================================
+ *  CP2AVX2.h: RSP Coprocessor #2 (AVX2).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__CP2AVX2_H__
+#define __RSP__CP2AVX2_H__
+#include "Common.h"
+#include "CP2.h"
+#include "Opcodes.h"
+
+#ifdef RSP_SSE_DISPATCH
+extern const RSPVectorFunction
+  RSPVectorFunctionTableAVX2[NUM_RSP_VECTOR_OPCODES];
+extern const RSPFusedFunction
+  RSPFusedFunctionTableAVX2[NUM_RSP_FUSED_IDIOMS];
+extern const RSPVectorFunction
+  RSPNoAccFunctionTableAVX2[NUM_RSP_PRODUCTS];
+extern const RSPVectorFunction
+  RSPNoFlagsFunctionTableAVX2[NUM_RSP_FLAG_WRITERS];
+#endif
+
+#endif
+
@@ -0,0 +1,31 @@
+/* ============================================================================
+ *  CP2AVX2Identity.c: RSP Coprocessor #2 (AVX2, identity elements).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CP2.h"
+#include "CP2AVX2Identity.h"
+
+#ifdef RSP_SSE_DISPATCH
+#pragma GCC target("avx2")
+#undef SSSE3_ONLY
+
+/* The vector functions, built for AVX2 and elements 0 and 1. */
+#define RSP_CP2_IDENTITY
+#define RSP_CP2_VARIANT(op) RSPAVX2Identity##op
+#include "CP2.c"
+
+const RSPVectorFunction
+  RSPVectorFunctionTableAVX2Identity[NUM_RSP_VECTOR_OPCODES] = {
+#define X(op) RSP##op,
+#include "VectorOpcodes.md"
+#undef X
+};
+#endif
+
@@ -0,0 +1,23 @@
+/* ============================================================================
+ *  CP2AVX2Identity.h: RSP Coprocessor #2 (AVX2, identity elements).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__CP2AVX2IDENTITY_H__
+#define __RSP__CP2AVX2IDENTITY_H__
+#include "Common.h"
+#include "CP2.h"
+#include "Opcodes.h"
+
+#ifdef RSP_SSE_DISPATCH
+extern const RSPVectorFunction
+  RSPVectorFunctionTableAVX2Identity[NUM_RSP_VECTOR_OPCODES];
+#endif
+
+#endif
+
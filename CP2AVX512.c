@@ -0,0 +1,331 @@
+/* ============================================================================
+ *  CP2AVX512.c: RSP Coprocessor #2 (AVX-512BW/VL).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CP2.h"
+#include "CP2AVX512.h"
+#include "Opcodes.h"
+
+#ifdef RSP_HAVE_AVX512
+#include <immintrin.h>
+
+#define avx512 __attribute__((target("avx512f,avx512bw,avx512vl")))
+
+/* ============================================================================
+ *  On hosts with AVX-512, the select/compare instructions keep their flags
+ *  in mask registers, 1 bit per slice, for as long as they work with them:
+ *  the compares produce masks, masks are combined with scalar logic, and
+ *  results are picked with masked blends. The flags they write are left as
+ *  bits, which is what a mask register already is.
+ * ========================================================================= */
+
+/* ============================================================================
+ *  GetVectorOperands: Builds the `vt` vector for an element specifier, with
+ *  a single vpermw in place of the pshufb keys.
+ * ========================================================================= */
+static avx512 __m128i
+GetVectorOperands(const int16_t *vtData, unsigned element) {
+  static const uint16_t VectorIndicesArray[16][8] align(16) = {
+    /* vpermw (_mm_permutexvar_epi16) indices. */
+    /* -- */ {0,1,2,3,4,5,6,7}, /* -- */ {0,1,2,3,4,5,6,7},
+    /* 0q */ {0,0,2,2,4,4,6,6}, /* 1q */ {1,1,3,3,5,5,7,7},
+    /* 0h */ {0,0,0,0,4,4,4,4}, /* 1h */ {1,1,1,1,5,5,5,5},
+    /* 2h */ {2,2,2,2,6,6,6,6}, /* 3h */ {3,3,3,3,7,7,7,7},
+    /* 0w */ {0,0,0,0,0,0,0,0}, /* 1w */ {1,1,1,1,1,1,1,1},
+    /* 2w */ {2,2,2,2,2,2,2,2}, /* 3w */ {3,3,3,3,3,3,3,3},
+    /* 4w */ {4,4,4,4,4,4,4,4}, /* 5w */ {5,5,5,5,5,5,5,5},
+    /* 6w */ {6,6,6,6,6,6,6,6}, /* 7w */ {7,7,7,7,7,7,7,7}
+  };
+
+  __m128i vt = _mm_load_si128((__m128i*) vtData);
+  __m128i key = _mm_load_si128((__m128i*) VectorIndicesArray[element]);
+  return _mm_permutexvar_epi16(key, vt);
+}
+
+/* ============================================================================
+ *  GetLoMask/GetHiMask: Reads half of a flag register as a mask, from the
+ *  bits if they're there, else straight from the masks (as VADDC, etc.
+ *  leave them) without keeping the bits.
+ * ========================================================================= */
+static avx512 __mmask8
+GetLoMask(const struct RSPFlags *flags) {
+  if (flags->forms & RSP_FLAGS_BITS)
+    return (__mmask8) flags->bits;
+
+  return _mm_movepi16_mask(_mm_load_si128((__m128i*) flags->lo.slices));
+}
+
+static avx512 __mmask8
+GetHiMask(const struct RSPFlags *flags) {
+  if (flags->forms & RSP_FLAGS_BITS)
+    return (__mmask8) (flags->bits >> 8);
+
+  return _mm_movepi16_mask(_mm_load_si128((__m128i*) flags->hi.slices));
+}
+
+/* ============================================================================
+ *  StoreSelect: Writes the result of a select, and clears VCO.
+ * ========================================================================= */
+static avx512 void
+StoreSelect(struct RSPCP2 *cp2, int16_t *vd, __m128i vdReg) {
+  _mm_store_si128((__m128i*) cp2->accumulatorLow.slices, vdReg);
+  _mm_store_si128((__m128i*) vd, vdReg);
+  RSPClearFlags(&cp2->vco);
+}
+
+/* ============================================================================
+ *  Instruction: VCH (Vector Select Clip Test High)
+ * ========================================================================= */
+avx512 void
+RSPAVX512VCH(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
+  __m128i vtReg = GetVectorOperands(vtData, element);
+  __m128i zero = _mm_setzero_si128();
+  __m128i ones = _mm_set1_epi16(-1);
+  __m128i sum, diff, vtSel, vdReg;
+  __mmask8 sn, vtNeg, ge, le, neq, ce, sel;
+
+  /* Signs differ: compare vs to -vt, else to vt. */
+  sn = _mm_movepi16_mask(_mm_xor_si128(vsReg, vtReg));
+  vtNeg = _mm_movepi16_mask(vtReg);
+  sum = _mm_add_epi16(vsReg, vtReg);
+  diff = _mm_sub_epi16(vsReg, vtReg);
+
+  le = _mm_mask_cmple_epi16_mask(sn, sum, zero) | (vtNeg & ~sn);
+  ge = _mm_mask_cmpge_epi16_mask(~sn, diff, zero) | (vtNeg & sn);
+  ce = _mm_mask_cmpeq_epi16_mask(sn, sum, ones);
+
+  neq = _mm_mask_cmpneq_epi16_mask(~sn, vsReg, vtReg) |
+    (_mm_mask_cmpneq_epi16_mask(sn, sum, zero) & ~ce);
+
+  /* vd = sn ? (le ? -vt : vs) : (ge ? vt : vs) */
+  sel = (sn & le) | (~sn & ge);
+  vtSel = _mm_mask_sub_epi16(vtReg, sn, zero, vtReg);
+  vdReg = _mm_mask_blend_epi16(sel, vsReg, vtSel);
+
+  _mm_store_si128((__m128i*) cp2->accumulatorLow.slices, vdReg);
+  _mm_store_si128((__m128i*) vd, vdReg);
+  RSPSetFlagBits(&cp2->vco, (uint16_t) neq << 8 | sn);
+  RSPSetFlagBits(&cp2->vcc, (uint16_t) ge << 8 | le);
+  RSPSetFlagBits(&cp2->vce, ce);
+}
+
+/* ============================================================================
+ *  Instruction: VCL (Vector Select Clip Test Low)
+ * ========================================================================= */
+avx512 void
+RSPAVX512VCL(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
+  __m128i vtReg = GetVectorOperands(vtData, element);
+  __m128i zero = _mm_setzero_si128();
+  __m128i sum, vtSel, vdReg;
+  __mmask8 sn, eq, ce, lz, uz, ge, le, sel;
+
+  sn = GetLoMask(&cp2->vco);
+  eq = ~GetHiMask(&cp2->vco);
+  ce = GetLoMask(&cp2->vce);
+
+  /* Where the slices are equal, the old VCC is retested: */
+  /* lz/uz are whether the 17-bit sum's low/high bits are zero. */
+  sum = _mm_add_epi16(vsReg, vtReg);
+  lz = _mm_cmpeq_epi16_mask(sum, zero);
+  uz = _mm_cmpge_epu16_mask(sum, vsReg);
+
+  le = (GetLoMask(&cp2->vcc) & ~(sn & eq)) |
+    (((~ce & lz & uz) | (ce & (lz | uz))) & sn & eq);
+  ge = (GetHiMask(&cp2->vcc) & ~(~sn & eq)) |
+    (_mm_cmpge_epu16_mask(vsReg, vtReg) & ~sn & eq);
+
+  /* vd = sn ? (le ? -vt : vs) : (ge ? vt : vs) */
+  sel = (sn & le) | (~sn & ge);
+  vtSel = _mm_mask_sub_epi16(vtReg, sn, zero, vtReg);
+  vdReg = _mm_mask_blend_epi16(sel, vsReg, vtSel);
+
+  StoreSelect(cp2, vd, vdReg);
+  RSPSetFlagBits(&cp2->vcc, (uint16_t) ge << 8 | le);
+  RSPClearFlags(&cp2->vce);
+}
+
+/* ============================================================================
+ *  Instruction: VCR (Vector Select Crimp Test Low)
+ * ========================================================================= */
+avx512 void
+RSPAVX512VCR(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
+  __m128i vtReg = GetVectorOperands(vtData, element);
+  __m128i ones = _mm_set1_epi16(-1);
+  __m128i vtSel, vdReg;
+  __mmask8 sn, vtNeg, ge, le;
+
+  /* Signs differ: compare vs to ~vt, else to vt. */
+  sn = _mm_movepi16_mask(_mm_xor_si128(vsReg, vtReg));
+  vtNeg = _mm_movepi16_mask(vtReg);
+
+  le = (_mm_movepi16_mask(_mm_add_epi16(vsReg, vtReg)) & sn) |
+    (vtNeg & ~sn);
+  ge = (~_mm_movepi16_mask(_mm_sub_epi16(vsReg, vtReg)) & ~sn) |
+    (vtNeg & sn);
+
+  /* vd = le ? (sn ? ~vt : vt) : vs */
+  vtSel = _mm_mask_sub_epi16(vtReg, sn, ones, vtReg);
+  vdReg = _mm_mask_blend_epi16(le, vsReg, vtSel);
+
+  StoreSelect(cp2, vd, vdReg);
+  RSPSetFlagBits(&cp2->vcc, (uint16_t) ge << 8 | le);
+  RSPClearFlags(&cp2->vce);
+}
+
+/* ============================================================================
+ *  Instruction: VEQ (Vector Select Equal)
+ * ========================================================================= */
+avx512 void
+RSPAVX512VEQ(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
+  __m128i vtReg = GetVectorOperands(vtData, element);
+  __mmask8 ne = GetHiMask(&cp2->vco);
+
+  RSPSetFlagBits(&cp2->vcc, _mm_mask_cmpeq_epi16_mask(~ne, vsReg, vtReg));
+  StoreSelect(cp2, vd, vtReg);
+}
+
+/* ============================================================================
+ *  Instruction: VGE (Vector Select Greater Than or Equal)
+ * ========================================================================= */
+avx512 void
+RSPAVX512VGE(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
+  __m128i vtReg = GetVectorOperands(vtData, element);
+  __mmask8 both = GetHiMask(&cp2->vco) & GetLoMask(&cp2->vco);
+  __mmask8 ge;
+
+  /* ge = vs > vt | (~(vco & vne) && vs == vt) */
+  ge = _mm_cmpgt_epi16_mask(vsReg, vtReg) |
+    _mm_mask_cmpeq_epi16_mask(~both, vsReg, vtReg);
+
+  RSPSetFlagBits(&cp2->vcc, ge);
+  StoreSelect(cp2, vd, _mm_mask_blend_epi16(ge, vtReg, vsReg));
+}
+
+/* ============================================================================
+ *  Instruction: VLT (Vector Select Less Than or Equal)
+ * ========================================================================= */
+avx512 void
+RSPAVX512VLT(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
+  __m128i vtReg = GetVectorOperands(vtData, element);
+  __mmask8 both = GetHiMask(&cp2->vco) & GetLoMask(&cp2->vco);
+  __mmask8 le;
+
+  /* le = vs < vt | ((vco & vne) && vs == vt) */
+  le = _mm_cmplt_epi16_mask(vsReg, vtReg) |
+    _mm_mask_cmpeq_epi16_mask(both, vsReg, vtReg);
+
+  RSPSetFlagBits(&cp2->vcc, le);
+  StoreSelect(cp2, vd, _mm_mask_blend_epi16(le, vtReg, vsReg));
+}
+
+/* ============================================================================
+ *  Instruction: VMRG (Vector Select Merge)
+ * ========================================================================= */
+avx512 void
+RSPAVX512VMRG(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
+  __m128i vtReg = GetVectorOperands(vtData, element);
+  __m128i vdReg = _mm_mask_blend_epi16(GetLoMask(&cp2->vcc), vtReg, vsReg);
+
+  _mm_store_si128((__m128i*) cp2->accumulatorLow.slices, vdReg);
+  _mm_store_si128((__m128i*) vd, vdReg);
+}
+
+/* ============================================================================
+ *  Instruction: VNE (Vector Select Not Equal)
+ * ========================================================================= */
+avx512 void
+RSPAVX512VNE(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  __m128i vsReg = _mm_load_si128((__m128i*) vsData);
+  __m128i vtReg = GetVectorOperands(vtData, element);
+  __mmask8 ne = GetHiMask(&cp2->vco);
+
+  RSPSetFlagBits(&cp2->vcc, _mm_cmpneq_epi16_mask(vsReg, vtReg) | ne);
+  StoreSelect(cp2, vd, vsReg);
+}
+
+/* ============================================================================
+ *  RSPHostHasAVX512: Checks if the host can run the functions above.
+ * ========================================================================= */
+bool
+RSPHostHasAVX512(void) {
+  __builtin_cpu_init();
+
+  return __builtin_cpu_supports("avx2") &&
+    __builtin_cpu_supports("avx512f") &&
+    __builtin_cpu_supports("avx512bw") &&
+    __builtin_cpu_supports("avx512vl");
+}
+
+/* ============================================================================
+ *  The vector function tables: the AVX2 ones, with the functions above
+ *  swapped in.
+ * ========================================================================= */
+#define RSP_CP2_VARIANT(op) RSPAVX2##op
+#include "CP2Variant.h"
+
+#undef RSPVCH
+#undef RSPVCL
+#undef RSPVCR
+#undef RSPVEQ
+#undef RSPVGE
+#undef RSPVLT
+#undef RSPVMRG
+#undef RSPVNE
+
+#define RSPVCH RSPAVX512VCH
+#define RSPVCL RSPAVX512VCL
+#define RSPVCR RSPAVX512VCR
+#define RSPVEQ RSPAVX512VEQ
+#define RSPVGE RSPAVX512VGE
+#define RSPVLT RSPAVX512VLT
+#define RSPVMRG RSPAVX512VMRG
+#define RSPVNE RSPAVX512VNE
+
+const RSPVectorFunction
+  RSPVectorFunctionTableAVX512[NUM_RSP_VECTOR_OPCODES] = {
+#define X(op) RSP##op,
+#include "VectorOpcodes.md"
+#undef X
+};
+
+/* The same, from the AVX2 table for elements 0 and 1 (the */
+/* names above expand to whatever RSP_CP2_VARIANT is now). */
+#undef RSP_CP2_VARIANT
+#define RSP_CP2_VARIANT(op) RSPAVX2Identity##op
+
+#define X(op) void RSP##op( \
+  struct RSPCP2 *, int16_t *, const int16_t *, const int16_t *, unsigned);
+#include "VectorOpcodes.md"
+#undef X
+
+const RSPVectorFunction
+  RSPVectorFunctionTableAVX512Identity[NUM_RSP_VECTOR_OPCODES] = {
+#define X(op) RSP##op,
+#include "VectorOpcodes.md"
+#undef X
+};
+
+#endif
+
@@ -0,0 +1,36 @@
+/* ============================================================================
+ *  CP2AVX512.h: RSP Coprocessor #2 (AVX-512BW/VL).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__CP2AVX512_H__
+#define __RSP__CP2AVX512_H__
+#include "Common.h"
+#include "CP2.h"
+#include "Opcodes.h"
+
+/* The functions are built for AVX-512 regardless of -march, */
+/* so only hosts that have it (see RSPHostHasAVX512) use them. */
+#ifdef RSP_SSE_DISPATCH
+#define RSP_HAVE_AVX512
+
+#define X(op) void RSPAVX512##op( \
+  struct RSPCP2 *, int16_t *, const int16_t *, const int16_t *, unsigned);
+X(VCH) X(VCL) X(VCR) X(VEQ) X(VGE) X(VLT) X(VMRG) X(VNE)
+#undef X
+
+extern const RSPVectorFunction
+  RSPVectorFunctionTableAVX512[NUM_RSP_VECTOR_OPCODES];
+extern const RSPVectorFunction
+  RSPVectorFunctionTableAVX512Identity[NUM_RSP_VECTOR_OPCODES];
+
+bool RSPHostHasAVX512(void);
+#endif
+
+#endif
+
@@ -0,0 +1,34 @@
+/* ============================================================================
+ *  CP2Identity.c: RSP Coprocessor #2 (identity elements).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CP2.h"
+#include "CP2Identity.h"
+
+#ifdef RSP_SSE_DISPATCH
+#pragma GCC target("ssse3")
+#ifndef SSSE3_ONLY
+#define SSSE3_ONLY
+#endif
+#endif
+
+/* The built-in vector functions, for elements 0 and 1 (where */
+/* `vt` is used as is, and there's nothing to shuffle). */
+#define RSP_CP2_IDENTITY
+#define RSP_CP2_VARIANT(op) RSPIdentity##op
+#include "CP2.c"
+
+const RSPVectorFunction
+  RSPVectorFunctionTableIdentity[NUM_RSP_VECTOR_OPCODES] = {
+#define X(op) RSP##op,
+#include "VectorOpcodes.md"
+#undef X
+};
+
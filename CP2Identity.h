@@ -0,0 +1,26 @@
+/* ============================================================================
+ *  CP2Identity.h: RSP Coprocessor #2 (identity elements).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__CP2IDENTITY_H__
+#define __RSP__CP2IDENTITY_H__
+#include "Common.h"
+#include "CP2.h"
+#include "Opcodes.h"
+
+#define X(op) void RSPIdentity##op( \
+  struct RSPCP2 *, int16_t *, const int16_t *, const int16_t *, unsigned);
+#include "VectorOpcodes.md"
+#undef X
+
+extern const RSPVectorFunction
+  RSPVectorFunctionTableIdentity[NUM_RSP_VECTOR_OPCODES];
+
+#endif
+
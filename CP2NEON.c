@@ -0,0 +1,705 @@
+/* ============================================================================
+ *  CP2NEON.c: RSP Coprocessor #2 (NEON).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CP2.h"
+#include "CP2NEON.h"
+#include "Opcodes.h"
+
+#ifdef RSP_HAVE_NEON
+#include <arm_neon.h>
+
+/* ============================================================================
+ *  On ARM64 hosts, the multiplies and selects work on whole vectors in
+ *  place of the plain C loops: products come from widening multiplies,
+ *  results are clamped with saturating narrows, and the flags are left in
+ *  lane masks (only CFC2 and the like ever need them packed).
+ * ========================================================================= */
+static const uint16_t FlagBits[2][8] align(16) = {
+  {0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080},
+  {0x0100, 0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000, 0x8000}
+};
+
+/* ============================================================================
+ *  GetVectorOperands: Builds the `vt` vector for an element specifier, with
+ *  a single tbl.
+ * ========================================================================= */
+static int16x8_t
+GetVectorOperands(const int16_t *vtData, unsigned element) {
+  static const uint8_t VectorOperandsArray[16][16] align(16) = {
+    /* tbl (vqtbl1q_u8) keys. */
+    /* -- */ {0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9,0xA,0xB,0xC,0xD,0xE,0xF},
+    /* -- */ {0x0,0x1,0x2,0x3,0x4,0x5,0x6,0x7,0x8,0x9,0xA,0xB,0xC,0xD,0xE,0xF},
+    /* 0q */ {0x0,0x1,0x0,0x1,0x4,0x5,0x4,0x5,0x8,0x9,0x8,0x9,0xC,0xD,0xC,0xD},
+    /* 1q */ {0x2,0x3,0x2,0x3,0x6,0x7,0x6,0x7,0xA,0xB,0xA,0xB,0xE,0xF,0xE,0xF},
+    /* 0h */ {0x0,0x1,0x0,0x1,0x0,0x1,0x0,0x1,0x8,0x9,0x8,0x9,0x8,0x9,0x8,0x9},
+    /* 1h */ {0x2,0x3,0x2,0x3,0x2,0x3,0x2,0x3,0xA,0xB,0xA,0xB,0xA,0xB,0xA,0xB},
+    /* 2h */ {0x4,0x5,0x4,0x5,0x4,0x5,0x4,0x5,0xC,0xD,0xC,0xD,0xC,0xD,0xC,0xD},
+    /* 3h */ {0x6,0x7,0x6,0x7,0x6,0x7,0x6,0x7,0xE,0xF,0xE,0xF,0xE,0xF,0xE,0xF},
+    /* 0w */ {0x0,0x1,0x0,0x1,0x0,0x1,0x0,0x1,0x0,0x1,0x0,0x1,0x0,0x1,0x0,0x1},
+    /* 1w */ {0x2,0x3,0x2,0x3,0x2,0x3,0x2,0x3,0x2,0x3,0x2,0x3,0x2,0x3,0x2,0x3},
+    /* 2w */ {0x4,0x5,0x4,0x5,0x4,0x5,0x4,0x5,0x4,0x5,0x4,0x5,0x4,0x5,0x4,0x5},
+    /* 3w */ {0x6,0x7,0x6,0x7,0x6,0x7,0x6,0x7,0x6,0x7,0x6,0x7,0x6,0x7,0x6,0x7},
+    /* 4w */ {0x8,0x9,0x8,0x9,0x8,0x9,0x8,0x9,0x8,0x9,0x8,0x9,0x8,0x9,0x8,0x9},
+    /* 5w */ {0xA,0xB,0xA,0xB,0xA,0xB,0xA,0xB,0xA,0xB,0xA,0xB,0xA,0xB,0xA,0xB},
+    /* 6w */ {0xC,0xD,0xC,0xD,0xC,0xD,0xC,0xD,0xC,0xD,0xC,0xD,0xC,0xD,0xC,0xD},
+    /* 7w */ {0xE,0xF,0xE,0xF,0xE,0xF,0xE,0xF,0xE,0xF,0xE,0xF,0xE,0xF,0xE,0xF}
+  };
+
+  uint8x16_t vt = vld1q_u8((const uint8_t*) vtData);
+  uint8x16_t key = vld1q_u8(VectorOperandsArray[element]);
+  return vreinterpretq_s16_u8(vqtbl1q_u8(vt, key));
+}
+
+/* ============================================================================
+ *  LoadFlags/StoreFlags: Loads a flag register as lane masks (building them
+ *  from its bits, without keeping them, if that's the form it's in), or
+ *  sets it to lane masks.
+ * ========================================================================= */
+static void
+LoadFlags(const struct RSPFlags *flags, uint16x8_t *lo, uint16x8_t *hi) {
+  uint16x8_t bits;
+
+  if (flags->forms & RSP_FLAGS_MASKS) {
+    *lo = vld1q_u16((const uint16_t*) flags->lo.slices);
+    *hi = vld1q_u16((const uint16_t*) flags->hi.slices);
+    return;
+  }
+
+  bits = vdupq_n_u16(flags->bits);
+  *lo = vtstq_u16(bits, vld1q_u16(FlagBits[0]));
+  *hi = vtstq_u16(bits, vld1q_u16(FlagBits[1]));
+}
+
+static void
+StoreFlags(struct RSPFlags *flags, uint16x8_t lo, uint16x8_t hi) {
+  vst1q_u16((uint16_t*) flags->lo.slices, lo);
+  vst1q_u16((uint16_t*) flags->hi.slices, hi);
+  flags->forms = RSP_FLAGS_MASKS;
+}
+
+/* ============================================================================
+ *  StoreSelect: Writes the result of a select, and clears VCO.
+ * ========================================================================= */
+static void
+StoreSelect(struct RSPCP2 *cp2, int16_t *vd, int16x8_t vdReg) {
+  vst1q_s16(cp2->accumulatorLow.slices, vdReg);
+  vst1q_s16(vd, vdReg);
+  RSPClearFlags(&cp2->vco);
+}
+
+/* ============================================================================
+ *  LoadUpper/StoreUpper: Loads/stores the upper 32 bits of the accumulator
+ *  (i.e., its high and middle words).
+ * ========================================================================= */
+static void
+LoadUpper(const struct RSPCP2 *cp2, int32x4_t *upperLo, int32x4_t *upperHi) {
+  *upperLo = vld1q_s32(cp2->accumulatorUpper.slices + 0);
+  *upperHi = vld1q_s32(cp2->accumulatorUpper.slices + 4);
+}
+
+static void
+StoreUpper(struct RSPCP2 *cp2, int32x4_t upperLo, int32x4_t upperHi) {
+  vst1q_s32(cp2->accumulatorUpper.slices + 0, upperLo);
+  vst1q_s32(cp2->accumulatorUpper.slices + 4, upperHi);
+}
+
+/* ============================================================================
+ *  Accumulate: Adds 32-bit products to the accumulator: the low halves go
+ *  to the low word, and the rest (with the carries out of the low word) to
+ *  the upper 32 bits, which are also returned in `sumLo`/`sumHi`. Returns
+ *  the new low word.
+ * ========================================================================= */
+static int16x8_t
+Accumulate(struct RSPCP2 *cp2, int32x4_t productLo, int32x4_t productHi,
+  int32x4_t *sumLo, int32x4_t *sumHi) {
+  uint16x8_t accLow = vld1q_u16((uint16_t*) cp2->accumulatorLow.slices);
+  uint32x4_t lowMask = vdupq_n_u32(0xFFFF);
+  int32x4_t upperLo, upperHi;
+  uint32x4_t lowLo, lowHi;
+  int16x8_t vaccLow;
+
+  LoadUpper(cp2, &upperLo, &upperHi);
+
+  /* 17-bit sums of the low words; bit 16 is the carry. */
+  lowLo = vandq_u32(vreinterpretq_u32_s32(productLo), lowMask);
+  lowHi = vandq_u32(vreinterpretq_u32_s32(productHi), lowMask);
+  lowLo = vaddw_u16(lowLo, vget_low_u16(accLow));
+  lowHi = vaddw_high_u16(lowHi, accLow);
+
+  upperLo = vsraq_n_s32(upperLo, productLo, 16);
+  upperHi = vsraq_n_s32(upperHi, productHi, 16);
+  upperLo = vaddq_s32(upperLo, vreinterpretq_s32_u32(vshrq_n_u32(lowLo, 16)));
+  upperHi = vaddq_s32(upperHi, vreinterpretq_s32_u32(vshrq_n_u32(lowHi, 16)));
+
+  vaccLow = vreinterpretq_s16_u16(vuzp1q_u16(
+    vreinterpretq_u16_u32(lowLo), vreinterpretq_u16_u32(lowHi)));
+
+  vst1q_s16(cp2->accumulatorLow.slices, vaccLow);
+  StoreUpper(cp2, upperLo, upperHi);
+
+  *sumLo = upperLo;
+  *sumHi = upperHi;
+  return vaccLow;
+}
+
+/* ============================================================================
+ *  ClampLowToVal: Keeps the low word of the accumulator where the high word
+ *  is just the sign of the middle one, and zeroes it elsewhere. The upper
+ *  32 bits fit in 16 just when adding 0x8000 leaves their top half zero.
+ * ========================================================================= */
+static int16x8_t
+ClampLowToVal(int16x8_t vaccLow, int32x4_t sumLo, int32x4_t sumHi) {
+  int32x4_t bias = vdupq_n_s32(0x8000);
+  int16x8_t top = vaddhn_high_s32(vaddhn_s32(sumLo, bias), sumHi, bias);
+  uint16x8_t inRange = vceqzq_s16(top);
+
+  return vandq_s16(vaccLow, vreinterpretq_s16_u16(inRange));
+}
+
+/* ============================================================================
+ *  MulSignedUnsigned: Widening multiply of signed `a` and unsigned `b`.
+ * ========================================================================= */
+static void
+MulSignedUnsigned(int16x8_t a, uint16x8_t b,
+  int32x4_t *productLo, int32x4_t *productHi) {
+  int32x4_t bLo = vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(b)));
+  int32x4_t bHi = vreinterpretq_s32_u32(vmovl_high_u16(b));
+
+  *productLo = vmulq_s32(vmovl_s16(vget_low_s16(a)), bLo);
+  *productHi = vmulq_s32(vmovl_high_s16(a), bHi);
+}
+
+/* ============================================================================
+ *  MulRounded: The doubled product of the sources, plus 0x8000 (rounding
+ *  the middle word), for VMULF/VMULU.
+ * ========================================================================= */
+static void
+MulRounded(int16x8_t vsReg, int16x8_t vtReg,
+  int32x4_t *productLo, int32x4_t *productHi) {
+  int32x4_t round = vdupq_n_s32(0x8000);
+
+  *productLo = vmull_s16(vget_low_s16(vsReg), vget_low_s16(vtReg));
+  *productHi = vmull_high_s16(vsReg, vtReg);
+  *productLo = vaddq_s32(vshlq_n_s32(*productLo, 1), round);
+  *productHi = vaddq_s32(vshlq_n_s32(*productHi, 1), round);
+}
+
+/* ============================================================================
+ *  StoreProduct: Writes a 32-bit product, sign extended, to the accumulator.
+ * ========================================================================= */
+static void
+StoreProduct(struct RSPCP2 *cp2, int32x4_t productLo, int32x4_t productHi) {
+  int16x8_t vaccLow = vmovn_high_s32(vmovn_s32(productLo), productHi);
+
+  vst1q_s16(cp2->accumulatorLow.slices, vaccLow);
+  StoreUpper(cp2, vshrq_n_s32(productLo, 16), vshrq_n_s32(productHi, 16));
+}
+
+/* ============================================================================
+ *  Instruction: VCH (Vector Select Clip Test High)
+ * ========================================================================= */
+void
+RSPNEONVCH(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vsData);
+  int16x8_t vtReg = GetVectorOperands(vtData, element);
+  int16x8_t sum = vaddq_s16(vsReg, vtReg);
+  int16x8_t diff = vsubq_s16(vsReg, vtReg);
+  uint16x8_t sn, vtNeg, ge, le, eq, ce, sel;
+  int16x8_t vtSel, vdReg;
+
+  /* Signs differ: compare vs to -vt, else to vt. */
+  sn = vcltzq_s16(veorq_s16(vsReg, vtReg));
+  vtNeg = vcltzq_s16(vtReg);
+
+  le = vbslq_u16(sn, vclezq_s16(sum), vtNeg);
+  ge = vbslq_u16(sn, vtNeg, vcgezq_s16(diff));
+  ce = vandq_u16(sn, vceqq_s16(sum, vdupq_n_s16(-1)));
+  eq = vbslq_u16(sn, vorrq_u16(vceqzq_s16(sum), ce), vceqzq_s16(diff));
+
+  /* vd = sn ? (le ? -vt : vs) : (ge ? vt : vs) */
+  sel = vbslq_u16(sn, le, ge);
+  vtSel = vbslq_s16(sn, vnegq_s16(vtReg), vtReg);
+  vdReg = vbslq_s16(sel, vtSel, vsReg);
+
+  vst1q_s16(cp2->accumulatorLow.slices, vdReg);
+  vst1q_s16(vd, vdReg);
+  StoreFlags(&cp2->vco, sn, vmvnq_u16(eq));
+  StoreFlags(&cp2->vcc, le, ge);
+  StoreFlags(&cp2->vce, ce, vdupq_n_u16(0));
+}
+
+/* ============================================================================
+ *  Instruction: VCL (Vector Select Clip Test Low)
+ * ========================================================================= */
+void
+RSPNEONVCL(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  uint16x8_t vsReg = vld1q_u16((const uint16_t*) vsData);
+  int16x8_t vtSigned = GetVectorOperands(vtData, element);
+  uint16x8_t vtReg = vreinterpretq_u16_s16(vtSigned);
+  uint16x8_t sn, eq, ce, ceHi, leOld, geOld;
+  uint16x8_t sum, lz, uz, ge, le, sel, vtSel, vdReg;
+
+  LoadFlags(&cp2->vco, &sn, &eq);
+  LoadFlags(&cp2->vcc, &leOld, &geOld);
+  LoadFlags(&cp2->vce, &ce, &ceHi);
+  eq = vmvnq_u16(eq);
+
+  /* Where the slices are equal, the old VCC is retested: */
+  /* lz/uz are whether the 17-bit sum's low/high bits are zero. */
+  sum = vaddq_u16(vsReg, vtReg);
+  lz = vceqzq_u16(sum);
+  uz = vcgeq_u16(sum, vsReg);
+
+  le = vbslq_u16(vandq_u16(sn, eq), vbslq_u16(ce,
+    vorrq_u16(lz, uz), vandq_u16(lz, uz)), leOld);
+  ge = vbslq_u16(vbicq_u16(eq, sn),
+    vcgeq_u16(vsReg, vtReg), geOld);
+
+  /* vd = sn ? (le ? -vt : vs) : (ge ? vt : vs) */
+  sel = vbslq_u16(sn, le, ge);
+  vtSel = vbslq_u16(sn, vreinterpretq_u16_s16(vnegq_s16(vtSigned)), vtReg);
+  vdReg = vbslq_u16(sel, vtSel, vsReg);
+
+  StoreSelect(cp2, vd, vreinterpretq_s16_u16(vdReg));
+  StoreFlags(&cp2->vcc, le, ge);
+  RSPClearFlags(&cp2->vce);
+}
+
+/* ============================================================================
+ *  Instruction: VCR (Vector Select Crimp Test Low)
+ * ========================================================================= */
+void
+RSPNEONVCR(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vsData);
+  int16x8_t vtReg = GetVectorOperands(vtData, element);
+  uint16x8_t sn, vtNeg, ge, le;
+  int16x8_t vtSel, vdReg;
+
+  /* Signs differ: compare vs to ~vt, else to vt. */
+  sn = vcltzq_s16(veorq_s16(vsReg, vtReg));
+  vtNeg = vcltzq_s16(vtReg);
+
+  le = vbslq_u16(sn, vcltzq_s16(vaddq_s16(vsReg, vtReg)), vtNeg);
+  ge = vbslq_u16(sn, vtNeg, vcgezq_s16(vsubq_s16(vsReg, vtReg)));
+
+  /* vd = le ? (sn ? ~vt : vt) : vs */
+  vtSel = vbslq_s16(sn, vmvnq_s16(vtReg), vtReg);
+  vdReg = vbslq_s16(le, vtSel, vsReg);
+
+  StoreSelect(cp2, vd, vdReg);
+  StoreFlags(&cp2->vcc, le, ge);
+  RSPClearFlags(&cp2->vce);
+}
+
+/* ============================================================================
+ *  Instruction: VEQ (Vector Select Equal)
+ * ========================================================================= */
+void
+RSPNEONVEQ(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vsData);
+  int16x8_t vtReg = GetVectorOperands(vtData, element);
+  uint16x8_t co, ne;
+
+  LoadFlags(&cp2->vco, &co, &ne);
+
+  StoreFlags(&cp2->vcc, vbicq_u16(vceqq_s16(vsReg, vtReg), ne),
+    vdupq_n_u16(0));
+  StoreSelect(cp2, vd, vtReg);
+}
+
+/* ============================================================================
+ *  Instruction: VGE (Vector Select Greater Than or Equal)
+ * ========================================================================= */
+void
+RSPNEONVGE(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vsData);
+  int16x8_t vtReg = GetVectorOperands(vtData, element);
+  uint16x8_t co, ne, both, ge;
+
+  LoadFlags(&cp2->vco, &co, &ne);
+  both = vandq_u16(co, ne);
+
+  /* ge = vs > vt | (~(vco & vne) && vs == vt) */
+  ge = vorrq_u16(vcgtq_s16(vsReg, vtReg),
+    vbicq_u16(vceqq_s16(vsReg, vtReg), both));
+
+  StoreFlags(&cp2->vcc, ge, vdupq_n_u16(0));
+  StoreSelect(cp2, vd, vbslq_s16(ge, vsReg, vtReg));
+}
+
+/* ============================================================================
+ *  Instruction: VLT (Vector Select Less Than or Equal)
+ * ========================================================================= */
+void
+RSPNEONVLT(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vsData);
+  int16x8_t vtReg = GetVectorOperands(vtData, element);
+  uint16x8_t co, ne, both, le;
+
+  LoadFlags(&cp2->vco, &co, &ne);
+  both = vandq_u16(co, ne);
+
+  /* le = vs < vt | ((vco & vne) && vs == vt) */
+  le = vorrq_u16(vcltq_s16(vsReg, vtReg),
+    vandq_u16(vceqq_s16(vsReg, vtReg), both));
+
+  StoreFlags(&cp2->vcc, le, vdupq_n_u16(0));
+  StoreSelect(cp2, vd, vbslq_s16(le, vsReg, vtReg));
+}
+
+/* ============================================================================
+ *  Instruction: VMACF (Vector Multiply-Accumulate of Signed Fractions)
+ * ========================================================================= */
+void
+RSPNEONVMACF(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vs);
+  int16x8_t vtReg = GetVectorOperands(vt, element);
+  int32x4_t productLo, productHi, sumLo, sumHi;
+
+  /* Doubled by a shift; vqdmull would saturate 0x8000 * 0x8000. */
+  productLo = vmull_s16(vget_low_s16(vsReg), vget_low_s16(vtReg));
+  productHi = vmull_high_s16(vsReg, vtReg);
+  productLo = vshlq_n_s32(productLo, 1);
+  productHi = vshlq_n_s32(productHi, 1);
+
+  Accumulate(cp2, productLo, productHi, &sumLo, &sumHi);
+  vst1q_s16(vd, vqmovn_high_s32(vqmovn_s32(sumLo), sumHi));
+}
+
+/* ============================================================================
+ *  Instruction: VMACU (Vector Multiply-Accumulate of Unsigned Fractions)
+ * ========================================================================= */
+void
+RSPNEONVMACU(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vs);
+  int16x8_t vtReg = GetVectorOperands(vt, element);
+  int32x4_t productLo, productHi, sumLo, sumHi;
+  int16x8_t vdReg;
+
+  productLo = vmull_s16(vget_low_s16(vsReg), vget_low_s16(vtReg));
+  productHi = vmull_high_s16(vsReg, vtReg);
+  productLo = vshlq_n_s32(productLo, 1);
+  productHi = vshlq_n_s32(productHi, 1);
+
+  Accumulate(cp2, productLo, productHi, &sumLo, &sumHi);
+
+  /* Negative sums give 0, and those past 0x7FFF give 0xFFFF. */
+  vdReg = vreinterpretq_s16_u16(vqmovun_high_s32(vqmovun_s32(sumLo), sumHi));
+  vst1q_s16(vd, vorrq_s16(vdReg, vshrq_n_s16(vdReg, 15)));
+}
+
+/* ============================================================================
+ *  Instruction: VMADH (Vector Multiply-Accumulate of High Partial Products)
+ * ========================================================================= */
+void
+RSPNEONVMADH(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vs);
+  int16x8_t vtReg = GetVectorOperands(vt, element);
+  int32x4_t upperLo, upperHi;
+
+  /* The product goes on top of the middle word. */
+  LoadUpper(cp2, &upperLo, &upperHi);
+  upperLo = vmlal_s16(upperLo, vget_low_s16(vsReg), vget_low_s16(vtReg));
+  upperHi = vmlal_high_s16(upperHi, vsReg, vtReg);
+  StoreUpper(cp2, upperLo, upperHi);
+
+  vst1q_s16(vd, vqmovn_high_s32(vqmovn_s32(upperLo), upperHi));
+}
+
+/* ============================================================================
+ *  Instruction: VMADL (Vector Multiply-Accumulate of Lower Partial Products)
+ * ========================================================================= */
+void
+RSPNEONVMADL(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  uint16x8_t vsReg = vld1q_u16((const uint16_t*) vs);
+  uint16x8_t vtReg = vreinterpretq_u16_s16(GetVectorOperands(vt, element));
+  int32x4_t productLo, productHi, sumLo, sumHi;
+  int16x8_t vaccLow;
+
+  /* Only the high word of the unsigned product is used. */
+  productLo = vreinterpretq_s32_u32(vshrq_n_u32(
+    vmull_u16(vget_low_u16(vsReg), vget_low_u16(vtReg)), 16));
+  productHi = vreinterpretq_s32_u32(vshrq_n_u32(
+    vmull_high_u16(vsReg, vtReg), 16));
+
+  vaccLow = Accumulate(cp2, productLo, productHi, &sumLo, &sumHi);
+  vst1q_s16(vd, ClampLowToVal(vaccLow, sumLo, sumHi));
+}
+
+/* ============================================================================
+ *  Instruction: VMADM (Vector Multiply-Accumulate of Mid Partial Products)
+ * ========================================================================= */
+void
+RSPNEONVMADM(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vs);
+  int16x8_t vtReg = GetVectorOperands(vt, element);
+  int32x4_t productLo, productHi, sumLo, sumHi;
+
+  /* Signed `vs`, unsigned `vt`. */
+  MulSignedUnsigned(vsReg, vreinterpretq_u16_s16(vtReg),
+    &productLo, &productHi);
+
+  Accumulate(cp2, productLo, productHi, &sumLo, &sumHi);
+  vst1q_s16(vd, vqmovn_high_s32(vqmovn_s32(sumLo), sumHi));
+}
+
+/* ============================================================================
+ *  Instruction: VMADN (Vector Multiply-Accumulate of Mid Partial Products)
+ * ========================================================================= */
+void
+RSPNEONVMADN(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vs);
+  int16x8_t vtReg = GetVectorOperands(vt, element);
+  int32x4_t productLo, productHi, sumLo, sumHi;
+  int16x8_t vaccLow;
+
+  /* Unsigned `vs`, signed `vt`. */
+  MulSignedUnsigned(vtReg, vreinterpretq_u16_s16(vsReg),
+    &productLo, &productHi);
+
+  vaccLow = Accumulate(cp2, productLo, productHi, &sumLo, &sumHi);
+  vst1q_s16(vd, ClampLowToVal(vaccLow, sumLo, sumHi));
+}
+
+/* ============================================================================
+ *  Instruction: VMRG (Vector Select Merge)
+ * ========================================================================= */
+void
+RSPNEONVMRG(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vsData);
+  int16x8_t vtReg = GetVectorOperands(vtData, element);
+  uint16x8_t le, ge;
+  int16x8_t vdReg;
+
+  LoadFlags(&cp2->vcc, &le, &ge);
+  vdReg = vbslq_s16(le, vsReg, vtReg);
+
+  vst1q_s16(cp2->accumulatorLow.slices, vdReg);
+  vst1q_s16(vd, vdReg);
+}
+
+/* ============================================================================
+ *  Instruction: VMUDH (Vector Multiply of High Partial Products)
+ * ========================================================================= */
+void
+RSPNEONVMUDH(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vs);
+  int16x8_t vtReg = GetVectorOperands(vt, element);
+  int32x4_t productLo, productHi;
+
+  productLo = vmull_s16(vget_low_s16(vsReg), vget_low_s16(vtReg));
+  productHi = vmull_high_s16(vsReg, vtReg);
+
+  vst1q_s16(vd, vqmovn_high_s32(vqmovn_s32(productLo), productHi));
+  vst1q_s16(cp2->accumulatorLow.slices, vdupq_n_s16(0));
+  StoreUpper(cp2, productLo, productHi);
+}
+
+/* ============================================================================
+ *  Instruction: VMUDL (Vector Multiply of Low Partial Products)
+ * ========================================================================= */
+void
+RSPNEONVMUDL(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  uint16x8_t vsReg = vld1q_u16((const uint16_t*) vs);
+  uint16x8_t vtReg = vreinterpretq_u16_s16(GetVectorOperands(vt, element));
+  uint32x4_t productLo, productHi;
+  int16x8_t vdReg;
+
+  productLo = vmull_u16(vget_low_u16(vsReg), vget_low_u16(vtReg));
+  productHi = vmull_high_u16(vsReg, vtReg);
+  vdReg = vreinterpretq_s16_u16(vshrn_high_n_u32(
+    vshrn_n_u32(productLo, 16), productHi, 16));
+
+  vst1q_s16(vd, vdReg);
+  vst1q_s16(cp2->accumulatorLow.slices, vdReg);
+  StoreUpper(cp2, vdupq_n_s32(0), vdupq_n_s32(0));
+}
+
+/* ============================================================================
+ *  Instruction: VMUDM (Vector Multiply of Mid Partial Products)
+ * ========================================================================= */
+void
+RSPNEONVMUDM(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vs);
+  int16x8_t vtReg = GetVectorOperands(vt, element);
+  int32x4_t productLo, productHi;
+
+  /* Signed `vs`, unsigned `vt`. */
+  MulSignedUnsigned(vsReg, vreinterpretq_u16_s16(vtReg),
+    &productLo, &productHi);
+
+  StoreProduct(cp2, productLo, productHi);
+  vst1q_s16(vd, vshrn_high_n_s32(vshrn_n_s32(productLo, 16), productHi, 16));
+}
+
+/* ============================================================================
+ *  Instruction: VMUDN (Vector Multiply of Mid Partial Products)
+ * ========================================================================= */
+void
+RSPNEONVMUDN(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vs);
+  int16x8_t vtReg = GetVectorOperands(vt, element);
+  int32x4_t productLo, productHi;
+
+  /* Unsigned `vs`, signed `vt`. */
+  MulSignedUnsigned(vtReg, vreinterpretq_u16_s16(vsReg),
+    &productLo, &productHi);
+
+  StoreProduct(cp2, productLo, productHi);
+  vst1q_s16(vd, vmovn_high_s32(vmovn_s32(productLo), productHi));
+}
+
+/* ============================================================================
+ *  Instruction: VMULF (Vector Multiply of Signed Fractions)
+ * ========================================================================= */
+void
+RSPNEONVMULF(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vs);
+  int16x8_t vtReg = GetVectorOperands(vt, element);
+  int32x4_t productLo, productHi;
+  int16x8_t vaccMid;
+
+  MulRounded(vsReg, vtReg, &productLo, &productHi);
+  StoreProduct(cp2, productLo, productHi);
+
+  /* vd = accMid + (accMid >> 15), as the plain C version does. */
+  vaccMid = vshrn_high_n_s32(vshrn_n_s32(productLo, 16), productHi, 16);
+  vst1q_s16(vd, vsraq_n_s16(vaccMid, vaccMid, 15));
+}
+
+/* ============================================================================
+ *  Instruction: VMULU (Vector Multiply of Unsigned Fractions)
+ * ========================================================================= */
+void
+RSPNEONVMULU(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vs, const int16_t *vt, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vs);
+  int16x8_t vtReg = GetVectorOperands(vt, element);
+  int32x4_t productLo, productHi;
+  uint16x8_t vdReg;
+
+  MulRounded(vsReg, vtReg, &productLo, &productHi);
+  StoreProduct(cp2, productLo, productHi);
+
+  /* Negative products give 0. */
+  vdReg = vqshrun_high_n_s32(vqshrun_n_s32(productLo, 16), productHi, 16);
+  vst1q_u16((uint16_t*) vd, vdReg);
+}
+
+/* ============================================================================
+ *  Instruction: VNE (Vector Select Not Equal)
+ * ========================================================================= */
+void
+RSPNEONVNE(struct RSPCP2 *cp2, int16_t *vd,
+  const int16_t *vsData, const int16_t *vtData, unsigned element) {
+  int16x8_t vsReg = vld1q_s16(vsData);
+  int16x8_t vtReg = GetVectorOperands(vtData, element);
+  uint16x8_t co, ne;
+
+  LoadFlags(&cp2->vco, &co, &ne);
+
+  StoreFlags(&cp2->vcc, vornq_u16(ne, vceqq_s16(vsReg, vtReg)),
+    vdupq_n_u16(0));
+  StoreSelect(cp2, vd, vsReg);
+}
+
+/* ============================================================================
+ *  Fused idioms: the multiplies above, one word after another.
+ * ========================================================================= */
+void
+RSPNEONFusedMUL32(struct RSPCP2 *cp2,
+  uint32_t iw0, uint32_t iw1, uint32_t iw2, uint32_t iw3) {
+  RSPRunVectorWord(cp2, RSPNEONVMUDL, iw0);
+  RSPRunVectorWord(cp2, RSPNEONVMADM, iw1);
+  RSPRunVectorWord(cp2, RSPNEONVMADN, iw2);
+  RSPRunVectorWord(cp2, RSPNEONVMADH, iw3);
+}
+
+void
+RSPNEONFusedMULF(struct RSPCP2 *cp2, uint32_t iw0, uint32_t iw1,
+  uint32_t unused(iw2), uint32_t unused(iw3)) {
+  RSPRunVectorWord(cp2, RSPNEONVMULF, iw0);
+  RSPRunVectorWord(cp2, RSPNEONVMACF, iw1);
+}
+
+/* ============================================================================
+ *  The vector function table: the built-in one, with the functions above
+ *  swapped in.
+ * ========================================================================= */
+#define RSPVCH RSPNEONVCH
+#define RSPVCL RSPNEONVCL
+#define RSPVCR RSPNEONVCR
+#define RSPVEQ RSPNEONVEQ
+#define RSPVGE RSPNEONVGE
+#define RSPVLT RSPNEONVLT
+#define RSPVMACF RSPNEONVMACF
+#define RSPVMACU RSPNEONVMACU
+#define RSPVMADH RSPNEONVMADH
+#define RSPVMADL RSPNEONVMADL
+#define RSPVMADM RSPNEONVMADM
+#define RSPVMADN RSPNEONVMADN
+#define RSPVMRG RSPNEONVMRG
+#define RSPVMUDH RSPNEONVMUDH
+#define RSPVMUDL RSPNEONVMUDL
+#define RSPVMUDM RSPNEONVMUDM
+#define RSPVMUDN RSPNEONVMUDN
+#define RSPVMULF RSPNEONVMULF
+#define RSPVMULU RSPNEONVMULU
+#define RSPVNE RSPNEONVNE
+
+const RSPVectorFunction
+  RSPVectorFunctionTableNEON[NUM_RSP_VECTOR_OPCODES] = {
+#define X(op) RSP##op,
+#include "VectorOpcodes.md"
+#undef X
+};
+
+const RSPFusedFunction
+  RSPFusedFunctionTableNEON[NUM_RSP_FUSED_IDIOMS] = {
+  RSPNEONFusedMUL32, RSPNEONFusedMULF
+};
+
+/* The multiplies above write the accumulator as they go. */
+const RSPVectorFunction
+  RSPNoAccFunctionTableNEON[NUM_RSP_PRODUCTS] = {
+#define X(op) RSP##op,
+  RSP_PRODUCT_OPCODES
+#undef X
+};
+
+/* Nor do the carries and compares skip their flags. */
+const RSPVectorFunction
+  RSPNoFlagsFunctionTableNEON[NUM_RSP_FLAG_WRITERS] = {
+#define X(op) RSP##op,
+  RSP_FLAG_WRITER_OPCODES
+#undef X
+};
+
+#endif
+
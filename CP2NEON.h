@@ -0,0 +1,39 @@
+/* ============================================================================
+ *  CP2NEON.h: RSP Coprocessor #2 (NEON).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__CP2NEON_H__
+#define __RSP__CP2NEON_H__
+#include "Common.h"
+#include "CP2.h"
+#include "Opcodes.h"
+
+#ifdef RSP_HAVE_NEON
+#define X(op) void RSPNEON##op( \
+  struct RSPCP2 *, int16_t *, const int16_t *, const int16_t *, unsigned);
+X(VCH) X(VCL) X(VCR) X(VEQ) X(VGE) X(VLT) X(VMRG) X(VNE)
+X(VMACF) X(VMACU) X(VMADH) X(VMADL) X(VMADM) X(VMADN)
+X(VMUDH) X(VMUDL) X(VMUDM) X(VMUDN) X(VMULF) X(VMULU)
+#undef X
+
+void RSPNEONFusedMUL32(struct RSPCP2 *, uint32_t, uint32_t, uint32_t, uint32_t);
+void RSPNEONFusedMULF(struct RSPCP2 *, uint32_t, uint32_t, uint32_t, uint32_t);
+
+extern const RSPVectorFunction
+  RSPVectorFunctionTableNEON[NUM_RSP_VECTOR_OPCODES];
+extern const RSPFusedFunction
+  RSPFusedFunctionTableNEON[NUM_RSP_FUSED_IDIOMS];
+extern const RSPVectorFunction
+  RSPNoAccFunctionTableNEON[NUM_RSP_PRODUCTS];
+extern const RSPVectorFunction
+  RSPNoFlagsFunctionTableNEON[NUM_RSP_FLAG_WRITERS];
+#endif
+
+#endif
+
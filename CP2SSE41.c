@@ -0,0 +1,49 @@
+/* ============================================================================
+ *  CP2SSE41.c: RSP Coprocessor #2 (SSE4.1).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CP2.h"
+#include "CP2SSE41.h"
+
+#ifdef RSP_SSE_DISPATCH
+#pragma GCC target("sse4.1")
+#undef SSSE3_ONLY
+
+/* The vector functions, built for SSE4.1. */
+#define RSP_CP2_VARIANT(op) RSPSSE41##op
+#include "CP2.c"
+
+const RSPVectorFunction
+  RSPVectorFunctionTableSSE41[NUM_RSP_VECTOR_OPCODES] = {
+#define X(op) RSP##op,
+#include "VectorOpcodes.md"
+#undef X
+};
+
+const RSPFusedFunction
+  RSPFusedFunctionTableSSE41[NUM_RSP_FUSED_IDIOMS] = {
+  RSPFusedMUL32, RSPFusedMULF
+};
+
+const RSPVectorFunction
+  RSPNoAccFunctionTableSSE41[NUM_RSP_PRODUCTS] = {
+#define X(op) RSP##op##NoAcc,
+  RSP_PRODUCT_OPCODES
+#undef X
+};
+
+const RSPVectorFunction
+  RSPNoFlagsFunctionTableSSE41[NUM_RSP_FLAG_WRITERS] = {
+#define X(op) RSP##op##NoFlags,
+  RSP_FLAG_WRITER_OPCODES
+#undef X
+};
+#endif
+
@@ -0,0 +1,29 @@
+/* ============================================================================
+ *  CP2SSE41.h: RSP Coprocessor #2 (SSE4.1).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__CP2SSE41_H__
+#define __RSP__CP2SSE41_H__
+#include "Common.h"
+#include "CP2.h"
+#include "Opcodes.h"
+
+#ifdef RSP_SSE_DISPATCH
+extern const RSPVectorFunction
+  RSPVectorFunctionTableSSE41[NUM_RSP_VECTOR_OPCODES];
+extern const RSPFusedFunction
+  RSPFusedFunctionTableSSE41[NUM_RSP_FUSED_IDIOMS];
+extern const RSPVectorFunction
+  RSPNoAccFunctionTableSSE41[NUM_RSP_PRODUCTS];
+extern const RSPVectorFunction
+  RSPNoFlagsFunctionTableSSE41[NUM_RSP_FLAG_WRITERS];
+#endif
+
+#endif
+
@@ -0,0 +1,31 @@
+/* ============================================================================
+ *  CP2SSE41Identity.c: RSP Coprocessor #2 (SSE4.1, identity elements).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CP2.h"
+#include "CP2SSE41Identity.h"
+
+#ifdef RSP_SSE_DISPATCH
+#pragma GCC target("sse4.1")
+#undef SSSE3_ONLY
+
+/* The vector functions, built for SSE4.1 and elements 0 and 1. */
+#define RSP_CP2_IDENTITY
+#define RSP_CP2_VARIANT(op) RSPSSE41Identity##op
+#include "CP2.c"
+
+const RSPVectorFunction
+  RSPVectorFunctionTableSSE41Identity[NUM_RSP_VECTOR_OPCODES] = {
+#define X(op) RSP##op,
+#include "VectorOpcodes.md"
+#undef X
+};
+#endif
+
@@ -0,0 +1,99 @@
+/* ============================================================================
+ *  CP2Variant.h: Names for a variant of the vector functions.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__CP2VARIANT_H__
+#define __RSP__CP2VARIANT_H__
+#include "Common.h"
+#include "Opcodes.h"
+
+/* With RSP_CP2_VARIANT(op) defined as, e.g., RSPAVX2##op, */
+/* RSPVABS and friends become RSPAVX2VABS and so on: CP2.c */
+/* can then be built once per instruction set. */
+
+#define RSPVINV RSP_CP2_VARIANT(VINV)
+#define RSPVABS RSP_CP2_VARIANT(VABS)
+#define RSPVADD RSP_CP2_VARIANT(VADD)
+#define RSPVADDC RSP_CP2_VARIANT(VADDC)
+#define RSPVAND RSP_CP2_VARIANT(VAND)
+#define RSPVCH RSP_CP2_VARIANT(VCH)
+#define RSPVCL RSP_CP2_VARIANT(VCL)
+#define RSPVCR RSP_CP2_VARIANT(VCR)
+#define RSPVEQ RSP_CP2_VARIANT(VEQ)
+#define RSPVGE RSP_CP2_VARIANT(VGE)
+#define RSPVLT RSP_CP2_VARIANT(VLT)
+#define RSPVMACF RSP_CP2_VARIANT(VMACF)
+#define RSPVMACQ RSP_CP2_VARIANT(VMACQ)
+#define RSPVMACU RSP_CP2_VARIANT(VMACU)
+#define RSPVMADH RSP_CP2_VARIANT(VMADH)
+#define RSPVMADL RSP_CP2_VARIANT(VMADL)
+#define RSPVMADM RSP_CP2_VARIANT(VMADM)
+#define RSPVMADN RSP_CP2_VARIANT(VMADN)
+#define RSPVMOV RSP_CP2_VARIANT(VMOV)
+#define RSPVMRG RSP_CP2_VARIANT(VMRG)
+#define RSPVMUDH RSP_CP2_VARIANT(VMUDH)
+#define RSPVMUDL RSP_CP2_VARIANT(VMUDL)
+#define RSPVMUDM RSP_CP2_VARIANT(VMUDM)
+#define RSPVMUDN RSP_CP2_VARIANT(VMUDN)
+#define RSPVMULF RSP_CP2_VARIANT(VMULF)
+#define RSPVMULQ RSP_CP2_VARIANT(VMULQ)
+#define RSPVMULU RSP_CP2_VARIANT(VMULU)
+#define RSPVNAND RSP_CP2_VARIANT(VNAND)
+#define RSPVNE RSP_CP2_VARIANT(VNE)
+#define RSPVNOP RSP_CP2_VARIANT(VNOP)
+#define RSPVNOR RSP_CP2_VARIANT(VNOR)
+#define RSPVNXOR RSP_CP2_VARIANT(VNXOR)
+#define RSPVOR RSP_CP2_VARIANT(VOR)
+#define RSPVRCP RSP_CP2_VARIANT(VRCP)
+#define RSPVRCPH RSP_CP2_VARIANT(VRCPH)
+#define RSPVRCPL RSP_CP2_VARIANT(VRCPL)
+#define RSPVRNDN RSP_CP2_VARIANT(VRNDN)
+#define RSPVRNDP RSP_CP2_VARIANT(VRNDP)
+#define RSPVRSQ RSP_CP2_VARIANT(VRSQ)
+#define RSPVRSQH RSP_CP2_VARIANT(VRSQH)
+#define RSPVRSQL RSP_CP2_VARIANT(VRSQL)
+#define RSPVSAR RSP_CP2_VARIANT(VSAR)
+#define RSPVSUB RSP_CP2_VARIANT(VSUB)
+#define RSPVSUBC RSP_CP2_VARIANT(VSUBC)
+#define RSPVXOR RSP_CP2_VARIANT(VXOR)
+#define RSPFusedMUL32 RSP_CP2_VARIANT(FusedMUL32)
+#define RSPFusedMULF RSP_CP2_VARIANT(FusedMULF)
+#define RSPVMUDHNoAcc RSP_CP2_VARIANT(VMUDHNoAcc)
+#define RSPVMUDLNoAcc RSP_CP2_VARIANT(VMUDLNoAcc)
+#define RSPVMUDMNoAcc RSP_CP2_VARIANT(VMUDMNoAcc)
+#define RSPVMUDNNoAcc RSP_CP2_VARIANT(VMUDNNoAcc)
+#define RSPVMULFNoAcc RSP_CP2_VARIANT(VMULFNoAcc)
+#define RSPVMULQNoAcc RSP_CP2_VARIANT(VMULQNoAcc)
+#define RSPVADDCNoFlags RSP_CP2_VARIANT(VADDCNoFlags)
+#define RSPVSUBCNoFlags RSP_CP2_VARIANT(VSUBCNoFlags)
+#define RSPVEQNoFlags RSP_CP2_VARIANT(VEQNoFlags)
+#define RSPVGENoFlags RSP_CP2_VARIANT(VGENoFlags)
+#define RSPVLTNoFlags RSP_CP2_VARIANT(VLTNoFlags)
+#define RSPVNENoFlags RSP_CP2_VARIANT(VNENoFlags)
+
+#define X(op) void RSP##op( \
+  struct RSPCP2 *, int16_t *, const int16_t *, const int16_t *, unsigned);
+#include "VectorOpcodes.md"
+#undef X
+
+void RSPFusedMUL32(struct RSPCP2 *, uint32_t, uint32_t, uint32_t, uint32_t);
+void RSPFusedMULF(struct RSPCP2 *, uint32_t, uint32_t, uint32_t, uint32_t);
+
+#define X(op) void RSP##op##NoAcc( \
+  struct RSPCP2 *, int16_t *, const int16_t *, const int16_t *, unsigned);
+RSP_PRODUCT_OPCODES
+#undef X
+
+#define X(op) void RSP##op##NoFlags( \
+  struct RSPCP2 *, int16_t *, const int16_t *, const int16_t *, unsigned);
+RSP_FLAG_WRITER_OPCODES
+#undef X
+
+#endif
+
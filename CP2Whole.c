@@ -0,0 +1,31 @@
+/* ============================================================================
+ *  CP2Whole.c: RSP Coprocessor #2 (whole elements).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CP2.h"
+#include "CP2Whole.h"
+
+/* The plain C vector functions, for elements 8 to 15: one */
+/* slice of `vt` is broadcast, in place of a shuffle (which, */
+/* without SSSE3, compilers do a slice at a time). With SSE, */
+/* one pshufb is as cheap as a broadcast: nothing is built. */
+#ifndef USE_SSE
+#define RSP_CP2_WHOLE
+#define RSP_CP2_VARIANT(op) RSPWhole##op
+#include "CP2.c"
+
+const RSPVectorFunction
+  RSPVectorFunctionTableWhole[NUM_RSP_VECTOR_OPCODES] = {
+#define X(op) RSP##op,
+#include "VectorOpcodes.md"
+#undef X
+};
+#endif
+
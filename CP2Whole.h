@@ -0,0 +1,23 @@
+/* ============================================================================
+ *  CP2Whole.h: RSP Coprocessor #2 (whole elements).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__CP2WHOLE_H__
+#define __RSP__CP2WHOLE_H__
+#include "Common.h"
+#include "CP2.h"
+#include "Opcodes.h"
+
+#ifndef USE_SSE
+extern const RSPVectorFunction
+  RSPVectorFunctionTableWhole[NUM_RSP_VECTOR_OPCODES];
+#endif
+
+#endif
+
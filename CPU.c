@@ -8,11 +8,16 @@
  *  This file is subject to the terms and conditions defined in
  *  file 'LICENSE', which is part of this source code package.
  * ========================================================================= */
+#include "CacheFile.h"
 #include "Common.h"
 #include "CP2.h"
 #include "CPU.h"
 #include "Externs.h"
+#include "Opcodes.h"
 #include "Pipeline.h"
+#include "ReciprocalROM.h"
+#include "Recompiler.h"
+#include "Registry.h"
 
 #ifdef __cplusplus
 #include <cstdlib>
@@ -22,14 +27,6 @@
 #include <string.h>
 #endif
 
-#ifndef USE_SSE
-const char *RSPBuildType = "ANSI C";
-#elif defined(SSSE3_ONLY)
-const char *RSPBuildType = "SSSE3";
-#else
-const char *RSPBuildType = "SSE4.1";
-#endif
-
 static void InitRSP(struct RSP *);
 
 /* ============================================================================
@@ -42,11 +39,15 @@ ConnectRSPToBus(struct RSP *rsp, struct BusController *bus) {
 
 /* ============================================================================
  *  CreateRSP: Creates and initializes an RSP instance.
+ *  The vector functions used are the best the host has to offer.
  * ========================================================================= */
 struct RSP *
 CreateRSP(void) {
   struct RSP *rsp;
 
+  RSPSelectVectorFunctions();
+  RSPBuildDivideTables();
+
   if ((rsp = (struct RSP*) malloc(sizeof(struct RSP))) == NULL) {
     debug("Failed to allocate memory.");
     return NULL;
@@ -58,14 +59,25 @@ CreateRSP(void) {
 
 /* ============================================================================
  *  DestroyRSP: Releases any resources allocated for a RSP instance.
+ *  A cache file that was opened is closed, but not saved.
  * ========================================================================= */
 void
 DestroyRSP(struct RSP *rsp) {
+  if (rsp->registry != NULL) {
+    RSPCloseCacheFile(rsp);
+    DestroyRSPRegistry(rsp->registry);
+  }
+
+  if (rsp->recompiler != NULL)
+    DestroyRSPRecompiler(rsp->recompiler);
+
   free(rsp);
 }
 
 /* ============================================================================
  *  GetRSPDMEMPtr: Returns a pointer to the RSP's DMEM.
+ *  Writes through this pointer must be marked with RSPMarkDirty if the
+ *  instance is snapshotted incrementally.
  * ========================================================================= */
 void *
 GetRSPDMEMPtr(const struct RSP *rsp) {
@@ -74,12 +86,24 @@ GetRSPDMEMPtr(const struct RSP *rsp) {
 
 /* ============================================================================
  *  GetRSPIMEMPtr: Returns a pointer to the RSP's IMEM.
+ *  Writes through this pointer must be followed by a RSPFlushDecodeCache
+ *  (and marked with RSPMarkDirty, as with DMEM).
  * ========================================================================= */
 void *
 GetRSPIMEMPtr(const struct RSP *rsp) {
   return (void*) rsp->imem;
 }
 
+/* ============================================================================
+ *  RSPSetExecutionMode: Selects how RunRSP executes instructions.
+ *  The latches are always left consistent between runs, so this can be
+ *  changed at any time outside of RunRSP.
+ * ========================================================================= */
+void
+RSPSetExecutionMode(struct RSP *rsp, enum RSPExecutionMode mode) {
+  rsp->mode = mode;
+}
+
 /* ============================================================================
  *  InitRSP: Initializes the RSP.
  * ========================================================================= */
@@ -93,7 +117,8 @@ InitRSP(struct RSP *rsp) {
   RSPInitCP2(&rsp->cp2);
 
   RSPInitPipeline(&rsp->pipeline);
-  RDPSetRSPDMEMPointer(rsp->dmem);
+  RSPFlushDecodeCache(&rsp->decodeCache);
+  RSPInitIdleLoop(&rsp->idleLoop);
 }
 
 #ifndef NDEBUG
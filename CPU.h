@@ -13,7 +13,9 @@
 #include "Common.h"
 #include "CP0.h"
 #include "CP2.h"
+#include "DecodeCache.h"
 #include "Externs.h"
+#include "IdleLoop.h"
 #include "Pipeline.h"
 
 #define RSP_DMEM_SIZE 4096
@@ -36,6 +38,17 @@ enum RSPRegister {
   NUM_RSP_REGISTERS
 };
 
+/* How RunRSP executes instructions. */
+enum RSPExecutionMode {
+  RSP_MODE_PIPELINE,      /* Cycle-accurate; CycleRSP. */
+  RSP_MODE_RECOMPILER,    /* Cycle-accurate; translated blocks. */
+  RSP_MODE_FUNCTIONAL,    /* One instruction at a time; untimed. */
+  RSP_MODE_FUNCTIONAL_TABLE /* As above, but never uses threaded code. */
+};
+
+struct RSPRecompiler;
+struct RSPRegistry;
+
 struct RSP {
   uint8_t dmem[RSP_DMEM_SIZE];
   uint8_t imem[RSP_IMEM_SIZE];
@@ -49,16 +62,48 @@ struct RSP {
   struct RSPCP2 cp2;
 
   struct RSPPipeline pipeline;
+  struct RSPDecodeCache decodeCache;
+  struct RSPRecompiler *recompiler;
+  struct RSPRegistry *registry;
+  enum RSPExecutionMode mode;
+  struct RSPIdleLoop idleLoop;
   struct RDP *rdp;
 
+  /* Lines of DMEM/IMEM written since the last incremental snapshot. */
+  uint64_t dirtyLines[RSP_DIRTY_LINE_WORDS];
+
   /* Various status flags. */
   uint8_t didBranch;
+  uint8_t events;
 };
 
+/* Events that end a RunRSP early. */
+#define RSP_EVENT_BREAK 0x1
+#define RSP_EVENT_HALT 0x2
+#define RSP_EVENT_SIGNAL 0x4
+#define RSP_EVENT_IDLE 0x8 /* Handled within RunRSP. */
+
 struct RSP *CreateRSP(void);
 void DestroyRSP(struct RSP *);
+void ConnectRSPToBus(struct RSP *, struct BusController *);
 void *GetRSPDMEMPtr(const struct RSP *);
 void *GetRSPIMEMPtr(const struct RSP *);
+void RSPSetExecutionMode(struct RSP *, enum RSPExecutionMode);
+
+/* ============================================================================
+ *  RSPGetRunStatus: Determines why a run ended from the pending events.
+ * ========================================================================= */
+static inline enum RSPRunStatus
+RSPGetRunStatus(const struct RSP *rsp) {
+  if (rsp->events & RSP_EVENT_BREAK)
+    return RSP_RUN_BREAK;
+
+  if (rsp->events & RSP_EVENT_HALT)
+    return RSP_RUN_HALT;
+
+  return (rsp->events & RSP_EVENT_SIGNAL)
+    ? RSP_RUN_SIGNAL : RSP_RUN_BUDGET;
+}
 
 #ifdef DEBUG
 void RSPDumpInstruction(uint32_t iw);
@@ -0,0 +1,447 @@
+/* ============================================================================
+ *  CacheFile.c: Persistent decode and translation cache.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include "CacheFile.h"
+#include "Common.h"
+#include "CPU.h"
+#include "DecodeCache.h"
+#include "Opcodes.h"
+#include "Recompiler.h"
+#include "Registry.h"
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define RSP_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Room for the ".<pid>.<instance>.tmp" of a temporary file name. */
+#define RSP_CACHE_FILE_SUFFIX_SIZE \
+  (sizeof(unsigned long) * 4 + sizeof("...tmp"))
+
+/* ============================================================================
+ *  MapFile: Maps (or reads) a whole file into memory, read-only. Nothing
+ *  in the file is ever run, so it is never mapped executable.
+ * ========================================================================= */
+static const uint8_t *
+MapFile(const char *path, size_t *size) {
+#ifdef RSP_HAVE_MMAP
+  struct stat status;
+  void *image;
+  int fd;
+
+  if ((fd = open(path, O_RDONLY)) < 0)
+    return NULL;
+
+  if (fstat(fd, &status) || status.st_size <= 0) {
+    close(fd);
+    return NULL;
+  }
+
+  *size = (size_t) status.st_size;
+  image = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  return image != MAP_FAILED ? (const uint8_t*) image : NULL;
+#else
+  uint8_t *image;
+  FILE *file;
+  long length;
+
+  if ((file = fopen(path, "rb")) == NULL)
+    return NULL;
+
+  if (fseek(file, 0, SEEK_END) || (length = ftell(file)) <= 0 ||
+    fseek(file, 0, SEEK_SET) ||
+    (image = (uint8_t*) malloc(length)) == NULL) {
+    fclose(file);
+    return NULL;
+  }
+
+  if (fread(image, 1, length, file) != (size_t) length) {
+    fclose(file);
+    free(image);
+    return NULL;
+  }
+
+  fclose(file);
+  *size = (size_t) length;
+  return image;
+#endif
+}
+
+/* ============================================================================
+ *  UnmapFile: Releases a file brought in by MapFile.
+ * ========================================================================= */
+static void
+UnmapFile(const uint8_t *image, size_t size) {
+#ifdef RSP_HAVE_MMAP
+  munmap((void*) image, size);
+#else
+  free((void*) image);
+#endif
+}
+
+/* ============================================================================
+ *  FillHeader: Describes the running build; any file that doesn't match
+ *  this (other than in the record count) is stale.
+ * ========================================================================= */
+static void
+FillHeader(struct RSPCacheFileHeader *header) {
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, RSP_CACHE_FILE_MAGIC, sizeof(header->magic));
+  strncpy(header->buildType, RSPBuildType, sizeof(header->buildType) - 1);
+
+  header->version = RSP_CACHE_FILE_VERSION;
+  header->recordSize = sizeof(struct RSPCacheRecord);
+  header->numScalarOpcodes = NUM_RSP_SCALAR_OPCODES;
+  header->numVectorOpcodes = NUM_RSP_VECTOR_OPCODES;
+}
+
+/* ============================================================================
+ *  PackInstruction: Strips the pointers out of a decoded instruction.
+ * ========================================================================= */
+static void
+PackInstruction(struct RSPCachedInstruction *cached,
+  const struct RSPDecodedInstruction *decoded) {
+  cached->iw = decoded->iw;
+  cached->infoFlags = decoded->opcode.infoFlags;
+  cached->vectorInfoFlags = decoded->vectorOpcode.infoFlags;
+  cached->offset = decoded->offset;
+  cached->id = decoded->opcode.id;
+  cached->vectorId = decoded->vectorOpcode.id;
+  cached->rs = decoded->rs;
+  cached->rt = decoded->rt;
+  cached->rd = decoded->rd;
+  cached->sa = decoded->sa;
+  cached->element = decoded->element;
+  cached->dest = decoded->dest;
+  cached->valid = decoded->valid;
+  cached->reserved = 0;
+}
+
+/* ============================================================================
+ *  UnpackInstruction: Rebuilds a decoded instruction from the file, given
+ *  the word in IMEM that it was decoded from. Returns false if any of the
+ *  fields are out of range, or if it was decoded from some other word.
+ * ========================================================================= */
+static bool
+UnpackInstruction(struct RSPDecodedInstruction *decoded,
+  const struct RSPCachedInstruction *cached, uint32_t iw) {
+  if (cached->id >= NUM_RSP_SCALAR_OPCODES ||
+    cached->vectorId >= NUM_RSP_VECTOR_OPCODES ||
+    (cached->rs | cached->rt | cached->rd | cached->sa) > 31 ||
+    cached->element > 15 || cached->dest > 31 || cached->valid > 1 ||
+    (cached->valid && cached->iw != iw))
+    return false;
+
+  decoded->opcode.id = (enum RSPOpcodeID) cached->id;
+  decoded->opcode.infoFlags = cached->infoFlags;
+  decoded->vectorOpcode.id = (enum RSPVOpcodeID) cached->vectorId;
+  decoded->vectorOpcode.infoFlags = cached->vectorInfoFlags;
+
+  decoded->scalarFunction = RSPScalarFunctionTable[cached->id];
+  decoded->vectorFunction = RSPVectorFormFunctions[RSPGetElementForm(
+    cached->element)][cached->vectorId];
+
+  decoded->iw = cached->iw;
+  decoded->offset = cached->offset;
+  decoded->rs = cached->rs;
+  decoded->rt = cached->rt;
+  decoded->rd = cached->rd;
+  decoded->sa = cached->sa;
+  decoded->element = cached->element;
+  decoded->dest = cached->dest;
+  decoded->valid = cached->valid;
+  decoded->block = NULL;
+  return true;
+}
+
+/* ============================================================================
+ *  GetRecordChecksum: Computes the checksum of a record's contents.
+ * ========================================================================= */
+static uint64_t
+GetRecordChecksum(const struct RSPCacheRecord *record) {
+  uint64_t words = RSPFingerprint((const uint8_t*) record->words,
+    sizeof(record->words));
+
+  return (words * 0x100000001B3ULL) ^ RSPFingerprint(
+    (const uint8_t*) record->blockHeads, sizeof(record->blockHeads));
+}
+
+/* ============================================================================
+ *  PackRecord: Fills out a record for a microcode and its decoded words.
+ *  If the entries have live translations, where they start is noted.
+ * ========================================================================= */
+static void
+PackRecord(struct RSPCacheRecord *record, uint64_t hash, const uint8_t *imem,
+  const struct RSPDecodedInstruction *entries, bool withBlocks) {
+  unsigned i;
+
+  record->hash = hash;
+  memcpy(record->imem, imem, RSP_IMEM_SIZE);
+  memset(record->blockHeads, 0, sizeof(record->blockHeads));
+
+  for (i = 0; i < RSP_DECODE_CACHE_ENTRIES; i++) {
+    PackInstruction(&record->words[i], &entries[i]);
+
+    if (withBlocks && entries[i].block != NULL)
+      record->blockHeads[i / 32] |= 1U << (i % 32);
+  }
+
+  record->checksum = GetRecordChecksum(record);
+}
+
+/* ============================================================================
+ *  RSPFetchCachedMicrocode: Looks for the microcode in IMEM in the cache
+ *  file, and fills out the decode cache with its words if it is found.
+ *  When running under the recompiler, the blocks that had been translated
+ *  are translated again up front (into the recompiler's own buffer).
+ *
+ *  Records are checked as they are used, so a damaged record only costs
+ *  a miss; the microcode just gets decoded the usual way.
+ * ========================================================================= */
+bool
+RSPFetchCachedMicrocode(struct RSP *rsp, uint64_t hash) {
+  const struct RSPRegistry *registry = rsp->registry;
+  struct RSPDecodeCache *cache = &rsp->decodeCache;
+
+  const struct RSPCacheFileHeader *header =
+    (const struct RSPCacheFileHeader*) registry->file;
+  const struct RSPCacheRecord *records =
+    (const struct RSPCacheRecord*) (header + 1);
+  unsigned i, j;
+
+  for (i = 0; i < header->numRecords; i++) {
+    const struct RSPCacheRecord *record = &records[i];
+
+    if (record->hash != hash ||
+      memcmp(record->imem, rsp->imem, RSP_IMEM_SIZE))
+      continue;
+
+    if (GetRecordChecksum(record) != record->checksum)
+      return false;
+
+    for (j = 0; j < RSP_DECODE_CACHE_ENTRIES; j++) {
+      uint32_t iw;
+
+      memcpy(&iw, rsp->imem + j * sizeof(iw), sizeof(iw));
+
+      if (!UnpackInstruction(&cache->entries[j],
+        &record->words[j], ByteOrderSwap32(iw))) {
+        RSPFlushDecodeCache(cache);
+        return false;
+      }
+    }
+
+    for (j = 0; rsp->mode == RSP_MODE_RECOMPILER &&
+      j < RSP_DECODE_CACHE_ENTRIES; j++) {
+      if ((record->blockHeads[j / 32] >> (j % 32) & 1) &&
+        cache->entries[j].valid &&
+        RSPTranslateBlock(rsp, 0x1000 | j << 2) == NULL)
+        break;
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+/* ============================================================================
+ *  RSPLoadCacheFile: Opens a file of decoded microcode for the registry.
+ *  Cache files are only ever used if they are opened this way.
+ *
+ *  Returns zero on success. Files that are truncated or written by some
+ *  other build are ignored (and left alone). The file stays mapped until
+ *  RSPCloseCacheFile; records are only looked at when a microcode that
+ *  isn't in the registry is started.
+ *
+ *  Nothing in the file is run: it holds decoded words (which are checked
+ *  against IMEM and range checked as they are unpacked) and where blocks
+ *  started, which are translated again from those words.
+ * ========================================================================= */
+int
+RSPLoadCacheFile(struct RSP *rsp, const char *path) {
+  const struct RSPCacheFileHeader *header;
+  struct RSPCacheFileHeader expected;
+  const uint8_t *image;
+  size_t size;
+
+  if ((image = MapFile(path, &size)) == NULL)
+    return 1;
+
+  header = (const struct RSPCacheFileHeader*) image;
+  FillHeader(&expected);
+
+  if (size < sizeof(*header) ||
+    memcmp(header->magic, expected.magic, sizeof(header->magic)) ||
+    header->version != expected.version ||
+    header->recordSize != expected.recordSize ||
+    memcmp(header->buildType, expected.buildType, sizeof(header->buildType)) ||
+    header->numScalarOpcodes != expected.numScalarOpcodes ||
+    header->numVectorOpcodes != expected.numVectorOpcodes ||
+    header->numRecords > RSP_CACHE_FILE_MAX_RECORDS ||
+    size != sizeof(*header) +
+      header->numRecords * sizeof(struct RSPCacheRecord)) {
+    debug("Ignoring a stale or corrupt cache file.");
+
+    UnmapFile(image, size);
+    return 2;
+  }
+
+  if (rsp->registry == NULL &&
+    (rsp->registry = CreateRSPRegistry()) == NULL) {
+    UnmapFile(image, size);
+    return 3;
+  }
+
+  RSPCloseCacheFile(rsp);
+  rsp->registry->file = image;
+  rsp->registry->fileSize = size;
+  return 0;
+}
+
+/* ============================================================================
+ *  RSPCloseCacheFile: Unmaps the file opened by RSPLoadCacheFile.
+ * ========================================================================= */
+void
+RSPCloseCacheFile(struct RSP *rsp) {
+  struct RSPRegistry *registry = rsp->registry;
+
+  if (registry != NULL && registry->file != NULL) {
+    UnmapFile(registry->file, registry->fileSize);
+
+    registry->file = NULL;
+    registry->fileSize = 0;
+  }
+}
+
+/* ============================================================================
+ *  RSPSaveCacheFile: Writes out every decoded microcode in the registry,
+ *  followed by those in the open cache file that weren't used this time.
+ *  Block heads are noted for the running microcode and for any slot whose
+ *  blocks are still live.
+ *
+ *  Returns zero on success. The file is written under a temporary name
+ *  and then renamed, so readers never see a partially written file (and
+ *  instances saving at the same time just replace one another's).
+ * ========================================================================= */
+int
+RSPSaveCacheFile(const struct RSP *rsp, const char *path) {
+  const struct RSPRegistry *registry = rsp->registry;
+  struct RSPCacheFileHeader header;
+  struct RSPCacheRecord *records;
+
+  unsigned generation;
+  unsigned i, j, count;
+  unsigned long pid = 0;
+  char *temporary;
+  FILE *file;
+  int status;
+
+  if (registry == NULL)
+    return 0;
+
+  if ((records = (struct RSPCacheRecord*) malloc(
+    RSP_CACHE_FILE_MAX_RECORDS * sizeof(*records))) == NULL) {
+    debug("Failed to allocate memory.");
+    return 1;
+  }
+
+  if ((temporary = (char*) malloc(strlen(path) + RSP_CACHE_FILE_SUFFIX_SIZE))
+    == NULL) {
+    debug("Failed to allocate memory.");
+    free(records);
+    return 1;
+  }
+
+  /* The running microcode's entries are in the decode cache itself. */
+  generation = rsp->recompiler != NULL ? rsp->recompiler->generation : 0;
+
+  for (i = 0, count = 0; i < RSP_REGISTRY_SLOTS; i++) {
+    const struct RSPRegistrySlot *slot = &registry->slots[i];
+
+    if (slot == registry->current &&
+      !memcmp(slot->imem, rsp->imem, RSP_IMEM_SIZE))
+      PackRecord(&records[count++], slot->hash, slot->imem,
+        rsp->decodeCache.entries, rsp->recompiler != NULL);
+
+    else if (slot->used && slot->saved)
+      PackRecord(&records[count++], slot->hash, slot->imem,
+        slot->entries, rsp->recompiler != NULL &&
+        slot->generation == generation);
+  }
+
+  if (registry->file != NULL) {
+    const struct RSPCacheFileHeader *old =
+      (const struct RSPCacheFileHeader*) registry->file;
+    const struct RSPCacheRecord *oldRecords =
+      (const struct RSPCacheRecord*) (old + 1);
+
+    for (i = 0; i < old->numRecords &&
+      count < RSP_CACHE_FILE_MAX_RECORDS; i++) {
+      for (j = 0; j < count; j++) {
+        if (records[j].hash == oldRecords[i].hash)
+          break;
+      }
+
+      if (j < count ||
+        GetRecordChecksum(&oldRecords[i]) != oldRecords[i].checksum)
+        continue;
+
+      memcpy(&records[count++], &oldRecords[i], sizeof(*records));
+    }
+  }
+
+  FillHeader(&header);
+  header.numRecords = count;
+
+  /* Unique to the process and instance, as others may be saving too. */
+#ifdef RSP_HAVE_MMAP
+  pid = (unsigned long) getpid();
+#endif
+
+  sprintf(temporary, "%s.%lx.%lx.tmp", path,
+    pid, (unsigned long) (uintptr_t) rsp);
+
+  status = 2;
+
+  if ((file = fopen(temporary, "wb")) != NULL) {
+    if (fwrite(&header, sizeof(header), 1, file) == 1 &&
+      fwrite(records, sizeof(*records), count, file) == count)
+      status = 0;
+
+    if (fclose(file) || status || rename(temporary, path)) {
+      remove(temporary);
+      status = 2;
+    }
+  }
+
+  free(temporary);
+  free(records);
+  return status;
+}
@@ -0,0 +1,68 @@
+/* ============================================================================
+ *  CacheFile.h: Persistent decode and translation cache.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__CACHEFILE_H__
+#define __RSP__CACHEFILE_H__
+#include "Common.h"
+#include "CPU.h"
+#include "DecodeCache.h"
+#include "Recompiler.h"
+#include "Registry.h"
+
+/* Bump whenever the layout or the meaning of a record changes. */
+#define RSP_CACHE_FILE_MAGIC "RSPSIMDC"
+#define RSP_CACHE_FILE_VERSION 2
+
+/* Decoded instruction, without any pointers. */
+struct RSPCachedInstruction {
+  uint32_t iw;
+  uint32_t infoFlags;
+  uint32_t vectorInfoFlags;
+  int16_t offset;
+  uint8_t id, vectorId;
+  uint8_t rs, rt, rd, sa;
+  uint8_t element, dest;
+  uint8_t valid, reserved;
+};
+
+/* Caps the size of the file (each record is ~28KiB). */
+#define RSP_CACHE_FILE_MAX_RECORDS 64
+
+/* One microcode; the hash is that of the IMEM image, and the */
+/* checksum is that of the words and block heads (which follow */
+/* it). Only where blocks started is kept, never their code: */
+/* they are translated again when the record is used. */
+struct RSPCacheRecord {
+  uint64_t hash;
+  uint64_t checksum;
+
+  uint8_t imem[RSP_IMEM_SIZE];
+  struct RSPCachedInstruction words[RSP_DECODE_CACHE_ENTRIES];
+  uint32_t blockHeads[RSP_DECODE_CACHE_ENTRIES / 32];
+};
+
+/* The records follow the header, back to back. */
+struct RSPCacheFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t recordSize;
+  char buildType[16];
+  uint16_t numScalarOpcodes;
+  uint16_t numVectorOpcodes;
+  uint32_t numRecords;
+};
+
+int RSPLoadCacheFile(struct RSP *, const char *);
+int RSPSaveCacheFile(const struct RSP *, const char *);
+void RSPCloseCacheFile(struct RSP *);
+
+bool RSPFetchCachedMicrocode(struct RSP *, uint64_t);
+
+#endif
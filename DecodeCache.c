@@ -0,0 +1,334 @@
+/* ============================================================================
+ *  DecodeCache.c: Pre-decoded instruction cache.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CPU.h"
+#include "DecodeCache.h"
+#include "Decoder.h"
+#include "Opcodes.h"
+
+#ifdef __cplusplus
+#include <cstring>
+#else
+#include <string.h>
+#endif
+
+/* ============================================================================
+ *  RSPResetInstruction: What the RD stage sees before the first fetch.
+ *  An all-zero instruction word decodes as SLL $zero, $zero, 0.
+ * ========================================================================= */
+const struct RSPDecodedInstruction RSPResetInstruction = {
+  {SLL}, {VINVALID}, RSPSLL, RSPVINV, 0, 0, 0, 0, 0, 0, 0, 0, true, NULL
+};
+
+/* ============================================================================
+ *  DecodeDestination: Determines which register an instruction writes.
+ * ========================================================================= */
+static unsigned
+DecodeDestination(enum RSPOpcodeID id, uint32_t iw) {
+  switch (id) {
+    case RSP_OPCODE_ADDI: case RSP_OPCODE_ANDI: case RSP_OPCODE_CFC2:
+    case RSP_OPCODE_LB: case RSP_OPCODE_LBU: case RSP_OPCODE_LH:
+    case RSP_OPCODE_LHU: case RSP_OPCODE_LUI: case RSP_OPCODE_LW:
+    case RSP_OPCODE_MFC0: case RSP_OPCODE_MFC2: case RSP_OPCODE_ORI:
+    case RSP_OPCODE_SLTI: case RSP_OPCODE_SLTIU: case RSP_OPCODE_XORI:
+      return GET_RT(iw);
+
+    case RSP_OPCODE_ADD: case RSP_OPCODE_AND: case RSP_OPCODE_NOR:
+    case RSP_OPCODE_OR: case RSP_OPCODE_SLL: case RSP_OPCODE_SLLV:
+    case RSP_OPCODE_SLT: case RSP_OPCODE_SLTU: case RSP_OPCODE_SRA:
+    case RSP_OPCODE_SRAV: case RSP_OPCODE_SRL: case RSP_OPCODE_SRLV:
+    case RSP_OPCODE_SUB: case RSP_OPCODE_XOR:
+      return GET_RD(iw);
+
+    case RSP_OPCODE_BGEZAL: case RSP_OPCODE_BLTZAL:
+    case RSP_OPCODE_JAL: case RSP_OPCODE_JALR:
+      return RSP_LINK_REGISTER;
+
+    default:
+      break;
+  }
+
+  return 0;
+}
+
+/* ============================================================================
+ *  RSPDecodeInstructionWord: Decodes an instruction word into an entry.
+ * ========================================================================= */
+void
+RSPDecodeInstructionWord(struct RSPDecodedInstruction *decoded, uint32_t iw) {
+  const struct RSPOpcode *opcode = RSPDecodeInstruction(iw);
+  uint32_t infoFlags = opcode->infoFlags;
+
+  decoded->opcode = *opcode;
+  decoded->scalarFunction = RSPScalarFunctionTable[opcode->id];
+
+  if (infoFlags & OPCODE_INFO_VCOMP)
+    decoded->vectorOpcode = *RSPDecodeVectorInstruction(iw);
+  else
+    RSPInvalidateVectorOpcode(&decoded->vectorOpcode);
+
+  decoded->iw = iw;
+  decoded->rs = GET_RS(iw);
+  decoded->rt = GET_RT(iw);
+  decoded->rd = GET_RD(iw);
+  decoded->sa = iw >> 6 & 0x1F;
+  decoded->dest = DecodeDestination(opcode->id, iw);
+  decoded->block = NULL;
+
+  /* LWC2/SWC2 use a 7-bit offset, with the element in the middle. */
+  if (infoFlags & (OPCODE_INFO_LWC2 | OPCODE_INFO_SWC2)) {
+    decoded->offset = (int16_t) ((iw & 0x7F) << 9) >> 9;
+    decoded->element = iw >> 7 & 0xF;
+  }
+
+  else if (opcode->id == RSP_OPCODE_MFC2 || opcode->id == RSP_OPCODE_MTC2) {
+    decoded->offset = 0;
+    decoded->element = iw >> 7 & 0xF;
+  }
+
+  else if (infoFlags & OPCODE_INFO_VCOMP) {
+    decoded->offset = 0;
+    decoded->element = iw >> 21 & 0xF;
+  }
+
+  else {
+    decoded->offset = (int16_t) iw;
+    decoded->element = 0;
+  }
+
+  /* Picked for the form of element, which is known by now. */
+  decoded->vectorFunction = RSPVectorFormFunctions[RSPGetElementForm(
+    decoded->element)][decoded->vectorOpcode.id];
+
+  decoded->valid = true;
+}
+
+/* ============================================================================
+ *  RSPFillDecodeCache: Decodes the IMEM word at a given PC into the cache.
+ * ========================================================================= */
+const struct RSPDecodedInstruction *
+RSPFillDecodeCache(struct RSPDecodeCache *cache,
+  const uint8_t *imem, uint32_t pc) {
+  struct RSPDecodedInstruction *decoded =
+    &cache->entries[pc >> 2 & RSP_DECODE_CACHE_MASK];
+  uint32_t iw;
+
+  memcpy(&iw, imem + (pc & 0xFFC), sizeof(iw));
+  RSPDecodeInstructionWord(decoded, ByteOrderSwap32(iw));
+  return decoded;
+}
+
+/* ============================================================================
+ *  RSPFlushDecodeCache: Invalidates every entry in the cache.
+ *  Required if IMEM is modified directly (i.e., via GetRSPIMEMPtr).
+ * ========================================================================= */
+void
+RSPFlushDecodeCache(struct RSPDecodeCache *cache) {
+  unsigned i;
+
+  for (i = 0; i < RSP_DECODE_CACHE_ENTRIES; i++) {
+    cache->entries[i].valid = false;
+    cache->entries[i].block = NULL;
+  }
+}
+
+/* ============================================================================
+ *  RSPInvalidateDecodeCache: Invalidates entries covering an IMEM range.
+ *
+ *  Entries keep their contents when invalidated; a stage holding onto an
+ *  entry that was fetched before the write still sees the old instruction.
+ *  Any recompiled block that might cover the range is dropped as well.
+ * ========================================================================= */
+void
+RSPInvalidateDecodeCache(struct RSPDecodeCache *cache,
+  uint32_t address, uint32_t length) {
+  uint32_t first = (address & 0xFFF) >> 2;
+  uint32_t last = ((address & 0xFFF) + length - 1) >> 2;
+  uint32_t i;
+
+  for (i = first; i <= last; i++)
+    cache->entries[i & RSP_DECODE_CACHE_MASK].valid = false;
+
+  for (i = first - (RSP_MAX_BLOCK_WORDS - 1); i != last + 1; i++)
+    cache->entries[i & RSP_DECODE_CACHE_MASK].block = NULL;
+}
+
+
+/* ============================================================================
+ *  RSPMatchFusedIdiom: Checks if a run of decoded instructions starts with
+ *  one of the fused idioms (see enum RSPFusedIdiom). Returns the number of
+ *  instructions it spans (zero if there wasn't one), and sets `idiom`.
+ * ========================================================================= */
+unsigned
+RSPMatchFusedIdiom(const struct RSPDecodedInstruction **instructions,
+  unsigned count, enum RSPFusedIdiom *idiom) {
+  static const struct {
+    unsigned length;
+    enum RSPVOpcodeID ids[4];
+  } idioms[NUM_RSP_FUSED_IDIOMS] = {
+    {4, {RSP_OPCODE_VMUDL, RSP_OPCODE_VMADM,
+      RSP_OPCODE_VMADN, RSP_OPCODE_VMADH}},
+    {2, {RSP_OPCODE_VMULF, RSP_OPCODE_VMACF}},
+  };
+
+  unsigned i, j;
+
+  for (i = 0; i < NUM_RSP_FUSED_IDIOMS; i++) {
+    if (idioms[i].length > count)
+      continue;
+
+    for (j = 0; j < idioms[i].length; j++) {
+      const struct RSPDecodedInstruction *decoded = instructions[j];
+
+      if (!(decoded->opcode.infoFlags & OPCODE_INFO_VCOMP) ||
+        decoded->vectorOpcode.id != idioms[i].ids[j])
+        break;
+    }
+
+    if (j == idioms[i].length) {
+      *idiom = (enum RSPFusedIdiom) i;
+      return j;
+    }
+  }
+
+  return 0;
+}
+
+/* ============================================================================
+ *  RSPFindDeadAccumulatorWrites: Works back through a run of decoded
+ *  instructions that always runs as a whole, and marks (in `dead`) the ones
+ *  that write all of the accumulator only for a later one to write all of
+ *  it again before anything reads it. Whatever the run leaves behind in the
+ *  accumulator is taken to be read after it.
+ * ========================================================================= */
+void
+RSPFindDeadAccumulatorWrites(const struct RSPDecodedInstruction **instructions,
+  unsigned count, bool *dead) {
+  bool live = true;
+  unsigned i;
+
+  for (i = count; i-- > 0; ) {
+    const struct RSPDecodedInstruction *decoded = instructions[i];
+
+    dead[i] = false;
+
+    if (!(decoded->opcode.infoFlags & OPCODE_INFO_VCOMP))
+      continue;
+
+    switch (decoded->vectorOpcode.id) {
+      /* Write all of it, without reading any. */
+      case RSP_OPCODE_VMUDH:
+      case RSP_OPCODE_VMUDL:
+      case RSP_OPCODE_VMUDM:
+      case RSP_OPCODE_VMUDN:
+      case RSP_OPCODE_VMULF:
+      case RSP_OPCODE_VMULQ:
+      case RSP_OPCODE_VMULU:
+        dead[i] = !live;
+        live = false;
+        break;
+
+      /* Write the low word only, without reading any. */
+      case RSP_OPCODE_VABS: case RSP_OPCODE_VADD: case RSP_OPCODE_VADDC:
+      case RSP_OPCODE_VAND: case RSP_OPCODE_VCH: case RSP_OPCODE_VCL:
+      case RSP_OPCODE_VCR: case RSP_OPCODE_VEQ: case RSP_OPCODE_VGE:
+      case RSP_OPCODE_VLT: case RSP_OPCODE_VMOV: case RSP_OPCODE_VMRG:
+      case RSP_OPCODE_VNAND: case RSP_OPCODE_VNE: case RSP_OPCODE_VNOR:
+      case RSP_OPCODE_VNXOR: case RSP_OPCODE_VOR: case RSP_OPCODE_VRCP:
+      case RSP_OPCODE_VRCPH: case RSP_OPCODE_VRCPL: case RSP_OPCODE_VRSQ:
+      case RSP_OPCODE_VRSQH: case RSP_OPCODE_VRSQL: case RSP_OPCODE_VSUB:
+      case RSP_OPCODE_VSUBC: case RSP_OPCODE_VXOR:
+        break;
+
+      /* Everything else may read it. */
+      default:
+        live = true;
+        break;
+    }
+  }
+}
+
+/* ============================================================================
+ *  RSPFindDeadFlagWrites: Works back through a run of decoded instructions
+ *  that always runs as a whole, and marks (in `dead`) the carries and the
+ *  compares whose own flag register (VCO for VADDC/VSUBC, VCC for the
+ *  compares) is written again before anything reads it. As above, the run
+ *  leaves all of the flags live behind it; CFC2 and CTC2 read all of them.
+ * ========================================================================= */
+void
+RSPFindDeadFlagWrites(const struct RSPDecodedInstruction **instructions,
+  unsigned count, bool *dead) {
+  enum {VCO = 1 << 0, VCC = 1 << 1, VCE = 1 << 2};
+  unsigned live = VCO | VCC | VCE;
+  unsigned i;
+
+  for (i = count; i-- > 0; ) {
+    const struct RSPDecodedInstruction *decoded = instructions[i];
+    unsigned reads = 0, writes = 0;
+
+    dead[i] = false;
+
+    if (!(decoded->opcode.infoFlags & OPCODE_INFO_VCOMP)) {
+      if (decoded->opcode.id == RSP_OPCODE_CFC2 ||
+        decoded->opcode.id == RSP_OPCODE_CTC2)
+        live = VCO | VCC | VCE;
+
+      continue;
+    }
+
+    switch (decoded->vectorOpcode.id) {
+      case RSP_OPCODE_VADD: case RSP_OPCODE_VSUB:
+        reads = writes = VCO;
+        break;
+
+      case RSP_OPCODE_VADDC: case RSP_OPCODE_VSUBC:
+        dead[i] = !(live & VCO);
+        writes = VCO;
+        break;
+
+      case RSP_OPCODE_VEQ: case RSP_OPCODE_VGE:
+      case RSP_OPCODE_VLT: case RSP_OPCODE_VNE:
+        dead[i] = !(live & VCC);
+        reads = VCO;
+        writes = VCO | VCC;
+        break;
+
+      case RSP_OPCODE_VCH: case RSP_OPCODE_VCR:
+        writes = VCO | VCC | VCE;
+        break;
+
+      case RSP_OPCODE_VMRG:
+        reads = VCC;
+        break;
+
+      /* Leave the flags alone. */
+      case RSP_OPCODE_VABS: case RSP_OPCODE_VAND: case RSP_OPCODE_VMACF:
+      case RSP_OPCODE_VMACQ: case RSP_OPCODE_VMACU: case RSP_OPCODE_VMADH:
+      case RSP_OPCODE_VMADL: case RSP_OPCODE_VMADM: case RSP_OPCODE_VMADN:
+      case RSP_OPCODE_VMOV: case RSP_OPCODE_VMUDH: case RSP_OPCODE_VMUDL:
+      case RSP_OPCODE_VMUDM: case RSP_OPCODE_VMUDN: case RSP_OPCODE_VMULF:
+      case RSP_OPCODE_VMULQ: case RSP_OPCODE_VMULU: case RSP_OPCODE_VNAND:
+      case RSP_OPCODE_VNOP: case RSP_OPCODE_VNOR: case RSP_OPCODE_VNXOR:
+      case RSP_OPCODE_VOR: case RSP_OPCODE_VRCP: case RSP_OPCODE_VRCPH:
+      case RSP_OPCODE_VRCPL: case RSP_OPCODE_VRNDN: case RSP_OPCODE_VRNDP:
+      case RSP_OPCODE_VRSQ: case RSP_OPCODE_VRSQH: case RSP_OPCODE_VRSQL:
+      case RSP_OPCODE_VSAR: case RSP_OPCODE_VXOR:
+        break;
+
+      /* Everything else (VCL included) may read all of them. */
+      default:
+        reads = VCO | VCC | VCE;
+        break;
+    }
+
+    live = (live & ~writes) | reads;
+  }
+}
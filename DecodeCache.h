@@ -0,0 +1,84 @@
+/* ============================================================================
+ *  DecodeCache.h: Pre-decoded instruction cache.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__DECODECACHE_H__
+#define __RSP__DECODECACHE_H__
+#include "Common.h"
+#include "Decoder.h"
+#include "Opcodes.h"
+
+#define RSP_DECODE_CACHE_ENTRIES (4096 / 4)
+#define RSP_DECODE_CACHE_MASK (RSP_DECODE_CACHE_ENTRIES - 1)
+
+/* Recompiled blocks never span more than this many words. */
+#define RSP_MAX_BLOCK_WORDS 32
+
+struct RSPBlock;
+
+/* One entry for every word of IMEM. */
+struct RSPDecodedInstruction {
+  struct RSPOpcode opcode;
+  struct RSPVOpcode vectorOpcode;
+
+  /* The vector one is from the table for its element form. */
+  void (*scalarFunction)(struct RSP *, uint32_t, uint32_t);
+  void (*vectorFunction)(struct RSPCP2 *,
+    int16_t *, const int16_t *, const int16_t *, unsigned);
+
+  /* Vector computational instructions use rt/rd/sa as vt/vs/vd. */
+  /* Offset is the sign-extended immediate (or LWC2/SWC2 offset). */
+  /* Dest is the scalar register the instruction writes back, if any. */
+  uint32_t iw;
+  int16_t offset;
+  uint8_t rs, rt, rd, sa;
+  uint8_t element, dest;
+  bool valid;
+
+  /* Recompiled block starting at this word, if any. */
+  const struct RSPBlock *block;
+};
+
+struct RSPDecodeCache {
+  struct RSPDecodedInstruction entries[RSP_DECODE_CACHE_ENTRIES];
+};
+
+extern const struct RSPDecodedInstruction RSPResetInstruction;
+
+void RSPDecodeInstructionWord(struct RSPDecodedInstruction *, uint32_t);
+const struct RSPDecodedInstruction *RSPFillDecodeCache(
+  struct RSPDecodeCache *, const uint8_t *, uint32_t);
+
+void RSPFlushDecodeCache(struct RSPDecodeCache *);
+void RSPInvalidateDecodeCache(struct RSPDecodeCache *, uint32_t, uint32_t);
+
+unsigned RSPMatchFusedIdiom(const struct RSPDecodedInstruction **,
+  unsigned, enum RSPFusedIdiom *);
+void RSPFindDeadAccumulatorWrites(const struct RSPDecodedInstruction **,
+  unsigned, bool *);
+void RSPFindDeadFlagWrites(const struct RSPDecodedInstruction **,
+  unsigned, bool *);
+
+/* ============================================================================
+ *  RSPGetDecodedInstruction: Returns the decoded IMEM word at a given PC.
+ * ========================================================================= */
+static inline const struct RSPDecodedInstruction *
+RSPGetDecodedInstruction(struct RSPDecodeCache *cache,
+  const uint8_t *imem, uint32_t pc) {
+  const struct RSPDecodedInstruction *decoded =
+    &cache->entries[pc >> 2 & RSP_DECODE_CACHE_MASK];
+
+  if (likely(decoded->valid))
+    return decoded;
+
+  return RSPFillDecodeCache(cache, imem, pc);
+}
+
+#endif
+
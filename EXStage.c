@@ -12,6 +12,7 @@
 #include "CPU.h"
 #include "Definitions.h"
 #include "EXStage.h"
+#include "IdleLoop.h"
 #include "Memory.h"
 #include "Pipeline.h"
 
@@ -23,6 +24,15 @@
 #include <string.h>
 #endif
 
+/* ============================================================================
+ *  WatchBranch: Shows a taken branch to the idle loop detector, if armed.
+ * ========================================================================= */
+static inline void
+WatchBranch(struct RSP *rsp) {
+  if (unlikely(rsp->idleLoop.armed))
+    RSPCheckIdleLoop(rsp);
+}
+
 /* ============================================================================
  *  Instruction: ADD{,U} (Add Signed/Unsigned)
  * ========================================================================= */
@@ -97,6 +107,7 @@ RSPBEQ(struct RSP *rsp, uint32_t rs, uint32_t rt) {
   ifrdLatch->pc &= 0xFFC;
   ifrdLatch->pc |= 0x1000;
   rsp->didBranch = 1;
+  WatchBranch(rsp);
 }
 
 /* ============================================================================
@@ -115,6 +126,7 @@ RSPBGEZ(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
   ifrdLatch->pc &= 0xFFC;
   ifrdLatch->pc |= 0x1000;
   rsp->didBranch = 1;
+  WatchBranch(rsp);
 }
 
 /* ============================================================================
@@ -137,6 +149,7 @@ RSPBGEZAL(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
   ifrdLatch->pc &= 0xFFC;
   ifrdLatch->pc |= 0x1000;
   rsp->didBranch = 1;
+  WatchBranch(rsp);
 }
 
 /* ============================================================================
@@ -155,6 +168,7 @@ RSPBGTZ(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
   ifrdLatch->pc &= 0xFFC;
   ifrdLatch->pc |= 0x1000;
   rsp->didBranch = 1;
+  WatchBranch(rsp);
 }
 
 /* ============================================================================
@@ -173,6 +187,7 @@ RSPBLEZ(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
   ifrdLatch->pc &= 0xFFC;
   ifrdLatch->pc |= 0x1000;
   rsp->didBranch = 1;
+  WatchBranch(rsp);
 }
 
 /* ============================================================================
@@ -191,6 +206,7 @@ RSPBLTZ(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
   ifrdLatch->pc &= 0xFFC;
   ifrdLatch->pc |= 0x1000;
   rsp->didBranch = 1;
+  WatchBranch(rsp);
 }
 
 /* ============================================================================
@@ -213,6 +229,7 @@ RSPBLTZAL(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
   ifrdLatch->pc &= 0xFFC;
   ifrdLatch->pc |= 0x1000;
   rsp->didBranch = 1;
+  WatchBranch(rsp);
 }
 
 /* ============================================================================
@@ -231,6 +248,7 @@ RSPBNE(struct RSP *rsp, uint32_t rs, uint32_t rt) {
   ifrdLatch->pc &= 0xFFC;
   ifrdLatch->pc |= 0x1000;
   rsp->didBranch = 1;
+  WatchBranch(rsp);
 }
 
 /* ============================================================================
@@ -239,6 +257,7 @@ RSPBNE(struct RSP *rsp, uint32_t rs, uint32_t rt) {
 void
 RSPBREAK(struct RSP *rsp, uint32_t unused(rs), uint32_t unused(rt)) {
   rsp->cp0.regs[SP_STATUS_REG] |= (SP_STATUS_HALT | SP_STATUS_BROKE);
+  rsp->events |= RSP_EVENT_BREAK;
 
   if (rsp->cp0.regs[SP_STATUS_REG] & SP_STATUS_INTR_BREAK)
     BusRaiseRCPInterrupt(rsp->bus, MI_INTR_SP);
@@ -257,10 +276,10 @@ RSPCFC2(struct RSP *rsp, uint32_t unused(rs), uint32_t unused(rt)) {
   unsigned data;
 
   switch (source & 3) {
-    case 0: data = (int) ((short) RSPGetVCO(&rsp->cp2)); break;
-    case 1: data = (int) ((short) rsp->cp2.vcc); break;
-    case 2: data = rsp->cp2.vce; break;
-    case 3: data = rsp->cp2.vce; break;
+    case 0: data = (int) ((short) RSPGetFlagBits(&rsp->cp2.vco)); break;
+    case 1: data = (int) ((short) RSPGetFlagBits(&rsp->cp2.vcc)); break;
+    case 2: data = RSPGetFlagBits(&rsp->cp2.vce); break;
+    case 3: data = RSPGetFlagBits(&rsp->cp2.vce); break;
   }
 
   exdfLatch->result.data = data;
@@ -276,10 +295,10 @@ RSPCTC2(struct RSP *rsp, uint32_t unused(rs), uint32_t rt) {
   unsigned dest = rdexLatch->iw >> 11 & 0x1F;
 
   switch (dest & 3) {
-    case 0: RSPSetVCO(&rsp->cp2, rt); break;
-    case 1: rsp->cp2.vcc = rt; break;
-    case 2: rsp->cp2.vce = rt; break;
-    case 3: rsp->cp2.vce = rt; break;
+    case 0: RSPSetFlagBits(&rsp->cp2.vco, rt); break;
+    case 1: RSPSetFlagBits(&rsp->cp2.vcc, rt); break;
+    case 2: RSPSetFlagBits(&rsp->cp2.vce, rt & 0xFF); break;
+    case 3: RSPSetFlagBits(&rsp->cp2.vce, rt & 0xFF); break;
   }
 }
 
@@ -300,6 +319,7 @@ RSPJ(struct RSP *rsp, uint32_t unused(rs), uint32_t unused(rt)) {
   ifrdLatch->pc = (rdexLatch->iw & 0x3FF) << 2;
   ifrdLatch->pc |= 0x1000;
   rsp->didBranch = 1;
+  WatchBranch(rsp);
 }
 
 /* ============================================================================
@@ -316,6 +336,7 @@ RSPJAL(struct RSP *rsp, uint32_t unused(rs), uint32_t unused(rt)) {
   ifrdLatch->pc = (rdexLatch->iw & 0x3FF) << 2;
   ifrdLatch->pc |= 0x1000;
   rsp->didBranch = 1;
+  WatchBranch(rsp);
 }
 
 /* ============================================================================
@@ -331,6 +352,7 @@ RSPJALR(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
   ifrdLatch->pc = rs;
   ifrdLatch->pc |= 0x1000;
   rsp->didBranch = 1;
+  WatchBranch(rsp);
 }
 
 /* ============================================================================
@@ -343,6 +365,7 @@ RSPJR(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
   ifrdLatch->pc = rs & 0xFFC;
   ifrdLatch->pc |= 0x1000;
   rsp->didBranch = 1;
+  WatchBranch(rsp);
 }
 
 /* ============================================================================
@@ -764,6 +787,7 @@ RSPSB(struct RSP *rsp, uint32_t rs, uint32_t rt) {
 
   exdfLatch->memoryData.data = rt;
   exdfLatch->memoryData.function = &StoreByte;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + offset;
 }
 
@@ -782,6 +806,7 @@ RSPSBV(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
 
   exdfLatch->memoryData.target = &rsp->cp2.regs[dest];
   exdfLatch->memoryData.function = &StoreByteVector;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + offset;
   exdfLatch->memoryData.element = element;
 }
@@ -801,6 +826,7 @@ RSPSDV(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
 
   exdfLatch->memoryData.target = &rsp->cp2.regs[dest];
   exdfLatch->memoryData.function = &StoreDoubleVector;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + (offset << 3);
   exdfLatch->memoryData.element = element;
 }
@@ -820,6 +846,7 @@ RSPSFV(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
 
   exdfLatch->memoryData.target = &rsp->cp2.regs[dest];
   exdfLatch->memoryData.function = &StorePackedFourthVector;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + (offset << 4);
   exdfLatch->memoryData.element = element;
 }
@@ -836,6 +863,7 @@ RSPSH(struct RSP *rsp, uint32_t rs, uint32_t rt) {
 
   exdfLatch->memoryData.data = rt;
   exdfLatch->memoryData.function = &StoreHalf;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + offset;
 }
 
@@ -854,6 +882,7 @@ RSPSHV(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
 
   exdfLatch->memoryData.target = &rsp->cp2.regs[dest];
   exdfLatch->memoryData.function = &StorePackedHalfVector;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + (offset << 4);
   exdfLatch->memoryData.element = element;
 }
@@ -903,6 +932,7 @@ RSPSLV(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
 
   exdfLatch->memoryData.target = &rsp->cp2.regs[dest];
   exdfLatch->memoryData.function = &StoreLongVector;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + (offset << 2);
   exdfLatch->memoryData.element = element;
 }
@@ -980,6 +1010,7 @@ RSPSPV(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
 
   exdfLatch->memoryData.target = &rsp->cp2.regs[dest];
   exdfLatch->memoryData.function = &StorePackedByteVector;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + (offset << 3);
   exdfLatch->memoryData.element = element;
 }
@@ -999,6 +1030,7 @@ RSPSQV(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
 
   exdfLatch->memoryData.target = &rsp->cp2.regs[dest];
   exdfLatch->memoryData.function = &StoreQuadVector;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + (offset << 4);
   exdfLatch->memoryData.element = element;
 }
@@ -1078,6 +1110,7 @@ RSPSRV(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
 
   exdfLatch->memoryData.target = &rsp->cp2.regs[dest];
   exdfLatch->memoryData.function = &StoreRestVector;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + (offset << 4);
   exdfLatch->memoryData.element = element;
 }
@@ -1097,6 +1130,7 @@ RSPSSV(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
 
   exdfLatch->memoryData.target = &rsp->cp2.regs[dest];
   exdfLatch->memoryData.function = &StoreShortVector;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + (offset << 1);
   exdfLatch->memoryData.element = element;
 }
@@ -1120,6 +1154,7 @@ RSPSTV(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
 
   exdfLatch->memoryData.target = &rsp->cp2.regs[NUM_RSP_VP_REGISTERS];
   exdfLatch->memoryData.function = &StoreTransposeVector;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + (offset << 4);
   exdfLatch->memoryData.element = element;
 
@@ -1146,6 +1181,7 @@ RSPSUV(struct RSP *rsp, uint32_t rs, uint32_t unused(rt)) {
 
   exdfLatch->memoryData.target = &rsp->cp2.regs[dest];
   exdfLatch->memoryData.function = &StorePackedVector;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + (offset << 3);
   exdfLatch->memoryData.element = element;
 }
@@ -1176,6 +1212,7 @@ RSPSW(struct RSP *rsp, uint32_t rs, uint32_t rt) {
 
   exdfLatch->memoryData.data = rt;
   exdfLatch->memoryData.function = &StoreWord;
+  exdfLatch->memoryData.dirtyLines = rsp->dirtyLines;
   exdfLatch->memoryData.offset = rs + offset;
 }
 
@@ -32,6 +32,7 @@ void BusRaiseRCPInterrupt(struct BusController *, unsigned);
 
 int DPRegRead(void *, uint32_t, void *);
 int DPRegWrite(void *, uint32_t, void *);
+void RDPSetRSPDMEMPointer(struct RDP *, uint8_t *);
 
 #endif
 
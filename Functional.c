@@ -0,0 +1,250 @@
+/* ============================================================================
+ *  Functional.c: Functional (untimed) execution.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CP0.h"
+#include "CP2.h"
+#include "CPU.h"
+#include "DecodeCache.h"
+#include "DFStage.h"
+#include "Functional.h"
+#include "Opcodes.h"
+#include "Pipeline.h"
+#include "WBStage.h"
+
+#ifdef __cplusplus
+#include <cstring>
+#else
+#include <string.h>
+#endif
+
+/* Labels as values are a GNU extension. */
+#if defined(__GNUC__) && !defined(RSP_NO_THREADED_DISPATCH)
+#define RSP_THREADED_DISPATCH
+#endif
+
+/* ============================================================================
+ *  ExecuteInstruction: Executes and retires one (already fetched) instruction.
+ * ========================================================================= */
+static inline void
+ExecuteInstruction(struct RSP *rsp,
+  const struct RSPDecodedInstruction *decoded, uint32_t pc) {
+  struct RSPRDEXLatch *rdexLatch = &rsp->pipeline.rdexLatch;
+  struct RSPEXDFLatch *exdfLatch = &rsp->pipeline.exdfLatch;
+
+  if (decoded->opcode.infoFlags & OPCODE_INFO_VCOMP) {
+    struct RSPCP2 *cp2 = &rsp->cp2;
+
+    cp2->iw = decoded->iw;
+    decoded->vectorFunction(cp2, cp2->regs[decoded->sa].slices,
+      cp2->regs[decoded->rd].slices, cp2->regs[decoded->rt].slices,
+      decoded->element);
+
+#ifndef NDEBUG
+    cp2->counts[decoded->vectorOpcode.id]++;
+#endif
+    return;
+  }
+
+  rdexLatch->iw = decoded->iw;
+  rdexLatch->pc = pc + 4;
+  exdfLatch->result.dest = 0;
+
+  decoded->scalarFunction(rsp,
+    rsp->regs[decoded->rs], rsp->regs[decoded->rt]);
+
+  /* Only memory operations need to go through DF. */
+  if (exdfLatch->memoryData.function != NULL) {
+    RSPDFStage(rsp);
+    RSPWBStage(rsp);
+  }
+
+  else
+    rsp->regs[exdfLatch->result.dest] = exdfLatch->result.data;
+
+  rsp->regs[RSP_REGISTER_ZERO] = 0;
+
+#ifndef NDEBUG
+  rsp->pipeline.counts[decoded->opcode.id]++;
+#endif
+}
+
+/* ============================================================================
+ *  RunTableDispatch: Executes instructions, calling through the decoded
+ *  function pointers (i.e., the opcode tables) for each one.
+ * ========================================================================= */
+static unsigned
+RunTableDispatch(struct RSP *rsp, unsigned i, unsigned count) {
+  struct RSPIFRDLatch *ifrdLatch = &rsp->pipeline.ifrdLatch;
+  const struct RSPDecodedInstruction *decoded = ifrdLatch->decoded;
+  uint32_t pc = ifrdLatch->fetchedPC;
+
+  for (; i < count && likely(!rsp->events); i++) {
+    const struct RSPDecodedInstruction *current = decoded;
+    uint32_t currentPC = pc;
+
+    pc = ifrdLatch->pc;
+    ifrdLatch->pc = ((pc + 4) & 0xFFC) | 0x1000;
+    decoded = RSPGetDecodedInstruction(&rsp->decodeCache, rsp->imem, pc);
+
+    ExecuteInstruction(rsp, current, currentPC);
+  }
+
+  ifrdLatch->fetchedPC = pc;
+  ifrdLatch->decoded = decoded;
+  ifrdLatch->firstIW = decoded->iw;
+  return i;
+}
+
+#ifdef RSP_THREADED_DISPATCH
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+/* ============================================================================
+ *  RunThreadedDispatch: Executes instructions, jumping straight from the
+ *  end of one instruction's body to the next's (computed goto).
+ *
+ *  Every opcode gets its own copy of the fetch/dispatch sequence, which
+ *  branch predictors handle far better than one shared indirect call.
+ *  The scalar bodies are direct calls to the handlers that the X-macro
+ *  tables declare, so the compiler is free to inline them into the loop.
+ *  The vector bodies call the function that was decoded for the word, so
+ *  they run whichever backend (and element form) the host was given.
+ * ========================================================================= */
+static unsigned
+RunThreadedDispatch(struct RSP *rsp, unsigned i, unsigned count) {
+  static const void *const labels[NUM_RSP_SCALAR_OPCODES +
+    NUM_RSP_VECTOR_OPCODES] = {
+#define X(op) &&Scalar##op,
+#include "ScalarOpcodes.md"
+#undef X
+#define X(op) &&Vector##op,
+#include "VectorOpcodes.md"
+#undef X
+  };
+
+  struct RSPIFRDLatch *ifrdLatch = &rsp->pipeline.ifrdLatch;
+  struct RSPRDEXLatch *rdexLatch = &rsp->pipeline.rdexLatch;
+  struct RSPEXDFLatch *exdfLatch = &rsp->pipeline.exdfLatch;
+  struct RSPCP2 *cp2 = &rsp->cp2;
+
+  const struct RSPDecodedInstruction *decoded = ifrdLatch->decoded;
+  const struct RSPDecodedInstruction *current;
+  uint32_t pc = ifrdLatch->fetchedPC, currentPC;
+
+#define DISPATCH() do { \
+  if (unlikely(i >= count || rsp->events)) \
+    goto done; \
+  \
+  current = decoded; \
+  currentPC = pc; \
+  pc = ifrdLatch->pc; \
+  ifrdLatch->pc = ((pc + 4) & 0xFFC) | 0x1000; \
+  decoded = RSPGetDecodedInstruction(&rsp->decodeCache, rsp->imem, pc); \
+  i++; \
+  \
+  goto *labels[(current->opcode.infoFlags & OPCODE_INFO_VCOMP) \
+    ? NUM_RSP_SCALAR_OPCODES + current->vectorOpcode.id \
+    : current->opcode.id]; \
+} while (0)
+
+#ifndef NDEBUG
+#define COUNT_SCALAR(id) rsp->pipeline.counts[id]++
+#define COUNT_VECTOR(id) cp2->counts[id]++
+#else
+#define COUNT_SCALAR(id) do {} while (0)
+#define COUNT_VECTOR(id) do {} while (0)
+#endif
+
+  DISPATCH();
+
+#define X(op) \
+Scalar##op: \
+  rdexLatch->iw = current->iw; \
+  rdexLatch->pc = currentPC + 4; \
+  exdfLatch->result.dest = 0; \
+  \
+  RSP##op(rsp, rsp->regs[current->rs], rsp->regs[current->rt]); \
+  \
+  if (exdfLatch->memoryData.function != NULL) { \
+    RSPDFStage(rsp); \
+    RSPWBStage(rsp); \
+  } \
+  \
+  else \
+    rsp->regs[exdfLatch->result.dest] = exdfLatch->result.data; \
+  \
+  rsp->regs[RSP_REGISTER_ZERO] = 0; \
+  COUNT_SCALAR(RSP_OPCODE_##op); \
+  DISPATCH();
+#include "ScalarOpcodes.md"
+#undef X
+
+#define X(op) \
+Vector##op: \
+  cp2->iw = current->iw; \
+  current->vectorFunction(cp2, cp2->regs[current->sa].slices, \
+    cp2->regs[current->rd].slices, cp2->regs[current->rt].slices, \
+    current->element); \
+  \
+  COUNT_VECTOR(RSP_OPCODE_##op); \
+  DISPATCH();
+#include "VectorOpcodes.md"
+#undef X
+
+#undef COUNT_VECTOR
+#undef COUNT_SCALAR
+#undef DISPATCH
+
+done:
+  ifrdLatch->fetchedPC = pc;
+  ifrdLatch->decoded = decoded;
+  ifrdLatch->firstIW = decoded->iw;
+  return i;
+}
+
+#pragma GCC diagnostic pop
+#endif
+
+/* ============================================================================
+ *  RSPRunFunctional: Executes up to a given number of instructions, with
+ *  no regard for timing. Stops early on the same events as RunRSP.
+ *
+ *  Instructions run in program order, using the same functions as the
+ *  pipeline. Each one is fetched before its predecessor executes, which
+ *  is what gives branches their delay slot (branches redirect the fetch
+ *  PC in the IF/RD latch, as usual).
+ *
+ *  The pipeline is drained on the way in and refilled (without any stall
+ *  that might have been pending) on the way out, so the latches are left
+ *  in a state that CycleRSP can pick up from.
+ * ========================================================================= */
+unsigned
+RSPRunFunctional(struct RSP *rsp, unsigned count) {
+  struct RSPHazardState state;
+  unsigned i;
+
+  if (count == 0 || (rsp->cp0.regs[SP_STATUS_REG] & 0x1))
+    return 0;
+
+  i = RSPDrainPipeline(rsp, &state);
+
+#ifdef RSP_THREADED_DISPATCH
+  if (rsp->mode != RSP_MODE_FUNCTIONAL_TABLE)
+    i = RunThreadedDispatch(rsp, i, count);
+  else
+#endif
+    i = RunTableDispatch(rsp, i, count);
+
+  memset(&state, 0, sizeof(state));
+  RSPRefillPipeline(rsp, &state);
+  return i;
+}
+
@@ -0,0 +1,21 @@
+/* ============================================================================
+ *  Functional.h: Functional (untimed) execution.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__FUNCTIONAL_H__
+#define __RSP__FUNCTIONAL_H__
+#include "Common.h"
+#include "Pipeline.h"
+
+struct RSP;
+
+unsigned RSPRunFunctional(struct RSP *, unsigned);
+
+#endif
+
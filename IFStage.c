@@ -10,45 +10,27 @@
  * ========================================================================= */
 #include "Common.h"
 #include "CPU.h"
+#include "DecodeCache.h"
 #include "IFStage.h"
 #include "Pipeline.h"
 
-#ifdef __cplusplus
-#include <cassert>
-#include <cstring>
-#else
-#include <assert.h>
-#include <string.h>
-#endif
-
 /* ============================================================================
- *  FetchInstructions: Fetches two instructions from a source address.
- * ========================================================================= */
-static void
-FetchInstructions(const uint8_t *source, uint32_t *iw1, uint32_t *iw2) {
-  memcpy(iw1, source + 0, sizeof(*iw1));
-  memcpy(iw2, source + 4, sizeof(*iw2));
-  *iw1 = ByteOrderSwap32(*iw1);
-  *iw2 = ByteOrderSwap32(*iw2);
-}
-
-/* ============================================================================
- *  RSPIFStage: Fetches, decodes, and checks for stall conditions.
- *  TODO: This is a massive hack as-is... fix it/the decoder.
+ *  RSPIFStage: Fetches an instruction out of the decode cache.
  * ========================================================================= */
 void
 RSPIFStage(struct RSP *rsp) {
   struct RSPIFRDLatch *ifrdLatch = &rsp->pipeline.ifrdLatch;
-
-  uint32_t *firstIW = &ifrdLatch->firstIW;
-  uint32_t *secondIW = &ifrdLatch->secondIW;
+  const struct RSPDecodedInstruction *decoded;
   uint32_t pc = ifrdLatch->pc;
 
-  /* Save the PC of the fetched instructions. */
+  /* Save the PC of the fetched instruction. */
   ifrdLatch->fetchedPC = pc;
 
-  /* Fetch a pair of instructions, bump the PC. */
-  FetchInstructions(rsp->dmem + ifrdLatch->pc, firstIW, secondIW);
+  /* Only decode the IMEM word if it was not seen yet, bump the PC. */
+  decoded = RSPGetDecodedInstruction(&rsp->decodeCache, rsp->imem, pc);
+  ifrdLatch->decoded = decoded;
+  ifrdLatch->firstIW = decoded->iw;
+
   ifrdLatch->pc = ((pc + 4) & 0xFFC) | 0x1000;
 }
 
@@ -0,0 +1,270 @@
+/* ============================================================================
+ *  IdleLoop.c: Polling loop detection.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CP0.h"
+#include "CPU.h"
+#include "DecodeCache.h"
+#include "IdleLoop.h"
+#include "Opcodes.h"
+#include "Pipeline.h"
+
+#ifdef __cplusplus
+#include <cstring>
+#else
+#include <string.h>
+#endif
+
+/* ============================================================================
+ *  GetBranchTarget: Returns where a branch/jump at a given PC would go.
+ * ========================================================================= */
+static uint32_t
+GetBranchTarget(const struct RSPDecodedInstruction *decoded, uint32_t pc) {
+  if (decoded->opcode.id == RSP_OPCODE_J)
+    return (decoded->iw & 0x3FF) << 2 | 0x1000;
+
+  return ((pc + 4 + (decoded->offset << 2)) & 0xFFC) | 0x1000;
+}
+
+/* ============================================================================
+ *  IsPollingLoop: Determines if the loop from target up to (and including
+ *  the delay slot of) the branch at branchPC can do nothing but poll.
+ *
+ *  Only ALU operations, reads of the SP registers proper (the DP ones go
+ *  out to the RDP) and branches that stay within the loop or leave it
+ *  going forward are allowed. Nothing in it can then touch memory, CP2
+ *  or anything outside, so registers, CP0 and the pipeline are the only
+ *  state it can change.
+ * ========================================================================= */
+static bool
+IsPollingLoop(struct RSP *rsp, uint32_t target, uint32_t branchPC) {
+  unsigned words = ((branchPC - target) >> 2) + 2;
+  bool polls = false;
+  unsigned i;
+
+  if (target > branchPC || words > RSP_IDLE_LOOP_MAX_WORDS)
+    return false;
+
+  for (i = 0; i < words; i++) {
+    uint32_t pc = target + i * 4;
+    const struct RSPDecodedInstruction *decoded =
+      RSPGetDecodedInstruction(&rsp->decodeCache, rsp->imem, pc);
+
+    switch (decoded->opcode.id) {
+      case RSP_OPCODE_ADD: case RSP_OPCODE_ADDI: case RSP_OPCODE_AND:
+      case RSP_OPCODE_ANDI: case RSP_OPCODE_LUI: case RSP_OPCODE_NOP:
+      case RSP_OPCODE_NOR: case RSP_OPCODE_OR: case RSP_OPCODE_ORI:
+      case RSP_OPCODE_SLL: case RSP_OPCODE_SLLV: case RSP_OPCODE_SLT:
+      case RSP_OPCODE_SLTI: case RSP_OPCODE_SLTIU: case RSP_OPCODE_SLTU:
+      case RSP_OPCODE_SRA: case RSP_OPCODE_SRAV: case RSP_OPCODE_SRL:
+      case RSP_OPCODE_SRLV: case RSP_OPCODE_SUB: case RSP_OPCODE_XOR:
+      case RSP_OPCODE_XORI:
+        break;
+
+      case RSP_OPCODE_MFC0:
+        if (decoded->rd >= CMD_START)
+          return false;
+
+        polls = true;
+        break;
+
+      /* Branches in the delay slot are not worth the trouble. */
+      case RSP_OPCODE_BEQ: case RSP_OPCODE_BGEZ: case RSP_OPCODE_BGTZ:
+      case RSP_OPCODE_BLEZ: case RSP_OPCODE_BLTZ: case RSP_OPCODE_BNE:
+      case RSP_OPCODE_J:
+        if (i == words - 1 || GetBranchTarget(decoded, pc) < target)
+          return false;
+
+        break;
+
+      default:
+        return false;
+    }
+  }
+
+  return polls;
+}
+
+/* ============================================================================
+ *  TakeSnapshot: Records the state that a polling loop can change.
+ * ========================================================================= */
+static void
+TakeSnapshot(const struct RSP *rsp, struct RSPIdleSnapshot *snapshot) {
+  memcpy(snapshot->regs, rsp->regs, sizeof(snapshot->regs));
+  memcpy(snapshot->cp0, rsp->cp0.regs, sizeof(snapshot->cp0));
+
+  snapshot->ifrdLatch = rsp->pipeline.ifrdLatch;
+  snapshot->dfwbLatch = rsp->pipeline.dfwbLatch;
+  snapshot->rdexLatch = rsp->pipeline.rdexLatch;
+  snapshot->exdfLatch = rsp->pipeline.exdfLatch;
+  snapshot->cp2Opcode = rsp->cp2.opcode;
+  snapshot->didBranch = rsp->didBranch;
+}
+
+/* ============================================================================
+ *  MatchesSnapshot: Compares the state against a snapshot, field by field
+ *  (the latches have padding, and not every field of them is live).
+ * ========================================================================= */
+static bool
+MatchesSnapshot(const struct RSP *rsp, const struct RSPIdleSnapshot *snapshot) {
+  const struct RSPPipeline *pipeline = &rsp->pipeline;
+
+  if (memcmp(snapshot->regs, rsp->regs, sizeof(snapshot->regs)) ||
+    memcmp(snapshot->cp0, rsp->cp0.regs, sizeof(snapshot->cp0)))
+    return false;
+
+  return snapshot->ifrdLatch.decoded == pipeline->ifrdLatch.decoded &&
+    snapshot->ifrdLatch.firstIW == pipeline->ifrdLatch.firstIW &&
+    snapshot->ifrdLatch.fetchedPC == pipeline->ifrdLatch.fetchedPC &&
+    snapshot->ifrdLatch.pc == pipeline->ifrdLatch.pc &&
+
+    snapshot->dfwbLatch.opcode.id == pipeline->dfwbLatch.opcode.id &&
+    snapshot->dfwbLatch.result.data == pipeline->dfwbLatch.result.data &&
+    snapshot->dfwbLatch.result.dest == pipeline->dfwbLatch.result.dest &&
+
+    snapshot->rdexLatch.pc == pipeline->rdexLatch.pc &&
+    snapshot->rdexLatch.iw == pipeline->rdexLatch.iw &&
+    snapshot->rdexLatch.opcode.id == pipeline->rdexLatch.opcode.id &&
+    snapshot->rdexLatch.opcode.infoFlags ==
+      pipeline->rdexLatch.opcode.infoFlags &&
+
+    snapshot->exdfLatch.opcode.id == pipeline->exdfLatch.opcode.id &&
+    snapshot->exdfLatch.result.data == pipeline->exdfLatch.result.data &&
+    snapshot->exdfLatch.result.dest == pipeline->exdfLatch.result.dest &&
+    snapshot->exdfLatch.memoryData.function ==
+      pipeline->exdfLatch.memoryData.function &&
+
+    snapshot->cp2Opcode.id == rsp->cp2.opcode.id &&
+    snapshot->didBranch == rsp->didBranch;
+}
+
+/* ============================================================================
+ *  RSPInitIdleLoop: Initializes the detector (skipping is allowed).
+ * ========================================================================= */
+void
+RSPInitIdleLoop(struct RSPIdleLoop *idle) {
+  memset(idle, 0, sizeof(*idle));
+  idle->allowed = true;
+}
+
+/* ============================================================================
+ *  RSPResetIdleLoop: Forgets what was seen by the last RunRSP (its cycle
+ *  counts are meaningless now), and enables detection if allowed.
+ * ========================================================================= */
+void
+RSPResetIdleLoop(struct RSPIdleLoop *idle) {
+  idle->enabled = idle->allowed;
+  idle->polled = false;
+  idle->armed = false;
+
+  idle->ignoredPC = 0;
+  idle->observations = 0;
+  idle->misses = 0;
+}
+
+/* ============================================================================
+ *  RSPCheckIdleLoop: Invoked on taken branches while armed.
+ *
+ *  A backward branch that closes a polling loop (which polled this time
+ *  around) raises RSP_EVENT_IDLE, so that RunRSP gets to look at the
+ *  state. Any other backward branch means the loop that was being
+ *  watched (if any) was left, and the observations are thrown out.
+ * ========================================================================= */
+void
+RSPCheckIdleLoop(struct RSP *rsp) {
+  struct RSPIdleLoop *idle = &rsp->idleLoop;
+  uint32_t branchPC = ((rsp->pipeline.rdexLatch.pc - 4) & 0xFFC) | 0x1000;
+  uint32_t target = rsp->pipeline.ifrdLatch.pc;
+  bool polled = idle->polled;
+
+  if (target > branchPC)
+    return;
+
+  idle->polled = false;
+
+  if (polled && branchPC != idle->ignoredPC &&
+    IsPollingLoop(rsp, target, branchPC)) {
+    idle->branchPC = branchPC;
+    rsp->events |= RSP_EVENT_IDLE;
+    return;
+  }
+
+  idle->observations = 0;
+  idle->armed = false;
+}
+
+/* ============================================================================
+ *  RSPSkipIdleLoop: Invoked by RunRSP when RSP_EVENT_IDLE is raised, with
+ *  the cycles consumed so far and the budget. Returns the cycles skipped.
+ *
+ *  If the state is the same as it was the last time around the loop, the
+ *  loop does the exact same thing on every pass until something outside
+ *  the RSP changes (which can't happen until RunRSP returns). Once two
+ *  passes in a row have come back to the same state in the same number of
+ *  cycles, as many whole passes as fit in the budget are skipped; the rest
+ *  of the budget is then run as usual.
+ * ========================================================================= */
+unsigned
+RSPSkipIdleLoop(struct RSP *rsp, unsigned count, unsigned cycles) {
+  struct RSPIdleLoop *idle = &rsp->idleLoop;
+  unsigned period = count - idle->mark;
+  unsigned skip;
+
+  if (idle->observations == 0 || idle->branchPC != idle->watchedPC ||
+    !MatchesSnapshot(rsp, &idle->snapshot)) {
+    if (idle->observations > 0 && idle->branchPC == idle->watchedPC &&
+      ++idle->misses == RSP_IDLE_LOOP_MAX_MISSES)
+      idle->ignoredPC = idle->branchPC;
+
+    idle->observations = 1;
+  }
+
+  else if (idle->observations == 1 || period != idle->period) {
+    idle->observations = 2;
+    idle->period = period;
+  }
+
+  else {
+    skip = (cycles - count) / period * period;
+    idle->skipped += skip;
+    idle->mark = count + skip;
+    idle->misses = 0;
+
+#ifndef NDEBUG
+    rsp->pipeline.cycles += skip;
+#endif
+    return skip;
+  }
+
+  TakeSnapshot(rsp, &idle->snapshot);
+  idle->watchedPC = idle->branchPC;
+  idle->mark = count;
+  idle->armed = true;
+  return 0;
+}
+
+/* ============================================================================
+ *  RSPGetSkippedCycles: Returns how many cycles (or, in the functional
+ *  modes, instructions) were skipped in polling loops.
+ * ========================================================================= */
+unsigned long long
+RSPGetSkippedCycles(const struct RSP *rsp) {
+  return rsp->idleLoop.skipped;
+}
+
+/* ============================================================================
+ *  RSPSetIdleLoopSkipping: Controls whether RunRSP skips polling loops.
+ *  Skipping doesn't change the outcome; RunRSP just gets there sooner.
+ * ========================================================================= */
+void
+RSPSetIdleLoopSkipping(struct RSP *rsp, bool allowed) {
+  rsp->idleLoop.allowed = allowed;
+}
+
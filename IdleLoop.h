@@ -0,0 +1,66 @@
+/* ============================================================================
+ *  IdleLoop.h: Polling loop detection.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__IDLELOOP_H__
+#define __RSP__IDLELOOP_H__
+#include "Common.h"
+#include "CP0.h"
+#include "Decoder.h"
+#include "Pipeline.h"
+
+/* Longest loop (closing branch and delay slot included) considered. */
+#define RSP_IDLE_LOOP_MAX_WORDS 16
+
+/* Times in a row that a loop may fail to settle before it is ignored. */
+#define RSP_IDLE_LOOP_MAX_MISSES 8
+
+/* Everything that a polling loop could change, as of a loop branch. */
+struct RSPIdleSnapshot {
+  uint32_t regs[32];
+  uint32_t cp0[NUM_SP_REGISTERS];
+
+  struct RSPIFRDLatch ifrdLatch;
+  struct RSPDFWBLatch dfwbLatch;
+  struct RSPRDEXLatch rdexLatch;
+  struct RSPEXDFLatch exdfLatch;
+  struct RSPVOpcode cp2Opcode;
+  uint8_t didBranch;
+};
+
+struct RSPIdleLoop {
+  bool allowed;  /* See RSPSetIdleLoopSkipping. */
+  bool enabled;  /* Only while in RunRSP. */
+
+  /* Set when an SP register is read (by MFC0); cleared by the next */
+  /* backward branch. Armed if either that or observations is set. */
+  bool polled, armed;
+
+  /* The closing branch of the last loop that raised RSP_EVENT_IDLE, */
+  /* and the one whose state was last recorded. */
+  uint32_t branchPC, watchedPC, ignoredPC;
+  unsigned observations, misses;
+  unsigned mark, period;
+
+  struct RSPIdleSnapshot snapshot;
+  unsigned long long skipped;
+};
+
+struct RSP;
+
+void RSPInitIdleLoop(struct RSPIdleLoop *);
+void RSPResetIdleLoop(struct RSPIdleLoop *);
+void RSPCheckIdleLoop(struct RSP *);
+unsigned RSPSkipIdleLoop(struct RSP *, unsigned, unsigned);
+
+unsigned long long RSPGetSkippedCycles(const struct RSP *);
+void RSPSetIdleLoopSkipping(struct RSP *, bool);
+
+#endif
+
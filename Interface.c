@@ -11,9 +11,11 @@
 #include "Address.h"
 #include "Common.h"
 #include "CPU.h"
+#include "DecodeCache.h"
 #include "Definitions.h"
 #include "Externs.h"
 #include "Interface.h"
+#include "Registry.h"
 
 #ifdef __cplusplus
 #include <cassert>
@@ -28,11 +30,13 @@ static void HandleDMAWrite(struct RSP *);
 static void HandleSPStatusWrite(struct RSP *, uint32_t);
 
 /* ============================================================================
- *  ConnectRDPtoRSP: Connects an RDP instance to this RSP.
+ *  ConnectRDPtoRSP: Connects an RDP instance to this RSP, and tells it
+ *  where this RSP's DMEM is (for XBUS command lists).
  * ========================================================================= */
 void
 ConnectRDPtoRSP(struct RSP *rsp, struct RDP *rdp) {
   rsp->rdp = rdp;
+  RDPSetRSPDMEMPointer(rdp, rsp->dmem);
 }
 
 /* ============================================================================
@@ -72,7 +76,14 @@ HandleDMARead(struct RSP *rsp) {
       uint32_t sourceAddr = (source + j) & 0x7FFFFC;
       uint32_t destAddr = (dest + j) & 0x1FFC;
 
+      if (destAddr & 0x1000)
+        RSPRegistrySave(rsp);
+
       DMAFromDRAM(rsp->bus, rsp->dmem + destAddr, sourceAddr, 4);
+      RSPMarkDirty(rsp->dirtyLines, destAddr, 4);
+
+      if (destAddr & 0x1000)
+        RSPInvalidateDecodeCache(&rsp->decodeCache, destAddr, 4);
 
       j += 4;
     } while (j < length);
@@ -148,18 +159,28 @@ HandleSPStatusWrite(struct RSP *rsp, uint32_t data) {
   assert(!((data & SP_CLR_SIG6) && (data & SP_SET_SIG6)));
   assert(!((data & SP_CLR_SIG7) && (data & SP_SET_SIG7)));
 
-  if (data & SP_CLR_HALT)
+  /* Microcode is (re)loaded while halted; see if it is one we know. */
+  if (data & SP_CLR_HALT) {
+    if (rsp->cp0.regs[SP_STATUS_REG] & SP_STATUS_HALT)
+      RSPRegistryLookup(rsp);
+
     rsp->cp0.regs[SP_STATUS_REG] &= ~SP_STATUS_HALT;
-  else if (data & SP_SET_HALT)
+  }
+
+  else if (data & SP_SET_HALT) {
     rsp->cp0.regs[SP_STATUS_REG] |= SP_STATUS_HALT;
+    rsp->events |= RSP_EVENT_HALT;
+  }
 
   if (data & SP_CLR_BROKE)
     rsp->cp0.regs[SP_STATUS_REG] &= ~SP_STATUS_BROKE;
 
   if (data & SP_CLR_INTR)
     BusClearRCPInterrupt(rsp->bus, MI_INTR_SP);
-  else if (data & SP_SET_INTR)
+  else if (data & SP_SET_INTR) {
     BusRaiseRCPInterrupt(rsp->bus, MI_INTR_SP);
+    rsp->events |= RSP_EVENT_SIGNAL;
+  }
 
   if (data & SP_CLR_SSTEP)
     rsp->cp0.regs[SP_STATUS_REG] &= ~SP_STATUS_SSTEP;
@@ -210,6 +231,11 @@ HandleSPStatusWrite(struct RSP *rsp, uint32_t data) {
     rsp->cp0.regs[SP_STATUS_REG] &= ~SP_STATUS_SIG7;
   else if (data & SP_SET_SIG7)
     rsp->cp0.regs[SP_STATUS_REG] |= SP_STATUS_SIG7;
+
+  /* Let RunRSP return so that the host can react to signals. */
+  if (data & (SP_SET_SIG0 | SP_SET_SIG1 | SP_SET_SIG2 | SP_SET_SIG3 |
+    SP_SET_SIG4 | SP_SET_SIG5 | SP_SET_SIG6 | SP_SET_SIG7))
+    rsp->events |= RSP_EVENT_SIGNAL;
 }
 
 /* ============================================================================
@@ -238,6 +264,7 @@ int RSPDMemWriteWord(void *_rsp, uint32_t address, void *_data) {
   word = ByteOrderSwap32(*data);
 
   memcpy(rsp->dmem + address, &word, sizeof(word));
+  RSPMarkDirty(rsp->dirtyLines, address, sizeof(word));
 
   return 0;
 }
@@ -283,7 +310,10 @@ int RSPIMemWriteByte(void *_rsp, uint32_t address, void *_data) {
   address = address - RSP_IMEM_BASE_ADDRESS;
   byte = *data;
 
+  RSPRegistrySave(rsp);
   memcpy(rsp->imem + address, &byte, sizeof(byte));
+  RSPInvalidateDecodeCache(&rsp->decodeCache, address, sizeof(byte));
+  RSPMarkDirty(rsp->dirtyLines, RSP_DMEM_SIZE + address, sizeof(byte));
 
   return 0;
 }
@@ -298,7 +328,10 @@ int RSPIMemWriteWord(void *_rsp, uint32_t address, void *_data) {
   address = address - RSP_IMEM_BASE_ADDRESS;
   word = ByteOrderSwap32(*data);
 
+  RSPRegistrySave(rsp);
   memcpy(rsp->imem + address, &word, sizeof(word));
+  RSPInvalidateDecodeCache(&rsp->decodeCache, address, sizeof(word));
+  RSPMarkDirty(rsp->dirtyLines, RSP_DMEM_SIZE + address, sizeof(word));
 
   return 0;
 }
@@ -15,6 +15,13 @@
 
 int SPRegRead(void *, uint32_t, void *);
 int SPRegWrite(void *, uint32_t, void *);
+int SPRegRead2(void *, uint32_t, void *);
+int SPRegWrite2(void *, uint32_t, void *);
+
+int RSPDMemReadWord(void *, uint32_t, void *);
+int RSPDMemWriteWord(void *, uint32_t, void *);
+int RSPIMemReadWord(void *, uint32_t, void *);
+int RSPIMemWriteWord(void *, uint32_t, void *);
 
 #endif
 
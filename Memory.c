@@ -23,6 +23,14 @@
 
 #ifdef USE_SSE
 #include <tmmintrin.h>
+#elif defined(RSP_HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
+/* Only the byte swaps need more than SSE2, and SSSE3 is */
+/* all they can use; CreateRSP refuses hosts without it. */
+#ifdef RSP_SSE_DISPATCH
+#pragma GCC target("ssse3")
 #endif
 
 /* SSE-assisted helper functions. */
@@ -48,8 +56,19 @@ CopyVectorSlices(void *src, void *dest) {
   temp = _mm_loadu_si128((__m128i*) src);
   temp = _mm_shuffle_epi8(temp, mask);
   _mm_storeu_si128((__m128i*) dest, temp);
+#elif defined(RSP_HAVE_NEON)
+  uint8x16_t temp = vld1q_u8((const uint8_t*) src);
+  vst1q_u8((uint8_t*) dest, vrev16q_u8(temp));
 #else
-#warning "Unimplemented function: CopyVectorSlices (No SSE)."
+  const uint8_t *source = (const uint8_t*) src;
+  uint8_t *destination = (uint8_t*) dest;
+  uint8_t temp[16];
+  unsigned i;
+
+  for (i = 0; i < 16; i++)
+    temp[i] = source[i ^ 1];
+
+  memcpy(destination, temp, sizeof(temp));
 #endif
 }
 
@@ -70,8 +89,18 @@ LoadPackedBytes(void *src, void *dest) {
   temp = _mm_loadu_si128((__m128i*) src);
   temp = _mm_shuffle_epi8(temp, mask);
   _mm_storeu_si128((__m128i*) dest, temp);
+#elif defined(RSP_HAVE_NEON)
+  uint8x8_t temp = vld1_u8((const uint8_t*) src);
+  vst1q_u16((uint16_t*) dest, vshll_n_u8(temp, 8));
 #else
-#warning "Unimplemented function: LoadPackedBytes (No SSE)."
+  const uint8_t *source = (const uint8_t*) src;
+  uint16_t temp[8];
+  unsigned i;
+
+  for (i = 0; i < 8; i++)
+    temp[i] = source[i] << 8;
+
+  memcpy(dest, temp, sizeof(temp));
 #endif
 }
 
@@ -93,8 +122,18 @@ LoadPackedUBytes(void *src, void *dest) {
   temp = _mm_shuffle_epi8(temp, mask);
   temp = _mm_slli_epi16(temp, 7);
   _mm_storeu_si128((__m128i*) dest, temp);
+#elif defined(RSP_HAVE_NEON)
+  uint8x8_t temp = vld1_u8((const uint8_t*) src);
+  vst1q_u16((uint16_t*) dest, vshll_n_u8(temp, 7));
 #else
-#warning "Unimplemented function: LoadPackedUBytes (No SSE)."
+  const uint8_t *source = (const uint8_t*) src;
+  uint16_t temp[8];
+  unsigned i;
+
+  for (i = 0; i < 8; i++)
+    temp[i] = source[i] << 7;
+
+  memcpy(dest, temp, sizeof(temp));
 #endif
 }
 
@@ -115,8 +154,18 @@ StorePackedBytes(void *src, void *dest) {
   temp = _mm_loadu_si128((__m128i*) src);
   temp = _mm_shuffle_epi8(temp, mask);
   _mm_storel_epi64((__m128i*) dest, temp);
+#elif defined(RSP_HAVE_NEON)
+  uint16x8_t temp = vld1q_u16((const uint16_t*) src);
+  vst1_u8((uint8_t*) dest, vshrn_n_u16(temp, 8));
 #else
-#warning "Unimplemented function: StorePackedBytes (No SSE)."
+  uint16_t temp[8];
+  uint8_t *destination = (uint8_t*) dest;
+  unsigned i;
+
+  memcpy(temp, src, sizeof(temp));
+
+  for (i = 0; i < 8; i++)
+    destination[i] = temp[i] >> 8;
 #endif
 }
 
@@ -138,8 +187,18 @@ StorePackedUBytes(void *src, void *dest) {
   temp = _mm_srai_epi16(temp, 7);
   temp = _mm_shuffle_epi8(temp, mask);
   _mm_storel_epi64((__m128i*) dest, temp);
+#elif defined(RSP_HAVE_NEON)
+  uint16x8_t temp = vld1q_u16((const uint16_t*) src);
+  vst1_u8((uint8_t*) dest, vshrn_n_u16(temp, 7));
 #else
-#warning "Unimplemented function: StorePackedUBytes (No SSE)."
+  uint16_t temp[8];
+  uint8_t *destination = (uint8_t*) dest;
+  unsigned i;
+
+  memcpy(temp, src, sizeof(temp));
+
+  for (i = 0; i < 8; i++)
+    destination[i] = temp[i] >> 7;
 #endif
 }
 
@@ -463,6 +522,7 @@ StoreByte(const struct RSPMemoryData *memoryData, uint8_t *dmem) {
   uint8_t byte = memoryData->data;
 
   memcpy(dmem + offset, &byte, sizeof(byte));
+  RSPMarkDirty(memoryData->dirtyLines, offset, sizeof(byte));
 }
 
 /* ============================================================================
@@ -477,6 +537,7 @@ StoreByteVector(const struct RSPMemoryData *memoryData, uint8_t *dmem) {
 
   memcpy(slice, vector->slices + (element >> 1), sizeof(slice));
   dmem[offset] = slice[(element & 1) ^ 1];
+  RSPMarkDirty(memoryData->dirtyLines, offset, 1);
 }
 
 /* ============================================================================
@@ -501,6 +562,7 @@ StoreDoubleVector(const struct RSPMemoryData *memoryData, uint8_t *dmem) {
 
   CopyVectorSlices(vector->slices, slices);
   memcpy(dmem + offset, slices + (element >> 1), 8);
+  RSPMarkDirty(memoryData->dirtyLines, offset, 8);
 }
 
 /* ============================================================================
@@ -512,6 +574,7 @@ StoreHalf(const struct RSPMemoryData *memoryData, uint8_t *dmem) {
   uint16_t half = ByteOrderSwap16(memoryData->data);
 
   memcpy(dmem + offset, &half, sizeof(half));
+  RSPMarkDirty(memoryData->dirtyLines, offset, sizeof(half));
 }
 
 /* ============================================================================
@@ -537,6 +600,7 @@ StoreLongVector(const struct RSPMemoryData *memoryData, uint8_t *dmem) {
   /* TODO: Shift the element right 1? */
   CopyVectorSlices(vector->slices, slices);
   memcpy(dmem + offset, slices + element, 4);
+  RSPMarkDirty(memoryData->dirtyLines, offset, 4);
 }
 
 /* ============================================================================
@@ -550,6 +614,7 @@ StorePackedByteVector(const struct RSPMemoryData *memoryData, uint8_t *dmem) {
 
   start = offset & 0x7;
   offset &= 0xFF8;
+  RSPMarkDirty(memoryData->dirtyLines, offset, 8);
 
   /* Currently dont even bother to handle either of these. */
   assert(element == 0 && "Element something other than zero?");
@@ -603,6 +668,7 @@ StorePackedVector(const struct RSPMemoryData *memoryData, uint8_t *dmem) {
 
   start = offset & 0x7;
   offset &= 0xFF8;
+  RSPMarkDirty(memoryData->dirtyLines, offset, 8);
 
   /* Currently dont even bother to handle either of these. */
   assert(element == 0 && "Element something other than zero?");
@@ -633,6 +699,7 @@ StoreQuadVector(const struct RSPMemoryData *memoryData, uint8_t *dmem) {
   unsigned element = memoryData->element, start;
 
   start = offset & 0xF;
+  RSPMarkDirty(memoryData->dirtyLines, offset, 16 - start);
 
   /* Currently dont even bother to handle either of these. */
   assert(element == 0 && "Element something other than zero?");
@@ -688,6 +755,7 @@ StoreShortVector(const struct RSPMemoryData *memoryData, uint8_t *dmem) {
   /* TODO: Shift the element right 1? */
   CopyVectorSlices(vector->slices, slices);
   memcpy(dmem + offset, slices + element, 2);
+  RSPMarkDirty(memoryData->dirtyLines, offset, 2);
 }
 
 /* ============================================================================
@@ -703,6 +771,7 @@ StoreTransposeVector(const struct RSPMemoryData *memoryData, uint8_t *dmem) {
 
   /* TODO: Check resulting byte ordering and output. */
   CopyVectorSlices(vector->slices, dmem + offset);
+  RSPMarkDirty(memoryData->dirtyLines, offset, 16);
 }
 
 /* ============================================================================
@@ -714,5 +783,6 @@ StoreWord(const struct RSPMemoryData *memoryData, uint8_t *dmem) {
   uint32_t word = ByteOrderSwap32(memoryData->data);
 
   memcpy(dmem + offset, &word, sizeof(word));
+  RSPMarkDirty(memoryData->dirtyLines, offset, sizeof(word));
 }
 
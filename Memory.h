@@ -13,12 +13,19 @@
 #include "Common.h"
 #include "CP2.h"
 
+/* Writes to DMEM and IMEM (which follows it) are tracked in */
+/* lines, so that snapshots only need to hold what changed. */
+#define RSP_DIRTY_LINE_SIZE 64
+#define NUM_RSP_DIRTY_LINES 128 /* = (DMEM + IMEM) / RSP_DIRTY_LINE_SIZE */
+#define RSP_DIRTY_LINE_WORDS (NUM_RSP_DIRTY_LINES / 64)
+
 struct RSPMemoryData;
 typedef void (*RSPMemoryFunction)(const struct RSPMemoryData *, uint8_t *);
 
 struct RSPMemoryData{
   RSPMemoryFunction function;
   struct RSPCP2 *cp2;
+  uint64_t *dirtyLines;
 
   void *target;
   unsigned element;
@@ -26,6 +33,20 @@ struct RSPMemoryData{
   uint32_t data;
 };
 
+/* ============================================================================
+ *  RSPMarkDirty: Marks the lines that a write of up to a line's worth of
+ *  bytes touches. The address is relative to the start of DMEM.
+ * ========================================================================= */
+static inline void
+RSPMarkDirty(uint64_t *dirtyLines, unsigned address, unsigned length) {
+  unsigned first = address / RSP_DIRTY_LINE_SIZE % NUM_RSP_DIRTY_LINES;
+  unsigned last = (address + length - 1) / RSP_DIRTY_LINE_SIZE %
+    NUM_RSP_DIRTY_LINES;
+
+  dirtyLines[first >> 6] |= (uint64_t) 1 << (first & 63);
+  dirtyLines[last >> 6] |= (uint64_t) 1 << (last & 63);
+}
+
 void CopyVectorSlices(void *src, void *dest);
 void LoadByte(const struct RSPMemoryData *, uint8_t *);
 void LoadByteVector(const struct RSPMemoryData *, uint8_t *);
@@ -8,8 +8,24 @@
  *  This file is subject to the terms and conditions defined in
  *  file 'LICENSE', which is part of this source code package.
  * ========================================================================= */
+#include "CP2.h"
+#include "CP2ANSI.h"
+#include "CP2AVX2.h"
+#include "CP2AVX2Identity.h"
+#include "CP2AVX512.h"
+#include "CP2Identity.h"
+#include "CP2NEON.h"
+#include "CP2SSE41.h"
+#include "CP2SSE41Identity.h"
+#include "CP2Whole.h"
+#include "CPU.h"
 #include "Opcodes.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#define RSP_HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
 /* ============================================================================
  *  Use a cross macro to build both tables.
  * ========================================================================= */
@@ -25,6 +41,176 @@ const RSPVectorFunction RSPVectorFunctionTable[NUM_RSP_VECTOR_OPCODES] = {
 #undef X
 };
 
+/* In the order of enum RSPFusedIdiom. */
+const RSPFusedFunction RSPFusedFunctionTable[NUM_RSP_FUSED_IDIOMS] = {
+  RSPFusedMUL32, RSPFusedMULF
+};
+
+/* In the order of enum RSPProduct. Without SSE, the accumulator */
+/* is written from the same loop as `vd`; there's little to skip. */
+const RSPVectorFunction RSPNoAccFunctionTable[NUM_RSP_PRODUCTS] = {
+#ifdef USE_SSE
+#define X(op) RSP##op##NoAcc,
+#else
+#define X(op) RSP##op,
+#endif
+  RSP_PRODUCT_OPCODES
+#undef X
+};
+
+/* In the order of enum RSPFlagWriter; as above, only with SSE. */
+const RSPVectorFunction RSPNoFlagsFunctionTable[NUM_RSP_FLAG_WRITERS] = {
+#ifdef USE_SSE
+#define X(op) RSP##op##NoFlags,
+#else
+#define X(op) RSP##op,
+#endif
+  RSP_FLAG_WRITER_OPCODES
+#undef X
+};
+
+/* ============================================================================
+ *  The tables above, and the ones built for later instruction sets.
+ * ========================================================================= */
+#ifndef USE_SSE
+#define RSP_BUILT_IN_TYPE "ANSI C"
+#elif defined(SSSE3_ONLY) || defined(RSP_SSE_DISPATCH)
+#define RSP_BUILT_IN_TYPE "SSSE3"
+#else
+#define RSP_BUILT_IN_TYPE "SSE4.1"
+#endif
+
+/* Only the forms that have something cheaper than the shuffle */
+/* that every element can take get tables of their own. */
+#define RSP_FORMS(identity, any, whole) {identity, any, any, whole}
+
+#ifdef USE_SSE
+#define RSP_BUILT_IN_FORMS RSP_FORMS(RSPVectorFunctionTableIdentity, \
+  RSPVectorFunctionTable, RSPVectorFunctionTable)
+#else
+#define RSP_BUILT_IN_FORMS RSP_FORMS(RSPVectorFunctionTableIdentity, \
+  RSPVectorFunctionTable, RSPVectorFunctionTableWhole)
+#endif
+
+const struct RSPVectorBackend RSPVectorBackends[] = {
+#ifdef RSP_SSE_DISPATCH
+  {"ANSI C", RSPVectorFunctionTableANSI,
+    RSP_FORMS(RSPVectorFunctionTableANSI,
+      RSPVectorFunctionTableANSI, RSPVectorFunctionTableANSI),
+    RSPFusedFunctionTableANSI, RSPNoAccFunctionTableANSI,
+    RSPNoFlagsFunctionTableANSI},
+#endif
+  {RSP_BUILT_IN_TYPE, RSPVectorFunctionTable, RSP_BUILT_IN_FORMS,
+    RSPFusedFunctionTable, RSPNoAccFunctionTable,
+    RSPNoFlagsFunctionTable},
+#ifdef RSP_SSE_DISPATCH
+  {"SSE4.1", RSPVectorFunctionTableSSE41,
+    RSP_FORMS(RSPVectorFunctionTableSSE41Identity,
+      RSPVectorFunctionTableSSE41, RSPVectorFunctionTableSSE41),
+    RSPFusedFunctionTableSSE41, RSPNoAccFunctionTableSSE41,
+    RSPNoFlagsFunctionTableSSE41},
+  {"AVX2", RSPVectorFunctionTableAVX2,
+    RSP_FORMS(RSPVectorFunctionTableAVX2Identity,
+      RSPVectorFunctionTableAVX2, RSPVectorFunctionTableAVX2),
+    RSPFusedFunctionTableAVX2, RSPNoAccFunctionTableAVX2,
+    RSPNoFlagsFunctionTableAVX2},
+  {"AVX-512", RSPVectorFunctionTableAVX512,
+    RSP_FORMS(RSPVectorFunctionTableAVX512Identity,
+      RSPVectorFunctionTableAVX512, RSPVectorFunctionTableAVX512),
+    RSPFusedFunctionTableAVX2, RSPNoAccFunctionTableAVX2,
+    RSPNoFlagsFunctionTableAVX2},
+#endif
+#ifdef RSP_HAVE_NEON
+  {"NEON", RSPVectorFunctionTableNEON,
+    RSP_FORMS(RSPVectorFunctionTableNEON,
+      RSPVectorFunctionTableNEON, RSPVectorFunctionTableNEON),
+    RSPFusedFunctionTableNEON, RSPNoAccFunctionTableNEON,
+    RSPNoFlagsFunctionTableNEON},
+#endif
+};
+
+const unsigned NumRSPVectorBackends =
+  sizeof(RSPVectorBackends) / sizeof(*RSPVectorBackends);
+
+/* What the host runs; set by RSPSelectVectorFunctions. */
+const RSPVectorFunction *RSPVectorFunctions = RSPVectorFunctionTable;
+const RSPVectorFunction *RSPVectorFormFunctions[NUM_RSP_ELEMENT_FORMS] =
+  RSP_BUILT_IN_FORMS;
+const RSPFusedFunction *RSPFusedFunctions = RSPFusedFunctionTable;
+const RSPVectorFunction *RSPNoAccFunctions = RSPNoAccFunctionTable;
+const RSPVectorFunction *RSPNoFlagsFunctions = RSPNoFlagsFunctionTable;
+const char *RSPBuildType = RSP_BUILT_IN_TYPE;
+
+/* ============================================================================
+ *  RSPGetHostVectorBackends: Returns how many of the backends (from the
+ *  first) the host can run. That's at least one: when picked at runtime,
+ *  the first is built from plain C.
+ * ========================================================================= */
+unsigned
+RSPGetHostVectorBackends(void) {
+#ifdef RSP_SSE_DISPATCH
+  __builtin_cpu_init();
+
+  if (!__builtin_cpu_supports("ssse3"))
+    return 1;
+
+  if (!__builtin_cpu_supports("sse4.1"))
+    return 2;
+
+  if (!__builtin_cpu_supports("avx2"))
+    return 3;
+
+  if (!RSPHostHasAVX512())
+    return 4;
+#endif
+
+  return NumRSPVectorBackends;
+}
+
+/* ============================================================================
+ *  SelectVectorFunctions: Points the tables at the best backend the host
+ *  can run. Only ever run once.
+ * ========================================================================= */
+static void
+SelectVectorFunctions(void) {
+  const struct RSPVectorBackend *backend =
+    &RSPVectorBackends[RSPGetHostVectorBackends() - 1];
+  unsigned i;
+
+  for (i = 0; i < NUM_RSP_ELEMENT_FORMS; i++)
+    RSPVectorFormFunctions[i] = backend->forms[i];
+
+  RSPVectorFunctions = backend->functions;
+  RSPFusedFunctions = backend->fused;
+  RSPNoAccFunctions = backend->noAcc;
+  RSPNoFlagsFunctions = backend->noFlags;
+  RSPBuildType = backend->name;
+}
+
+/* ============================================================================
+ *  RSPSelectVectorFunctions: Picks the best tables of vector (and fused)
+ *  functions for the host. Every table computes the same results; they only
+ *  differ in the instructions used to get them. Called by CreateRSP, before
+ *  anything is decoded. The tables are picked by the first call only, under
+ *  pthread_once, so RSPs may be created from several threads at once; later
+ *  calls just wait for them.
+ * ========================================================================= */
+void
+RSPSelectVectorFunctions(void) {
+#ifdef RSP_HAVE_PTHREADS
+  static pthread_once_t selected = PTHREAD_ONCE_INIT;
+
+  pthread_once(&selected, SelectVectorFunctions);
+#else
+  static bool selected;
+
+  if (!selected) {
+    SelectVectorFunctions();
+    selected = true;
+  }
+#endif
+}
+
 #ifndef NDEBUG
 const char *RSPScalarOpcodeMnemonics[NUM_RSP_SCALAR_OPCODES] = {
 #define X(op) #op,
@@ -48,6 +48,134 @@ typedef void (*const RSPVectorFunction)
 extern const RSPScalarFunction RSPScalarFunctionTable[NUM_RSP_SCALAR_OPCODES];
 extern const RSPVectorFunction RSPVectorFunctionTable[NUM_RSP_VECTOR_OPCODES];
 
+/* Runs of vector instructions that microcode uses together, and */
+/* that can be run as one call (see RSPMatchFusedIdiom). Each of */
+/* the functions takes the instruction words of the run, in order. */
+enum RSPFusedIdiom {
+  RSP_FUSED_MUL32, /* VMUDL, VMADM, VMADN, VMADH */
+  RSP_FUSED_MULF,  /* VMULF, VMACF */
+  NUM_RSP_FUSED_IDIOMS
+};
+
+void RSPFusedMUL32(struct RSPCP2 *, uint32_t, uint32_t, uint32_t, uint32_t);
+void RSPFusedMULF(struct RSPCP2 *, uint32_t, uint32_t, uint32_t, uint32_t);
+
+typedef void (*const RSPFusedFunction)
+  (struct RSPCP2 *, uint32_t, uint32_t, uint32_t, uint32_t);
+
+extern const RSPFusedFunction RSPFusedFunctionTable[NUM_RSP_FUSED_IDIOMS];
+
+/* Vector instructions that write all of the accumulator without */
+/* reading it. Each also has a function that leaves it alone, for */
+/* when what it'd write is written over before anything reads it */
+/* (see RSPFindDeadAccumulatorWrites); they take the same arguments. */
+#define RSP_PRODUCT_OPCODES \
+  X(VMUDH) X(VMUDL) X(VMUDM) X(VMUDN) X(VMULF) X(VMULQ)
+
+enum RSPProduct {
+#define X(op) RSP_PRODUCT_##op,
+  RSP_PRODUCT_OPCODES
+#undef X
+  NUM_RSP_PRODUCTS
+};
+
+#define X(op) void RSP##op##NoAcc( \
+  struct RSPCP2 *, int16_t *, const int16_t *, const int16_t *, unsigned);
+RSP_PRODUCT_OPCODES
+#undef X
+
+extern const RSPVectorFunction RSPNoAccFunctionTable[NUM_RSP_PRODUCTS];
+
+static inline bool RSPGetProduct(enum RSPVOpcodeID id,
+  enum RSPProduct *product) {
+  switch (id) {
+#define X(op) case RSP_OPCODE_##op: *product = RSP_PRODUCT_##op; return true;
+    RSP_PRODUCT_OPCODES
+#undef X
+
+    default:
+      return false;
+  }
+}
+
+/* Vector instructions that write a flag register whole without */
+/* reading it: VCO for the carries, VCC for the compares. Each */
+/* also has a function that leaves that register alone, for when */
+/* what it'd write is written over before anything reads it (see */
+/* RSPFindDeadFlagWrites); they take the same arguments. */
+#define RSP_FLAG_WRITER_OPCODES \
+  X(VADDC) X(VSUBC) X(VEQ) X(VGE) X(VLT) X(VNE)
+
+enum RSPFlagWriter {
+#define X(op) RSP_FLAG_WRITER_##op,
+  RSP_FLAG_WRITER_OPCODES
+#undef X
+  NUM_RSP_FLAG_WRITERS
+};
+
+#define X(op) void RSP##op##NoFlags( \
+  struct RSPCP2 *, int16_t *, const int16_t *, const int16_t *, unsigned);
+RSP_FLAG_WRITER_OPCODES
+#undef X
+
+extern const RSPVectorFunction RSPNoFlagsFunctionTable[NUM_RSP_FLAG_WRITERS];
+
+static inline bool RSPGetFlagWriter(enum RSPVOpcodeID id,
+  enum RSPFlagWriter *writer) {
+  switch (id) {
+#define X(op) case RSP_OPCODE_##op: \
+    *writer = RSP_FLAG_WRITER_##op; return true;
+    RSP_FLAG_WRITER_OPCODES
+#undef X
+
+    default:
+      return false;
+  }
+}
+
+/* Forms an element specifier takes: vt as is (0-1), or with */
+/* each quarter (2-3), half (4-7) or all (8-15) of it filled */
+/* from one of its slices. Tables built for one form only take */
+/* the elements of that form, and can skip the work for others. */
+enum RSPElementForm {
+  RSP_ELEMENTS_IDENTITY,
+  RSP_ELEMENTS_QUARTER,
+  RSP_ELEMENTS_HALF,
+  RSP_ELEMENTS_WHOLE,
+  NUM_RSP_ELEMENT_FORMS
+};
+
+static inline enum RSPElementForm RSPGetElementForm(unsigned element) {
+  return (enum RSPElementForm) ((element >= 2) + (element >= 4) +
+    (element >= 8));
+}
+
+/* Tables of vector functions built for different instruction */
+/* sets, in order; each needs what the ones before it need. */
+/* Each also has a table per element form (see above), which */
+/* is the one for any element where nothing better was built. */
+struct RSPVectorBackend {
+  const char *name;
+  const RSPVectorFunction *functions;
+  const RSPVectorFunction *forms[NUM_RSP_ELEMENT_FORMS];
+  const RSPFusedFunction *fused;
+  const RSPVectorFunction *noAcc;
+  const RSPVectorFunction *noFlags;
+};
+
+extern const struct RSPVectorBackend RSPVectorBackends[];
+extern const unsigned NumRSPVectorBackends;
+
+/* The tables the host runs (see RSPSelectVectorFunctions). */
+extern const RSPVectorFunction *RSPVectorFunctions;
+extern const RSPVectorFunction *RSPVectorFormFunctions[NUM_RSP_ELEMENT_FORMS];
+extern const RSPFusedFunction *RSPFusedFunctions;
+extern const RSPVectorFunction *RSPNoAccFunctions;
+extern const RSPVectorFunction *RSPNoFlagsFunctions;
+
+unsigned RSPGetHostVectorBackends(void);
+void RSPSelectVectorFunctions(void);
+
 #ifndef NDEBUG
 extern const char *RSPScalarOpcodeMnemonics[NUM_RSP_SCALAR_OPCODES];
 extern const char *RSPVectorOpcodeMnemonics[NUM_RSP_VECTOR_OPCODES];
@@ -15,10 +15,13 @@
 #include "Decoder.h"
 #include "DFStage.h"
 #include "EXStage.h"
+#include "Functional.h"
+#include "IdleLoop.h"
 #include "IFStage.h"
 #include "Opcodes.h"
 #include "Pipeline.h"
 #include "RDStage.h"
+#include "Recompiler.h"
 #include "WBStage.h"
 
 #ifdef __cplusplus
@@ -64,24 +67,19 @@ IsLoadUseStall(const struct RSPRDEXLatch *rdexLatch, uint32_t exInfoFlags,
 }
 
 /* ============================================================================
- *  CycleRSP: Advances the state of the processor pipeline one cycle.
+ *  AdvancePipeline: Advances the state of the processor pipeline one cycle.
  * ========================================================================= */
-void
-CycleRSP(struct RSP *rsp) {
+static inline void
+AdvancePipeline(struct RSP *rsp) {
   bool ldStoreStall, ldUseStall;
   unsigned rsSource = GET_RS(rsp->pipeline.rdexLatch.iw);
   unsigned rtSource = GET_RT(rsp->pipeline.rdexLatch.iw);
-  unsigned rs, rt;
 
   /* Generate outputs for later stages. */ 
   struct RSPOpcode dfOpcode = rsp->pipeline.exdfLatch.opcode;
   struct RSPOpcode exOpcode = rsp->pipeline.rdexLatch.opcode;
   struct RSPOpcode rfOpcode;
 
-  /* If we're halted, just bail out. */
-  if (rsp->cp0.regs[SP_STATUS_REG] & 0x1)
-    return;
-
   RSPWBStage(rsp);
   RSPDFStage(rsp);
 
@@ -112,6 +110,65 @@ CycleRSP(struct RSP *rsp) {
     RSPIFStage(rsp);
 }
 
+/* ============================================================================
+ *  CycleRSP: Advances the state of the processor pipeline one cycle.
+ * ========================================================================= */
+void
+CycleRSP(struct RSP *rsp) {
+
+  /* If we're halted, just bail out. */
+  if (rsp->cp0.regs[SP_STATUS_REG] & 0x1)
+    return;
+
+  AdvancePipeline(rsp);
+}
+
+/* ============================================================================
+ *  RSPDrainPipeline: Advances the pipeline one cycle, retiring everything
+ *  in flight instead of decoding/fetching: only the IF/RD latch remains.
+ *
+ *  Afterwards, every instruction up to and including the one that was in
+ *  EX has been written back, and instructions may be retired one at a time
+ *  (fetch, execute, commit) until the pipeline is refilled. The state that
+ *  is needed to refill it again is returned through the hazard state.
+ * ========================================================================= */
+unsigned
+RSPDrainPipeline(struct RSP *rsp, struct RSPHazardState *state) {
+  unsigned rsSource = GET_RS(rsp->pipeline.rdexLatch.iw);
+  unsigned rtSource = GET_RT(rsp->pipeline.rdexLatch.iw);
+  struct RSPOpcode exOpcode = rsp->pipeline.rdexLatch.opcode;
+
+  if (rsp->cp0.regs[SP_STATUS_REG] & 0x1)
+    return 0;
+
+  /* Retire whatever is in DF, then execute. */
+  RSPWBStage(rsp);
+  RSPDFStage(rsp);
+  RSPWBStage(rsp);
+
+  state->dfDest = rsp->pipeline.dfwbLatch.result.dest;
+  RSPEXStage(rsp, rsSource, rtSource);
+  RSPCycleCP2(&rsp->cp2);
+
+  state->exInfoFlags = exOpcode.infoFlags;
+  state->rsSource = rsSource;
+  state->rtSource = rtSource;
+  state->exDest = rsp->pipeline.exdfLatch.result.dest;
+
+  RSPDFStage(rsp);
+  RSPWBStage(rsp);
+  rsp->regs[RSP_REGISTER_ZERO] = 0;
+
+  RSPInvalidateOpcode(&rsp->pipeline.rdexLatch.opcode);
+  RSPInvalidateVectorOpcode(&rsp->cp2.opcode);
+
+#ifndef NDEBUG
+  rsp->pipeline.cycles++;
+#endif
+
+  return 1;
+}
+
 /* ============================================================================
  *  RSPInitPipeline: Initializes the pipeline.
  * ========================================================================= */
@@ -120,8 +177,110 @@ RSPInitPipeline(struct RSPPipeline *pipeline) {
   RSPInvalidateOpcode(&pipeline->rdexLatch.opcode);
   RSPInvalidateOpcode(&pipeline->exdfLatch.opcode);
 
+  pipeline->ifrdLatch.decoded = &RSPResetInstruction;
   pipeline->ifrdLatch.firstIW = 0;
-  pipeline->ifrdLatch.secondIW = 0;
   pipeline->ifrdLatch.pc = 0x1000;
 }
 
+
+/* ============================================================================
+ *  RunMode: Runs for up to a given number of cycles (or instructions) in
+ *  the current execution mode, stopping early on any event.
+ * ========================================================================= */
+static unsigned
+RunMode(struct RSP *rsp, unsigned cycles) {
+  unsigned count = 0;
+
+  switch (rsp->mode) {
+    case RSP_MODE_FUNCTIONAL:
+    case RSP_MODE_FUNCTIONAL_TABLE:
+      return RSPRunFunctional(rsp, cycles);
+
+    case RSP_MODE_RECOMPILER:
+      return RSPRunRecompiled(rsp, cycles);
+
+    default:
+      while (count < cycles) {
+        AdvancePipeline(rsp);
+        count++;
+
+        if (unlikely(rsp->events))
+          break;
+      }
+
+      break;
+  }
+
+  return count;
+}
+
+/* ============================================================================
+ *  RunRSP: Advances the pipeline up to a given number of cycles, stopping
+ *  early on a BREAK, halt, or when an interrupt or signal is raised.
+ *  Returns the number of cycles consumed; the status says why it stopped.
+ *
+ *  In functional mode, the budget is in instructions rather than cycles.
+ *
+ *  Polling loops that can't get anywhere until the host does something
+ *  are skipped (see RSPSkipIdleLoop); the budget is then consumed all the
+ *  same, but the status is RSP_RUN_IDLE so the host knows to move on.
+ * ========================================================================= */
+unsigned
+RunRSP(struct RSP *rsp, unsigned cycles, enum RSPRunStatus *status) {
+  unsigned count, skipped = 0;
+
+  rsp->events = 0;
+
+  if (rsp->cp0.regs[SP_STATUS_REG] & 0x1) {
+    *status = RSP_RUN_HALT;
+    return 0;
+  }
+
+  RSPResetIdleLoop(&rsp->idleLoop);
+  count = RunMode(rsp, cycles);
+
+  while (rsp->events == RSP_EVENT_IDLE) {
+    unsigned skip = RSPSkipIdleLoop(rsp, count, cycles);
+
+    rsp->events = 0;
+    skipped += skip;
+
+    if ((count += skip) < cycles)
+      count += RunMode(rsp, cycles - count);
+  }
+
+  rsp->idleLoop.enabled = false;
+  *status = skipped > 0 && !rsp->events
+    ? RSP_RUN_IDLE : RSPGetRunStatus(rsp);
+
+  return count;
+}
+
+/* ============================================================================
+ *  RSPRefillPipeline: Rebuilds the latches of a drained pipeline, such
+ *  that CycleRSP picks up exactly where the pipeline would have been.
+ * ========================================================================= */
+void
+RSPRefillPipeline(struct RSP *rsp, const struct RSPHazardState *state) {
+  struct RSPPipeline *pipeline = &rsp->pipeline;
+  uint32_t rdInfoFlags;
+
+  /* Results have already been written back; replay them harmlessly. */
+  pipeline->exdfLatch.result.dest = state->exDest;
+  pipeline->exdfLatch.result.data = rsp->regs[state->exDest];
+  pipeline->exdfLatch.memoryData.function = NULL;
+  pipeline->dfwbLatch.result.dest = state->dfDest;
+  pipeline->dfwbLatch.result.data = rsp->regs[state->dfDest];
+
+  RSPRDStage(rsp);
+  rdInfoFlags = pipeline->rdexLatch.opcode.infoFlags;
+
+  /* Fetch if there were no stalls. */
+  if (unlikely(RSPIsLoadUseHazard(state, rdInfoFlags))) {
+    RSPInvalidateOpcode(&pipeline->rdexLatch.opcode);
+    RSPInvalidateVectorOpcode(&rsp->cp2.opcode);
+  }
+
+  else
+    RSPIFStage(rsp);
+}
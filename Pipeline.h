@@ -11,6 +11,7 @@
 #ifndef __RSP__PIPELINE_H__
 #define __RSP__PIPELINE_H__
 #include "Common.h"
+#include "DecodeCache.h"
 #include "Decoder.h"
 #include "Memory.h"
 
@@ -28,7 +29,8 @@ struct RSPScalarResult {
 };
 
 struct RSPIFRDLatch {
-  uint32_t firstIW, secondIW;
+  const struct RSPDecodedInstruction *decoded;
+  uint32_t firstIW;
   uint32_t fetchedPC, pc;
 };
 
@@ -60,10 +62,67 @@ struct RSPPipeline {
 #endif
 };
 
+/* Everything needed to reproduce load/use stalls when */
+/* instructions are retired one at a time (i.e., the pipeline */
+/* has been drained): the last instruction to leave EX, and the */
+/* destinations of the last two EX cycles (zero for bubbles). */
+struct RSPHazardState {
+  uint32_t exInfoFlags;
+  unsigned rsSource, rtSource;
+  unsigned exDest, dfDest;
+};
+
+/* Why RunRSP returned; see RSPGetRunStatus. */
+enum RSPRunStatus {
+  RSP_RUN_BUDGET,
+  RSP_RUN_BREAK,
+  RSP_RUN_HALT,
+  RSP_RUN_SIGNAL,
+  RSP_RUN_IDLE    /* Budget spent, some of it skipped in a polling loop. */
+};
+
 struct RSP;
 
 void CycleRSP(struct RSP *);
+unsigned RunRSP(struct RSP *, unsigned, enum RSPRunStatus *);
+unsigned RSPDrainPipeline(struct RSP *, struct RSPHazardState *);
 void RSPInitPipeline(struct RSPPipeline *);
+void RSPRefillPipeline(struct RSP *, const struct RSPHazardState *);
+
+/* ============================================================================
+ *  RSPIsLoadUseHazard: Determines if an instruction about to leave RD
+ *  would be held back by the last instruction to leave EX.
+ *
+ *  Mirrors the checks that CycleRSP performs on the latches. Scalar
+ *  load/store stalls never occur in CycleRSP (exdfLatch.opcode is never
+ *  populated), so they are not modeled here either.
+ * ========================================================================= */
+static inline bool
+RSPIsLoadUseHazard(const struct RSPHazardState *state, uint32_t rdInfoFlags) {
+  bool rdRequiresRS = rdInfoFlags & OPCODE_INFO_NEED_RS;
+  bool rdRequiresRT = rdInfoFlags & OPCODE_INFO_NEED_RT;
+
+  if (!(state->exInfoFlags & OPCODE_INFO_LOAD))
+    return false;
+
+  return (rdRequiresRS && (state->rsSource == state->exDest ||
+    state->rsSource == state->dfDest)) || (rdRequiresRT &&
+    (state->rtSource == state->exDest || state->rtSource == state->dfDest));
+}
+
+/* ============================================================================
+ *  RSPAdvanceHazardState: Records an instruction (or a bubble, if the
+ *  flags are zero) leaving the EX stage.
+ * ========================================================================= */
+static inline void
+RSPAdvanceHazardState(struct RSPHazardState *state, uint32_t exInfoFlags,
+  unsigned rsSource, unsigned rtSource, unsigned exDest) {
+  state->dfDest = state->exDest;
+  state->exInfoFlags = exInfoFlags;
+  state->rsSource = rsSource;
+  state->rtSource = rtSource;
+  state->exDest = exDest;
+}
 
 #endif
 
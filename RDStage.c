@@ -10,6 +10,7 @@
  * ========================================================================= */
 #include "Common.h"
 #include "CPU.h"
+#include "DecodeCache.h"
 #include "Decoder.h"
 #include "Opcodes.h"
 #include "RDStage.h"
@@ -48,12 +49,13 @@ void
 RSPRDStage(struct RSP *rsp) {
   struct RSPIFRDLatch *ifrdLatch = &rsp->pipeline.ifrdLatch;
   struct RSPRDEXLatch *rdexLatch = &rsp->pipeline.rdexLatch;
+  const struct RSPDecodedInstruction *decoded = ifrdLatch->decoded;
   bool isFirstIWBranchType, isFirstIWVectorType, inDelaySlot;
   const struct RSPOpcode *firstOpcode, *secondOpcode;
   uint32_t fetchedPC = ifrdLatch->fetchedPC;
 
   /* Classify the instruction that was fetched first. */
-  firstOpcode = RSPDecodeInstruction(ifrdLatch->firstIW);
+  firstOpcode = &decoded->opcode;
   isFirstIWBranchType = IsBranch(firstOpcode);
   isFirstIWVectorType = IsVector(firstOpcode);
   inDelaySlot = IsBranch(&rdexLatch->opcode);
@@ -62,13 +64,16 @@ RSPRDStage(struct RSP *rsp) {
   /* Might not dual issue based on prior logic in some (niche?) cases. */
   /* Examples: Target of taken branch and not doubleword aligned, etc... */
   if (CanDualIssue(isFirstIWBranchType, didBranch, inDelaySlot, fetchedPC)) {
-    secondOpcode = RSPDecodeInstruction(ifrdLatch->secondIW);
+    const struct RSPDecodedInstruction *second = RSPGetDecodedInstruction(
+      &rsp->decodeCache, rsp->imem, fetchedPC + 4);
+
+    secondOpcode = &second->opcode;
 
     /* We can dual-issue; just make sure types differ. */
     if (isFirstIWVectorType != IsVector(secondOpcode)) {
 
       if (isFirstIWVectorType) {
-        rdexLatch->iw = ifrdLatch->secondIW;
+        rdexLatch->iw = second->iw;
         cp2->iw = ifrdLatch->firstIW;
 
         rdexLatch->opcode = *secondOpcode;
@@ -77,7 +82,7 @@ RSPRDStage(struct RSP *rsp) {
 
       else {
         rdexLatch->iw = ifrdLatch->firstIW;
-        cp2->iw = ifrdLatch->secondIW;
+        cp2->iw = second->iw;
 
         rdexLatch->opcode = *firstOpcode;
         cp2->opcode = *RSPDecodeVectorInstruction(cp2->iw);
@@ -94,7 +99,7 @@ RSPRDStage(struct RSP *rsp) {
   if (isFirstIWVectorType) {
     rsp->cp2.iw = ifrdLatch->firstIW;
 
-    rsp->cp2.opcode = *RSPDecodeVectorInstruction(rsp->cp2.iw);
+    rsp->cp2.opcode = decoded->vectorOpcode;
     RSPInvalidateOpcode(&rdexLatch->opcode);
   }
 
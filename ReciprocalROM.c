@@ -11,6 +11,11 @@
 #include "Common.h"
 #include "ReciprocalROM.h"
 
+#if defined(RSP_DIVIDE_TABLES) && (defined(__unix__) || defined(__APPLE__))
+#define RSP_HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
 const uint16_t ReciprocalLUT[1024] = {
   0xffff, 0xff00, 0xfe01, 0xfd04, 0xfc07, 0xfb0c, 0xfa11, 0xf918,
   0xf81f, 0xf727, 0xf631, 0xf53b, 0xf446, 0xf352, 0xf25f, 0xf16d,
@@ -142,3 +147,43 @@ const uint16_t ReciprocalLUT[1024] = {
   0x0101, 0x6b76, 0x00c0, 0x6b1a, 0x0080, 0x6abf, 0x0040, 0x6a64
 };
 
+
+#ifdef RSP_DIVIDE_TABLES
+uint32_t RSPReciprocalTable[RSP_DIVIDE_TABLE_ENTRIES];
+uint32_t RSPInverseSqrtTable[RSP_DIVIDE_TABLE_ENTRIES];
+
+/* ============================================================================
+ *  FillDivideTables: Computes every entry of the tables. Only ever run once.
+ * ========================================================================= */
+static void
+FillDivideTables(void) {
+  int32_t input;
+
+  for (input = -0x8000; input < 0x10000; input++) {
+    RSPReciprocalTable[input + 0x8000] = RSPReciprocal(input);
+    RSPInverseSqrtTable[input + 0x8000] = RSPInverseSqrt(input);
+  }
+}
+#endif
+
+/* ============================================================================
+ *  RSPBuildDivideTables: Fills in the tables of single precision results,
+ *  if they are built in. Called by CreateRSP. The first call fills them,
+ *  under pthread_once, so RSPs may be created from several threads at once;
+ *  later calls just wait for it.
+ * ========================================================================= */
+void
+RSPBuildDivideTables(void) {
+#ifdef RSP_HAVE_PTHREADS
+  static pthread_once_t built = PTHREAD_ONCE_INIT;
+
+  pthread_once(&built, FillDivideTables);
+#elif defined(RSP_DIVIDE_TABLES)
+  static bool built;
+
+  if (!built) {
+    FillDivideTables();
+    built = true;
+  }
+#endif
+}
@@ -14,5 +14,97 @@
 
 extern const uint16_t ReciprocalLUT[1024];
 
+/* With RSP_DIVIDE_TABLES, the result for every input a single */
+/* precision VRCP* or VRSQ* can take (a slice, sign or zero */
+/* extended) is kept, indexed by the input plus 0x8000. */
+#define RSP_DIVIDE_TABLE_ENTRIES 0x18000
+
+#ifdef RSP_DIVIDE_TABLES
+extern uint32_t RSPReciprocalTable[RSP_DIVIDE_TABLE_ENTRIES];
+extern uint32_t RSPInverseSqrtTable[RSP_DIVIDE_TABLE_ENTRIES];
+#endif
+
+void RSPBuildDivideTables(void);
+
+/* ============================================================================
+ *  RSPCountLeadingZeros: Counts the leading zeros of a nonzero word.
+ * ========================================================================= */
+static inline unsigned
+RSPCountLeadingZeros(uint32_t word) {
+#ifdef __GNUC__
+  return __builtin_clz(word);
+#else
+  unsigned count = 0;
+
+  while (!(word & 0x80000000)) {
+    word <<= 1;
+    count++;
+  }
+
+  return count;
+#endif
+}
+
+/* ============================================================================
+ *  RSPReciprocal/RSPInverseSqrt: What the divider returns for an input: the
+ *  ROM entry for the 9 bits after its leading one, shifted down by (half of,
+ *  for square roots) the position of that one. Negative inputs work on their
+ *  magnitude (less one, below -32768), and invert the result.
+ * ========================================================================= */
+static inline uint32_t
+RSPReciprocal(int32_t input) {
+  uint32_t data = input < 0
+    ? -(uint32_t) input - (input < -32768) : (uint32_t) input;
+  uint32_t result;
+  unsigned shift;
+
+  if (data == 0)
+    return 0x7FFFFFFF;
+
+  shift = RSPCountLeadingZeros(data);
+  result = ReciprocalLUT[data << shift >> 22 & 0x1FF];
+  result = (0x40000000 | result << 14) >> (31 - shift);
+  return input < 0 ? ~result : result;
+}
+
+static inline uint32_t
+RSPInverseSqrt(int32_t input) {
+  uint32_t data = input < 0
+    ? -(uint32_t) input - (input < -32768) : (uint32_t) input;
+  uint32_t result, index;
+  unsigned shift;
+
+  if (data == 0)
+    return 0x7FFFFFFF;
+
+  /* Odd and even shifts get halves of the table of their own. */
+  shift = RSPCountLeadingZeros(data);
+  index = (data << shift >> 22 & 0x1FE) | 0x200 | (shift & 1);
+  result = (0x40000000 | ReciprocalLUT[index] << 14) >> ((31 - shift) >> 1);
+  return input < 0 ? ~result : result;
+}
+
+/* ============================================================================
+ *  RSPSingleReciprocal/RSPSingleInverseSqrt: The same, for single precision
+ *  inputs; looked up whole where there are tables for them.
+ * ========================================================================= */
+static inline uint32_t
+RSPSingleReciprocal(int32_t input) {
+#ifdef RSP_DIVIDE_TABLES
+  return RSPReciprocalTable[input + 0x8000];
+#else
+  return RSPReciprocal(input);
+#endif
+}
+
+static inline uint32_t
+RSPSingleInverseSqrt(int32_t input) {
+#ifdef RSP_DIVIDE_TABLES
+  return RSPInverseSqrtTable[input + 0x8000];
+#else
+  return RSPInverseSqrt(input);
+#endif
+}
+
 #endif
 
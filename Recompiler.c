@@ -0,0 +1,703 @@
+/* ============================================================================
+ *  Recompiler.c: Dynamic recompiler (x86-64).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include "Common.h"
+#include "CP0.h"
+#include "CP2.h"
+#include "CPU.h"
+#include "Definitions.h"
+#include "DecodeCache.h"
+#include "DFStage.h"
+#include "IFStage.h"
+#include "Opcodes.h"
+#include "Pipeline.h"
+#include "Recompiler.h"
+#include "Registry.h"
+#include "WBStage.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#else
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+#ifdef RSP_HAVE_RECOMPILER
+#include <sys/mman.h>
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+/* Upper bound on the code emitted for one instruction. */
+#define RSP_MAX_INSTRUCTION_BYTES 192
+
+enum X86Register {
+  X86_EAX, X86_ECX, X86_EDX, X86_EBX,
+  X86_ESP, X86_EBP, X86_ESI, X86_EDI
+};
+
+#define OFFSET(member) ((uint32_t) offsetof(struct RSP, member))
+
+#define NEXT_PC(pc) ((((pc) + 4) & 0xFFC) | 0x1000)
+
+/* ============================================================================
+ *  Emitter: Everything is addressed relative to rbx, which holds the RSP
+ *  for the duration of a block (and is preserved by the calls we make).
+ * ========================================================================= */
+static uint8_t *
+EmitByte(uint8_t *code, uint8_t byte) {
+  *code = byte;
+  return code + 1;
+}
+
+static uint8_t *
+EmitDword(uint8_t *code, uint32_t dword) {
+  memcpy(code, &dword, sizeof(dword));
+  return code + sizeof(dword);
+}
+
+/* mov reg32, [rbx + disp32] */
+static uint8_t *
+EmitLoad(uint8_t *code, enum X86Register reg, uint32_t disp) {
+  code = EmitByte(code, 0x8B);
+  code = EmitByte(code, 0x80 | reg << 3 | X86_EBX);
+  return EmitDword(code, disp);
+}
+
+/* mov dword [rbx + disp32], imm32 */
+static uint8_t *
+EmitStoreImmediate(uint8_t *code, uint32_t disp, uint32_t imm) {
+  code = EmitByte(code, 0xC7);
+  code = EmitByte(code, 0x80 | X86_EBX);
+  code = EmitDword(code, disp);
+  return EmitDword(code, imm);
+}
+
+/* lea reg64, [rbx + disp32] */
+static uint8_t *
+EmitAddress(uint8_t *code, enum X86Register reg, uint32_t disp) {
+  code = EmitByte(code, 0x48);
+  code = EmitByte(code, 0x8D);
+  code = EmitByte(code, 0x80 | reg << 3 | X86_EBX);
+  return EmitDword(code, disp);
+}
+
+/* mov reg32, [rbx + disp32] (or xor reg32, reg32 for $zero) */
+static uint8_t *
+EmitLoadRegister(uint8_t *code, enum X86Register reg, unsigned source) {
+  if (source == RSP_REGISTER_ZERO) {
+    code = EmitByte(code, 0x31);
+    return EmitByte(code, 0xC0 | reg << 3 | reg);
+  }
+
+  return EmitLoad(code, reg, OFFSET(regs) + source * sizeof(uint32_t));
+}
+
+/* mov rax, [rbx + recompiler]; call [rax + calls[call]] */
+static uint8_t *
+EmitCall(uint8_t *code, enum RSPRecompilerCall call) {
+  code = EmitByte(code, 0x48);
+  code = EmitByte(code, 0x8B);
+  code = EmitByte(code, 0x80 | X86_EAX << 3 | X86_EBX);
+  code = EmitDword(code, OFFSET(recompiler));
+
+  code = EmitByte(code, 0xFF);
+  code = EmitByte(code, 0x80 | 2 << 3 | X86_EAX);
+  return EmitDword(code, (uint32_t) (offsetof(struct RSPRecompiler, calls) +
+    call * sizeof(uintptr_t)));
+}
+
+/* mov rdi, rbx; call function */
+static uint8_t *
+EmitCallWithRSP(uint8_t *code, enum RSPRecompilerCall call) {
+  code = EmitByte(code, 0x48);
+  code = EmitByte(code, 0x89);
+  code = EmitByte(code, 0xDF);
+  return EmitCall(code, call);
+}
+
+/* ============================================================================
+ *  CommitMemoryResult: Retires a memory operation (DF, then WB).
+ * ========================================================================= */
+static void
+CommitMemoryResult(struct RSP *rsp) {
+  RSPDFStage(rsp);
+  RSPWBStage(rsp);
+  rsp->regs[RSP_REGISTER_ZERO] = 0;
+}
+
+/* ============================================================================
+ *  EmitFetch: Emits the IF stage for the instruction after the one at pc.
+ *  Done ahead of executing it, as the pipeline would have done.
+ * ========================================================================= */
+static uint8_t *
+EmitFetch(uint8_t *code, uint32_t pc) {
+  code = EmitStoreImmediate(code,
+    OFFSET(pipeline.ifrdLatch.pc), NEXT_PC(pc));
+
+  return EmitCallWithRSP(code, RSP_CALL_IF_STAGE);
+}
+
+/* ============================================================================
+ *  EmitScalarInstruction: Emits the RD, EX, DF and WB stages.
+ * ========================================================================= */
+static uint8_t *
+EmitScalarInstruction(uint8_t *code,
+  const struct RSPDecodedInstruction *decoded, uint32_t pc) {
+  uint32_t infoFlags = decoded->opcode.infoFlags;
+
+  code = EmitStoreImmediate(code, OFFSET(pipeline.rdexLatch.iw), decoded->iw);
+  code = EmitStoreImmediate(code, OFFSET(pipeline.exdfLatch.result.dest), 0);
+
+  if (infoFlags & OPCODE_INFO_BRANCH)
+    code = EmitStoreImmediate(code, OFFSET(pipeline.rdexLatch.pc), pc + 4);
+
+  code = EmitLoadRegister(code, X86_ESI, decoded->rs);
+  code = EmitLoadRegister(code, X86_EDX, decoded->rt);
+  code = EmitCallWithRSP(code, (enum RSPRecompilerCall) decoded->opcode.id);
+
+  /* Loads and stores go through DF; write everything else back here. */
+  if (infoFlags & (OPCODE_INFO_LOAD | OPCODE_INFO_STORE |
+    OPCODE_INFO_LWC2 | OPCODE_INFO_SWC2))
+    return EmitCallWithRSP(code, RSP_CALL_COMMIT_MEMORY);
+
+  code = EmitLoad(code, X86_EAX, OFFSET(pipeline.exdfLatch.result.data));
+  code = EmitLoad(code, X86_ECX, OFFSET(pipeline.exdfLatch.result.dest));
+
+  /* mov [rbx + rcx * 4 + disp32], eax */
+  code = EmitByte(code, 0x89);
+  code = EmitByte(code, 0x84);
+  code = EmitByte(code, 0x8B);
+  code = EmitDword(code, OFFSET(regs));
+
+  return EmitStoreImmediate(code, OFFSET(regs), 0);
+}
+
+/* ============================================================================
+ *  EmitVectorInstruction: Emits a direct call to the vector unit, to the
+ *  function for the instruction's element form; or, if what it writes to
+ *  the accumulator is dead, to the one that leaves the accumulator be; or,
+ *  if the flag register it writes is dead, to the one that leaves it be.
+ * ========================================================================= */
+static uint8_t *
+EmitVectorInstruction(uint8_t *code,
+  const struct RSPDecodedInstruction *decoded,
+  bool deadAccumulator, bool deadFlags) {
+  enum RSPFlagWriter writer;
+  enum RSPProduct product;
+  uint32_t vregs = OFFSET(cp2.regs);
+  uint32_t size = sizeof(struct RSPVector);
+
+  /* Some functions peek at the instruction word. */
+  code = EmitStoreImmediate(code, OFFSET(cp2.iw), decoded->iw);
+
+  code = EmitAddress(code, X86_EDI, OFFSET(cp2));
+  code = EmitAddress(code, X86_ESI, vregs + decoded->sa * size);
+  code = EmitAddress(code, X86_EDX, vregs + decoded->rd * size);
+  code = EmitAddress(code, X86_ECX, vregs + decoded->rt * size);
+
+  /* mov r8d, imm32 */
+  code = EmitByte(code, 0x41);
+  code = EmitByte(code, 0xB8);
+  code = EmitDword(code, decoded->element);
+
+  if (deadAccumulator && RSPGetProduct(decoded->vectorOpcode.id, &product))
+    return EmitCall(code,
+      (enum RSPRecompilerCall) (RSP_CALL_NO_ACC + product));
+
+  if (deadFlags && RSPGetFlagWriter(decoded->vectorOpcode.id, &writer))
+    return EmitCall(code,
+      (enum RSPRecompilerCall) (RSP_CALL_NO_FLAGS + writer));
+
+  return EmitCall(code, (enum RSPRecompilerCall) (NUM_RSP_SCALAR_OPCODES +
+    RSPGetElementForm(decoded->element) * NUM_RSP_VECTOR_OPCODES +
+    decoded->vectorOpcode.id));
+}
+
+/* ============================================================================
+ *  EmitFusedInstructions: Emits a single call to the function for a fused
+ *  idiom, with each of the instruction words in the run (zero past it).
+ * ========================================================================= */
+static uint8_t *
+EmitFusedInstructions(uint8_t *code,
+  const struct RSPDecodedInstruction **instructions,
+  unsigned length, enum RSPFusedIdiom idiom) {
+  static const enum X86Register words[] = {X86_ESI, X86_EDX, X86_ECX};
+  uint32_t iws[4] = {0, 0, 0, 0};
+  unsigned i;
+
+  for (i = 0; i < length; i++)
+    iws[i] = instructions[i]->iw;
+
+  code = EmitAddress(code, X86_EDI, OFFSET(cp2));
+
+  /* mov reg32, imm32 */
+  for (i = 0; i < 3; i++) {
+    code = EmitByte(code, 0xB8 | words[i]);
+    code = EmitDword(code, iws[i]);
+  }
+
+  /* mov r8d, imm32 */
+  code = EmitByte(code, 0x41);
+  code = EmitByte(code, 0xB8);
+  code = EmitDword(code, iws[3]);
+
+  return EmitCall(code, (enum RSPRecompilerCall) (RSP_CALL_FUSED + idiom));
+}
+
+/* ============================================================================
+ *  GatherBlock: Collects the instructions that make up a block.
+ *
+ *  Blocks end after a branch and its delay slot, or after an instruction
+ *  that might halt the processor or rewrite IMEM. Blocks never wrap around
+ *  IMEM, and branches in delay slots are left to the interpreter.
+ * ========================================================================= */
+static unsigned
+GatherBlock(struct RSP *rsp, uint32_t pc,
+  const struct RSPDecodedInstruction **instructions, bool *endsInBranch) {
+  unsigned length = 0;
+
+  for (*endsInBranch = false; length < RSP_MAX_BLOCK_WORDS; pc += 4) {
+    const struct RSPDecodedInstruction *decoded, *delaySlot;
+
+    if (pc > 0x1FFC)
+      break;
+
+    decoded = RSPGetDecodedInstruction(&rsp->decodeCache, rsp->imem, pc);
+
+    if (decoded->opcode.infoFlags & OPCODE_INFO_BRANCH) {
+      if (length + 2 > RSP_MAX_BLOCK_WORDS || pc + 4 > 0x1FFC)
+        break;
+
+      delaySlot = RSPGetDecodedInstruction(
+        &rsp->decodeCache, rsp->imem, pc + 4);
+
+      if (delaySlot->opcode.infoFlags & OPCODE_INFO_BRANCH)
+        break;
+
+      instructions[length++] = decoded;
+      instructions[length++] = delaySlot;
+      *endsInBranch = true;
+      break;
+    }
+
+    instructions[length++] = decoded;
+
+    if (decoded->opcode.id == RSP_OPCODE_BREAK ||
+      decoded->opcode.id == RSP_OPCODE_MTC0)
+      break;
+  }
+
+  return length;
+}
+
+/* ============================================================================
+ *  ComputeBlockExit: Works out the cycles taken by a block (including any
+ *  load/use stalls within it), given the destination written back by the
+ *  EX cycle just before it.
+ * ========================================================================= */
+static void
+ComputeBlockExit(const struct RSPDecodedInstruction **instructions,
+  unsigned length, unsigned entryDest, struct RSPBlockExit *exit) {
+  struct RSPHazardState state;
+  unsigned i;
+
+  memset(&state, 0, sizeof(state));
+  state.exDest = entryDest;
+  exit->cycles = 0;
+
+  for (i = 0; i < length; i++) {
+    const struct RSPDecodedInstruction *decoded = instructions[i];
+    uint32_t infoFlags = decoded->opcode.infoFlags;
+
+    if (i > 0 && RSPIsLoadUseHazard(&state, infoFlags)) {
+      RSPAdvanceHazardState(&state, OPCODE_INFO_NONE, 0, 0, 0);
+      exit->cycles++;
+    }
+
+    RSPAdvanceHazardState(&state, infoFlags,
+      decoded->rs, decoded->rt, decoded->dest);
+
+    exit->cycles++;
+  }
+
+  exit->state = state;
+}
+
+/* ============================================================================
+ *  SetCodeWritable: Flips the code buffer between writable and executable;
+ *  it is never both at once. Returns false if the protection can't change.
+ * ========================================================================= */
+static bool
+SetCodeWritable(struct RSPRecompiler *recompiler, bool writable) {
+  if (recompiler->writable == writable)
+    return true;
+
+  if (mprotect(recompiler->code, RSP_RECOMPILER_CODE_SIZE, writable
+    ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC)) {
+    debug("Failed to change the protection of the code buffer.");
+    return false;
+  }
+
+  recompiler->writable = writable;
+  return true;
+}
+
+/* ============================================================================
+ *  FlushRecompiler: Discards every block that has been translated.
+ * ========================================================================= */
+static void
+FlushRecompiler(struct RSP *rsp, struct RSPRecompiler *recompiler) {
+  unsigned i;
+
+  for (i = 0; i < RSP_DECODE_CACHE_ENTRIES; i++)
+    rsp->decodeCache.entries[i].block = NULL;
+
+  recompiler->codeUsed = 0;
+  recompiler->numBlocks = 0;
+  recompiler->generation++;
+}
+
+/* ============================================================================
+ *  TranslateBlock: Translates the block starting at a given PC.
+ * ========================================================================= */
+static const struct RSPBlock *
+TranslateBlock(struct RSP *rsp,
+  struct RSPRecompiler *recompiler, uint32_t pc) {
+  const struct RSPDecodedInstruction *instructions[RSP_MAX_BLOCK_WORDS];
+  bool deadAccumulator[RSP_MAX_BLOCK_WORDS];
+  bool deadFlags[RSP_MAX_BLOCK_WORDS];
+  struct RSPDecodedInstruction *head =
+    &rsp->decodeCache.entries[pc >> 2 & RSP_DECODE_CACHE_MASK];
+
+  struct RSPBlock *block;
+  uint8_t *start, *code;
+
+  bool endsInBranch;
+  unsigned i, length, span;
+  unsigned other;
+
+  if ((length = GatherBlock(rsp, pc, instructions, &endsInBranch)) == 0)
+    return NULL;
+
+  /* Blocks run as a whole, so nothing can read the accumulator */
+  /* (or the flags) between the instructions of one but themselves. */
+  RSPFindDeadAccumulatorWrites(instructions, length, deadAccumulator);
+  RSPFindDeadFlagWrites(instructions, length, deadFlags);
+
+  if (recompiler->numBlocks == RSP_RECOMPILER_MAX_BLOCKS ||
+    RSP_RECOMPILER_CODE_SIZE - recompiler->codeUsed <
+    (length + 1) * RSP_MAX_INSTRUCTION_BYTES)
+    FlushRecompiler(rsp, recompiler);
+
+  if (!SetCodeWritable(recompiler, true))
+    return NULL;
+
+  block = &recompiler->blocks[recompiler->numBlocks++];
+  start = code = recompiler->code + recompiler->codeUsed;
+
+  /* push rbx; mov rbx, rdi */
+  code = EmitByte(code, 0x53);
+  code = EmitByte(code, 0x48);
+  code = EmitByte(code, 0x89);
+  code = EmitByte(code, 0xFB);
+
+  for (i = 0; i < length; i += span, pc += span * 4) {
+    const struct RSPDecodedInstruction *decoded = instructions[i];
+    bool isBranch = decoded->opcode.infoFlags & OPCODE_INFO_BRANCH;
+    enum RSPFusedIdiom idiom;
+
+    /* Runs of vector instructions that make up an idiom are run */
+    /* as one; nothing outside the vector unit can see between them. */
+    if ((span = RSPMatchFusedIdiom(instructions + i,
+      length - i, &idiom)) == 0)
+      span = 1;
+
+    /* The next instruction is fetched before this one executes. */
+    if (isBranch || (i + span == length && !endsInBranch))
+      code = EmitFetch(code, pc + (span - 1) * 4);
+
+    if (span > 1)
+      code = EmitFusedInstructions(code, instructions + i, span, idiom);
+
+    else if (decoded->opcode.infoFlags & OPCODE_INFO_VCOMP)
+      code = EmitVectorInstruction(code, decoded,
+        deadAccumulator[i], deadFlags[i]);
+
+    else
+      code = EmitScalarInstruction(code, decoded, pc);
+
+    /* Fetch from wherever the branch decided to go. */
+    if (isBranch)
+      code = EmitCallWithRSP(code, RSP_CALL_IF_STAGE);
+  }
+
+  /* pop rbx; ret */
+  code = EmitByte(code, 0x5B);
+  code = EmitByte(code, 0xC3);
+
+  recompiler->codeUsed += code - start;
+  block->code = (void (*)(struct RSP *)) (uintptr_t) start;
+  block->size = (uint32_t) (code - start);
+  block->infoFlags = instructions[0]->opcode.infoFlags;
+  block->rs = instructions[0]->rs;
+  block->rt = instructions[0]->rt;
+  block->length = length;
+
+  /* Only equality with rs/rt of the head matters on entry. */
+  for (other = 0; other == block->rs || other == block->rt; other++);
+
+  ComputeBlockExit(instructions, length, block->rs, &block->exits[0]);
+  ComputeBlockExit(instructions, length, block->rt, &block->exits[1]);
+  ComputeBlockExit(instructions, length, other, &block->exits[2]);
+
+  head->block = block;
+  return block;
+}
+
+/* ============================================================================
+ *  LookupBlock: Finds (or translates) the block that starts with the
+ *  instruction in the IF/RD latch, if it is safe to enter one there.
+ * ========================================================================= */
+static const struct RSPBlock *
+LookupBlock(struct RSP *rsp, struct RSPRecompiler *recompiler) {
+  const struct RSPIFRDLatch *ifrdLatch = &rsp->pipeline.ifrdLatch;
+  uint32_t pc = ifrdLatch->fetchedPC;
+
+  const struct RSPDecodedInstruction *decoded =
+    &rsp->decodeCache.entries[pc >> 2 & RSP_DECODE_CACHE_MASK];
+
+  /* Only enter on straight-line fetches of an up-to-date word. */
+  /* That rules out delay slots, and instructions fetched before */
+  /* their IMEM word was rewritten. */
+  if ((pc & ~0xFFCU) != 0x1000 || ifrdLatch->pc != NEXT_PC(pc) ||
+    ifrdLatch->decoded != decoded || !decoded->valid)
+    return NULL;
+
+  if (decoded->block != NULL)
+    return decoded->block;
+
+  return TranslateBlock(rsp, recompiler, pc);
+}
+
+/* ============================================================================
+ *  CreateRSPRecompiler: Creates a recompiler, with its code buffer.
+ * ========================================================================= */
+struct RSPRecompiler *
+CreateRSPRecompiler(void) {
+  struct RSPRecompiler *recompiler;
+  unsigned i;
+  void *code;
+
+  if ((recompiler = (struct RSPRecompiler*) malloc(
+    sizeof(*recompiler))) == NULL) {
+    debug("Failed to allocate memory.");
+    return NULL;
+  }
+
+  /* Blocks are emitted while it is writable, and only run once */
+  /* it has been made executable again (see SetCodeWritable). */
+  if ((code = mmap(NULL, RSP_RECOMPILER_CODE_SIZE,
+    PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+    -1, 0)) == MAP_FAILED) {
+    debug("Failed to map memory for code.");
+    free(recompiler);
+    return NULL;
+  }
+
+  for (i = 0; i < NUM_RSP_SCALAR_OPCODES; i++)
+    recompiler->calls[i] = (uintptr_t) RSPScalarFunctionTable[i];
+
+  for (i = 0; i < NUM_RSP_ELEMENT_FORMS * NUM_RSP_VECTOR_OPCODES; i++) {
+    recompiler->calls[NUM_RSP_SCALAR_OPCODES + i] = (uintptr_t)
+      RSPVectorFormFunctions[i / NUM_RSP_VECTOR_OPCODES][
+      i % NUM_RSP_VECTOR_OPCODES];
+  }
+
+  recompiler->calls[RSP_CALL_IF_STAGE] = (uintptr_t) &RSPIFStage;
+  recompiler->calls[RSP_CALL_COMMIT_MEMORY] = (uintptr_t) &CommitMemoryResult;
+
+  for (i = 0; i < NUM_RSP_FUSED_IDIOMS; i++)
+    recompiler->calls[RSP_CALL_FUSED + i] = (uintptr_t) RSPFusedFunctions[i];
+
+  for (i = 0; i < NUM_RSP_PRODUCTS; i++)
+    recompiler->calls[RSP_CALL_NO_ACC + i] = (uintptr_t) RSPNoAccFunctions[i];
+
+  for (i = 0; i < NUM_RSP_FLAG_WRITERS; i++)
+    recompiler->calls[RSP_CALL_NO_FLAGS + i] =
+      (uintptr_t) RSPNoFlagsFunctions[i];
+
+  recompiler->code = (uint8_t*) code;
+  recompiler->writable = true;
+  recompiler->codeUsed = 0;
+  recompiler->numBlocks = 0;
+  recompiler->generation = 0;
+  return recompiler;
+}
+
+/* ============================================================================
+ *  DestroyRSPRecompiler: Releases a recompiler and its code buffer.
+ * ========================================================================= */
+void
+DestroyRSPRecompiler(struct RSPRecompiler *recompiler) {
+  munmap(recompiler->code, RSP_RECOMPILER_CODE_SIZE);
+  free(recompiler);
+}
+
+/* ============================================================================
+ *  RSPFlushRecompiler: Discards every block, e.g., before the memory that
+ *  some of them were installed from goes away.
+ * ========================================================================= */
+void
+RSPFlushRecompiler(struct RSP *rsp) {
+  if (rsp->recompiler != NULL)
+    FlushRecompiler(rsp, rsp->recompiler);
+}
+
+/* ============================================================================
+ *  RSPTranslateBlock: Translates the block that starts at a PC ahead of
+ *  time (e.g., where a cache file says one was), unless it already has
+ *  been. Returns NULL if it couldn't be translated.
+ * ========================================================================= */
+const struct RSPBlock *
+RSPTranslateBlock(struct RSP *rsp, uint32_t pc) {
+  struct RSPRecompiler *recompiler = rsp->recompiler;
+  const struct RSPBlock *block;
+
+  if (recompiler == NULL &&
+    (recompiler = rsp->recompiler = CreateRSPRecompiler()) == NULL)
+    return NULL;
+
+  pc = (pc & 0xFFC) | 0x1000;
+
+  if ((block = rsp->decodeCache.entries[
+    pc >> 2 & RSP_DECODE_CACHE_MASK].block) != NULL)
+    return block;
+
+  return TranslateBlock(rsp, recompiler, pc);
+}
+
+/* ============================================================================
+ *  RSPRunRecompiled: Runs for up to a given number of cycles, executing
+ *  translated blocks wherever possible. Returns the cycles consumed, and
+ *  stops early on the same events as RunRSP (which, as there, are cleared
+ *  on the way in).
+ *
+ *  The pipeline is drained on the way in and refilled on the way out, so
+ *  this can be freely mixed with CycleRSP. Cycle counts (stalls included)
+ *  match those of CycleRSP; a block is only run if it fits in the budget.
+ * ========================================================================= */
+unsigned
+RSPRunRecompiled(struct RSP *rsp, unsigned cycles) {
+  struct RSPRecompiler *recompiler = rsp->recompiler;
+  struct RSPHazardState state;
+  unsigned count = 0;
+
+  rsp->events = 0;
+
+  if (cycles == 0 || (rsp->cp0.regs[SP_STATUS_REG] & SP_STATUS_HALT))
+    return 0;
+
+  if (recompiler == NULL &&
+    (recompiler = rsp->recompiler = CreateRSPRecompiler()) == NULL) {
+    while (count < cycles && !rsp->events) {
+      CycleRSP(rsp);
+      count++;
+    }
+
+    return count;
+  }
+
+  count = RSPDrainPipeline(rsp, &state);
+
+  while (count < cycles && !rsp->events) {
+    const struct RSPBlock *block = LookupBlock(rsp, recompiler);
+
+    if (block != NULL && SetCodeWritable(recompiler, false)) {
+      bool stall = RSPIsLoadUseHazard(&state, block->infoFlags);
+      unsigned entryDest = stall ? 0 : state.exDest;
+      const struct RSPBlockExit *exit = &block->exits[
+        entryDest == block->rs ? 0 : entryDest == block->rt ? 1 : 2];
+
+      if (count + stall + exit->cycles <= cycles) {
+        block->code(rsp);
+        count += stall + exit->cycles;
+
+        state = exit->state;
+        if (block->length == 1)
+          state.dfDest = entryDest;
+
+#ifndef NDEBUG
+        rsp->pipeline.cycles += stall + exit->cycles;
+#endif
+        continue;
+      }
+    }
+
+    /* Otherwise, let the interpreter have a go at it. */
+    RSPRefillPipeline(rsp, &state);
+    CycleRSP(rsp);
+
+    if (++count == cycles || rsp->events)
+      return count;
+
+    count += RSPDrainPipeline(rsp, &state);
+  }
+
+  RSPRefillPipeline(rsp, &state);
+  return count;
+}
+
+#else
+/* ============================================================================
+ *  No recompiler for this host: RSPRunRecompiled just interprets.
+ * ========================================================================= */
+struct RSPRecompiler *
+CreateRSPRecompiler(void) {
+  return NULL;
+}
+
+void
+DestroyRSPRecompiler(struct RSPRecompiler *unused(recompiler)) {}
+
+void
+RSPFlushRecompiler(struct RSP *unused(rsp)) {}
+
+const struct RSPBlock *
+RSPTranslateBlock(struct RSP *unused(rsp), uint32_t unused(pc)) {
+  return NULL;
+}
+
+unsigned
+RSPRunRecompiled(struct RSP *rsp, unsigned cycles) {
+  unsigned count = 0;
+
+  rsp->events = 0;
+
+  if (rsp->cp0.regs[SP_STATUS_REG] & SP_STATUS_HALT)
+    return 0;
+
+  while (count < cycles && !rsp->events) {
+    CycleRSP(rsp);
+    count++;
+  }
+
+  return count;
+}
+#endif
+
@@ -0,0 +1,88 @@
+/* ============================================================================
+ *  Recompiler.h: Dynamic recompiler (x86-64).
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__RECOMPILER_H__
+#define __RSP__RECOMPILER_H__
+#include "Common.h"
+#include "DecodeCache.h"
+#include "Opcodes.h"
+#include "Pipeline.h"
+
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#define RSP_HAVE_RECOMPILER
+#endif
+
+#define RSP_RECOMPILER_CODE_SIZE (1 << 20)
+#define RSP_RECOMPILER_MAX_BLOCKS 4096
+
+struct RSP;
+
+/* Translated code calls everything through the recompiler's table, */
+/* and addresses everything else relative to the RSP, so blocks */
+/* don't embed any host addresses. */
+/* The opcode handlers come first, scalar and then vector (a */
+/* table for each element form, in order); the fused idioms */
+/* products that leave the accumulator be, and the carries and */
+/* compares that leave their flags be come last. */
+enum RSPRecompilerCall {
+  RSP_CALL_IF_STAGE = NUM_RSP_SCALAR_OPCODES +
+    NUM_RSP_ELEMENT_FORMS * NUM_RSP_VECTOR_OPCODES,
+  RSP_CALL_COMMIT_MEMORY,
+  RSP_CALL_FUSED,
+  RSP_CALL_NO_ACC = RSP_CALL_FUSED + NUM_RSP_FUSED_IDIOMS,
+  RSP_CALL_NO_FLAGS = RSP_CALL_NO_ACC + NUM_RSP_PRODUCTS,
+  NUM_RSP_RECOMPILER_CALLS = RSP_CALL_NO_FLAGS + NUM_RSP_FLAG_WRITERS
+};
+
+/* Cycles taken by, and hazards left behind by, a block. Which */
+/* one applies depends on what was written back just before it. */
+struct RSPBlockExit {
+  struct RSPHazardState state;
+  unsigned cycles;
+};
+
+struct RSPBlock {
+  void (*code)(struct RSP *);
+  struct RSPBlockExit exits[3];
+
+  /* The first instruction, for hazard checks on entry. */
+  uint32_t infoFlags;
+  uint8_t rs, rt;
+  uint8_t length;
+
+  /* Bytes of code. */
+  uint32_t size;
+};
+
+struct RSPRecompiler {
+  uintptr_t calls[NUM_RSP_RECOMPILER_CALLS];
+
+  uint8_t *code;
+  size_t codeUsed;
+
+  /* Whether the code buffer is writable (else, it's executable). */
+  bool writable;
+
+  struct RSPBlock blocks[RSP_RECOMPILER_MAX_BLOCKS];
+  unsigned numBlocks;
+
+  /* Bumped whenever every block is discarded. */
+  unsigned generation;
+};
+
+struct RSPRecompiler *CreateRSPRecompiler(void);
+void DestroyRSPRecompiler(struct RSPRecompiler *);
+unsigned RSPRunRecompiled(struct RSP *, unsigned);
+
+void RSPFlushRecompiler(struct RSP *);
+const struct RSPBlock *RSPTranslateBlock(struct RSP *, uint32_t);
+
+#endif
+
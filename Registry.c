@@ -0,0 +1,280 @@
+/* ============================================================================
+ *  Registry.c: Microcode registry.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "CacheFile.h"
+#include "Common.h"
+#include "CPU.h"
+#include "DecodeCache.h"
+#include "Recompiler.h"
+#include "Registry.h"
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+/* ============================================================================
+ *  GetRecompilerGeneration: Identifies the set of blocks that is live.
+ * ========================================================================= */
+static unsigned
+GetRecompilerGeneration(const struct RSP *rsp) {
+  return rsp->recompiler != NULL ? rsp->recompiler->generation : 0;
+}
+
+/* ============================================================================
+ *  KeepLatchedInstruction: Gives the IF/RD latch its own copy of the
+ *  instruction it holds, which may be from the previous program and must
+ *  not change under it when the decode cache is replaced.
+ * ========================================================================= */
+static void
+KeepLatchedInstruction(struct RSP *rsp, struct RSPRegistry *registry) {
+  struct RSPIFRDLatch *ifrdLatch = &rsp->pipeline.ifrdLatch;
+  const struct RSPDecodedInstruction *entries = rsp->decodeCache.entries;
+
+  if (ifrdLatch->decoded >= entries &&
+    ifrdLatch->decoded < entries + RSP_DECODE_CACHE_ENTRIES) {
+    registry->latched = *ifrdLatch->decoded;
+    registry->latched.block = NULL;
+    ifrdLatch->decoded = &registry->latched;
+  }
+}
+
+/* ============================================================================
+ *  RestoreSlot: Replaces the decode cache with a slot's saved copy.
+ *  Translated blocks are only kept if none have been discarded since.
+ * ========================================================================= */
+static void
+RestoreSlot(struct RSP *rsp, struct RSPRegistry *registry,
+  const struct RSPRegistrySlot *slot) {
+  struct RSPDecodedInstruction *entries = rsp->decodeCache.entries;
+  unsigned i;
+
+  KeepLatchedInstruction(rsp, registry);
+  memcpy(entries, slot->entries, sizeof(slot->entries));
+
+  if (slot->generation != GetRecompilerGeneration(rsp)) {
+    for (i = 0; i < RSP_DECODE_CACHE_ENTRIES; i++)
+      entries[i].block = NULL;
+  }
+}
+
+/* ============================================================================
+ *  CreateRSPRegistry: Creates an empty registry.
+ *  Only the slot headers are touched; the images are filled on demand.
+ * ========================================================================= */
+struct RSPRegistry *
+CreateRSPRegistry(void) {
+  struct RSPRegistry *registry;
+  unsigned i;
+
+  if ((registry = (struct RSPRegistry*) malloc(sizeof(*registry))) == NULL) {
+    debug("Failed to allocate memory.");
+    return NULL;
+  }
+
+  for (i = 0; i < RSP_REGISTRY_SLOTS; i++) {
+    registry->slots[i].used = false;
+    registry->slots[i].saved = false;
+  }
+
+  registry->current = NULL;
+  registry->clock = 0;
+
+  registry->file = NULL;
+  registry->fileSize = 0;
+
+  registry->hits = 0;
+  registry->misses = 0;
+  registry->fileHits = 0;
+  registry->evictions = 0;
+  return registry;
+}
+
+/* ============================================================================
+ *  DestroyRSPRegistry: Releases a registry.
+ * ========================================================================= */
+void
+DestroyRSPRegistry(struct RSPRegistry *registry) {
+  free(registry);
+}
+
+/* ============================================================================
+ *  RSPFingerprint: Computes a 64-bit hash of a buffer (e.g., IMEM).
+ *
+ *  Four words are mixed in at a time, each into its own lane, so that
+ *  the multiplies don't serialize. The size must be a multiple of 32.
+ * ========================================================================= */
+uint64_t
+RSPFingerprint(const uint8_t *data, size_t size) {
+  uint64_t lanes[4] = {
+    0xCBF29CE484222325ULL, 0x84222325CBF29CE4ULL,
+    0x9E3779B97F4A7C15ULL, 0x7F4A7C159E3779B9ULL
+  };
+
+  uint64_t hash;
+  size_t i, j;
+
+  for (i = 0; i < size; i += sizeof(lanes)) {
+    for (j = 0; j < 4; j++) {
+      uint64_t word;
+
+      memcpy(&word, data + i + j * sizeof(word), sizeof(word));
+      lanes[j] = (lanes[j] ^ word) * 0x100000001B3ULL;
+      lanes[j] ^= lanes[j] >> 32;
+    }
+  }
+
+  for (hash = size, j = 0; j < 4; j++) {
+    hash = (hash ^ lanes[j]) * 0x100000001B3ULL;
+    hash ^= hash >> 32;
+  }
+
+  return hash;
+}
+
+/* ============================================================================
+ *  RSPGetRegistryStats: Reports how well the registry is doing.
+ * ========================================================================= */
+void
+RSPGetRegistryStats(const struct RSP *rsp, struct RSPRegistryStats *stats) {
+  const struct RSPRegistry *registry = rsp->registry;
+
+  memset(stats, 0, sizeof(*stats));
+
+  if (registry != NULL) {
+    stats->hits = registry->hits;
+    stats->misses = registry->misses;
+    stats->fileHits = registry->fileHits;
+    stats->evictions = registry->evictions;
+    stats->footprint = sizeof(*registry);
+  }
+}
+
+/* ============================================================================
+ *  RSPRegistryLookup: Invoked when the RSP is about to be unhalted.
+ *
+ *  Fingerprints IMEM and, if the same microcode was seen before, restores
+ *  the decode cache (and with it, any translated blocks) that was built
+ *  the last time it ran. Otherwise, the least recently used slot is taken
+ *  over to record the new microcode, and the cache file (if one is open)
+ *  is checked for a decoded (and maybe translated) copy of it.
+ * ========================================================================= */
+void
+RSPRegistryLookup(struct RSP *rsp) {
+  struct RSPRegistry *registry = rsp->registry;
+  struct RSPRegistrySlot *slot;
+  uint64_t hash;
+  unsigned i;
+
+  if (registry == NULL &&
+    (registry = rsp->registry = CreateRSPRegistry()) == NULL)
+    return;
+
+  hash = RSPFingerprint(rsp->imem, RSP_IMEM_SIZE);
+  registry->clock++;
+
+  /* Still running the same microcode; the cache is already warm. */
+  if ((slot = registry->current) != NULL) {
+    if (slot->hash == hash &&
+      !memcmp(slot->imem, rsp->imem, RSP_IMEM_SIZE)) {
+      slot->lastUsed = registry->clock;
+      return;
+    }
+
+    registry->current = NULL;
+  }
+
+  for (i = 0, slot = registry->slots; i < RSP_REGISTRY_SLOTS; i++, slot++) {
+    if (slot->used && slot->hash == hash &&
+      !memcmp(slot->imem, rsp->imem, RSP_IMEM_SIZE))
+      break;
+  }
+
+  if (i < RSP_REGISTRY_SLOTS) {
+    registry->hits++;
+
+    if (slot->saved)
+      RestoreSlot(rsp, registry, slot);
+  }
+
+  else {
+    registry->misses++;
+    slot = RSPRegistryInsert(registry, hash, rsp->imem);
+
+    if (registry->file != NULL) {
+      KeepLatchedInstruction(rsp, registry);
+
+      if (RSPFetchCachedMicrocode(rsp, hash))
+        registry->fileHits++;
+    }
+  }
+
+  slot->lastUsed = registry->clock;
+  registry->current = slot;
+}
+
+/* ============================================================================
+ *  RSPRegistryInsert: Takes over the least recently used slot to record
+ *  a microcode, and returns it. Nothing is saved in the slot yet.
+ * ========================================================================= */
+struct RSPRegistrySlot *
+RSPRegistryInsert(struct RSPRegistry *registry,
+  uint64_t hash, const uint8_t *imem) {
+  struct RSPRegistrySlot *slot, *victim;
+  unsigned i;
+
+  for (i = 0, victim = slot = registry->slots;
+    i < RSP_REGISTRY_SLOTS; i++, slot++) {
+    if (victim->used && (!slot->used || slot->lastUsed < victim->lastUsed))
+      victim = slot;
+  }
+
+  if (victim->used)
+    registry->evictions++;
+
+  if (registry->current == victim)
+    registry->current = NULL;
+
+  victim->hash = hash;
+  victim->lastUsed = registry->clock;
+  victim->used = true;
+  victim->saved = false;
+  memcpy(victim->imem, imem, RSP_IMEM_SIZE);
+  return victim;
+}
+
+/* ============================================================================
+ *  RSPRegistrySave: Invoked before IMEM is written.
+ *
+ *  Records the decode cache of the microcode that is about to be replaced
+ *  in its slot. IMEM is compared against the slot first, as it may have
+ *  been written directly (through GetRSPIMEMPtr) since the lookup.
+ * ========================================================================= */
+void
+RSPRegistrySave(struct RSP *rsp) {
+  struct RSPRegistry *registry = rsp->registry;
+  struct RSPRegistrySlot *slot;
+
+  if (registry == NULL || (slot = registry->current) == NULL)
+    return;
+
+  registry->current = NULL;
+
+  if (memcmp(slot->imem, rsp->imem, RSP_IMEM_SIZE))
+    return;
+
+  memcpy(slot->entries, rsp->decodeCache.entries, sizeof(slot->entries));
+  slot->generation = GetRecompilerGeneration(rsp);
+  slot->saved = true;
+}
+
@@ -0,0 +1,73 @@
+/* ============================================================================
+ *  Registry.h: Microcode registry.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__REGISTRY_H__
+#define __RSP__REGISTRY_H__
+#include "Common.h"
+#include "CPU.h"
+#include "DecodeCache.h"
+
+/* Each slot costs an IMEM image plus a decode cache (~60KiB). */
+#ifndef RSP_REGISTRY_SLOTS
+#define RSP_REGISTRY_SLOTS 8
+#endif
+
+struct RSPRegistrySlot {
+  uint64_t hash;
+  unsigned long long lastUsed;
+  unsigned generation;
+  bool used, saved;
+
+  uint8_t imem[RSP_IMEM_SIZE];
+  struct RSPDecodedInstruction entries[RSP_DECODE_CACHE_ENTRIES];
+};
+
+struct RSPRegistry {
+  struct RSPRegistrySlot slots[RSP_REGISTRY_SLOTS];
+
+  /* The slot whose contents match IMEM, if any. */
+  struct RSPRegistrySlot *current;
+  unsigned long long clock;
+
+  /* Where the IF/RD latch is pointed when its entry is replaced. */
+  struct RSPDecodedInstruction latched;
+
+  /* Cache file mapped (read-only) by RSPLoadCacheFile, if any. */
+  const uint8_t *file;
+  size_t fileSize;
+
+  unsigned long long hits;
+  unsigned long long misses;
+  unsigned long long fileHits;
+  unsigned long long evictions;
+};
+
+/* Misses that were satisfied by the cache file count as fileHits. */
+struct RSPRegistryStats {
+  unsigned long long hits;
+  unsigned long long misses;
+  unsigned long long fileHits;
+  unsigned long long evictions;
+  size_t footprint;
+};
+
+struct RSPRegistry *CreateRSPRegistry(void);
+void DestroyRSPRegistry(struct RSPRegistry *);
+uint64_t RSPFingerprint(const uint8_t *, size_t);
+void RSPGetRegistryStats(const struct RSP *, struct RSPRegistryStats *);
+
+struct RSPRegistrySlot *RSPRegistryInsert(struct RSPRegistry *,
+  uint64_t, const uint8_t *);
+
+void RSPRegistryLookup(struct RSP *);
+void RSPRegistrySave(struct RSP *);
+
+#endif
+
@@ -0,0 +1,317 @@
+/* ============================================================================
+ *  Rewind.c: Incremental snapshots, kept in a ring for rewinding.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CPU.h"
+#include "DecodeCache.h"
+#include "Registry.h"
+#include "Rewind.h"
+#include "State.h"
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+/* ============================================================================
+ *  IsDirty: Checks if a line is set in a bitmap of lines.
+ * ========================================================================= */
+static bool
+IsDirty(const uint64_t *lines, unsigned line) {
+  return lines[line >> 6] >> (line & 63) & 1;
+}
+
+/* ============================================================================
+ *  GetLine: Returns a line of DMEM or IMEM (which follows DMEM).
+ * ========================================================================= */
+static uint8_t *
+GetLine(struct RSP *rsp, unsigned line) {
+  unsigned address = line * RSP_DIRTY_LINE_SIZE;
+
+  return address < RSP_DMEM_SIZE
+    ? rsp->dmem + address
+    : rsp->imem + (address - RSP_DMEM_SIZE);
+}
+
+/* ============================================================================
+ *  WriteLine: Puts back the contents of a line. IMEM is written the way a
+ *  DMA would write it: the decode cache is saved to the registry before
+ *  the first change, and the entries covering the line are invalidated.
+ * ========================================================================= */
+static void
+WriteLine(struct RSP *rsp, unsigned line, const uint8_t *data,
+  bool *imemChanged) {
+  unsigned address = line * RSP_DIRTY_LINE_SIZE;
+  uint8_t *memory = GetLine(rsp, line);
+
+  if (!memcmp(memory, data, RSP_DIRTY_LINE_SIZE))
+    return;
+
+  if (address < RSP_DMEM_SIZE)
+    memcpy(memory, data, RSP_DIRTY_LINE_SIZE);
+
+  else {
+    if (!*imemChanged)
+      RSPRegistrySave(rsp);
+
+    memcpy(memory, data, RSP_DIRTY_LINE_SIZE);
+    RSPInvalidateDecodeCache(&rsp->decodeCache,
+      address - RSP_DMEM_SIZE, RSP_DIRTY_LINE_SIZE);
+
+    *imemChanged = true;
+  }
+}
+
+/* ============================================================================
+ *  GetNewest/GetOldest: Returns the newest or oldest frame in the ring.
+ * ========================================================================= */
+static struct RSPRewindFrame *
+GetNewest(const struct RSPRewind *rewind) {
+  return &rewind->frames[(rewind->first + rewind->count - 1) %
+    rewind->maxFrames];
+}
+
+static struct RSPRewindFrame *
+GetOldest(const struct RSPRewind *rewind) {
+  return &rewind->frames[rewind->first];
+}
+
+/* ============================================================================
+ *  DropOldest: Forgets the oldest frame, freeing up its space.
+ * ========================================================================= */
+static void
+DropOldest(struct RSPRewind *rewind) {
+  rewind->first = (rewind->first + 1) % rewind->maxFrames;
+
+  if (--rewind->count == 0)
+    rewind->head = 0;
+}
+
+/* ============================================================================
+ *  Overlaps: Checks if a frame occupies any of a range of the arena.
+ * ========================================================================= */
+static bool
+Overlaps(const struct RSPRewindFrame *frame, size_t offset, size_t size) {
+  size_t end = frame->offset + RSP_REWIND_FRAME_SIZE(frame->numLines);
+  return frame->offset < offset + size && offset < end;
+}
+
+/* ============================================================================
+ *  Allocate: Finds room in the arena for a frame after the newest one,
+ *  pushing out the oldest frames as needed. Returns NULL if the frame
+ *  wouldn't fit even in an empty arena.
+ * ========================================================================= */
+static uint8_t *
+Allocate(struct RSPRewind *rewind, size_t size) {
+  size_t offset = rewind->head;
+
+  if (size > rewind->arenaSize)
+    return NULL;
+
+  if (rewind->count == rewind->maxFrames)
+    DropOldest(rewind);
+
+  /* Wrap around; frames past the newest are the oldest. */
+  if (offset + size > rewind->arenaSize) {
+    while (rewind->count > 0 && GetOldest(rewind)->offset >= offset)
+      DropOldest(rewind);
+
+    offset = 0;
+  }
+
+  while (rewind->count > 0 && Overlaps(GetOldest(rewind), offset, size))
+    DropOldest(rewind);
+
+  return rewind->arena + offset;
+}
+
+/* ============================================================================
+ *  CreateRSPRewind: Creates a ring of up to a number of frames, kept in an
+ *  arena of a given size; once either runs out, the oldest frames go.
+ *
+ *  The ring takes over the instance's dirty lines: it is meant to be the
+ *  only thing snapshotting the instance incrementally.
+ * ========================================================================= */
+struct RSPRewind *
+CreateRSPRewind(struct RSP *rsp, unsigned frames, size_t bytes) {
+  struct RSPRewind *rewind;
+
+  if (frames == 0)
+    return NULL;
+
+  if ((rewind = (struct RSPRewind*) calloc(1, sizeof(*rewind))) == NULL) {
+    debug("Failed to allocate memory.");
+    return NULL;
+  }
+
+  if ((rewind->frames = (struct RSPRewindFrame*) calloc(
+    frames, sizeof(*rewind->frames))) == NULL ||
+    (rewind->arena = (uint8_t*) malloc(bytes)) == NULL) {
+    debug("Failed to allocate memory.");
+    DestroyRSPRewind(rewind);
+    return NULL;
+  }
+
+  rewind->maxFrames = frames;
+  rewind->arenaSize = bytes;
+
+  memcpy(rewind->shadow, rsp->dmem, RSP_DMEM_SIZE);
+  memcpy(rewind->shadow + RSP_DMEM_SIZE, rsp->imem, RSP_IMEM_SIZE);
+  memset(rsp->dirtyLines, 0, sizeof(rsp->dirtyLines));
+  return rewind;
+}
+
+/* ============================================================================
+ *  DestroyRSPRewind: Releases a ring and its frames.
+ * ========================================================================= */
+void
+DestroyRSPRewind(struct RSPRewind *rewind) {
+  free(rewind->frames);
+  free(rewind->arena);
+  free(rewind);
+}
+
+/* ============================================================================
+ *  RSPRewindPush: Records a frame of the instance's current state (which,
+ *  as with RSPSaveState, should be taken between runs).
+ *
+ *  Only lines that were written since the last frame, and that actually
+ *  changed, are kept; what's kept is what they held before, so that
+ *  stepping back is a matter of putting it back.
+ *
+ *  Returns zero on success, or nonzero if the frame is larger than the
+ *  arena (in which case nothing is recorded).
+ * ========================================================================= */
+int
+RSPRewindPush(struct RSPRewind *rewind, struct RSP *rsp) {
+  uint64_t changed[RSP_DIRTY_LINE_WORDS] = {0};
+  unsigned line, numLines = 0;
+  struct RSPRewindFrame *frame;
+  uint8_t *record, *cursor;
+
+  for (line = 0; line < NUM_RSP_DIRTY_LINES; line++) {
+    if (IsDirty(rsp->dirtyLines, line) && memcmp(GetLine(rsp, line),
+      rewind->shadow + line * RSP_DIRTY_LINE_SIZE, RSP_DIRTY_LINE_SIZE)) {
+      changed[line >> 6] |= (uint64_t) 1 << (line & 63);
+      numLines++;
+    }
+  }
+
+  if ((record = Allocate(rewind, RSP_REWIND_FRAME_SIZE(numLines))) == NULL)
+    return 1;
+
+  RSPSaveRegisterState(rsp, record);
+  cursor = record + RSP_STATE_REGS_SIZE;
+
+  for (line = 0; line < NUM_RSP_DIRTY_LINES; line++) {
+    uint8_t *shadow = rewind->shadow + line * RSP_DIRTY_LINE_SIZE;
+
+    if (IsDirty(changed, line)) {
+      cursor[0] = line;
+      memcpy(cursor + 1, shadow, RSP_DIRTY_LINE_SIZE);
+      memcpy(shadow, GetLine(rsp, line), RSP_DIRTY_LINE_SIZE);
+      cursor += RSP_REWIND_LINE_SIZE;
+    }
+  }
+
+  frame = &rewind->frames[(rewind->first + rewind->count++) %
+    rewind->maxFrames];
+
+  frame->offset = record - rewind->arena;
+  frame->numLines = numLines;
+  rewind->head = frame->offset + RSP_REWIND_FRAME_SIZE(numLines);
+
+  memset(rsp->dirtyLines, 0, sizeof(rsp->dirtyLines));
+  return 0;
+}
+
+/* ============================================================================
+ *  RSPRewindRestore: Puts the instance back to how it was a number of
+ *  frames ago (zero being the newest frame). Frames newer than that are
+ *  dropped; the one restored stays, so it can be restored again.
+ *
+ *  Returns zero on success, or nonzero if there aren't that many frames
+ *  (in which case nothing is changed) or memory ran out.
+ * ========================================================================= */
+int
+RSPRewindRestore(struct RSPRewind *rewind, struct RSP *rsp,
+  unsigned frames) {
+  const struct RSPRewindFrame *frame;
+  bool imemChanged = false;
+  unsigned line;
+
+  if (frames >= rewind->count)
+    return 1;
+
+  /* Undo whatever was written since the newest frame... */
+  for (line = 0; line < NUM_RSP_DIRTY_LINES; line++) {
+    if (IsDirty(rsp->dirtyLines, line))
+      WriteLine(rsp, line, rewind->shadow + line * RSP_DIRTY_LINE_SIZE,
+        &imemChanged);
+  }
+
+  /* ...then step back through the frames being dropped. */
+  for (; frames > 0; frames--) {
+    const uint8_t *cursor;
+    unsigned i;
+
+    frame = GetNewest(rewind);
+    cursor = rewind->arena + frame->offset + RSP_STATE_REGS_SIZE;
+
+    for (i = 0; i < frame->numLines; i++) {
+      line = cursor[0];
+
+      memcpy(rewind->shadow + line * RSP_DIRTY_LINE_SIZE,
+        cursor + 1, RSP_DIRTY_LINE_SIZE);
+      WriteLine(rsp, line, cursor + 1, &imemChanged);
+      cursor += RSP_REWIND_LINE_SIZE;
+    }
+
+    rewind->head = frame->offset;
+    rewind->count--;
+  }
+
+  if (imemChanged && rsp->registry != NULL)
+    RSPRegistryLookup(rsp);
+
+  memset(rsp->dirtyLines, 0, sizeof(rsp->dirtyLines));
+  frame = GetNewest(rewind);
+  return RSPLoadRegisterState(rsp, rewind->arena + frame->offset);
+}
+
+/* ============================================================================
+ *  RSPRewindGetFrames: Returns the number of frames that can be restored.
+ * ========================================================================= */
+unsigned
+RSPRewindGetFrames(const struct RSPRewind *rewind) {
+  return rewind->count;
+}
+
+/* ============================================================================
+ *  RSPRewindGetBytes: Returns the space taken up by the frames in the ring.
+ * ========================================================================= */
+size_t
+RSPRewindGetBytes(const struct RSPRewind *rewind) {
+  size_t bytes = 0;
+  unsigned i;
+
+  for (i = 0; i < rewind->count; i++) {
+    const struct RSPRewindFrame *frame =
+      &rewind->frames[(rewind->first + i) % rewind->maxFrames];
+
+    bytes += RSP_REWIND_FRAME_SIZE(frame->numLines);
+  }
+
+  return bytes;
+}
+
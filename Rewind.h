@@ -0,0 +1,57 @@
+/* ============================================================================
+ *  Rewind.h: Incremental snapshots, kept in a ring for rewinding.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__REWIND_H__
+#define __RSP__REWIND_H__
+#include "Common.h"
+#include "CPU.h"
+#include "State.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+#else
+#include <stddef.h>
+#endif
+
+/* Each frame is the registers, plus the previous contents */
+/* of every line written since the frame before it. */
+#define RSP_REWIND_LINE_SIZE (1 + RSP_DIRTY_LINE_SIZE)
+#define RSP_REWIND_FRAME_SIZE(lines) (RSP_STATE_REGS_SIZE + \
+  (lines) * RSP_REWIND_LINE_SIZE)
+
+struct RSPRewindFrame {
+  size_t offset;
+  unsigned numLines;
+};
+
+/* Frames are appended to the arena one after the other, */
+/* wrapping around to the start and pushing out the oldest */
+/* ones as needed. The shadow is memory as of the newest. */
+struct RSPRewind {
+  uint8_t shadow[RSP_DMEM_SIZE + RSP_IMEM_SIZE];
+
+  struct RSPRewindFrame *frames;
+  unsigned maxFrames, first, count;
+
+  uint8_t *arena;
+  size_t arenaSize, head;
+};
+
+struct RSPRewind *CreateRSPRewind(struct RSP *, unsigned, size_t);
+void DestroyRSPRewind(struct RSPRewind *);
+
+int RSPRewindPush(struct RSPRewind *, struct RSP *);
+int RSPRewindRestore(struct RSPRewind *, struct RSP *, unsigned);
+
+unsigned RSPRewindGetFrames(const struct RSPRewind *);
+size_t RSPRewindGetBytes(const struct RSPRewind *);
+
+#endif
+
@@ -0,0 +1,522 @@
+/* ============================================================================
+ *  State.c: Saving and restoring the RSP state.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#include "Common.h"
+#include "CP0.h"
+#include "CP2.h"
+#include "CPU.h"
+#include "DecodeCache.h"
+#include "Memory.h"
+#include "Pipeline.h"
+#include "Registry.h"
+#include "State.h"
+
+#ifdef __cplusplus
+#include <cassert>
+#include <cstring>
+#else
+#include <assert.h>
+#include <string.h>
+#endif
+
+/* Pending memory operations are saved as an index into this. */
+static const RSPMemoryFunction MemoryFunctions[] = {
+  NULL, &LoadByte, &LoadByteUnsigned, &LoadByteVector, &LoadDoubleVector,
+  &LoadHalf, &LoadHalfUnsigned, &LoadLongVector, &LoadPackedByteVector,
+  &LoadPackedFourthVector, &LoadPackedHalfVector, &LoadPackedVector,
+  &LoadQuadVector, &LoadRestVector, &LoadShortVector, &LoadTransposeVector,
+  &LoadWord, &StoreByte, &StoreByteVector, &StoreDoubleVector, &StoreHalf,
+  &StoreLongVector, &StorePackedByteVector, &StorePackedFourthVector,
+  &StorePackedHalfVector, &StorePackedVector, &StoreQuadVector,
+  &StoreRestVector, &StoreShortVector, &StoreTransposeVector, &StoreWord
+};
+
+#define NUM_MEMORY_FUNCTIONS \
+  (sizeof(MemoryFunctions) / sizeof(*MemoryFunctions))
+
+/* What a pending memory operation targets: nothing, the DF/WB */
+/* latch (scalar loads), or a vector register (plus this). */
+#define TARGET_NONE 0
+#define TARGET_RESULT 1
+#define TARGET_VECTOR 2
+
+/* What the IF/RD latch holds: the reset instruction or a word. */
+#define LATCHED_RESET 0
+#define LATCHED_WORD 1
+
+/* ============================================================================
+ *  Put8/Put16/Put32: Appends a little-endian value to a snapshot.
+ * ========================================================================= */
+static uint8_t *
+Put8(uint8_t *cursor, uint8_t value) {
+  *cursor = value;
+  return cursor + 1;
+}
+
+static uint8_t *
+Put16(uint8_t *cursor, uint16_t value) {
+  cursor[0] = value;
+  cursor[1] = value >> 8;
+  return cursor + 2;
+}
+
+static uint8_t *
+Put32(uint8_t *cursor, uint32_t value) {
+  cursor[0] = value;
+  cursor[1] = value >> 8;
+  cursor[2] = value >> 16;
+  cursor[3] = value >> 24;
+  return cursor + 4;
+}
+
+/* ============================================================================
+ *  Get8/Get16/Get32: Reads a little-endian value out of a snapshot.
+ * ========================================================================= */
+static uint8_t
+Get8(const uint8_t **cursor) {
+  return *(*cursor)++;
+}
+
+static uint16_t
+Get16(const uint8_t **cursor) {
+  const uint8_t *bytes = *cursor;
+
+  *cursor += 2;
+  return bytes[0] | bytes[1] << 8;
+}
+
+static uint32_t
+Get32(const uint8_t **cursor) {
+  const uint8_t *bytes = *cursor;
+
+  *cursor += 4;
+  return (uint32_t) bytes[0] | (uint32_t) bytes[1] << 8 |
+    (uint32_t) bytes[2] << 16 | (uint32_t) bytes[3] << 24;
+}
+
+/* ============================================================================
+ *  PutVector/GetVector: Saves or restores the slices of a vector.
+ * ========================================================================= */
+static uint8_t *
+PutVector(uint8_t *cursor, const struct RSPVector *vector) {
+  unsigned i;
+
+  for (i = 0; i < 8; i++)
+    cursor = Put16(cursor, vector->slices[i]);
+
+  return cursor;
+}
+
+static void
+GetVector(const uint8_t **cursor, struct RSPVector *vector) {
+  unsigned i;
+
+  for (i = 0; i < 8; i++)
+    vector->slices[i] = (int16_t) Get16(cursor);
+}
+
+/* ============================================================================
+ *  PutOpcode/GetOpcode: Saves or restores a decoded opcode.
+ * ========================================================================= */
+static uint8_t *
+PutOpcode(uint8_t *cursor, unsigned id, uint32_t infoFlags) {
+  return Put32(Put32(cursor, id), infoFlags);
+}
+
+static void
+GetOpcode(const uint8_t **cursor, struct RSPOpcode *opcode) {
+  opcode->id = (enum RSPOpcodeID) Get32(cursor);
+  opcode->infoFlags = Get32(cursor);
+}
+
+/* ============================================================================
+ *  SaveCP2: Saves the vector unit, flags and divider included.
+ * ========================================================================= */
+static uint8_t *
+SaveCP2(uint8_t *cursor, const struct RSPCP2 *cp2) {
+  struct RSPVector acc[3];
+  unsigned i;
+
+  for (i = 0; i < NUM_RSP_VP_REGISTERS; i++)
+    cursor = PutVector(cursor, &cp2->regs[i]);
+
+  cursor = PutVector(cursor, &cp2->transposeVector);
+
+  /* The accumulator is saved as its high, middle and low words, */
+  /* so snapshots don't depend on how it is laid out in memory. */
+  RSPGetAccumulator(cp2, acc);
+
+  for (i = 0; i < 3; i++)
+    cursor = PutVector(cursor, &acc[i]);
+
+  /* Likewise, the flags are saved as bits, whatever form they're in. */
+  cursor = Put16(cursor, RSPPackFlags(&cp2->vco));
+  cursor = Put16(cursor, RSPPackFlags(&cp2->vcc));
+  cursor = Put8(cursor, RSPPackFlags(&cp2->vce));
+
+  for (i = 0; i < sizeof(cp2->locked); i++)
+    cursor = Put8(cursor, cp2->locked[i]);
+
+  cursor = Put32(cursor, cp2->mulStageDest);
+  cursor = Put32(cursor, cp2->accStageDest);
+  cursor = PutOpcode(cursor, cp2->opcode.id, cp2->opcode.infoFlags);
+  cursor = Put32(cursor, cp2->iw);
+
+  cursor = Put32(cursor, (uint32_t) cp2->doublePrecision);
+  cursor = Put32(cursor, (uint32_t) cp2->divOut);
+  return Put32(cursor, (uint32_t) cp2->divIn);
+}
+
+/* ============================================================================
+ *  LoadCP2: Restores what SaveCP2 saved.
+ * ========================================================================= */
+static void
+LoadCP2(const uint8_t **cursor, struct RSPCP2 *cp2) {
+  struct RSPVector acc[3];
+  unsigned i;
+
+  for (i = 0; i < NUM_RSP_VP_REGISTERS; i++)
+    GetVector(cursor, &cp2->regs[i]);
+
+  GetVector(cursor, &cp2->transposeVector);
+
+  for (i = 0; i < 3; i++)
+    GetVector(cursor, &acc[i]);
+
+  RSPSetAccumulator(cp2, acc);
+
+  RSPSetFlagBits(&cp2->vco, Get16(cursor));
+  RSPSetFlagBits(&cp2->vcc, Get16(cursor));
+  RSPSetFlagBits(&cp2->vce, Get8(cursor));
+
+  for (i = 0; i < sizeof(cp2->locked); i++)
+    cp2->locked[i] = Get8(cursor) != 0;
+
+  cp2->mulStageDest = Get32(cursor);
+  cp2->accStageDest = Get32(cursor);
+  cp2->opcode.id = (enum RSPVOpcodeID) Get32(cursor);
+  cp2->opcode.infoFlags = Get32(cursor);
+  cp2->iw = Get32(cursor);
+
+  cp2->doublePrecision = (int32_t) Get32(cursor);
+  cp2->divOut = (int32_t) Get32(cursor);
+  cp2->divIn = (int32_t) Get32(cursor);
+}
+
+/* ============================================================================
+ *  SaveMemoryData: Saves a pending memory operation. The function and
+ *  target are saved as what they refer to, and not as pointers.
+ * ========================================================================= */
+static uint8_t *
+SaveMemoryData(uint8_t *cursor, const struct RSP *rsp,
+  const struct RSPMemoryData *memoryData) {
+  const struct RSPVector *target = (const struct RSPVector*) memoryData->target;
+  unsigned function, kind = TARGET_NONE;
+
+  for (function = 0; function < NUM_MEMORY_FUNCTIONS; function++) {
+    if (MemoryFunctions[function] == memoryData->function)
+      break;
+  }
+
+  assert(function < NUM_MEMORY_FUNCTIONS);
+
+  if (function == 0)
+    kind = TARGET_NONE;
+
+  else if (memoryData->target == &rsp->pipeline.dfwbLatch.result.data)
+    kind = TARGET_RESULT;
+
+  else if (target >= rsp->cp2.regs &&
+    target <= rsp->cp2.regs + NUM_RSP_VP_REGISTERS)
+    kind = TARGET_VECTOR + (unsigned) (target - rsp->cp2.regs);
+
+  cursor = Put8(cursor, function);
+  cursor = Put8(cursor, kind);
+  cursor = Put32(cursor, memoryData->element);
+  cursor = Put32(cursor, memoryData->offset);
+  return Put32(cursor, memoryData->data);
+}
+
+/* ============================================================================
+ *  LoadMemoryData: Restores what SaveMemoryData saved.
+ *  Returns nonzero if the function or target is out of range.
+ * ========================================================================= */
+static int
+LoadMemoryData(const uint8_t **cursor, struct RSP *rsp,
+  struct RSPMemoryData *memoryData) {
+  unsigned function = Get8(cursor);
+  unsigned kind = Get8(cursor);
+
+  if (function >= NUM_MEMORY_FUNCTIONS ||
+    kind > TARGET_VECTOR + NUM_RSP_VP_REGISTERS)
+    return 1;
+
+  memoryData->function = MemoryFunctions[function];
+  memoryData->cp2 = &rsp->cp2;
+  memoryData->dirtyLines = rsp->dirtyLines;
+
+  if (kind == TARGET_RESULT)
+    memoryData->target = &rsp->pipeline.dfwbLatch.result.data;
+  else if (kind >= TARGET_VECTOR)
+    memoryData->target = &rsp->cp2.regs[kind - TARGET_VECTOR];
+  else
+    memoryData->target = NULL;
+
+  memoryData->element = Get32(cursor);
+  memoryData->offset = Get32(cursor);
+  memoryData->data = Get32(cursor);
+  return 0;
+}
+
+/* ============================================================================
+ *  SavePipeline: Saves the latches between the stages.
+ *
+ *  The IF/RD latch points at a decoded instruction. Only the word is
+ *  saved; it is decoded again on load.
+ * ========================================================================= */
+static uint8_t *
+SavePipeline(uint8_t *cursor, const struct RSP *rsp) {
+  const struct RSPPipeline *pipeline = &rsp->pipeline;
+  const struct RSPIFRDLatch *ifrdLatch = &pipeline->ifrdLatch;
+  const struct RSPRDEXLatch *rdexLatch = &pipeline->rdexLatch;
+  const struct RSPEXDFLatch *exdfLatch = &pipeline->exdfLatch;
+  const struct RSPDFWBLatch *dfwbLatch = &pipeline->dfwbLatch;
+
+  cursor = Put8(cursor, ifrdLatch->decoded == &RSPResetInstruction
+    ? LATCHED_RESET : LATCHED_WORD);
+  cursor = Put32(cursor, ifrdLatch->decoded->iw);
+  cursor = Put32(cursor, ifrdLatch->firstIW);
+  cursor = Put32(cursor, ifrdLatch->fetchedPC);
+  cursor = Put32(cursor, ifrdLatch->pc);
+
+  cursor = Put32(cursor, rdexLatch->pc);
+  cursor = Put32(cursor, rdexLatch->iw);
+  cursor = PutOpcode(cursor, rdexLatch->opcode.id,
+    rdexLatch->opcode.infoFlags);
+
+  cursor = PutOpcode(cursor, exdfLatch->opcode.id,
+    exdfLatch->opcode.infoFlags);
+  cursor = Put32(cursor, exdfLatch->result.data);
+  cursor = Put32(cursor, exdfLatch->result.dest);
+  cursor = SaveMemoryData(cursor, rsp, &exdfLatch->memoryData);
+
+  cursor = PutOpcode(cursor, dfwbLatch->opcode.id,
+    dfwbLatch->opcode.infoFlags);
+  cursor = Put32(cursor, dfwbLatch->result.data);
+  return Put32(cursor, dfwbLatch->result.dest);
+}
+
+/* ============================================================================
+ *  LoadLatchedInstruction: Points the IF/RD latch at a decoded copy of the
+ *  word it held. That is normally the decode cache entry for the fetched
+ *  PC; if IMEM has changed since the fetch, the registry keeps a copy.
+ * ========================================================================= */
+static int
+LoadLatchedInstruction(struct RSP *rsp, unsigned kind, uint32_t iw) {
+  struct RSPIFRDLatch *ifrdLatch = &rsp->pipeline.ifrdLatch;
+  const struct RSPDecodedInstruction *decoded;
+
+  if (kind == LATCHED_RESET) {
+    ifrdLatch->decoded = &RSPResetInstruction;
+    return 0;
+  }
+
+  decoded = RSPGetDecodedInstruction(&rsp->decodeCache,
+    rsp->imem, ifrdLatch->fetchedPC);
+
+  if (decoded->iw != iw) {
+    if (rsp->registry == NULL &&
+      (rsp->registry = CreateRSPRegistry()) == NULL)
+      return 1;
+
+    RSPDecodeInstructionWord(&rsp->registry->latched, iw);
+    decoded = &rsp->registry->latched;
+  }
+
+  ifrdLatch->decoded = decoded;
+  return 0;
+}
+
+/* ============================================================================
+ *  LoadPipeline: Restores what SavePipeline saved.
+ * ========================================================================= */
+static int
+LoadPipeline(const uint8_t **cursor, struct RSP *rsp) {
+  struct RSPPipeline *pipeline = &rsp->pipeline;
+  struct RSPIFRDLatch *ifrdLatch = &pipeline->ifrdLatch;
+  struct RSPRDEXLatch *rdexLatch = &pipeline->rdexLatch;
+  struct RSPEXDFLatch *exdfLatch = &pipeline->exdfLatch;
+  struct RSPDFWBLatch *dfwbLatch = &pipeline->dfwbLatch;
+  unsigned kind = Get8(cursor);
+  uint32_t iw = Get32(cursor);
+
+  ifrdLatch->firstIW = Get32(cursor);
+  ifrdLatch->fetchedPC = Get32(cursor);
+  ifrdLatch->pc = Get32(cursor);
+
+  rdexLatch->pc = Get32(cursor);
+  rdexLatch->iw = Get32(cursor);
+  GetOpcode(cursor, &rdexLatch->opcode);
+
+  GetOpcode(cursor, &exdfLatch->opcode);
+  exdfLatch->result.data = Get32(cursor);
+  exdfLatch->result.dest = Get32(cursor);
+
+  if (LoadMemoryData(cursor, rsp, &exdfLatch->memoryData))
+    return 1;
+
+  GetOpcode(cursor, &dfwbLatch->opcode);
+  dfwbLatch->result.data = Get32(cursor);
+  dfwbLatch->result.dest = Get32(cursor);
+
+  return LoadLatchedInstruction(rsp, kind, iw);
+}
+
+/* ============================================================================
+ *  CheckRegisterState: Checks the one field of the registers section that
+ *  can be out of range (a pending memory operation); the rest can take
+ *  any value. Returns nonzero if it is out of range.
+ * ========================================================================= */
+static int
+CheckRegisterState(struct RSP *rsp, const uint8_t *buffer) {
+  const uint8_t *cursor = buffer + (NUM_RSP_REGISTERS + NUM_SP_REGISTERS) *
+    4 + RSP_STATE_CP2_SIZE + 17 + 16 + 16;
+  struct RSPMemoryData memoryData;
+
+  return LoadMemoryData(&cursor, rsp, &memoryData);
+}
+
+/* ============================================================================
+ *  RSPSaveRegisterState: Writes everything but memory (the scalar and SP
+ *  registers, CP2, the pipeline latches and the branch flag) into a
+ *  buffer of RSP_STATE_REGS_SIZE bytes.
+ * ========================================================================= */
+void
+RSPSaveRegisterState(const struct RSP *rsp, uint8_t *buffer) {
+  uint8_t *cursor = buffer;
+  unsigned i;
+
+  for (i = 0; i < NUM_RSP_REGISTERS; i++)
+    cursor = Put32(cursor, rsp->regs[i]);
+
+  for (i = 0; i < NUM_SP_REGISTERS; i++)
+    cursor = Put32(cursor, rsp->cp0.regs[i]);
+
+  cursor = SaveCP2(cursor, &rsp->cp2);
+  cursor = SavePipeline(cursor, rsp);
+  cursor = Put8(cursor, rsp->didBranch);
+
+  assert(cursor == buffer + RSP_STATE_REGS_SIZE);
+}
+
+/* ============================================================================
+ *  RSPLoadRegisterState: Restores what RSPSaveRegisterState saved. IMEM
+ *  must already be restored, as the IF/RD latch is decoded from it.
+ *
+ *  Returns zero on success, or nonzero if the buffer is out of range (in
+ *  which case the RSP is left as it was) or memory ran out (in which case
+ *  it's left partly loaded, and has to be loaded again before it is run).
+ * ========================================================================= */
+int
+RSPLoadRegisterState(struct RSP *rsp, const uint8_t *buffer) {
+  const uint8_t *cursor = buffer;
+  unsigned i;
+
+  if (CheckRegisterState(rsp, buffer))
+    return 1;
+
+  for (i = 0; i < NUM_RSP_REGISTERS; i++)
+    rsp->regs[i] = Get32(&cursor);
+
+  for (i = 0; i < NUM_SP_REGISTERS; i++)
+    rsp->cp0.regs[i] = Get32(&cursor);
+
+  LoadCP2(&cursor, &rsp->cp2);
+
+  if (LoadPipeline(&cursor, rsp))
+    return 1;
+
+  rsp->didBranch = Get8(&cursor);
+  rsp->events = 0;
+  return 0;
+}
+
+/* ============================================================================
+ *  RSPSaveState: Writes a snapshot of everything the microcode can see
+ *  (memory, registers, CP2 and the pipeline) into a caller's buffer.
+ *
+ *  Returns the size of the snapshot (RSP_STATE_SIZE), or zero if the
+ *  buffer is too small. Nothing is allocated. Caches (decoded words,
+ *  translated blocks) and the execution mode are not part of the state.
+ * ========================================================================= */
+size_t
+RSPSaveState(const struct RSP *rsp, void *buffer, size_t size) {
+  uint8_t *cursor = (uint8_t*) buffer;
+
+  if (size < RSP_STATE_SIZE)
+    return 0;
+
+  memcpy(cursor, RSP_STATE_MAGIC, 8);
+  cursor = Put32(cursor + 8, RSP_STATE_VERSION);
+  cursor = Put32(cursor, RSP_STATE_SIZE);
+
+  memcpy(cursor, rsp->dmem, RSP_DMEM_SIZE);
+  memcpy(cursor + RSP_DMEM_SIZE, rsp->imem, RSP_IMEM_SIZE);
+  cursor += RSP_DMEM_SIZE + RSP_IMEM_SIZE;
+
+  RSPSaveRegisterState(rsp, cursor);
+  return RSP_STATE_SIZE;
+}
+
+/* ============================================================================
+ *  RSPLoadState: Restores a snapshot taken by RSPSaveState.
+ *
+ *  Returns zero on success, or nonzero if the snapshot is not one this
+ *  build can read (in which case the RSP is left as it was) or memory
+ *  ran out. In the latter case, memory and some of the registers have
+ *  already been replaced; the RSP has to be loaded again (or reset)
+ *  before it is run. Pointers are derived again rather than restored.
+ *
+ *  When IMEM is unchanged, the decode cache and translated blocks are
+ *  kept. Otherwise IMEM is replaced the way a DMA would replace it,
+ *  so the registry can find the microcode if it was seen before. All
+ *  of memory is marked dirty, as it is replaced wholesale.
+ * ========================================================================= */
+int
+RSPLoadState(struct RSP *rsp, const void *buffer, size_t size) {
+  const uint8_t *cursor = (const uint8_t*) buffer;
+  const uint8_t *dmem = cursor + 16;
+  const uint8_t *imem = dmem + RSP_DMEM_SIZE;
+
+  if (size < RSP_STATE_SIZE || memcmp(cursor, RSP_STATE_MAGIC, 8))
+    return 1;
+
+  cursor += 8;
+
+  if (Get32(&cursor) != RSP_STATE_VERSION ||
+    Get32(&cursor) != RSP_STATE_SIZE ||
+    CheckRegisterState(rsp, imem + RSP_IMEM_SIZE))
+    return 1;
+
+  memcpy(rsp->dmem, dmem, RSP_DMEM_SIZE);
+
+  if (memcmp(rsp->imem, imem, RSP_IMEM_SIZE)) {
+    RSPRegistrySave(rsp);
+    memcpy(rsp->imem, imem, RSP_IMEM_SIZE);
+    RSPInvalidateDecodeCache(&rsp->decodeCache, 0, RSP_IMEM_SIZE);
+
+    if (rsp->registry != NULL)
+      RSPRegistryLookup(rsp);
+  }
+
+  memset(rsp->dirtyLines, 0xFF, sizeof(rsp->dirtyLines));
+  return RSPLoadRegisterState(rsp, imem + RSP_IMEM_SIZE);
+}
+
@@ -0,0 +1,52 @@
+/* ============================================================================
+ *  State.h: Saving and restoring the RSP state.
+ *
+ *  RSPSIM: Reality Signal Processor SIMulator.
+ *  Copyright (C) 2013, Tyler J. Stachecki.
+ *  All rights reserved.
+ *
+ *  This file is subject to the terms and conditions defined in
+ *  file 'LICENSE', which is part of this source code package.
+ * ========================================================================= */
+#ifndef __RSP__STATE_H__
+#define __RSP__STATE_H__
+#include "Common.h"
+#include "CP0.h"
+#include "CP2.h"
+#include "CPU.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+#else
+#include <stddef.h>
+#endif
+
+#define RSP_STATE_MAGIC "RSPSTATE"
+#define RSP_STATE_VERSION 2
+
+/* Vector registers (and the transpose/accumulator vectors), VCO, */
+/* VCC, VCE, the register locks, and the vector unit's latches. */
+#define RSP_STATE_CP2_SIZE ((NUM_RSP_VP_REGISTERS + 4) * 16 + 2 + 2 + 1 + \
+  (32 + NUM_RSP_VP_REGISTERS) + 2 * 4 + 8 + 4 + 3 * 4)
+
+/* The IF/RD, RD/EX, EX/DF and DF/WB latches. */
+#define RSP_STATE_PIPELINE_SIZE (17 + 16 + 30 + 16)
+
+/* The scalar and SP registers, CP2, the pipeline latches */
+/* and the branch flag; that is, everything but memory. */
+#define RSP_STATE_REGS_SIZE (NUM_RSP_REGISTERS * 4 + \
+  NUM_SP_REGISTERS * 4 + RSP_STATE_CP2_SIZE + RSP_STATE_PIPELINE_SIZE + 1)
+
+/* Every snapshot is exactly this size: the header (magic, version */
+/* and size), DMEM, IMEM and the registers. All little-endian. */
+#define RSP_STATE_SIZE (16 + RSP_DMEM_SIZE + RSP_IMEM_SIZE + \
+  RSP_STATE_REGS_SIZE)
+
+size_t RSPSaveState(const struct RSP *, void *, size_t);
+int RSPLoadState(struct RSP *, const void *, size_t);
+
+void RSPSaveRegisterState(const struct RSP *, uint8_t *);
+int RSPLoadRegisterState(struct RSP *, const uint8_t *);
+
+#endif
+
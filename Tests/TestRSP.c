@@ -1,9 +1,28 @@
+#include "Address.h"
+#include "Async.h"
+#include "Batch.h"
+#include "CacheFile.h"
+#include "CP2.h"
 #include "CPU.h"
+#include "Definitions.h"
+#include "IdleLoop.h"
+#include "Interface.h"
+#include "Opcodes.h"
 #include "Pipeline.h"
+#include "ReciprocalROM.h"
+#include "Registry.h"
+#include "Rewind.h"
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
-struct BusController;
+/* Batch tasks each get a bus of their own, with their DRAM. */
+struct BusController {
+	uint8_t *dram;
+	size_t size;
+};
 
 /* Stub functions. */
 uint32_t BusReadWord(struct BusController *unused(bus),
@@ -11,83 +30,2018 @@ uint32_t BusReadWord(struct BusController *unused(bus),
 void BusWriteWord(const struct BusController *unused(bus),
   uint32_t unused(address), uint32_t unused(size)) {}
 
-void DMAFromDRAM(struct BusController *unused(bus), void *unused(dest),
-  uint32_t unused(src), uint32_t unused(size)) {}
-void DMAToDRAM(struct BusController *unused(bus), uint32_t unused(dest),
-  const void *unused(src), size_t unused(size)) {}
+void DMAFromDRAM(struct BusController *bus, void *dest,
+  uint32_t src, uint32_t size) {
+	if (bus != NULL) {
+		if (src < bus->size && size <= bus->size - src)
+			memcpy(dest, bus->dram + src, size);
+		else
+			memset(dest, 0, size);
+	}
+}
+
+void DMAToDRAM(struct BusController *bus, uint32_t dest,
+  const void *src, size_t size) {
+	if (bus != NULL && dest < bus->size && size <= bus->size - dest)
+		memcpy(bus->dram + dest, src, size);
+}
+
+void BusClearRCPInterrupt(struct BusController *unused(bus),
+  unsigned unused(i)) {}
+void BusRaiseRCPInterrupt(struct BusController *unused(bus),
+  unsigned unused(i)) {}
+
+int DPRegRead(void *unused(rdp), uint32_t unused(address),
+  void *unused(data)) { return 0; }
+int DPRegWrite(void *unused(rdp), uint32_t unused(address),
+  void *unused(data)) { return 0; }
+void RDPSetRSPDMEMPointer(struct RDP *unused(rdp),
+  uint8_t *unused(dmem)) {}
+
+static const char *ModeNames[] = {
+	"pipeline", "recompiler", "functional", "functional-table"
+};
+
+#define NUM_MODES (sizeof(ModeNames) / sizeof(*ModeNames))
+
+static const char *StatusNames[] = {
+	"budget", "break", "halt", "signal", "idle"
+};
+
+/* Tasks are loaded (and run) this many at a time. */
+#define BATCH_CHUNK 256
+
+/* A task as read from a task list. */
+struct BatchEntry {
+	char name[256];
+	uint8_t imem[4096], dmem[4096];
+	struct BusController bus;
+};
+#define STARTUP_RUNS 200
+
+/* Frames kept by -w (the arena fits as many full snapshots). */
+#define REWIND_FRAMES 64
+
+/* Calls made to each vector function timed by -v. */
+#define VECTOR_CALLS 2000000
+
+static const char *VectorOpcodeNames[] = {
+#define X(op) #op,
+#include "VectorOpcodes.md"
+#undef X
+};
+
+/* Opcodes that -v leaves out: those that don't do anything. */
+static const int UntimedVectorOpcodes[NUM_RSP_VECTOR_OPCODES] = {
+	[RSP_OPCODE_VINV] = 1, [RSP_OPCODE_VNOP] = 1
+};
+
+/* The fused idioms, and the opcodes each one stands for. */
+static const struct {
+	const char *name;
+	unsigned length;
+	int opcodes[4];
+} FusedIdioms[NUM_RSP_FUSED_IDIOMS] = {
+	[RSP_FUSED_MUL32] = {"MUL32", 4, {RSP_OPCODE_VMUDL, RSP_OPCODE_VMADM,
+		RSP_OPCODE_VMADN, RSP_OPCODE_VMADH}},
+	[RSP_FUSED_MULF] = {"MULF", 2, {RSP_OPCODE_VMULF, RSP_OPCODE_VMACF}}
+};
+
+static int SkipIdleLoops = 1;
+
+/* Creates an RSP instance with the given uCode loaded. */
+static struct RSP *CreateLoadedRSP(const uint8_t *imem, const uint8_t *dmem,
+	enum RSPExecutionMode mode, const char *cacheFile) {
+	uint32_t status = SP_CLR_HALT;
+	struct RSP *rsp;
+
+	if ((rsp = CreateRSP()) == NULL)
+		return NULL;
+
+	if (cacheFile != NULL)
+		RSPLoadCacheFile(rsp, cacheFile);
+
+	memcpy(rsp->imem, imem, 4096);
+	memcpy(rsp->dmem, dmem, 4096);
+	RSPSetExecutionMode(rsp, mode);
+	RSPSetIdleLoopSkipping(rsp, SkipIdleLoops);
+
+	/* Unhalt (as the CPU would, so the uCode gets looked up). */
+	SPRegWrite(rsp, SP_REGS_BASE_ADDRESS + SP_STATUS_REG * 4, &status);
+	return rsp;
+}
+
+/* Runs until the budget is spent or the RSP halts. */
+static long RunToCompletion(struct RSP *rsp, long cycles) {
+	enum RSPRunStatus status;
+
+	while (cycles > 0) {
+		cycles -= RunRSP(rsp, cycles, &status);
+
+		if (status == RSP_RUN_BREAK || status == RSP_RUN_HALT)
+			break;
+	}
+
+	return cycles;
+}
+
+/* What the instance looked like as each frame in the ring was */
+/* recorded (the frame for push N is in slot N % REWIND_FRAMES). */
+static uint8_t RewindSnapshots[REWIND_FRAMES][RSP_STATE_SIZE];
+
+/* Runs as above, recording a frame for rewinding (and a snapshot */
+/* to check it against) every so often. Counts frames in `pushes`. */
+static long RecordRewind(struct RSPRewind *rewind, struct RSP *rsp,
+	long cycles, long interval, unsigned *pushes) {
+	enum RSPRunStatus status;
+
+	*pushes = 0;
+
+	while (cycles > 0) {
+		long budget = cycles < interval ? cycles : interval;
+
+		cycles -= RunRSP(rsp, budget, &status);
+		RSPRewindPush(rewind, rsp);
+		RSPSaveState(rsp, RewindSnapshots[(*pushes)++ % REWIND_FRAMES],
+			RSP_STATE_SIZE);
+
+		if (status == RSP_RUN_BREAK || status == RSP_RUN_HALT)
+			break;
+	}
+
+	return cycles;
+}
+
+/* Restores every frame left in the ring, newest to oldest, and */
+/* returns how many didn't match the snapshot taken with them. */
+static unsigned CheckRewindFrames(struct RSPRewind *rewind,
+	struct RSP *rsp, unsigned pushes) {
+	static uint8_t actual[RSP_STATE_SIZE];
+	unsigned i, frames = RSPRewindGetFrames(rewind), mismatches = 0;
+
+	for (i = 0; i < frames; i++) {
+		const uint8_t *expected =
+			RewindSnapshots[(pushes - 1 - i) % REWIND_FRAMES];
+
+		mismatches += RSPRewindRestore(rewind, rsp, i > 0) ||
+			!RSPSaveState(rsp, actual, sizeof(actual)) ||
+			memcmp(expected, actual, sizeof(actual));
+	}
+
+	return mismatches;
+}
+
+/* Runs as above, recording a frame for rewinding every so often; */
+/* each is then restored and checked, before carrying on as it was. */
+static long RunWithRewind(struct RSP *rsp, long cycles, long interval) {
+	static uint8_t final[RSP_STATE_SIZE];
+	struct RSPRewind *rewind;
+	unsigned frames, pushes, mismatches;
+
+	if ((rewind = CreateRSPRewind(rsp, REWIND_FRAMES,
+		REWIND_FRAMES * (size_t) RSP_STATE_SIZE)) == NULL) {
+		printf("Failed to create the rewind ring.\n");
+		return cycles;
+	}
+
+	cycles = RecordRewind(rewind, rsp, cycles, interval, &pushes);
+
+	if ((frames = RSPRewindGetFrames(rewind)) > 0)
+		printf("Rewind frames take %lu bytes on average "
+			"(full snapshots: %u).\n", (unsigned long)
+			(RSPRewindGetBytes(rewind) / frames), RSP_STATE_SIZE);
+
+	RSPSaveState(rsp, final, sizeof(final));
+	mismatches = CheckRewindFrames(rewind, rsp, pushes);
+
+	printf("Restored %u frames: %u did not match their snapshots.\n",
+		frames, mismatches);
+
+	if (RSPLoadState(rsp, final, sizeof(final)))
+		printf("Failed to restore the final state.\n");
+
+	DestroyRSPRewind(rewind);
+	return cycles;
+}
+
+/* Times creating an instance and running the uCode on it. */
+static double TimeStartup(const uint8_t *imem, const uint8_t *dmem,
+	enum RSPExecutionMode mode, const char *cacheFile, long cycles) {
+	clock_t start = clock();
+	struct RSP *rsp;
+	unsigned i;
+
+	for (i = 0; i < STARTUP_RUNS; i++) {
+		if ((rsp = CreateLoadedRSP(imem, dmem, mode, cacheFile)) == NULL)
+			return -1.0;
+
+		RunToCompletion(rsp, cycles);
+		DestroyRSP(rsp);
+	}
+
+	return (double) (clock() - start) / CLOCKS_PER_SEC / STARTUP_RUNS;
+}
+
+/* Times a vector function on random registers and flags, */
+/* in nanoseconds per call. Every element is used in turn. */
+static double TimeVectorFunction(RSPVectorFunction function) {
+	static struct RSPCP2 cp2;
+	clock_t start;
+	unsigned i;
+
+	memset(&cp2, 0, sizeof(cp2));
+	srand(1);
+
+	for (i = 0; i < NUM_RSP_VP_REGISTERS * 8; i++)
+		cp2.regs[i / 8].slices[i % 8] = rand();
+
+	RSPSetFlagBits(&cp2.vco, rand());
+	RSPSetFlagBits(&cp2.vcc, rand());
+	RSPSetFlagBits(&cp2.vce, rand() & 0xFF);
+	start = clock();
+
+	for (i = 0; i < VECTOR_CALLS; i++) {
+		function(&cp2, cp2.regs[i & 31].slices, cp2.regs[(i + 9) & 31].slices,
+			cp2.regs[(i + 20) & 31].slices, i & 0xF);
+	}
+
+	return (double) (clock() - start) / CLOCKS_PER_SEC / VECTOR_CALLS * 1e9;
+}
+
+/* Builds a vector computational instruction word. */
+static uint32_t VectorWord(unsigned vd, unsigned vs,
+	unsigned vt, unsigned element) {
+	return 0x4A000000 | element << 21 | vt << 16 | vs << 11 | vd << 6;
+}
+
+/* As TimeVectorFunction, for a fused idiom under a backend: */
+/* nanoseconds per run of its opcodes, either fused or run */
+/* one word at a time (each of which waits on the last). */
+static double TimeFusedIdiom(const struct RSPVectorBackend *backend,
+	unsigned idiom, int fused) {
+	static struct RSPCP2 cp2;
+	uint32_t iws[4];
+	clock_t start;
+	unsigned i, j;
+
+	memset(&cp2, 0, sizeof(cp2));
+	srand(1);
+
+	for (i = 0; i < NUM_RSP_VP_REGISTERS * 8; i++)
+		cp2.regs[i / 8].slices[i % 8] = rand();
+
+	start = clock();
+
+	for (i = 0; i < VECTOR_CALLS; i++) {
+		for (j = 0; j < 4; j++) {
+			iws[j] = VectorWord((i + j) & 31, (i + j + 9) & 31,
+				(i + j + 20) & 31, i & 0xF);
+		}
+
+		if (fused)
+			backend->fused[idiom](&cp2, iws[0], iws[1], iws[2], iws[3]);
+
+		else {
+			for (j = 0; j < FusedIdioms[idiom].length; j++) {
+				RSPRunVectorWord(&cp2, backend->functions[
+					FusedIdioms[idiom].opcodes[j]], iws[j]);
+			}
+		}
+	}
+
+	return (double) (clock() - start) / CLOCKS_PER_SEC / VECTOR_CALLS * 1e9;
+}
+
+/* Times every vector opcode (and then every fused idiom) under */
+/* each of the backends the host can run, from the first up. */
+static int BenchmarkVectorUnit(void) {
+	unsigned count = RSPGetHostVectorBackends();
+	unsigned i, j;
+
+	/* Set up as CreateRSP would, for the divider. */
+	RSPBuildDivideTables();
+
+	printf("opcode");
+
+	for (j = 0; j < count; j++)
+		printf(" %10s", RSPVectorBackends[j].name);
+
+	printf("   (ns per call)\n");
+
+	for (i = 0; i < NUM_RSP_VECTOR_OPCODES; i++) {
+		if (UntimedVectorOpcodes[i])
+			continue;
+
+		printf("%-6s", VectorOpcodeNames[i]);
+
+		for (j = 0; j < count; j++) {
+			printf(" %10.2f", TimeVectorFunction(
+				RSPVectorBackends[j].functions[i]));
+		}
+
+		printf("\n");
+	}
+
+	/* Each idiom, fused and then not. */
+	for (i = 0; i < NUM_RSP_FUSED_IDIOMS * 2; i++) {
+		printf("%-6s", i & 1 ? " (seq)" : FusedIdioms[i / 2].name);
+
+		for (j = 0; j < count; j++) {
+			printf(" %10.2f", TimeFusedIdiom(
+				&RSPVectorBackends[j], i / 2, !(i & 1)));
+		}
+
+		printf("\n");
+	}
+
+	return 0;
+}
+
+/* Calls made to each vector function checked by -x. */
+#define CHECKED_CALLS 200000
+
+/* Slices that sit on the edges the vector functions */
+/* branch, round or clamp on. */
+static const int16_t EdgeSlices[] = {
+	0, 1, -1, 2, -2, 0x7FFF, -0x7FFF, -0x8000, 0x7FFE, 0x4000, -0x4000,
+	0x1F, 0x20, -0x20, -0x21
+};
+
+/* Returns a slice, picked from the edges a quarter of the time. */
+static int16_t RandomSlice(void) {
+	unsigned count = sizeof(EdgeSlices) / sizeof(*EdgeSlices);
+
+	if ((rand() & 3) == 0)
+		return EdgeSlices[rand() % count];
+
+	return (int16_t) (rand() ^ rand() << 8);
+}
+
+/* Sets a flag register to random bits, in either or both forms. */
+static void RandomFlags(struct RSPFlags *flags, uint16_t mask) {
+	RSPSetFlagBits(flags, (rand() ^ rand() << 8) & mask);
+
+	switch (rand() % 3) {
+		case 1: RSPExpandFlags(flags); break;
+		case 2: RSPExpandFlags(flags); flags->forms = RSP_FLAGS_MASKS; break;
+	}
+}
+
+/* The slice of `vt` an element specifier picks for slice `i`. */
+static int16_t GetElement(const int16_t *vt, unsigned element, unsigned i) {
+	if (element < 2)
+		return vt[i];
+	if (element < 4)
+		return vt[(i & ~1) | (element & 1)];
+	if (element < 8)
+		return vt[(i & ~3) | (element & 3)];
+
+	return vt[element & 7];
+}
+
+/* Clamps a value to a slice, as the vector unit does. */
+static int16_t ClampSlice(int64_t value) {
+	if (value < -32768)
+		return -32768;
+
+	return value > 32767 ? 32767 : (int16_t) value;
+}
+
+/* Gets/sets slice `i` of the accumulator as a 48-bit value. */
+static int64_t GetAccumulator(const struct RSPVector *acc, unsigned i) {
+	return ((int64_t) acc[0].slices[i] * 65536 +
+		(uint16_t) acc[1].slices[i]) * 65536 + (uint16_t) acc[2].slices[i];
+}
+
+static void SetAccumulator(struct RSPVector *acc, unsigned i, int64_t value) {
+	acc[0].slices[i] = (int16_t) (value >> 32);
+	acc[1].slices[i] = (int16_t) (value >> 16);
+	acc[2].slices[i] = (int16_t) value;
+}
+
+/* The vector functions that have to be checked most closely, as */
+/* plain per-slice loops (on a 48-bit accumulator, where it's used). */
+static void ReferenceVCH(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *vsData, const int16_t *vtData, unsigned element) {
+	uint16_t vco = 0, vcc = 0, vce = 0;
+	int16_t result[8];
+	unsigned i;
+
+	for (i = 0; i < 8; i++) {
+		int vs = vsData[i], vt = GetElement(vtData, element, i);
+		int sn = (vs ^ vt) < 0, ge, le, eq;
+
+		if (sn) {
+			ge = vt < 0;
+			le = vs + vt <= 0;
+			eq = vs + vt == 0 || vs + vt == -1;
+			vce |= (vs + vt == -1) << i;
+			result[i] = le ? -vt : vs;
+		}
+
+		else {
+			le = vt < 0;
+			ge = vs - vt >= 0;
+			eq = vs == vt;
+			result[i] = ge ? vt : vs;
+		}
+
+		vco |= !eq << (i + 8) | sn << i;
+		vcc |= ge << (i + 8) | le << i;
+	}
+
+	memcpy(cp2->accumulatorLow.slices, result, sizeof(result));
+	memcpy(vd, result, sizeof(result));
+	RSPSetFlagBits(&cp2->vco, vco);
+	RSPSetFlagBits(&cp2->vcc, vcc);
+	RSPSetFlagBits(&cp2->vce, vce);
+}
+
+static void ReferenceVCL(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *vsData, const int16_t *vtData, unsigned element) {
+	uint16_t vco = RSPGetFlagBits(&cp2->vco);
+	uint16_t vccOld = RSPGetFlagBits(&cp2->vcc);
+	uint16_t vce = RSPGetFlagBits(&cp2->vce);
+	uint16_t vcc = 0;
+	int16_t result[8];
+	unsigned i;
+
+	for (i = 0; i < 8; i++) {
+		unsigned vs = (uint16_t) vsData[i];
+		unsigned vt = (uint16_t) GetElement(vtData, element, i);
+		int sn = vco >> i & 1, eq = !(vco >> (i + 8) & 1);
+		int le = vccOld >> i & 1, ge = vccOld >> (i + 8) & 1;
+
+		if (sn) {
+			if (eq) {
+				unsigned sum = vs + vt;
+				int lz = (sum & 0xFFFF) == 0, uz = sum >> 16 == 0;
+
+				le = vce >> i & 1 ? lz || uz : lz && uz;
+			}
+
+			result[i] = le ? -vt : vs;
+		}
+
+		else {
+			if (eq)
+				ge = vs >= vt;
+
+			result[i] = ge ? vt : vs;
+		}
+
+		vcc |= ge << (i + 8) | le << i;
+	}
+
+	memcpy(cp2->accumulatorLow.slices, result, sizeof(result));
+	memcpy(vd, result, sizeof(result));
+	RSPSetFlagBits(&cp2->vco, 0);
+	RSPSetFlagBits(&cp2->vcc, vcc);
+	RSPSetFlagBits(&cp2->vce, 0);
+}
+
+static void ReferenceVCR(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *vsData, const int16_t *vtData, unsigned element) {
+	uint16_t vcc = 0;
+	int16_t result[8];
+	unsigned i;
+
+	for (i = 0; i < 8; i++) {
+		int vs = vsData[i], vt = GetElement(vtData, element, i);
+		int sn = (vs ^ vt) < 0, ge, le;
+
+		if (sn) {
+			ge = vt < 0;
+			le = vs + vt < 0;
+			result[i] = le ? ~vt : vs;
+		}
+
+		else {
+			le = vt < 0;
+			ge = vs - vt >= 0;
+			result[i] = le ? vt : vs;
+		}
+
+		vcc |= ge << (i + 8) | le << i;
+	}
+
+	memcpy(cp2->accumulatorLow.slices, result, sizeof(result));
+	memcpy(vd, result, sizeof(result));
+	RSPSetFlagBits(&cp2->vco, 0);
+	RSPSetFlagBits(&cp2->vcc, vcc);
+	RSPSetFlagBits(&cp2->vce, 0);
+}
+
+static void ReferenceVMACQ(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *unused(vsData), const int16_t *unused(vtData),
+	unsigned unused(element)) {
+	struct RSPVector acc[3];
+	unsigned i;
+
+	RSPGetAccumulator(cp2, acc);
+
+	for (i = 0; i < 8; i++) {
+		int64_t value = GetAccumulator(acc, i);
+		int32_t product = (int32_t) (value >> 16);
+
+		if (!(product & 0x20)) {
+			if (product < 0)
+				product += 0x20;
+
+			else if (product >= 0x20)
+				product -= 0x20;
+		}
+
+		SetAccumulator(acc, i, (int64_t) product * 65536 + (value & 0xFFFF));
+		vd[i] = ClampSlice(product >> 1) & ~0xF;
+	}
+
+	RSPSetAccumulator(cp2, acc);
+}
+
+static void ReferenceVMULQ(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *vsData, const int16_t *vtData, unsigned element) {
+	struct RSPVector acc[3];
+	int16_t result[8];
+	unsigned i;
+
+	for (i = 0; i < 8; i++) {
+		int32_t product = vsData[i] * GetElement(vtData, element, i);
+
+		if (product < 0)
+			product += 31;
+
+		SetAccumulator(acc, i, (int64_t) product * 65536);
+		result[i] = ClampSlice(product >> 1) & ~0xF;
+	}
+
+	RSPSetAccumulator(cp2, acc);
+	memcpy(vd, result, sizeof(result));
+}
+
+static void ReferenceVRND(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *vtData, unsigned element, int positive) {
+	struct RSPVector acc[3];
+	int16_t result[8];
+	unsigned i;
+
+	RSPGetAccumulator(cp2, acc);
+
+	for (i = 0; i < 8; i++) {
+		int64_t value = GetAccumulator(acc, i);
+		int64_t product = GetElement(vtData, element, i);
+
+		if (cp2->iw >> 11 & 1)
+			product *= 65536;
+
+		if ((value >= 0) == positive)
+			value += product;
+
+		/* Wrap around to 48 bits. */
+		value = (int64_t) ((uint64_t) value << 16) / 65536;
+		SetAccumulator(acc, i, value);
+		result[i] = ClampSlice(value >> 16);
+	}
+
+	RSPSetAccumulator(cp2, acc);
+	memcpy(vd, result, sizeof(result));
+}
+
+static void ReferenceVRNDN(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *unused(vsData), const int16_t *vtData, unsigned element) {
+	ReferenceVRND(cp2, vd, vtData, element, 0);
+}
+
+static void ReferenceVRNDP(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *unused(vsData), const int16_t *vtData, unsigned element) {
+	ReferenceVRND(cp2, vd, vtData, element, 1);
+}
+
+/* What the divider returns for an input, from a search for */
+/* its leading one: the ROM entry for the 9 bits after it, */
+/* shifted down by (half of, for square roots) its position. */
+static uint32_t ReferenceDivide(int32_t input, int squareRoot) {
+	uint32_t data = (uint32_t) input;
+	unsigned shift = 0, index;
+	uint32_t result;
+
+	if (input == 0)
+		return 0x7FFFFFFF;
+
+	if (input < 0)
+		data = -data - (input < -32768);
+
+	while (!(data << shift & 0x80000000))
+		shift++;
+
+	index = (data << shift & 0x7FC00000) >> 22;
+
+	/* Odd and even shifts get halves of the table of their own. */
+	if (squareRoot)
+		index = ((index | 0x200) & 0x3FE) | (shift & 1);
+
+	result = 0x40000000 | ReciprocalLUT[index] << 14;
+	result >>= squareRoot ? (31 - shift) >> 1 : 31 - shift;
+	return input < 0 ? ~result : result;
+}
+
+/* Writes what VRCP* and VRSQ* (but the high halves) leave behind. */
+static void ReferenceDivideResult(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *vtData, unsigned element, int32_t input, uint32_t result) {
+	unsigned i;
+
+	for (i = 0; i < 8; i++)
+		cp2->accumulatorLow.slices[i] = GetElement(vtData, element, i);
+
+	vd[cp2->iw >> 11 & 7] = (int16_t) result;
+	cp2->divIn = input;
+	cp2->divOut = result;
+	cp2->doublePrecision = 0;
+}
+
+/* The low halves take on the high half if one came first. */
+static int32_t ReferenceDivideLow(const struct RSPCP2 *cp2, int16_t slice) {
+	if (cp2->doublePrecision)
+		return cp2->divIn | (uint16_t) slice;
+
+	return (uint16_t) slice;
+}
+
+static void ReferenceVRCP(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *unused(vsData), const int16_t *vtData, unsigned element) {
+	int32_t input = vtData[element & 7];
+	ReferenceDivideResult(cp2, vd, vtData, element, input,
+		ReferenceDivide(input, 0));
+}
+
+static void ReferenceVRCPL(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *unused(vsData), const int16_t *vtData, unsigned element) {
+	int32_t input = ReferenceDivideLow(cp2, vtData[element & 7]);
+	ReferenceDivideResult(cp2, vd, vtData, element, input,
+		ReferenceDivide(input, 0));
+}
+
+static void ReferenceVRSQ(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *unused(vsData), const int16_t *vtData, unsigned element) {
+	int32_t input = vtData[element & 7];
+	ReferenceDivideResult(cp2, vd, vtData, element, input,
+		input == -32768 ? 0xFFFF0000 : ReferenceDivide(input, 1));
+}
+
+static void ReferenceVRSQL(struct RSPCP2 *cp2, int16_t *vd,
+	const int16_t *unused(vsData), const int16_t *vtData, unsigned element) {
+	int32_t input = ReferenceDivideLow(cp2, vtData[element & 7]);
+	ReferenceDivideResult(cp2, vd, vtData, element, input,
+		ReferenceDivide(input, 1));
+}
+
+/* Whether two units agree on the registers, the */
+/* accumulator, the flags and the divider state. */
+static int SameResults(const struct RSPCP2 *a, const struct RSPCP2 *b) {
+	struct RSPVector accA[3], accB[3];
+
+	RSPGetAccumulator(a, accA);
+	RSPGetAccumulator(b, accB);
+
+	return !memcmp(a->regs, b->regs, sizeof(a->regs)) &&
+		!memcmp(accA, accB, sizeof(accA)) &&
+		RSPPackFlags(&a->vco) == RSPPackFlags(&b->vco) &&
+		RSPPackFlags(&a->vcc) == RSPPackFlags(&b->vcc) &&
+		RSPPackFlags(&a->vce) == RSPPackFlags(&b->vce) &&
+		a->divIn == b->divIn && a->divOut == b->divOut &&
+		a->doublePrecision == b->doublePrecision;
+}
+
+/* Sets up a unit to check a vector function on: random slices, */
+/* accumulator, flags, divider state and instruction word. */
+static void RandomizeCP2(struct RSPCP2 *cp2) {
+	struct RSPVector acc[3];
+	unsigned i;
+
+	memset(cp2, 0, sizeof(*cp2));
+
+	for (i = 0; i < 8 * 8; i++)
+		cp2->regs[i / 8].slices[i % 8] = RandomSlice();
+
+	/* The high word is often just the sign of the middle one. */
+	for (i = 0; i < 8; i++) {
+		acc[1].slices[i] = RandomSlice();
+		acc[2].slices[i] = RandomSlice();
+		acc[0].slices[i] = rand() % 3 ? -(acc[1].slices[i] < 0) : RandomSlice();
+	}
+
+	RSPSetAccumulator(cp2, acc);
+	RandomFlags(&cp2->vco, 0xFFFF);
+	RandomFlags(&cp2->vcc, 0xFFFF);
+	RandomFlags(&cp2->vce, 0x00FF);
+
+	cp2->iw = rand() ^ rand() << 16;
+	cp2->divIn = rand() ^ rand() << 16;
+	cp2->divOut = rand() ^ rand() << 16;
+	cp2->doublePrecision = rand() & 1;
+}
+
+/* Runs each fused idiom under each backend on random units and */
+/* words (whose registers often overlap), against the functions */
+/* of the same backend run one word at a time. */
+static unsigned CheckFusedIdioms(unsigned count) {
+	static struct RSPCP2 start, expected, actual;
+	unsigned i, j, k, l, failures = 0;
+
+	for (i = 0; i < NUM_RSP_FUSED_IDIOMS; i++) {
+		printf("%-6s", FusedIdioms[i].name);
+
+		for (j = 0; j < count; j++) {
+			const struct RSPVectorBackend *backend = &RSPVectorBackends[j];
+			unsigned mismatches = 0;
+
+			srand(i + 1);
+
+			for (k = 0; k < CHECKED_CALLS; k++) {
+				uint32_t iws[4] = {0, 0, 0, 0};
+
+				for (l = 0; l < FusedIdioms[i].length; l++) {
+					unsigned vd = rand() & 7, vs = rand() & 7, vt = rand() & 7;
+					iws[l] = VectorWord(vd, vs, vt, rand() & 0xF);
+				}
+
+				RandomizeCP2(&start);
+				expected = actual = start;
+
+				for (l = 0; l < FusedIdioms[i].length; l++) {
+					RSPRunVectorWord(&expected,
+						backend->functions[FusedIdioms[i].opcodes[l]], iws[l]);
+				}
+
+				backend->fused[i](&actual, iws[0], iws[1], iws[2], iws[3]);
+				mismatches += !SameResults(&expected, &actual) ||
+					expected.iw != actual.iw;
+			}
+
+			printf(" %10s", mismatches ? "FAIL" : "ok");
+			failures += mismatches;
+		}
+
+		printf("\n");
+	}
+
+	return failures;
+}
+
+/* Runs random opcodes from each backend's table for each element */
+/* form, on random units and elements of that form, against those */
+/* from the backend's table for any element. */
+static unsigned CheckElementForms(unsigned count) {
+	static const char *names[NUM_RSP_ELEMENT_FORMS] = {
+		"0-1", "2-3", "4-7", "8-15"
+	};
+
+	static struct RSPCP2 start, expected, actual;
+	unsigned i, j, k, failures = 0;
+
+	for (i = 0; i < NUM_RSP_ELEMENT_FORMS; i++) {
+		unsigned first = i ? 1 << i : 0, size = i ? 1 << i : 2;
+		printf("%-6s", names[i]);
+
+		for (j = 0; j < count; j++) {
+			const struct RSPVectorBackend *backend = &RSPVectorBackends[j];
+			unsigned mismatches = 0;
+
+			srand(i + 1);
+
+			for (k = 0; k < CHECKED_CALLS; k++) {
+				unsigned opcode = rand() % NUM_RSP_VECTOR_OPCODES;
+				unsigned vd = rand() & 7, vs = rand() & 7, vt = rand() & 7;
+				unsigned element = first + rand() % size;
+
+				RandomizeCP2(&start);
+				expected = actual = start;
+
+				backend->functions[opcode](&expected,
+					expected.regs[vd].slices, expected.regs[vs].slices,
+					expected.regs[vt].slices, element);
+				backend->forms[i][opcode](&actual, actual.regs[vd].slices,
+					actual.regs[vs].slices, actual.regs[vt].slices, element);
+
+				mismatches += !SameResults(&expected, &actual);
+			}
+
+			printf(" %10s", mismatches ? "FAIL" : "ok");
+			failures += mismatches;
+		}
+
+		printf("\n");
+	}
+
+	return failures;
+}
+
+/* Runs each product's function that leaves the accumulator be */
+/* under each backend on random units and elements, against the */
+/* backend's function for the product (but for the accumulator). */
+static unsigned CheckNoAccProducts(unsigned count) {
+	static const int opcodes[NUM_RSP_PRODUCTS] = {
+#define X(op) RSP_OPCODE_##op,
+		RSP_PRODUCT_OPCODES
+#undef X
+	};
+
+	static struct RSPCP2 start, expected, actual;
+	unsigned i, j, k, failures = 0;
+
+	for (i = 0; i < NUM_RSP_PRODUCTS; i++) {
+		printf("%-6s", VectorOpcodeNames[opcodes[i]]);
+
+		for (j = 0; j < count; j++) {
+			const struct RSPVectorBackend *backend = &RSPVectorBackends[j];
+			unsigned mismatches = 0;
+
+			srand(i + 1);
+
+			for (k = 0; k < CHECKED_CALLS; k++) {
+				unsigned vd = rand() & 7, vs = rand() & 7, vt = rand() & 7;
+				unsigned element = rand() & 0xF;
+				struct RSPVector acc[3];
+
+				RandomizeCP2(&start);
+				expected = actual = start;
+
+				backend->functions[opcodes[i]](&expected,
+					expected.regs[vd].slices, expected.regs[vs].slices,
+					expected.regs[vt].slices, element);
+				backend->noAcc[i](&actual, actual.regs[vd].slices,
+					actual.regs[vs].slices, actual.regs[vt].slices, element);
+
+				RSPGetAccumulator(&expected, acc);
+				RSPSetAccumulator(&actual, acc);
+				mismatches += !SameResults(&expected, &actual);
+			}
+
+			printf(" %10s", mismatches ? "FAIL" : "ok");
+			failures += mismatches;
+		}
+
+		printf("\n");
+	}
+
+	return failures;
+}
+
+/* Runs each carry's and compare's function that leaves its flags */
+/* be under each backend on random units and elements, against the */
+/* backend's function for the instruction (but for VCO or VCC). */
+static unsigned CheckNoFlagWriters(unsigned count) {
+	static const int opcodes[NUM_RSP_FLAG_WRITERS] = {
+#define X(op) RSP_OPCODE_##op,
+		RSP_FLAG_WRITER_OPCODES
+#undef X
+	};
+
+	static struct RSPCP2 start, expected, actual;
+	unsigned i, j, k, failures = 0;
+
+	for (i = 0; i < NUM_RSP_FLAG_WRITERS; i++) {
+		printf("%-6s", VectorOpcodeNames[opcodes[i]]);
+
+		for (j = 0; j < count; j++) {
+			const struct RSPVectorBackend *backend = &RSPVectorBackends[j];
+			unsigned mismatches = 0;
+
+			srand(i + 1);
+
+			for (k = 0; k < CHECKED_CALLS; k++) {
+				unsigned vd = rand() & 7, vs = rand() & 7, vt = rand() & 7;
+				unsigned element = rand() & 0xF;
+
+				RandomizeCP2(&start);
+				expected = actual = start;
+
+				backend->functions[opcodes[i]](&expected,
+					expected.regs[vd].slices, expected.regs[vs].slices,
+					expected.regs[vt].slices, element);
+				backend->noFlags[i](&actual, actual.regs[vd].slices,
+					actual.regs[vs].slices, actual.regs[vt].slices, element);
+
+				if (opcodes[i] == RSP_OPCODE_VADDC ||
+					opcodes[i] == RSP_OPCODE_VSUBC)
+					actual.vco = expected.vco;
+				else
+					actual.vcc = expected.vcc;
+
+				mismatches += !SameResults(&expected, &actual);
+			}
+
+			printf(" %10s", mismatches ? "FAIL" : "ok");
+			failures += mismatches;
+		}
+
+		printf("\n");
+	}
+
+	return failures;
+}
+
+/* Runs the vector functions above under each backend the host */
+/* can run on random units and elements, and against the loops. */
+static int CheckVectorUnit(void) {
+	static const struct {
+		int opcode;
+		RSPVectorFunction reference;
+	} checks[] = {
+		{RSP_OPCODE_VCH, ReferenceVCH}, {RSP_OPCODE_VCL, ReferenceVCL},
+		{RSP_OPCODE_VCR, ReferenceVCR}, {RSP_OPCODE_VMACQ, ReferenceVMACQ},
+		{RSP_OPCODE_VMULQ, ReferenceVMULQ}, {RSP_OPCODE_VRNDN, ReferenceVRNDN},
+		{RSP_OPCODE_VRNDP, ReferenceVRNDP}, {RSP_OPCODE_VRSQ, ReferenceVRSQ},
+		{RSP_OPCODE_VRCP, ReferenceVRCP}, {RSP_OPCODE_VRCPL, ReferenceVRCPL},
+		{RSP_OPCODE_VRSQL, ReferenceVRSQL}
+	};
+
+	static struct RSPCP2 start, expected, actual;
+	unsigned count = RSPGetHostVectorBackends();
+	unsigned i, j, k, failures = 0;
+
+	/* Set up as CreateRSP would, for the divider. */
+	RSPBuildDivideTables();
+
+	printf("opcode");
+
+	for (j = 0; j < count; j++)
+		printf(" %10s", RSPVectorBackends[j].name);
+
+	printf("\n");
+
+	for (i = 0; i < sizeof(checks) / sizeof(*checks); i++) {
+		printf("%-6s", VectorOpcodeNames[checks[i].opcode]);
+
+		for (j = 0; j < count; j++) {
+			RSPVectorFunction function =
+				RSPVectorBackends[j].functions[checks[i].opcode];
+			unsigned mismatches = 0;
+
+			srand(i + 1);
+
+			for (k = 0; k < CHECKED_CALLS; k++) {
+				unsigned vd = rand() & 7, vs = rand() & 7, vt = rand() & 7;
+				unsigned element = rand() & 0xF;
+
+				RandomizeCP2(&start);
+				expected = actual = start;
+
+				checks[i].reference(&expected,
+					expected.regs[vd].slices, expected.regs[vs].slices,
+					expected.regs[vt].slices, element);
+				function(&actual, actual.regs[vd].slices,
+					actual.regs[vs].slices, actual.regs[vt].slices, element);
+
+				mismatches += !SameResults(&expected, &actual);
+			}
+
+			printf(" %10s", mismatches ? "FAIL" : "ok");
+			failures += mismatches;
+		}
+
+		printf("\n");
+	}
+
+	failures += CheckFusedIdioms(count);
+	failures += CheckElementForms(count);
+	failures += CheckNoAccProducts(count);
+	return failures + CheckNoFlagWriters(count) != 0;
+}
+
+/* Instruction words, for the program below. */
+#define IWORD(op, rs, rt, imm) ((uint32_t) (op) << 26 | (rs) << 21 | \
+	(rt) << 16 | ((imm) & 0xFFFF))
+#define RWORD(rs, rt, rd, sa, funct) ((rs) << 21 | (rt) << 16 | \
+	(rd) << 11 | (sa) << 6 | (funct))
+#define VWORD(funct, vd, vs, vt, element) (0x4A000000 | (element) << 21 | \
+	(vt) << 16 | (vs) << 11 | (vd) << 6 | (funct))
+#define LSWORD(op, kind, vt, base, offset) ((uint32_t) (op) << 26 | \
+	(base) << 21 | (vt) << 16 | (kind) << 11 | ((offset) & 0x7F))
+#define C2WORD(kind, rt, rd, element) (0x12u << 26 | (kind) << 21 | \
+	(rt) << 16 | (rd) << 11 | (element) << 7)
+
+/* Cycles (or instructions) the program below is given to break in. */
+#define CHECKED_CYCLES 100000
+
+/* A program for comparing whole runs: 24 times over, it loads a */
+/* block of DMEM, mixes it with scalar and vector instructions */
+/* (with a branch that goes either way, load-use stalls, fused */
+/* idioms, flags written over and the divider) and stores what it */
+/* got further up. */
+/* It then polls SP_STATUS until SIG0 is set (which, unless -x is */
+/* checking idle loops, it already is). The pipeline halts on the */
+/* break with what's behind it in DF and WB yet to be written */
+/* back, so nothing useful is there. */
+static const uint32_t CheckedProgram[] = {
+	IWORD(0x09, 0, 1, 0),          /* addiu r1, r0, 0 */
+	IWORD(0x09, 0, 3, 0x600),      /* addiu r3, r0, 0x600 */
+	IWORD(0x09, 0, 2, 24),         /* addiu r2, r0, 24 */
+	LSWORD(0x32, 4, 1, 1, 0),      /* lqv v1[0], 0(r1) */
+	LSWORD(0x32, 4, 2, 1, 1),      /* lqv v2[0], 16(r1) */
+	IWORD(0x23, 1, 4, 32),         /* lw r4, 32(r1) */
+	IWORD(0x21, 1, 5, 38),         /* lh r5, 38(r1) */
+	RWORD(4, 5, 6, 0, 0x21),       /* addu r6, r4, r5 */
+	RWORD(6, 4, 7, 0, 0x26),       /* xor r7, r6, r4 */
+	RWORD(0, 7, 8, 3, 0x03),       /* sra r8, r7, 3 */
+	RWORD(4, 5, 9, 0, 0x2A),       /* slt r9, r4, r5 */
+	C2WORD(4, 6, 3, 2),            /* mtc2 r6, v3[2] */
+	IWORD(0x04, 9, 0, 2),          /* beq r9, r0, 2 */
+	VWORD(0x10, 3, 3, 1, 0),       /* vadd v3, v3, v1 */
+	VWORD(0x11, 3, 3, 2, 5),       /* vsub v3, v3, v2[1h] */
+	VWORD(0x04, 4, 1, 2, 0),       /* vmudl v4, v1, v2 */
+	VWORD(0x0D, 5, 1, 2, 3),       /* vmadm v5, v1, v2[1q] */
+	VWORD(0x0E, 4, 1, 2, 9),       /* vmadn v4, v1, v2[1] */
+	VWORD(0x0F, 5, 1, 2, 0),       /* vmadh v5, v1, v2 */
+	VWORD(0x00, 6, 1, 3, 4),       /* vmulf v6, v1, v3[0h] */
+	VWORD(0x08, 6, 2, 3, 0),       /* vmacf v6, v2, v3 */
+	VWORD(0x07, 14, 2, 1, 15),     /* vmudh v14, v2, v1[7] */
+	VWORD(0x05, 15, 14, 3, 7),     /* vmudm v15, v14, v3[3h] */
+	VWORD(0x1D, 7, 0, 0, 9),       /* vsar v7, v0, v0[9] */
+	VWORD(0x14, 16, 1, 2, 0),      /* vaddc v16, v1, v2 */
+	VWORD(0x15, 16, 16, 3, 5),     /* vsubc v16, v16, v3[1h] */
+	VWORD(0x10, 16, 16, 1, 0),     /* vadd v16, v16, v1 */
+	VWORD(0x23, 17, 1, 16, 0),     /* vge v17, v1, v16 */
+	VWORD(0x20, 17, 17, 2, 2),     /* vlt v17, v17, v2[0q] */
+	VWORD(0x27, 17, 16, 17, 0),    /* vmrg v17, v16, v17 */
+	VWORD(0x25, 8, 4, 5, 0),       /* vch v8, v4, v5 */
+	VWORD(0x24, 9, 6, 5, 2),       /* vcl v9, v6, v5[0q] */
+	VWORD(0x27, 10, 8, 9, 0),      /* vmrg v10, v8, v9 */
+	VWORD(0x30, 11, 3, 4, 10),     /* vrcp v11[3], v4[2] */
+	VWORD(0x32, 12, 1, 5, 11),     /* vrcph v12[1], v5[3] */
+	VWORD(0x31, 12, 2, 4, 12),     /* vrcpl v12[2], v4[4] */
+	VWORD(0x34, 13, 0, 7, 8),      /* vrsq v13[0], v7[0] */
+	VWORD(0x36, 13, 4, 6, 14),     /* vrsqh v13[4], v6[6] */
+	VWORD(0x35, 13, 5, 7, 13),     /* vrsql v13[5], v7[5] */
+	C2WORD(2, 10, 1, 0),           /* cfc2 r10, vcc */
+	C2WORD(0, 11, 11, 6),          /* mfc2 r11, v11[6] */
+	LSWORD(0x3A, 4, 4, 3, 0),      /* sqv v4[0], 0(r3) */
+	LSWORD(0x3A, 4, 6, 3, 1),      /* sqv v6[0], 16(r3) */
+	LSWORD(0x3A, 4, 10, 3, 2),     /* sqv v10[0], 32(r3) */
+	IWORD(0x2B, 3, 8, 48),         /* sw r8, 48(r3) */
+	IWORD(0x29, 3, 10, 52),        /* sh r10, 52(r3) */
+	IWORD(0x28, 3, 11, 54),        /* sb r11, 54(r3) */
+	IWORD(0x2B, 3, 7, 56),         /* sw r7, 56(r3) */
+	LSWORD(0x3A, 2, 13, 3, 15),    /* slv v13[0], 60(r3) */
+	LSWORD(0x3A, 4, 12, 3, 4),     /* sqv v12[0], 64(r3) */
+	LSWORD(0x3A, 4, 15, 3, 5),     /* sqv v15[0], 80(r3) */
+	IWORD(0x09, 1, 1, 48),         /* addiu r1, r1, 48 */
+	IWORD(0x09, 2, 2, -1),         /* addiu r2, r2, -1 */
+	IWORD(0x05, 2, 0, -51),        /* bne r2, r0, -51 */
+	IWORD(0x09, 3, 3, 96),         /* addiu r3, r3, 96 */
+	IWORD(0x10, 0, 12, 4 << 11),   /* mfc0 r12, sp_status */
+	IWORD(0x0C, 12, 12, 0x80),     /* andi r12, r12, SIG0 */
+	IWORD(0x04, 12, 0, -3),        /* beq r12, r0, -3 */
+	0, 0, 0,                       /* nop; nop; nop */
+	RWORD(0, 0, 0, 0, 0x0D)        /* break */
+};
+
+/* Creates an instance with the program above loaded (as a uCode */
+/* file would have it, big endian), along with some random data, */
+/* and SIG0 set (so that it doesn't poll). */
+static struct RSP *CreateCheckedRSP(enum RSPExecutionMode mode,
+	const char *cacheFile) {
+	static uint8_t imem[4096], dmem[4096];
+	uint32_t status = SP_SET_SIG0;
+	struct RSP *rsp;
+	unsigned i;
+
+	memset(imem, 0, sizeof(imem));
+
+	for (i = 0; i < sizeof(CheckedProgram) / sizeof(*CheckedProgram); i++) {
+		imem[i * 4 + 0] = CheckedProgram[i] >> 24;
+		imem[i * 4 + 1] = CheckedProgram[i] >> 16;
+		imem[i * 4 + 2] = CheckedProgram[i] >> 8;
+		imem[i * 4 + 3] = CheckedProgram[i];
+	}
+
+	srand(1);
+
+	for (i = 0; i < sizeof(dmem); i++)
+		dmem[i] = rand();
+
+	if ((rsp = CreateLoadedRSP(imem, dmem, mode, cacheFile)) != NULL)
+		SPRegWrite(rsp, SP_REGS_BASE_ADDRESS + SP_STATUS_REG * 4, &status);
+
+	return rsp;
+}
+
+/* Whether two instances agree on the scalar registers, */
+/* the vector unit (as SameResults) and DMEM. */
+static int SameState(const struct RSP *a, const struct RSP *b) {
+	return !memcmp(a->regs, b->regs, sizeof(a->regs)) &&
+		SameResults(&a->cp2, &b->cp2) &&
+		!memcmp(a->dmem, b->dmem, sizeof(a->dmem));
+}
+
+/* Runs the program above to its break under every mode, and */
+/* checks that each leaves everything as the pipeline does (in */
+/* as many cycles, for the recompiler). */
+static int CheckModes(void) {
+	struct RSP *expected, *actual;
+	long remaining;
+	unsigned i, failures = 0;
+
+	if ((expected = CreateCheckedRSP(RSP_MODE_PIPELINE, NULL)) == NULL) {
+		printf("Failed to initialize the RSP.\n");
+		return 1;
+	}
+
+	remaining = RunToCompletion(expected, CHECKED_CYCLES);
+	printf("\nmode             result\n");
+	printf("%-16s %6s\n", ModeNames[RSP_MODE_PIPELINE],
+		RSPGetRunStatus(expected) == RSP_RUN_BREAK ? "ok" : "FAIL");
+
+	failures += RSPGetRunStatus(expected) != RSP_RUN_BREAK;
+
+	for (i = 1; i < NUM_MODES; i++) {
+		int mismatch;
+
+		if ((actual = CreateCheckedRSP((enum RSPExecutionMode) i, NULL)) == NULL) {
+			printf("Failed to initialize the RSP.\n");
+			DestroyRSP(expected);
+			return 1;
+		}
+
+		mismatch = RunToCompletion(actual, CHECKED_CYCLES) != remaining &&
+			i == RSP_MODE_RECOMPILER;
+
+		mismatch |= RSPGetRunStatus(actual) != RSP_RUN_BREAK ||
+			!SameState(expected, actual);
+
+		printf("%-16s %6s\n", ModeNames[i], mismatch ? "FAIL" : "ok");
+		failures += mismatch;
+		DestroyRSP(actual);
+	}
+
+	DestroyRSP(expected);
+	return failures != 0;
+}
+
+/* Cycles the program above runs before -x snapshots it (spread */
+/* out, so the pipeline is caught with different things in it). */
+static const long SnapshotCycles[] = {101, 257, 400, 613, 888};
+
+#define NUM_SNAPSHOT_CYCLES (sizeof(SnapshotCycles) / sizeof(*SnapshotCycles))
+
+/* Snapshots an instance partway through the program above, runs */
+/* it to its break, then restores the snapshot and runs it again: */
+/* on the same instance, and on one that never ran. Every run has */
+/* to end in the same snapshot, in as many cycles. */
+static int CheckSnapshot(enum RSPExecutionMode mode, long cycles) {
+	static uint8_t start[RSP_STATE_SIZE];
+	static uint8_t expected[RSP_STATE_SIZE], actual[RSP_STATE_SIZE];
+	struct RSP *rsp, *fresh;
+	long remaining;
+	int mismatch;
+
+	if ((rsp = CreateCheckedRSP(mode, NULL)) == NULL)
+		return 1;
+
+	if ((fresh = CreateCheckedRSP(mode, NULL)) == NULL) {
+		DestroyRSP(rsp);
+		return 1;
+	}
+
+	RunToCompletion(rsp, cycles);
+	mismatch = RSPSaveState(rsp, start, sizeof(start)) != RSP_STATE_SIZE;
+	remaining = RunToCompletion(rsp, CHECKED_CYCLES);
+	RSPSaveState(rsp, expected, sizeof(expected));
+
+	mismatch |= RSPLoadState(rsp, start, sizeof(start)) ||
+		RunToCompletion(rsp, CHECKED_CYCLES) != remaining ||
+		!RSPSaveState(rsp, actual, sizeof(actual)) ||
+		memcmp(expected, actual, sizeof(actual));
+
+	mismatch |= RSPLoadState(fresh, start, sizeof(start)) ||
+		RunToCompletion(fresh, CHECKED_CYCLES) != remaining ||
+		!RSPSaveState(fresh, actual, sizeof(actual)) ||
+		memcmp(expected, actual, sizeof(actual));
+
+	DestroyRSP(fresh);
+	DestroyRSP(rsp);
+	return mismatch;
+}
+
+/* Checks snapshots taken at each point above, under every mode. */
+static int CheckSnapshots(void) {
+	unsigned i, j, failures = 0;
+
+	printf("\nsnapshot         result\n");
+
+	for (i = 0; i < NUM_MODES; i++) {
+		unsigned mismatches = 0;
+
+		for (j = 0; j < NUM_SNAPSHOT_CYCLES; j++) {
+			mismatches += CheckSnapshot((enum RSPExecutionMode) i,
+				SnapshotCycles[j]);
+		}
+
+		printf("%-16s %6s\n", ModeNames[i], mismatches ? "FAIL" : "ok");
+		failures += mismatches;
+	}
 
-void BusClearRCPInterrupt(struct BusController *unused(bus),
-  unsigned unused(i)) {}
-void BusRaiseRCPInterrupt(struct BusController *unused(bus),
-  unsigned unused(i)) {}
+	return failures != 0;
+}
 
-int DPRegRead(void *unused(rdp), uint32_t unused(address),
-  void *unused(data)) { return 0; }
-int DPRegWrite(void *unused(rdp), uint32_t unused(address),
-  void *unused(data)) { return 0; }
+/* Cycles the program above runs between frames, under -x. */
+#define CHECKED_REWIND_INTERVAL 97
+
+/* Records frames for rewinding while running the program above, */
+/* under every mode. Each is restored and checked against what the */
+/* instance looked like as it was recorded; from the oldest one, */
+/* the program then has to run to the same end as it did before. */
+static int CheckRewind(void) {
+	static uint8_t expected[RSP_STATE_SIZE], actual[RSP_STATE_SIZE];
+	unsigned i, failures = 0;
+
+	printf("\nrewind           result\n");
+
+	for (i = 0; i < NUM_MODES; i++) {
+		struct RSPRewind *rewind;
+		struct RSP *rsp;
+		unsigned pushes, mismatches;
+		long remaining;
+
+		if ((rsp = CreateCheckedRSP((enum RSPExecutionMode) i, NULL)) == NULL)
+			return 1;
+
+		if ((rewind = CreateRSPRewind(rsp, REWIND_FRAMES,
+			REWIND_FRAMES * (size_t) RSP_STATE_SIZE)) == NULL) {
+			DestroyRSP(rsp);
+			return 1;
+		}
+
+		remaining = RecordRewind(rewind, rsp, CHECKED_CYCLES,
+			CHECKED_REWIND_INTERVAL, &pushes);
+		RSPSaveState(rsp, expected, sizeof(expected));
+
+		mismatches = CheckRewindFrames(rewind, rsp, pushes);
+		mismatches += pushes < 2 || RSPRewindGetFrames(rewind) != 1;
+
+		/* The oldest frame was taken one interval in. The run is */
+		/* split up as before: where a run ends can show in state */
+		/* that's left behind in the latches. */
+		mismatches += RecordRewind(rewind, rsp, CHECKED_CYCLES -
+			CHECKED_REWIND_INTERVAL, CHECKED_REWIND_INTERVAL,
+			&pushes) != remaining ||
+			!RSPSaveState(rsp, actual, sizeof(actual)) ||
+			memcmp(expected, actual, sizeof(actual));
+
+		printf("%-16s %6s\n", ModeNames[i], mismatches ? "FAIL" : "ok");
+		failures += mismatches;
+
+		DestroyRSPRewind(rewind);
+		DestroyRSP(rsp);
+	}
+
+	return failures != 0;
+}
+
+/* Cycles in each run -x gives the program above while it waits */
+/* on SIG0, and runs that go by before SIG0 is set. */
+#define CHECKED_IDLE_SLICE 1000
+#define CHECKED_IDLE_SLICES 8
+
+/* Runs the program above with SIG0 clear, in slices: once the */
+/* program has been polling for a few of them, SIG0 is set, as */
+/* the CPU would, and it runs on to its break. Returns the cycles */
+/* used, or -1 if it never got there. */
+static long RunPollingProgram(struct RSP *rsp) {
+	uint32_t status = SP_CLR_SIG0;
+	long cycles = 0;
+	unsigned i;
+
+	SPRegWrite(rsp, SP_REGS_BASE_ADDRESS + SP_STATUS_REG * 4, &status);
+
+	for (i = 0; i < CHECKED_CYCLES / CHECKED_IDLE_SLICE; i++) {
+		if (i == CHECKED_IDLE_SLICES) {
+			status = SP_SET_SIG0;
+			SPRegWrite(rsp, SP_REGS_BASE_ADDRESS + SP_STATUS_REG * 4, &status);
+		}
+
+		cycles += CHECKED_IDLE_SLICE -
+			RunToCompletion(rsp, CHECKED_IDLE_SLICE);
+
+		if (RSPGetRunStatus(rsp) == RSP_RUN_BREAK)
+			return cycles;
+	}
+
+	return -1;
+}
+
+/* Runs the program above (polling, as above) under every mode, */
+/* with idle loops skipped and not: each run has to end the same */
+/* way, in as many cycles, and only the first may skip (which it */
+/* has to have done). */
+static int CheckIdleLoops(void) {
+	static uint8_t expected[RSP_STATE_SIZE], actual[RSP_STATE_SIZE];
+	unsigned i, failures = 0;
+
+	printf("\nidle loop        result\n");
+
+	for (i = 0; i < NUM_MODES; i++) {
+		struct RSP *skipping, *spinning;
+		long cycles;
+		int mismatch;
+
+		if ((skipping = CreateCheckedRSP((enum RSPExecutionMode) i,
+			NULL)) == NULL)
+			return 1;
+
+		if ((spinning = CreateCheckedRSP((enum RSPExecutionMode) i,
+			NULL)) == NULL) {
+			DestroyRSP(skipping);
+			return 1;
+		}
+
+		RSPSetIdleLoopSkipping(skipping, true);
+		RSPSetIdleLoopSkipping(spinning, false);
+
+		cycles = RunPollingProgram(spinning);
+		mismatch = cycles < 0 || RunPollingProgram(skipping) != cycles ||
+			RSPGetSkippedCycles(skipping) == 0 ||
+			RSPGetSkippedCycles(spinning) != 0;
+
+		RSPSaveState(spinning, expected, sizeof(expected));
+		RSPSaveState(skipping, actual, sizeof(actual));
+		mismatch |= memcmp(expected, actual, sizeof(actual));
+
+		printf("%-16s %6s\n", ModeNames[i], mismatch ? "FAIL" : "ok");
+		failures += mismatch;
+
+		DestroyRSP(spinning);
+		DestroyRSP(skipping);
+	}
+
+	return failures != 0;
+}
+
+/* Distinct uCode images -x cycles through the registry; enough */
+/* that the oldest ones get evicted. */
+#define CHECKED_IMAGES (RSP_REGISTRY_SLOTS + 3)
+
+/* Writes a word to an SP register (PC included) or IMEM, as the */
+/* CPU would: through the queue, if given one, or else directly. */
+static void WriteWord(struct RSP *rsp, struct RSPAsync *async,
+	uint32_t address, uint32_t word) {
+	if (async != NULL)
+		RSPAsyncWrite(async, address, word);
+
+	else if (address >= SP_REGS2_BASE_ADDRESS)
+		SPRegWrite2(rsp, address, &word);
+
+	else if (address >= SP_REGS_BASE_ADDRESS)
+		SPRegWrite(rsp, address, &word);
+
+	else
+		RSPIMemWriteWord(rsp, address, &word);
+}
+
+/* Replaces IMEM the way the CPU would (halted, a word at a time) */
+/* with the program above, looping as many times as given, then */
+/* points the PC at it and unhalts. */
+static void UploadProgram(struct RSP *rsp, struct RSPAsync *async,
+	unsigned loops) {
+	unsigned i;
+
+	WriteWord(rsp, async, SP_REGS_BASE_ADDRESS + SP_STATUS_REG * 4,
+		SP_SET_HALT);
+
+	for (i = 0; i < 1024; i++) {
+		uint32_t word = i < sizeof(CheckedProgram) / sizeof(*CheckedProgram)
+			? CheckedProgram[i] : 0;
+
+		if (i == 2)
+			word = IWORD(0x09, 0, 2, loops);
+
+		WriteWord(rsp, async, RSP_IMEM_BASE_ADDRESS + i * 4, word);
+	}
+
+	WriteWord(rsp, async, SP_REGS2_BASE_ADDRESS, 0);
+	WriteWord(rsp, async, SP_REGS_BASE_ADDRESS + SP_STATUS_REG * 4,
+		SP_CLR_HALT | SP_CLR_BROKE);
+}
+
+/* Uploads the program above (as UploadProgram), and runs it to */
+/* its break. */
+static int RunUploadedProgram(struct RSP *rsp, unsigned loops) {
+	UploadProgram(rsp, NULL, loops);
+	RunToCompletion(rsp, CHECKED_CYCLES);
+	return RSPGetRunStatus(rsp) != RSP_RUN_BREAK;
+}
+
+/* Uploads one program, then another, then the first again, which */
+/* the registry has to recognize. Then cycles through more of them */
+/* than it has slots for: the oldest have to be evicted, without */
+/* the registry growing. */
+static int CheckRegistry(void) {
+	struct RSPRegistryStats first, stats;
+	struct RSP *rsp;
+	unsigned i;
+	int hit, eviction;
+
+	printf("\nregistry         result\n");
+
+	if ((rsp = CreateCheckedRSP(RSP_MODE_RECOMPILER, NULL)) == NULL)
+		return 1;
+
+	RunToCompletion(rsp, CHECKED_CYCLES);
+	hit = RSPGetRunStatus(rsp) != RSP_RUN_BREAK;
+	hit |= RunUploadedProgram(rsp, 1);
+	hit |= RunUploadedProgram(rsp, 24);
+	RSPGetRegistryStats(rsp, &first);
+
+	hit |= first.hits != 1 || first.misses != 2 ||
+		first.evictions != 0 || first.footprint == 0;
+
+	printf("%-16s %6s\n", "hit", hit ? "FAIL" : "ok");
+
+	for (i = 2, eviction = 0; i < CHECKED_IMAGES; i++)
+		eviction |= RunUploadedProgram(rsp, i);
+
+	RSPGetRegistryStats(rsp, &stats);
+
+	eviction |= stats.hits != 1 || stats.misses != CHECKED_IMAGES ||
+		stats.evictions != CHECKED_IMAGES - RSP_REGISTRY_SLOTS ||
+		stats.footprint != first.footprint;
+
+	printf("%-16s %6s\n", "eviction", eviction ? "FAIL" : "ok");
+
+	DestroyRSP(rsp);
+	return hit | eviction;
+}
+
+/* Cycles in each of the runs -x queues up one after another; */
+/* few enough that the program takes a few hundred of them. */
+#define CHECKED_ASYNC_SLICE 5
+
+/* Runs the program above through the queue under a mode, in one */
+/* run, then uploads it again (more words than the queue holds) */
+/* and runs it in slices. Each time, it has to end in the same */
+/* snapshot, status and cycles as when run directly, split up the */
+/* same way (where a run ends can show in the latches). */
+static int CheckAsyncMode(enum RSPExecutionMode mode) {
+	static uint8_t expected[RSP_STATE_SIZE], actual[RSP_STATE_SIZE];
+	struct RSP *direct, *queued;
+	struct RSPAsync *async;
+	unsigned long long cycles;
+	uint32_t word;
+	unsigned i;
+	int mismatch;
+
+	if ((direct = CreateCheckedRSP(mode, NULL)) == NULL)
+		return 1;
+
+	if ((queued = CreateCheckedRSP(mode, NULL)) == NULL) {
+		DestroyRSP(direct);
+		return 1;
+	}
+
+	if ((async = CreateRSPAsync(queued)) == NULL) {
+		DestroyRSP(queued);
+		DestroyRSP(direct);
+		return 1;
+	}
+
+	/* In one run. */
+	cycles = CHECKED_CYCLES - RunToCompletion(direct, CHECKED_CYCLES);
+	RSPAsyncRun(async, CHECKED_CYCLES);
+	RSPAsyncSync(async);
+
+	mismatch = RSPGetRunStatus(direct) != RSP_RUN_BREAK ||
+		RSPAsyncGetCycles(async) != cycles ||
+		RSPAsyncGetStatus(async) != direct->cp0.regs[SP_STATUS_REG];
+
+	RSPSaveState(direct, expected, sizeof(expected));
+	RSPSaveState(queued, actual, sizeof(actual));
+	mismatch |= memcmp(expected, actual, sizeof(actual));
+
+	/* In slices, after an upload that wraps the queue around. */
+	UploadProgram(direct, NULL, 24);
+	UploadProgram(queued, async, 24);
+
+	for (i = 0; i < CHECKED_CYCLES / CHECKED_ASYNC_SLICE &&
+		!(direct->cp0.regs[SP_STATUS_REG] & SP_STATUS_HALT); i++) {
+		cycles += CHECKED_ASYNC_SLICE -
+			RunToCompletion(direct, CHECKED_ASYNC_SLICE);
+		RSPAsyncRun(async, CHECKED_ASYNC_SLICE);
+	}
+
+	RSPDMemReadWord(direct, RSP_DMEM_BASE_ADDRESS + 0x600, &word);
+
+	mismatch |= RSPGetRunStatus(direct) != RSP_RUN_BREAK ||
+		RSPAsyncRead(async, SP_REGS_BASE_ADDRESS + SP_STATUS_REG * 4) !=
+		direct->cp0.regs[SP_STATUS_REG] ||
+		RSPAsyncRead(async, RSP_DMEM_BASE_ADDRESS + 0x600) != word ||
+		RSPAsyncGetCycles(async) != cycles;
+
+	DestroyRSPAsync(async);
+	RSPSaveState(direct, expected, sizeof(expected));
+	RSPSaveState(queued, actual, sizeof(actual));
+	mismatch |= memcmp(expected, actual, sizeof(actual));
+
+	DestroyRSP(queued);
+	DestroyRSP(direct);
+	return mismatch;
+}
+
+/* Checks running through the queue, under every mode. */
+static int CheckAsync(void) {
+	unsigned i, failures = 0;
+
+	printf("\nasync            result\n");
+
+	for (i = 0; i < NUM_MODES; i++) {
+		int mismatch = CheckAsyncMode((enum RSPExecutionMode) i);
+
+		printf("%-16s %6s\n", ModeNames[i], mismatch ? "FAIL" : "ok");
+		failures += mismatch;
+	}
+
+	return failures != 0;
+}
+
+/* File that -x writes a cache file to (and removes after). */
+#define CHECKED_CACHE_FILE "rspsim-x.cache"
+
+/* What -x does to a cache file before it is loaded: all but */
+/* the first have to be noticed, and the file ignored. */
+enum CacheFileDamage {
+	CACHE_FILE_INTACT,
+	CACHE_FILE_TRUNCATED,
+	CACHE_FILE_STALE,
+	CACHE_FILE_FLIPPED,
+	NUM_CACHE_FILE_DAMAGES
+};
+
+static const char *CacheFileDamageNames[NUM_CACHE_FILE_DAMAGES] = {
+	"intact", "truncated", "stale", "bit flipped"
+};
+
+/* Writes out a copy of a cache file, damaged as given. */
+static int WriteDamagedCacheFile(const uint8_t *image, size_t size,
+	enum CacheFileDamage damage) {
+	static uint8_t copy[sizeof(struct RSPCacheFileHeader) +
+		RSP_CACHE_FILE_MAX_RECORDS * sizeof(struct RSPCacheRecord)];
+	struct RSPCacheFileHeader header;
+	FILE *file;
+	int failed;
+
+	memcpy(copy, image, size);
+	memcpy(&header, copy, sizeof(header));
+
+	switch (damage) {
+		case CACHE_FILE_TRUNCATED:
+			size -= sizeof(struct RSPCacheRecord) / 2;
+			break;
+
+		case CACHE_FILE_STALE:
+			header.version++;
+			memcpy(copy, &header, sizeof(header));
+			break;
+
+		case CACHE_FILE_FLIPPED:
+			copy[sizeof(header) + offsetof(struct RSPCacheRecord, words) +
+				sizeof(struct RSPCachedInstruction) * 5 + 1] ^= 0x10;
+			break;
+
+		default:
+			break;
+	}
+
+	if ((file = fopen(CHECKED_CACHE_FILE, "wb")) == NULL)
+		return 1;
+
+	failed = fwrite(copy, 1, size, file) != size;
+	return fclose(file) || failed;
+}
+
+/* Saves a cache file after running the program above under the */
+/* recompiler, and runs it again with the file loaded: intact, */
+/* its blocks have to be translated before it starts, and damaged */
+/* (or stale) it has to be ignored. Either way, the program has */
+/* to end as it does under the pipeline, in as many cycles. */
+static int CheckCacheFile(void) {
+	static uint8_t image[sizeof(struct RSPCacheFileHeader) +
+		RSP_CACHE_FILE_MAX_RECORDS * sizeof(struct RSPCacheRecord)];
+	struct RSP *expected, *rsp;
+	long remaining;
+	unsigned i, failures = 0;
+	size_t size = 0;
+	FILE *file;
+
+	printf("\ncache file       result\n");
+
+	if ((expected = CreateCheckedRSP(RSP_MODE_PIPELINE, NULL)) == NULL)
+		return 1;
+
+	if ((rsp = CreateCheckedRSP(RSP_MODE_RECOMPILER, NULL)) == NULL) {
+		DestroyRSP(expected);
+		return 1;
+	}
+
+	remaining = RunToCompletion(expected, CHECKED_CYCLES);
+	RunToCompletion(rsp, CHECKED_CYCLES);
+
+	if (RSPSaveCacheFile(rsp, CHECKED_CACHE_FILE) ||
+		(file = fopen(CHECKED_CACHE_FILE, "rb")) == NULL) {
+		printf("Failed to write the cache file.\n");
+		DestroyRSP(expected);
+		DestroyRSP(rsp);
+		return 1;
+	}
+
+	size = fread(image, 1, sizeof(image), file);
+	fclose(file);
+	DestroyRSP(rsp);
+
+	for (i = 0; i < NUM_CACHE_FILE_DAMAGES; i++) {
+		struct RSPRegistryStats stats;
+		int mismatch, used = i == CACHE_FILE_INTACT;
+
+		if (WriteDamagedCacheFile(image, size, (enum CacheFileDamage) i) ||
+			(rsp = CreateCheckedRSP(RSP_MODE_RECOMPILER,
+			CHECKED_CACHE_FILE)) == NULL) {
+			failures++;
+			continue;
+		}
+
+		RSPGetRegistryStats(rsp, &stats);
+		mismatch = stats.fileHits != (unsigned long long) used;
+
+#ifdef RSP_HAVE_RECOMPILER
+		mismatch |= used != (rsp->recompiler != NULL &&
+			rsp->recompiler->numBlocks > 0);
+#endif
+
+		mismatch |= RunToCompletion(rsp, CHECKED_CYCLES) != remaining ||
+			RSPGetRunStatus(rsp) != RSP_RUN_BREAK ||
+			!SameState(expected, rsp);
+
+		printf("%-16s %6s\n", CacheFileDamageNames[i],
+			mismatch ? "FAIL" : "ok");
+
+		failures += mismatch;
+		DestroyRSP(rsp);
+	}
+
+	remove(CHECKED_CACHE_FILE);
+	DestroyRSP(expected);
+	return failures != 0;
+}
+
+/* Reads one 4KiB memory image out of the uCode file. */
+static int ReadImage(FILE *rspUCodeFile, uint8_t *image) {
+	size_t total, size;
+
+	for (size = 0, total = 0; total < 4096; total += size) {
+		size = fread(image + total, 1, 4096 - total, rspUCodeFile);
+
+		if (ferror(rspUCodeFile))
+			return 1;
+
+		if (size == 0)
+			break;
+	}
+
+	return 0;
+}
+
+/* Reads a DRAM snapshot, padded out to a multiple of 32 bytes. */
+static int ReadDRAM(const char *path, struct BusController *bus) {
+	FILE *dramFile;
+	long size;
+
+	if ((dramFile = fopen(path, "rb")) == NULL)
+		return 1;
+
+	if (fseek(dramFile, 0, SEEK_END) || (size = ftell(dramFile)) < 0 ||
+		fseek(dramFile, 0, SEEK_SET)) {
+		fclose(dramFile);
+		return 1;
+	}
+
+	bus->size = ((size_t) size + 31) & ~(size_t) 31;
+
+	if ((bus->dram = (uint8_t*) calloc(bus->size + 32, 1)) == NULL ||
+		fread(bus->dram, 1, size, dramFile) != (size_t) size) {
+		fclose(dramFile);
+		return 1;
+	}
+
+	fclose(dramFile);
+	return 0;
+}
+
+/* Parses one line of a task list (see the usage) into a task. */
+/* Returns -1 for blank lines and comments, 1 on errors. */
+static int ReadTask(char *line, struct BatchEntry *entry,
+	struct RSPBatchTask *task) {
+	char *token, *value;
+	FILE *rspUCodeFile;
+
+	memset(task, 0, sizeof(*task));
+	entry->bus.dram = NULL;
+	entry->bus.size = 0;
+
+	if ((token = strtok(line, " \t\r\n")) == NULL || token[0] == '#')
+		return -1;
+
+	strncpy(entry->name, token, sizeof(entry->name) - 1);
+	entry->name[sizeof(entry->name) - 1] = '\0';
+
+	if ((rspUCodeFile = fopen(token, "rb")) == NULL)
+		return 1;
+
+	if (ReadImage(rspUCodeFile, entry->imem) ||
+		ReadImage(rspUCodeFile, entry->dmem)) {
+		fclose(rspUCodeFile);
+		return 1;
+	}
+
+	fclose(rspUCodeFile);
+
+	if ((token = strtok(NULL, " \t\r\n")) == NULL)
+		return 1;
+
+	task->cycles = strtoull(token, NULL, 0);
+	task->imem = entry->imem;
+	task->dmem = entry->dmem;
+	task->bus = &entry->bus;
+
+	while ((token = strtok(NULL, " \t\r\n")) != NULL) {
+		if ((value = strchr(token, '=')) == NULL)
+			return 1;
+
+		*value++ = '\0';
+
+		if (!strcmp(token, "dram")) {
+			if (entry->bus.dram != NULL || ReadDRAM(value, &entry->bus))
+				return 1;
+
+			task->dram = entry->bus.dram;
+			task->dramSize = entry->bus.size;
+		}
+
+		else if (!strcmp(token, "pc"))
+			task->pc = strtoul(value, NULL, 0);
+
+		else if (token[0] == 'r' && atoi(token + 1) > 0 &&
+			atoi(token + 1) < NUM_RSP_REGISTERS)
+			task->regs[atoi(token + 1)] = strtoul(value, NULL, 0);
+
+		else
+			return 1;
+	}
+
+	return 0;
+}
+
+/* Runs every task in a task list, a chunk at a time, */
+/* and prints the outcome of each as it goes. */
+static int RunTaskList(const char *path,
+	enum RSPExecutionMode mode, unsigned threads) {
+	static struct BatchEntry entries[BATCH_CHUNK];
+	static struct RSPBatchTask tasks[BATCH_CHUNK];
+	unsigned long lineNumber = 0;
+	size_t count = 0, i;
+	char line[4096];
+	int status = 0;
+	FILE *list;
+
+	if ((list = fopen(path, "r")) == NULL) {
+		printf("Failed to open the task list.\n");
+		return 1;
+	}
+
+	for (;;) {
+		int more = fgets(line, sizeof(line), list) != NULL;
+
+		if (more) {
+			int result = ReadTask(line, &entries[count], &tasks[count]);
+			lineNumber++;
+
+			if (result == 0)
+				count++;
+
+			else if (result > 0) {
+				printf("Unable to load the task on line %lu.\n", lineNumber);
+				free(entries[count].bus.dram);
+				status = 1;
+			}
+		}
+
+		if (count == BATCH_CHUNK || (!more && count > 0)) {
+			if (RSPRunBatch(tasks, count, threads, mode)) {
+				printf("Failed to initialize the RSPs.\n");
+				status = 2;
+			}
+
+			else for (i = 0; i < count; i++) {
+				printf("%s %s %llu %016llx %016llx\n", entries[i].name,
+					StatusNames[tasks[i].status], tasks[i].cyclesRun,
+					(unsigned long long) tasks[i].dmemHash,
+					(unsigned long long) tasks[i].dramHash);
+			}
+
+			for (i = 0; i < count; i++)
+				free(entries[i].bus.dram);
+
+			count = 0;
+		}
+
+		if (!more || status == 2)
+			break;
+	}
+
+	fclose(list);
+	return status;
+}
 
 /* Entry point. */
 int main(int argc, const char *argv[]) {
+	static uint8_t imem[4096], dmem[4096];
+	enum RSPExecutionMode mode = RSP_MODE_PIPELINE;
+	const char *cacheFile = NULL, *taskList = NULL;
+	unsigned threads = 0;
+	long rewindInterval = 0;
 	FILE *rspUCodeFile;
 	struct RSP *rsp;
-	size_t total, size;
-	long i, cycles;
+	int benchmark = 0, vectorBenchmark = 0, vectorCheck = 0;
+	long cycles;
+	unsigned i;
+	int arg;
+
+	for (arg = 1; arg < argc && argv[arg][0] == '-'; arg++) {
+		if (!strcmp(argv[arg], "-b"))
+			benchmark = 1;
+
+		else if (!strcmp(argv[arg], "-c") && arg + 1 < argc)
+			cacheFile = argv[++arg];
+
+		else if (!strcmp(argv[arg], "-i"))
+			SkipIdleLoops = 0;
+
+		else if (!strcmp(argv[arg], "-j") && arg + 1 < argc)
+			threads = strtoul(argv[++arg], NULL, 10);
+
+		else if (!strcmp(argv[arg], "-m") && arg + 1 < argc) {
+			for (i = 0, arg++; i < NUM_MODES; i++)
+				if (!strcmp(argv[arg], ModeNames[i]))
+					break;
+
+			if (i == NUM_MODES) {
+				printf("Unknown execution mode: %s\n", argv[arg]);
+				return 0;
+			}
+
+			mode = (enum RSPExecutionMode) i;
+		}
+
+		else if (!strcmp(argv[arg], "-r") && arg + 1 < argc)
+			taskList = argv[++arg];
+
+		else if (!strcmp(argv[arg], "-v"))
+			vectorBenchmark = 1;
 
-	if (argc != 3) {
-		printf("Usage: %s <uCode> <Cycles>\n", argv[0]);
+		else if (!strcmp(argv[arg], "-x"))
+			vectorCheck = 1;
+
+		else if (!strcmp(argv[arg], "-w") && arg + 1 < argc)
+			rewindInterval = strtol(argv[++arg], NULL, 10);
+
+		else
+			break;
+	}
+
+	if (taskList != NULL && arg == argc)
+		return RunTaskList(taskList, mode, threads);
+
+	if (vectorBenchmark && arg == argc)
+		return BenchmarkVectorUnit();
+
+	if (vectorCheck && arg == argc)
+		return CheckVectorUnit() | CheckModes() | CheckSnapshots() |
+			CheckRewind() | CheckIdleLoops() | CheckRegistry() |
+			CheckAsync() | CheckCacheFile();
+
+	if (argc - arg != 2) {
+		printf("Usage: %s [-b] [-c <file>] [-i] [-m <mode>] "
+			"[-w <cycles>]\n         <uCode> <Cycles>\n", argv[0]);
+		printf("       %s [-j <threads>] [-m <mode>] -r <tasks>\n", argv[0]);
+		printf("       %s -v | -x\n", argv[0]);
+		printf("  -b  Run the uCode under every mode and compare speeds.\n");
+		printf("  -c  Load/save decoded uCode from/to a file.\n");
+		printf("  -i  Run polling loops out instead of skipping them.\n");
+		printf("  -j  Threads to run tasks on (default: one per CPU).\n");
+		printf("  -m  One of: pipeline, recompiler, functional, "
+			"functional-table.\n");
+		printf("  -r  Run each task in a list, one per line, as:\n");
+		printf("      <uCode> <Cycles> [dram=<file>] [pc=<addr>] "
+			"[r<N>=<value>]...\n");
+		printf("  -v  Time each vector opcode and fused idiom per backend.\n");
+		printf("  -w  Record a frame for rewinding every so many cycles "
+			"(and check each).\n");
+		printf("  -x  Check the trickier opcodes, fused idioms, element forms and products,\n");
+		printf("      a program under every mode (from snapshots and "
+			"rewinds, too), idle\n");
+		printf("      loop skipping, the registry, the async queue and cache "
+			"files.\n");
 		return 0;
 	}
 
-	/* Open the uCode file, create an RSP instance. */
-	if ((rspUCodeFile = fopen(argv[1], "rb")) == NULL) {
+	/* Read the uCode (IMEM, then DMEM image). */
+	if ((rspUCodeFile = fopen(argv[arg], "rb")) == NULL) {
 		printf("Failed to open RSP uCode.\n");
 
 		return 1;
 	}
 
-	if ((rsp = CreateRSP()) == NULL) {
-		printf("Failed to initialize the RSP.\n");
+	if (ReadImage(rspUCodeFile, imem) || ReadImage(rspUCodeFile, dmem)) {
+		printf("Unable to read the uCode file.\n");
 
 		fclose(rspUCodeFile);
-		return 2;
+		return 3;
 	}
 
-	/* Read the uCode into the RSP. */
-	for (size = 0, total = 0; total < 4096; total += size) {
-		size = fread(rsp->imem + total, 1, 4096 - total, rspUCodeFile);
+	fclose(rspUCodeFile);
+	cycles = strtol(argv[arg + 1], NULL, 10);
+
+	/* Time each mode on a fresh instance. The functional */
+	/* modes count instructions rather than cycles. */
+	if (benchmark) {
+		for (i = 0; i < NUM_MODES; i++) {
+			long remaining;
+			clock_t start;
+			double seconds;
 
-		if (ferror(rspUCodeFile)) {
-			printf("Unable to read the uCode file.\n");
+			if ((rsp = CreateLoadedRSP(imem, dmem,
+				(enum RSPExecutionMode) i, NULL)) == NULL) {
+				printf("Failed to initialize the RSP.\n");
+
+				return 2;
+			}
+
+			start = clock();
+			remaining = RunToCompletion(rsp, cycles);
+			seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+			printf("%-16s %10ld steps in %.3fs (%.1f M/s)\n", ModeNames[i],
+				cycles - remaining, seconds, seconds > 0
+					? (cycles - remaining) / seconds / 1e6 : 0.0);
 
-			fclose(rspUCodeFile);
 			DestroyRSP(rsp);
-			return 3;
 		}
-	}
 
-	/* Read the uCode into the RSP. */
-	for (size = 0, total = 0; total < 4096; total += size) {
-		size = fread(rsp->dmem + total, 1, 4096 - total, rspUCodeFile);
+		/* Populate the cache file, then compare cold and warm starts. */
+		if (cacheFile != NULL) {
+			double cold, warm;
+
+			if ((rsp = CreateLoadedRSP(imem, dmem, mode, NULL)) == NULL) {
+				printf("Failed to initialize the RSP.\n");
 
-		if (ferror(rspUCodeFile)) {
-			printf("Unable to read the uCode file.\n");
+				return 2;
+			}
 
-			fclose(rspUCodeFile);
+			RunToCompletion(rsp, cycles);
+			RSPSaveCacheFile(rsp, cacheFile);
 			DestroyRSP(rsp);
-			return 3;
+
+			cold = TimeStartup(imem, dmem, mode, NULL, cycles);
+			warm = TimeStartup(imem, dmem, mode, cacheFile, cycles);
+
+			printf("startup (cold)   %10.1fus per instance\n", cold * 1e6);
+			printf("startup (cached) %10.1fus per instance\n", warm * 1e6);
 		}
+
+		return 0;
 	}
 
-	fclose(rspUCodeFile);
-	cycles = strtol(argv[2], NULL, 10);
+	if ((rsp = CreateLoadedRSP(imem, dmem, mode, cacheFile)) == NULL) {
+		printf("Failed to initialize the RSP.\n");
+
+		return 2;
+	}
 
 	printf("Running RSP for %ld cycles.\n", cycles);
-  rsp->cp0.regs[SP_STATUS_REG] = 0; /* Unhalt. */
 
-	for (i = 0; i < cycles; i++)
-		CycleRSP(rsp);
+	cycles = rewindInterval > 0
+		? RunWithRewind(rsp, cycles, rewindInterval)
+		: RunToCompletion(rsp, cycles);
+
+	if (cycles > 0)
+		printf("RSP halted with %ld cycles remaining.\n", cycles);
+
+	if (RSPGetSkippedCycles(rsp) > 0)
+		printf("Skipped %llu cycles in polling loops.\n",
+			RSPGetSkippedCycles(rsp));
 
 	RSPDumpRegisters(rsp);
+
+	if (cacheFile != NULL && RSPSaveCacheFile(rsp, cacheFile))
+		printf("Unable to write the cache file.\n");
+
+	DestroyRSP(rsp);
 	return 0;
 }
-